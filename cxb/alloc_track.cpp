@@ -0,0 +1,293 @@
+#include "alloc_track.h"
+#include "format.h"
+#include "profile.h"
+
+#include <new>
+
+#if defined(CXB_PLATFORM_UNIX)
+#include <dlfcn.h>
+#endif
+
+struct AllocTrackThread {
+    AllocSite sites[ALLOC_TRACK_MAX_SITES];
+    AllocSite overflow[2]; // indexed by AllocSiteKind
+    u32 n_sites;
+    AllocTrackThread* next;
+};
+
+// precedes every allocation of the tracking allocator
+struct AllocTrackHeader {
+    AllocSite* site;
+    u64 t_alloc;
+    u64 n_header_bytes; // >= sizeof(AllocTrackHeader), the inner allocation starts n_header_bytes before the data
+    u64 _pad;
+};
+static_assert(sizeof(AllocTrackHeader) == 32);
+
+INTERNAL Atomic<AllocTrackThread*> alloc_track_threads = nullptr;
+INTERNAL thread_local AllocTrackThread* alloc_track_thread = nullptr;
+// set while reporting, such that the report's own arena pushes are not recorded
+INTERNAL thread_local bool alloc_track_busy = false;
+thread_local void* alloc_track_entry_site = nullptr;
+
+INTERNAL AllocTrackThread* _alloc_track_thread_init() {
+    // NOTE: not allocated through an arena, arena pushes are tracked
+    void* mem = calloc(1, sizeof(AllocTrackThread));
+    ASSERT(mem, "could not allocate the allocation tracking table");
+    AllocTrackThread* t = new(mem) AllocTrackThread{};
+    t->overflow[ALLOC_SITE_ALLOCATOR].kind = ALLOC_SITE_ALLOCATOR;
+    t->overflow[ALLOC_SITE_ARENA].kind = ALLOC_SITE_ARENA;
+
+    AllocTrackThread* head = alloc_track_threads.load();
+    do {
+        t->next = head;
+    } while(!alloc_track_threads.compare_exchange_weak(head, t));
+    alloc_track_thread = t;
+    return t;
+}
+
+INTERNAL AllocSite* _alloc_track_site(void* addr, AllocSiteKind kind) {
+    AllocTrackThread* t = alloc_track_thread;
+    if(UNLIKELY(!t)) {
+        t = _alloc_track_thread_init();
+    }
+
+    u64 mask = ALLOC_TRACK_MAX_SITES - 1;
+    u64 i = (((u64) addr) * 0x9E3779B97F4A7C15ull) >> 40;
+    for(u32 probe = 0; probe < ALLOC_TRACK_MAX_SITES; ++probe, ++i) {
+        AllocSite* s = &t->sites[i & mask];
+        void* x = s->addr.load(memory_order_relaxed);
+        if(LIKELY(x == addr && s->kind == kind)) {
+            return s;
+        }
+        if(x == nullptr) {
+            // only the owning thread inserts: kind is written before addr is published to readers
+            if(t->n_sites >= ALLOC_TRACK_MAX_SITES * 3 / 4) {
+                break;
+            }
+            s->kind = kind;
+            s->addr.store(addr, memory_order_release);
+            t->n_sites += 1;
+            return s;
+        }
+    }
+    return &t->overflow[kind];
+}
+
+INTERNAL void _alloc_track_add_live(AllocSite* s, u64 n_bytes) {
+    u64 live = s->live_bytes.fetch_add(n_bytes, memory_order_relaxed) + n_bytes;
+    u64 peak = s->peak_live_bytes.load(memory_order_relaxed);
+    while(live > peak && !s->peak_live_bytes.compare_exchange_weak(peak, live)) {
+    }
+}
+
+INTERNAL CXB_INLINE u32 _alloc_track_lifetime_bucket(u64 ticks) {
+    u32 log2 = 63 - (u32) __builtin_clzll(ticks | 1);
+    return min(log2, ALLOC_TRACK_LIFETIME_BUCKETS - 1);
+}
+
+void alloc_track_arena_push(void* site_addr, u64 n_bytes) {
+    if(alloc_track_busy) return;
+    // e.g. an MArray growing on an arena is attributed to the caller of the container
+    if(alloc_track_entry_site) site_addr = alloc_track_entry_site;
+    AllocSite* s = _alloc_track_site(site_addr, ALLOC_SITE_ARENA);
+    s->n_allocs.fetch_add(1, memory_order_relaxed);
+    s->n_bytes.fetch_add(n_bytes, memory_order_relaxed);
+}
+
+/* SECTION: tracking allocator */
+INTERNAL void* alloc_track_alloc_proc(
+    void* head, size_t n_bytes, size_t alignment, size_t old_n_bytes, bool fill_zeros, void* data) {
+    Allocator* inner = (Allocator*) data;
+
+    if(head == nullptr) {
+        // without CXB_ALLOC_TRACKING there are no entry points, the site is the caller of alloc_proc
+        void* site_addr = alloc_track_entry_site ? alloc_track_entry_site : __builtin_return_address(0);
+        size_t n_header_bytes = max(sizeof(AllocTrackHeader), alignment);
+        size_t inner_alignment = max(alignof(AllocTrackHeader), alignment);
+        char* base = (char*) inner->alloc_proc(
+            nullptr, n_bytes + n_header_bytes, inner_alignment, 0, fill_zeros, inner->data);
+        if(!base) return nullptr;
+
+        AllocSite* s = _alloc_track_site(site_addr, ALLOC_SITE_ALLOCATOR);
+        AllocTrackHeader* h = (AllocTrackHeader*) (base + n_header_bytes) - 1;
+        h->site = s;
+        h->t_alloc = profile_now();
+        h->n_header_bytes = n_header_bytes;
+        s->n_allocs.fetch_add(1, memory_order_relaxed);
+        s->n_bytes.fetch_add(n_bytes, memory_order_relaxed);
+        _alloc_track_add_live(s, n_bytes);
+        return base + n_header_bytes;
+    }
+
+    // NOTE: a reallocation stays attributed to the site of the original allocation
+    AllocTrackHeader* h = (AllocTrackHeader*) head - 1;
+    AllocSite* s = h->site;
+    size_t n_header_bytes = h->n_header_bytes;
+    size_t inner_alignment = max(alignof(AllocTrackHeader), alignment);
+    char* base = (char*) inner->alloc_proc((char*) head - n_header_bytes,
+                                           n_bytes + n_header_bytes,
+                                           inner_alignment,
+                                           old_n_bytes + n_header_bytes,
+                                           fill_zeros,
+                                           inner->data);
+    if(!base) return nullptr;
+
+    if(n_bytes >= old_n_bytes) {
+        s->n_bytes.fetch_add(n_bytes - old_n_bytes, memory_order_relaxed);
+        _alloc_track_add_live(s, n_bytes - old_n_bytes);
+    } else {
+        s->live_bytes.fetch_sub(old_n_bytes - n_bytes, memory_order_relaxed);
+    }
+    return base + n_header_bytes;
+}
+
+INTERNAL void alloc_track_free_proc(void* head, size_t n_bytes, void* data) {
+    Allocator* inner = (Allocator*) data;
+    if(!head) return;
+
+    AllocTrackHeader* h = (AllocTrackHeader*) head - 1;
+    AllocSite* s = h->site;
+    u64 lifetime = profile_now() - h->t_alloc;
+    s->n_frees.fetch_add(1, memory_order_relaxed);
+    s->live_bytes.fetch_sub(n_bytes, memory_order_relaxed);
+    s->lifetimes[_alloc_track_lifetime_bucket(lifetime)].fetch_add(1, memory_order_relaxed);
+
+    size_t n_header_bytes = h->n_header_bytes;
+    inner->free_proc((char*) head - n_header_bytes, n_bytes + n_header_bytes, inner->data);
+}
+
+// NOTE: allocations released in bulk are not attributed, they stay live in the report
+INTERNAL void alloc_track_free_all_proc(void* data) {
+    Allocator* inner = (Allocator*) data;
+    inner->free_all_proc(inner->data);
+}
+
+Allocator alloc_track_allocator(Allocator* inner) {
+    return Allocator{.alloc_proc = alloc_track_alloc_proc,
+                     .free_proc = alloc_track_free_proc,
+                     .free_all_proc = alloc_track_free_all_proc,
+                     .data = (void*) inner};
+}
+
+/* SECTION: reports */
+INTERNAL void _alloc_track_accumulate(AllocSiteStats& dst, const AllocSite& s) {
+    dst.n_allocs += s.n_allocs.load(memory_order_relaxed);
+    dst.n_frees += s.n_frees.load(memory_order_relaxed);
+    dst.n_bytes += s.n_bytes.load(memory_order_relaxed);
+    dst.live_bytes += s.live_bytes.load(memory_order_relaxed);
+    dst.peak_live_bytes += s.peak_live_bytes.load(memory_order_relaxed);
+    for(u32 i = 0; i < ALLOC_TRACK_LIFETIME_BUCKETS; ++i) {
+        dst.lifetimes[i] += s.lifetimes[i].load(memory_order_relaxed);
+    }
+}
+
+INTERNAL void _alloc_track_merge(AArray<AllocSiteStats>& stats, void* addr, AllocSiteKind kind, const AllocSite& s) {
+    if(s.n_allocs.load(memory_order_relaxed) == 0) return;
+    for(AllocSiteStats& x : stats) {
+        if(x.addr == addr && x.kind == kind) {
+            _alloc_track_accumulate(x, s);
+            return;
+        }
+    }
+    AllocSiteStats x = {};
+    x.addr = addr;
+    x.kind = kind;
+    _alloc_track_accumulate(x, s);
+    stats.push_back(x);
+}
+
+Array<AllocSiteStats> alloc_track_snapshot(Arena* a) {
+    bool was_busy = alloc_track_busy;
+    alloc_track_busy = true;
+
+    AArray<AllocSiteStats> stats{};
+    for(AllocTrackThread* t = alloc_track_threads.load(); t; t = t->next) {
+        for(u32 i = 0; i < ALLOC_TRACK_MAX_SITES; ++i) {
+            const AllocSite& s = t->sites[i];
+            void* addr = s.addr.load(memory_order_acquire);
+            if(addr) _alloc_track_merge(stats, addr, s.kind, s);
+        }
+        _alloc_track_merge(stats, nullptr, ALLOC_SITE_ALLOCATOR, t->overflow[ALLOC_SITE_ALLOCATOR]);
+        _alloc_track_merge(stats, nullptr, ALLOC_SITE_ARENA, t->overflow[ALLOC_SITE_ARENA]);
+    }
+    merge_sort(stats.data, stats.len, [](const AllocSiteStats& x, const AllocSiteStats& y) {
+        return x.live_bytes != y.live_bytes ? x.live_bytes > y.live_bytes : x.n_bytes > y.n_bytes;
+    });
+    Array<AllocSiteStats> result =
+        stats.len > 0 ? arena_push_array(a, Array<AllocSiteStats>(stats)) : Array<AllocSiteStats>{};
+
+    alloc_track_busy = was_busy;
+    return result;
+}
+
+String8 alloc_track_site_name(Arena* a, void* addr) {
+    if(!addr) {
+        return arena_push_string8(a, S8_LIT("<overflow>"));
+    }
+#if defined(CXB_PLATFORM_UNIX)
+    Dl_info info = {};
+    if(dladdr(addr, &info) && info.dli_sname) {
+        return format(a, "{}+{}", info.dli_sname, (u64) ((char*) addr - (char*) info.dli_saddr));
+    }
+    if(info.dli_fname) {
+        return format(a, "{}+{}", info.dli_fname, (u64) ((char*) addr - (char*) info.dli_fbase));
+    }
+#endif
+    return format(a, "{}", addr);
+}
+
+f64 alloc_track_lifetime_quantile_ns(const AllocSiteStats& s, f64 q) {
+    u64 total = 0;
+    for(u32 i = 0; i < ALLOC_TRACK_LIFETIME_BUCKETS; ++i) total += s.lifetimes[i];
+    if(total == 0) return 0;
+
+    u64 target = (u64) (q * (f64) total);
+    u64 seen = 0;
+    u32 bucket = 0;
+    for(; bucket < ALLOC_TRACK_LIFETIME_BUCKETS - 1; ++bucket) {
+        seen += s.lifetimes[bucket];
+        if(seen > target) break;
+    }
+    // upper bound of the bucket
+    return (f64) (1ull << (bucket + 1)) / profile_ticks_per_ns();
+}
+
+void alloc_track_print_report(FILE* f, u64 max_sites) {
+    bool was_busy = alloc_track_busy;
+    alloc_track_busy = true;
+
+    AArenaTmp tmp = begin_scratch();
+    Array<AllocSiteStats> stats = alloc_track_snapshot(tmp.arena);
+    u64 live = 0;
+    u64 total = 0;
+    for(const AllocSiteStats& s : stats) {
+        live += s.live_bytes;
+        total += s.n_bytes;
+    }
+    print(f, tmp.arena, "{} sites, {} live bytes, {} bytes allocated\n", stats.len, live, total);
+    for(u64 i = 0; i < min(max_sites, (u64) stats.len); ++i) {
+        const AllocSiteStats& s = stats[i];
+        String8 name = alloc_track_site_name(tmp.arena, s.addr);
+        if(s.kind == ALLOC_SITE_ARENA) {
+            print(f, tmp.arena, "[arena] {}: pushes={} bytes={}\n", name, s.n_allocs, s.n_bytes);
+        } else {
+            print(f,
+                  tmp.arena,
+                  "[alloc] {}: allocs={} frees={} bytes={} live={} peak={}",
+                  name,
+                  s.n_allocs,
+                  s.n_frees,
+                  s.n_bytes,
+                  s.live_bytes,
+                  s.peak_live_bytes);
+            if(s.n_frees > 0) {
+                f64 p50 = alloc_track_lifetime_quantile_ns(s, 0.5);
+                f64 p99 = alloc_track_lifetime_quantile_ns(s, 0.99);
+                print(f, tmp.arena, " lifetime p50<{.0}ns p99<{.0}ns", p50, p99);
+            }
+            fputc('\n', f);
+        }
+    }
+    alloc_track_busy = was_busy;
+}
@@ -0,0 +1,76 @@
+/*
+# cxb/alloc_track: allocation tracking by call site
+
+* `alloc_track_allocator(inner)` wraps any `Allocator`. Every allocation carries a small header (call site, timestamp)
+  such that frees and reallocations are attributed to the site that allocated, along with a histogram of lifetimes
+* with `CXB_ALLOC_TRACKING` defined, `arena_push_bytes` and `arena_push_bytes_inline` record every push by call site.
+  Arena memory is released in bulk, i.e. arena sites only count pushes and bytes, not frees or lifetimes. Without the
+  define the hook does not exist, i.e. there is no overhead
+* call sites are return addresses, `alloc_track_site_name` symbolizes them with `dladdr` (link with `-rdynamic` to
+  resolve functions that are not exported)
+* with `CXB_ALLOC_TRACKING` defined, the allocating methods of `Allocator`, `MArray`, `MString8` and `MHashMap` are
+  entry points (`CXB_ALLOC_ENTRY`, see arena.h): they are not inlined and record their caller, such that e.g. a
+  `push_back` is attributed to the function calling it rather than to `reserve`. The outermost entry point wins.
+  Without the define, a tracking allocator attributes to the caller of `alloc_proc`, often a container helper
+* sites are recorded in a per-thread table which only the owning thread inserts into. Counters are atomics, since a
+  free on another thread updates the site of the allocating thread. Nothing takes a lock
+* `alloc_track_snapshot` merges the tables of all threads, `alloc_track_print_report` prints the top sites and can be
+  called at any time, e.g. from a signal handler thread or a debug endpoint
+
+Live and peak bytes are per allocating thread, peaks of a site allocated from several threads are summed, i.e. an
+upper bound.
+*/
+#ifndef CXB_ALLOC_TRACK_H
+#define CXB_ALLOC_TRACK_H
+
+#include "atomic.h"
+#include "string8.h"
+
+enum AllocSiteKind : u32 {
+    ALLOC_SITE_ALLOCATOR = 0,
+    ALLOC_SITE_ARENA = 1,
+};
+
+// bucket i counts lifetimes in [2^i, 2^(i+1)) ticks (see profile_ticks_per_ns), the last bucket is unbounded
+constexpr u32 ALLOC_TRACK_LIFETIME_BUCKETS = 32;
+// per thread, allocations from further sites are recorded in the thread's overflow sites (addr = nullptr)
+constexpr u32 ALLOC_TRACK_MAX_SITES = 512;
+
+struct AllocSite {
+    Atomic<void*> addr; // nullptr: empty slot
+    AllocSiteKind kind;
+    Atomic<u64> n_allocs;
+    Atomic<u64> n_frees;
+    Atomic<u64> n_bytes; // total ever allocated, including growth by reallocation
+    Atomic<u64> live_bytes;
+    Atomic<u64> peak_live_bytes;
+    Atomic<u64> lifetimes[ALLOC_TRACK_LIFETIME_BUCKETS];
+};
+
+struct AllocSiteStats {
+    void* addr;
+    AllocSiteKind kind;
+    u64 n_allocs;
+    u64 n_frees;
+    u64 n_bytes;
+    u64 live_bytes;
+    u64 peak_live_bytes;
+    u64 lifetimes[ALLOC_TRACK_LIFETIME_BUCKETS];
+};
+
+// NOTE: the returned allocator's data points to `inner`, which must outlive it
+Allocator alloc_track_allocator(Allocator* inner);
+
+// hook called by arena_push_bytes with CXB_ALLOC_TRACKING
+void alloc_track_arena_push(void* site_addr, u64 n_bytes);
+// the caller of the outermost entry point on this thread (set by CXB_ALLOC_SITE), nullptr outside of one
+extern thread_local void* alloc_track_entry_site;
+
+// sorted by live bytes, then total bytes, descending
+Array<AllocSiteStats> alloc_track_snapshot(Arena* a);
+String8 alloc_track_site_name(Arena* a, void* addr);
+// lifetime below which `q` (0..1) of the site's frees fall, in ns
+f64 alloc_track_lifetime_quantile_ns(const AllocSiteStats& s, f64 q);
+void alloc_track_print_report(FILE* f, u64 max_sites = 20);
+
+#endif /* CXB_ALLOC_TRACK_H */
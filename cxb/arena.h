@@ -0,0 +1,504 @@
+/*
+# cxb/arena: arenas, allocators and the per-thread runtime
+
+* `Arena`: `arena_make`, `arena_push<T>`, `arena_pop_to`, ..., live arenas are registered with usage telemetry, see
+  `arena_stats` / `arena_registry_snapshot`
+* scratch arenas: `begin_scratch` / `end_scratch`, or `AArenaTmp` to end the scope in its destructor
+* `array_*` free functions, for any `ArrayLike` (`.data`, `.len`) at the end of an arena
+* `Allocator`: `heap_alloc`, `make_arena_alloc`
+*/
+#ifndef CXB_ARENA_H
+#define CXB_ARENA_H
+
+#include "core.h"
+#include "fwd.h"
+
+/* SECTION: arena */
+#ifdef CXB_USE_CXX_CONCEPTS
+template <typename A>
+concept ArrayLike = requires(A x) {
+    { x.data } -> std::convertible_to<void*>;
+    { x.len } -> std::convertible_to<u64>;
+};
+#endif
+
+template <typename T>
+Array<T> arena_push_array(Arena* arena, size_t n);
+template <typename T>
+Array<T> arena_push_array(Arena* arena, Array<T> to_copy);
+
+CXB_C_TYPE struct ArenaParams {
+    CXB_C_COMPAT_BEGIN
+    size_t reserve_bytes;
+    size_t max_n_blocks;
+    const char* name; // shown by arena_registry_snapshot, must outlive the arena
+    // popping below the committed bytes by more than this returns the excess to the OS (arena_decommit), 0: never
+    size_t decommit_threshold;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Arena {
+    CXB_C_COMPAT_BEGIN
+    char* start;
+    char* end;
+    size_t pos;
+    ArenaParams params;
+
+    // chaining
+    Arena* next;
+    Arena* prev;
+    size_t n_blocks;
+
+    // telemetry, see arena_stats
+    size_t commit_pos; // highest pos since the last decommit, i.e. pages below it may be resident
+    size_t high_water; // highest pos before the last decommit, the high-water mark is max(high_water, commit_pos)
+    size_t n_pushes;
+
+    // registry of live arenas
+    Arena* registry_next;
+    Arena* registry_prev;
+
+    // TODO: freelist
+    CXB_C_COMPAT_END
+
+    inline Allocator make_alloc();
+    inline Allocator* push_alloc();
+};
+
+CXB_C_EXPORT Arena* arena_make(ArenaParams params);
+CXB_C_EXPORT Arena* arena_make_nbytes(size_t n_bytes);
+CXB_C_EXPORT void arena_destroy(Arena* arena);
+
+CXB_C_EXPORT void* arena_push_bytes(Arena* arena, size_t size, size_t align);
+CXB_C_EXPORT void arena_pop_to(Arena* arena, u64 pos);
+CXB_C_EXPORT void arena_clear(Arena* arena);
+// returns the pages above max(pos, keep_bytes) to the OS
+CXB_C_EXPORT void arena_decommit(Arena* arena, size_t keep_bytes);
+size_t os_page_size();
+
+#ifdef CXB_ALLOC_TRACKING
+// see alloc_track.h
+void alloc_track_arena_push(void* site_addr, u64 n_bytes);
+
+// the caller of the outermost allocating entry point (e.g. MArray::push_back) running on this thread, or nullptr
+extern thread_local void* alloc_track_entry_site;
+
+struct AllocTrackEntry {
+    bool outermost;
+    CXB_INLINE AllocTrackEntry(void* site) : outermost{alloc_track_entry_site == nullptr} {
+        if(outermost) alloc_track_entry_site = site;
+    }
+    CXB_INLINE ~AllocTrackEntry() {
+        if(outermost) alloc_track_entry_site = nullptr;
+    }
+};
+
+// entry points are not inlined, such that their return address is in the caller rather than in a container helper
+#define CXB_ALLOC_ENTRY __attribute__((noinline))
+#define CXB_ALLOC_SITE() AllocTrackEntry _alloc_track_entry{__builtin_return_address(0)}
+#else
+#define CXB_ALLOC_ENTRY inline
+#define CXB_ALLOC_SITE() ((void) 0)
+#endif
+
+// the body of arena_push_bytes, for hot paths made of many small pushes (e.g. serial_write_bytes)
+CXB_INLINE void* arena_push_bytes_inline(Arena* arena, size_t size, size_t align) {
+    ASSERT(UNLIKELY(arena != nullptr), "expected an arena");
+    u64 padding = (-arena->pos) & (align - 1);
+    arena->pos += padding;
+    ASSERT(arena->start + arena->pos + size < arena->end, "arena will spill");
+
+    void* data = arena->start + arena->pos;
+    // data % align == 0, but align = 2^x
+    DEBUG_ASSERT(((u64) data & (align - 1)) == 0);
+    ASAN_UNPOISON_MEMORY_REGION(data, size);
+    arena->pos += size;
+    arena->n_pushes += 1;
+    arena->commit_pos = max(arena->commit_pos, arena->pos);
+#ifdef CXB_ALLOC_TRACKING
+    // NOTE: once inlined, the site is the caller of the function this is inlined into
+    alloc_track_arena_push(__builtin_return_address(0), size);
+#endif
+    return data;
+}
+
+CXB_C_TYPE struct ArenaTmp {
+    CXB_C_COMPAT_BEGIN
+    Arena* arena;
+    u64 pos;
+    CXB_C_COMPAT_END
+};
+
+Arena* get_perm();
+ArenaTmp begin_scratch();
+void end_scratch(const ArenaTmp& tmp);
+
+struct AArenaTmp : ArenaTmp {
+    AArenaTmp(const ArenaTmp& other) : ArenaTmp{other} {}
+    CXB_INLINE ~AArenaTmp() {
+        end_scratch(*this);
+    }
+};
+
+// *SECTION: Arena free functions
+template <typename T>
+inline T* arena_push_fast(Arena* arena, size_t n = 1) {
+    T* data = (T*) arena_push_bytes(arena, sizeof(T) * n, alignof(T));
+    return data;
+}
+
+template <typename T>
+inline T* arena_push(Arena* arena, size_t n = 1) {
+    T* data = (T*) arena_push_bytes(arena, sizeof(T) * n, alignof(T));
+    ::construct(data, n);
+    return data;
+}
+
+template <typename T>
+inline T* arena_push(Arena* arena, size_t n, T default_value) {
+    T* data = (T*) arena_push_bytes(arena, sizeof(T) * n, alignof(T));
+    ::construct(data, n, default_value);
+    return data;
+}
+
+template <typename T>
+inline void arena_pop(Arena* arena, T* x) {
+    ASSERT((void*) (x) >= (void*) arena->start && (void*) (x) < arena->end, "array not allocated on arena");
+    ASSERT((void*) (x + 1) == (void*) (arena->start + arena->pos), "cannot pop unless array is at the end");
+    arena->pos -= sizeof(T);
+}
+
+// *SECTION: Array<T> functions
+template <typename T>
+inline Array<T> arena_push_array(Arena* arena, size_t n) {
+    T* data = arena_push<T>(arena, n);
+    return Array<T>{data, n};
+}
+
+template <typename T>
+inline Array<T> arena_push_array_fast(Arena* arena, size_t n) {
+    T* data = arena_push_fast<T>(arena, n);
+    return Array<T>{data, n};
+}
+
+template <typename T>
+inline Array<T> arena_push_array(Arena* arena, Array<T> to_copy) {
+    T* data = arena_push<T>(arena, to_copy.len);
+    ::copy(data, to_copy.data, to_copy.len);
+    return Array<T>{data, to_copy.len};
+}
+
+template <typename A>
+inline void array_resize_fast(A& xs, Arena* arena, size_t new_size)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A>
+#endif
+{
+    using T = std::remove_reference_t<decltype(xs.data[0])>;
+
+    if(UNLIKELY(new_size == xs.len)) return;
+
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) || (void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos),
+                 "cannot resize unless array is at the end");
+    if(new_size > xs.len) {
+        T* data = arena_push_fast<T>(arena, new_size - xs.len);
+        xs.data = xs.data == nullptr ? data : xs.data;
+        xs.len = new_size;
+    } else {
+        arena_pop_to(arena, arena->pos + (sizeof(T) * (xs.len - new_size)));
+        xs.len = new_size;
+    }
+}
+
+template <typename A>
+inline void array_resize(A& xs, Arena* arena, size_t new_size)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A>
+#endif
+{
+    using T = std::remove_reference_t<decltype(xs.data[0])>;
+
+    if(UNLIKELY(new_size == xs.len)) return;
+
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) || (void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos),
+                 "cannot resize unless array is at the end");
+    if(new_size > xs.len) {
+        T* data = arena_push<T>(arena, new_size - xs.len);
+        xs.data = xs.data == nullptr ? data : xs.data;
+        xs.len = new_size;
+    } else {
+        arena_pop_to(arena, arena->pos - (sizeof(T) * (xs.len - new_size)));
+        xs.len = new_size;
+    }
+}
+
+template <typename A, typename T>
+inline void array_resize(A& xs, Arena* arena, size_t new_size, T default_value)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A>
+#endif
+{
+    if(UNLIKELY(new_size == xs.len)) return;
+
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) || ((void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos)),
+                 "cannot resize unless array is at the end");
+    if(new_size > xs.len) {
+        T* data = arena_push<T>(arena, new_size - xs.len, default_value);
+        xs.data = xs.data == nullptr ? data : xs.data;
+        xs.len = new_size;
+    } else {
+        arena_pop_to(arena, arena->pos + (sizeof(T) * (xs.len - new_size)));
+        xs.len = new_size;
+    }
+}
+
+template <typename A, typename T>
+inline void array_push_back(A& xs, Arena* arena, T value)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A>
+#endif
+{
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) || (void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos),
+                 "cannot push unless array is at the end");
+    void* data = arena_push_bytes(arena, sizeof(T), alignof(T));
+    xs.data = UNLIKELY(xs.data == nullptr) ? (T*) data : xs.data;
+    xs.data[xs.len] = value;
+    xs.len += 1;
+}
+
+template <typename A, typename... Args>
+inline void array_emplace_back(A& xs, Arena* arena, Args&&... args)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A>
+#endif
+{
+    using T = std::remove_reference_t<decltype(xs.data[0])>;
+
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) || ((void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos)),
+                 "cannot push unless array is at the end");
+
+    void* data = arena_push_bytes(arena, sizeof(T), alignof(T));
+    xs.data = UNLIKELY(xs.data == nullptr) ? (T*) data : xs.data;
+    xs.data[xs.len] = T{forward<Args>(args)...};
+    xs.len += 1;
+}
+
+template <typename A>
+inline void array_pop_back(A& xs, Arena* arena)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A>
+#endif
+{
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT((void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos),
+                 "cannot pop unless array is at the end");
+    ::destroy(&xs.data[xs.len - 1], 1);
+    arena_pop_to(arena, arena->pos - sizeof(xs.data[0]));
+    xs.len -= 1;
+}
+
+template <typename A, typename B>
+inline void array_insert(A& xs, Arena* arena, const B& to_insert, size_t i)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A> && ArrayLike<B>
+#endif
+{
+    using T = std::remove_reference_t<decltype(xs.data[0])>;
+
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT((void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos),
+                 "cannot push unless array is at the end");
+    DEBUG_ASSERT(i <= xs.len, "insert position out of bounds");
+
+    arena_push_bytes(arena, to_insert.len * sizeof(T), alignof(T));
+
+    size_t old_len = xs.len;
+    xs.len += to_insert.len;
+
+    memmove(xs.data + i + to_insert.len, xs.data + i, (old_len - i) * sizeof(T));
+    ::copy(xs.data + i, to_insert.data, to_insert.len);
+}
+
+template <typename A, typename B>
+inline void array_extend(A& xs, Arena* arena, const B& to_append)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A> && ArrayLike<B>
+#endif
+{
+    using T = std::remove_reference_t<decltype(xs.data[0])>;
+
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) || (void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos),
+                 "cannot extend unless array is at the end");
+
+    void* data = arena_push_bytes(arena, to_append.len * sizeof(T), alignof(T));
+    xs.data = UNLIKELY(xs.data == nullptr) ? (T*) data : xs.data;
+
+    size_t old_len = xs.len;
+    xs.len += to_append.len;
+
+    ::copy(xs.data + old_len, to_append.data, to_append.len);
+}
+
+template <typename A>
+inline void array_pop_all(A& xs, Arena* arena)
+#ifdef CXB_USE_CXX_CONCEPTS
+    requires ArrayLike<A>
+#endif
+{
+    DEBUG_ASSERT(UNLIKELY(xs.data == nullptr) ||
+                     ((void*) xs.data >= (void*) arena->start && (void*) xs.data < arena->end),
+                 "array not allocated on arena");
+    DEBUG_ASSERT((void*) (xs.data + xs.len) == (void*) (arena->start + arena->pos),
+                 "cannot pop unless array is at the end");
+    arena_pop_to(arena, arena->pos - (sizeof(xs.data[0]) * xs.len));
+    xs.data = nullptr;
+    xs.len = 0;
+}
+
+/* SECTION: general allocation */
+CXB_C_TYPE struct Allocator {
+    CXB_C_COMPAT_BEGIN
+    void* (*alloc_proc)(void* head, size_t n_bytes, size_t alignment, size_t old_n_bytes, bool fill_zeros, void* data);
+    void (*free_proc)(void* head, size_t n_bytes, void* data);
+    void (*free_all_proc)(void* data);
+    void* data;
+    CXB_C_COMPAT_END
+
+    template <typename T, typename H>
+    struct AllocationWithHeader {
+        T* data;
+        H* header;
+    };
+
+    void free_all() {
+        this->free_all_proc(data);
+    }
+
+    template <typename T>
+    CXB_ALLOC_ENTRY T* alloc(size_t count = 1) {
+        CXB_ALLOC_SITE();
+        T* result = (T*) this->alloc_proc(nullptr, sizeof(T) * count, alignof(T), 0, false, data);
+        return result;
+    }
+
+    template <typename T>
+    CXB_ALLOC_ENTRY T* calloc(size_t old_count, size_t count = 1) {
+        CXB_ALLOC_SITE();
+        T* result = (T*) this->alloc_proc(nullptr, sizeof(T) * count, alignof(T), sizeof(T) * old_count, true, data);
+        return result;
+    }
+
+    template <typename T>
+    CXB_ALLOC_ENTRY T* realloc(T* head, size_t old_count, bool fill_zeros, size_t count) {
+        CXB_ALLOC_SITE();
+        T* result =
+            (T*) this->alloc_proc((void*) head, sizeof(T) * count, alignof(T), sizeof(T) * old_count, fill_zeros, data);
+        return result;
+    }
+
+    template <typename H, typename T>
+    CXB_ALLOC_ENTRY AllocationWithHeader<T, H> realloc_with_header(H* header, size_t old_count, size_t count) {
+        CXB_ALLOC_SITE();
+        char* new_header = (char*) this->alloc_proc((void*) header,                    // header
+                                                    sizeof(T) * count + sizeof(H),     // n_bytes
+                                                    alignof(T) + sizeof(H),            // alignment
+                                                    sizeof(T) * old_count + sizeof(H), // old bytes
+                                                    false,                             // fill_zeros
+                                                    this->data);
+        T* data = (T*) (new_header + sizeof(H));
+        return AllocationWithHeader<T, H>{data, (H*) new_header};
+    }
+
+    template <typename H, typename T>
+    CXB_ALLOC_ENTRY AllocationWithHeader<T, H> recalloc_with_header(H* header, size_t old_count, size_t count) {
+        CXB_ALLOC_SITE();
+        char* new_header = (char*) this->alloc_proc((void*) header,                                      // header
+                                                    sizeof(T) * count + sizeof(H),                       // n_bytes
+                                                    alignof(T) + sizeof(H),                              // alignment
+                                                    sizeof(T) * old_count + sizeof(H) * (old_count > 0), // old bytes
+                                                    true,                                                // fill_zeros
+                                                    this->data);
+        T* data = (T*) (new_header + sizeof(H));
+        return AllocationWithHeader<T, H>{data, (H*) new_header};
+    }
+
+    template <typename H, typename T>
+    inline void free_header_offset(T* offset_from_header, size_t count) {
+        this->free_proc((char*) (offset_from_header) - sizeof(H), sizeof(T) * count + sizeof(H), this->data);
+    }
+
+    template <typename T>
+    inline void free(T* head, size_t count) {
+        this->free_proc((void*) head, sizeof(T) * count, this->data);
+    }
+};
+
+Allocator make_arena_alloc(Arena* arena);
+Allocator* push_arena_alloc(Arena* arena);
+inline Allocator Arena::make_alloc() {
+    return make_arena_alloc(this);
+}
+inline Allocator* Arena::push_alloc() {
+    return push_arena_alloc(this);
+}
+
+CXB_C_COMPAT_BEGIN
+extern Allocator heap_alloc;
+CXB_C_COMPAT_END
+
+struct ThreadLocalRuntime {
+    Arena* perm;
+    Arena* scratch[2];
+    int scratch_idx;
+};
+
+struct CxbRuntimeParams {
+    ArenaParams perm_params;
+    ArenaParams scratch_params;
+};
+
+extern thread_local ThreadLocalRuntime cxb_runtime;
+void cxb_init(CxbRuntimeParams);
+/* SECTION: arena telemetry
+Every arena is registered on creation (including the per-thread perm and scratch arenas) until arena_destroy.
+Snapshots read the arenas of other threads without synchronization, i.e. their values may be slightly stale.
+*/
+struct ArenaStats {
+    const char* name; // "" if unnamed
+    const Arena* arena;
+    size_t pos;
+    size_t high_water;
+    size_t committed; // bytes that may be resident, rounded up to pages
+    size_t reserved;
+    size_t n_pushes;
+};
+
+ArenaStats arena_stats(const Arena* arena);
+// sorted by committed bytes, descending
+Array<ArenaStats> arena_registry_snapshot(Arena* a);
+size_t arena_registry_committed();
+void format_value(Arena* a, String8& dst, String8 args, const ArenaStats& s);
+
+#endif /* CXB_ARENA_H */
@@ -0,0 +1,510 @@
+/*
+# cxb/array: arrays
+
+* `Array<T>`: a view of a pointer and a length, resized at the end of an arena (`xs.push_back(arena, x)`)
+* `StaticArray<T, N>`: a fixed size array, convertible to `Array<T>`
+* `MArray<T>`: a manually managed array given an `Allocator`, call `.destroy()` to free its memory. `AArray<T>`: the
+  RAII version
+* `merge_sort`
+*/
+#ifndef CXB_ARRAY_H
+#define CXB_ARRAY_H
+
+#include "arena.h"
+
+/* SECTION: Array<T> */
+template <typename T>
+struct Array {
+    T* data;
+    size_t len;
+
+    Array() : data{nullptr}, len{0} {}
+    Array(T* data, size_t len) : data{data}, len{len} {}
+    Array(std::initializer_list<T>) = delete;
+    Array(Arena* a, std::initializer_list<T> xs) : data{nullptr}, len{0} {
+        data = arena_push_fast<T>(a, xs.size());
+        len = xs.size();
+        ::copy(data, xs.begin(), xs.size());
+    }
+    Array(const Array<T>& o) : data{o.data}, len{o.len} {}
+    Array<T>& operator=(const Array<T>& o) {
+        data = o.data;
+        len = o.len;
+        return *this;
+    }
+    Array(Array<T>&& o) : data{o.data}, len{o.len} {
+        o.data = nullptr;
+        o.len = 0;
+    }
+    Array<T>& operator=(Array<T>&& o) {
+        data = o.data;
+        len = o.len;
+        o.data = nullptr;
+        o.len = 0;
+        return *this;
+    }
+    ~Array() = default;
+
+    inline size_t size() const {
+        return len;
+    }
+    inline bool empty() const {
+        return len == 0;
+    }
+    inline T& operator[](size_t idx) {
+        DEBUG_ASSERT(idx < len, "index out of bounds {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline const T& operator[](size_t idx) const {
+        DEBUG_ASSERT(idx < len, "index out of bounds {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline T& back() {
+        return data[len - 1];
+    }
+    inline Array<T> slice(i64 i = 0, i64 j = -1) {
+        i64 ii = clamp(i < 0 ? (i64) len + i : i, (i64) 0, (i64) len - 1);
+        i64 jj = clamp(j < 0 ? (i64) len + j : j, (i64) 0, (i64) len - 1);
+        DEBUG_ASSERT(ii <= jj, "i > j: {} ({}) < {} ({})", ii, i, jj, j);
+
+        Array<T> c = *this;
+        c.data = c.data + ii;
+        c.len = jj - ii + 1;
+        return c;
+    }
+
+    inline bool operator<(const Array<T>& o) const {
+        size_t n = len < o.len ? len : o.len;
+        for(size_t i = 0; i < n; ++i) {
+            if(o.data[i] < data[i])
+                return false;
+            else if(data[i] < o.data[i])
+                return true;
+        }
+        return len < o.len;
+    }
+
+    inline bool operator==(const Array<T>& o) const {
+        if(len != o.len) return false;
+        for(size_t i = 0; i < len; ++i) {
+            if(!(data[i] == o.data[i])) return false;
+        }
+        return true;
+    }
+
+    inline bool operator!=(const Array<T>& o) const {
+        return !(*this == o);
+    }
+
+    inline bool operator>(const Array<T>& o) const {
+        return o < *this;
+    }
+
+    inline T* begin() {
+        return data;
+    }
+    inline T* end() {
+        return data + len;
+    }
+    inline const T* begin() const {
+        return data;
+    }
+    inline const T* end() const {
+        return data + len;
+    }
+
+    // ** SECTION: arena UFCS
+    CXB_INLINE void resize_fast(Arena* arena, size_t n) {
+        array_resize_fast(*this, arena, n);
+    }
+    CXB_INLINE void resize(Arena* arena, size_t n) {
+        array_resize(*this, arena, n);
+    }
+    CXB_INLINE void resize(Arena* arena, size_t n, T value) {
+        array_resize(*this, arena, n, value);
+    }
+    CXB_INLINE void push_back(Arena* arena, T x) {
+        array_push_back(*this, arena, x);
+    }
+    CXB_INLINE void pop_back(Arena* arena) {
+        array_pop_back(*this, arena);
+    }
+    CXB_INLINE void pop_all(Arena* arena) {
+        array_pop_all(*this, arena);
+    }
+    CXB_INLINE void insert(Arena* arena, T value, size_t i) {
+        StaticArray<T, 1> tmp{{value}};
+        array_insert(*this, arena, tmp, i);
+    }
+    CXB_INLINE void insert(Arena* arena, Array<T> to_insert, size_t i) {
+        array_insert(*this, arena, to_insert, i);
+    }
+    template <size_t N>
+    CXB_INLINE void insert(Arena* arena, const StaticArray<T, N>& to_insert, size_t i) {
+        array_insert(*this, arena, to_insert, i);
+    }
+    CXB_INLINE void extend(Arena* arena, Array<T> to_append) {
+        array_extend(*this, arena, to_append);
+    }
+    template <size_t N>
+    CXB_INLINE void extend(Arena* arena, const StaticArray<T, N>& to_append) {
+        array_extend(*this, arena, to_append);
+    }
+
+    // defined in string8.h
+    template <typename U = T, typename = std::enable_if_t<std::is_same_v<U, char>>>
+    inline String8 as_string8(bool nt_len = true) const;
+};
+
+/* SECTION: StaticArray<T, N> */
+template <typename T, size_t N>
+struct StaticArray {
+    T data[N];
+    size_t len = N;
+
+    CXB_INLINE operator Array<T>() & {
+        return Array<T>{data, len};
+    }
+    CXB_INLINE operator Array<T>() && = delete;
+};
+
+template <typename T, size_t N>
+CXB_INLINE StaticArray<T, N> make_static_array(const T (&xs)[N]) {
+    StaticArray<T, N> sa{};
+    ::copy(sa.data, xs, N);
+    return sa;
+}
+
+/* SECTION: MArray<T>, AArray<T> */
+template <typename T>
+struct MArray {
+    T* data;
+    size_t len;
+    size_t capacity;
+    Allocator* allocator;
+
+    MArray(Allocator* allocator = &heap_alloc) : data{nullptr}, len{0}, capacity{0}, allocator{allocator} {}
+    MArray(std::initializer_list<T> xs, Allocator* allocator = &heap_alloc)
+        : data{nullptr}, len{0}, capacity{0}, allocator{allocator} {
+        extend(Array<T>{(T*) (xs.begin()), xs.size()});
+    }
+    MArray(T* data, size_t len, Allocator* allocator = &heap_alloc)
+        : data{data}, len{len}, capacity{0}, allocator{allocator} {}
+    MArray(T* data, size_t len, size_t capacity, Allocator* allocator)
+        : data{data}, len{len}, capacity{capacity}, allocator{allocator} {}
+    MArray(const MArray<T>& o) = default;
+    MArray<T>& operator=(const MArray<T>& o) = default;
+
+    // ** SECTION: slice compatible methods
+    inline size_t size() const {
+        return len;
+    }
+    inline bool empty() const {
+        return len == 0;
+    }
+    inline T& operator[](size_t idx) {
+        DEBUG_ASSERT(idx < len, "index out of bounds {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline const T& operator[](size_t idx) const {
+        DEBUG_ASSERT(idx < len, "index out of bounds {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline T& back() {
+        return data[len - 1];
+    }
+    inline Array<T> slice(i64 i = 0, i64 j = -1) {
+        i64 ii = clamp(i < 0 ? (i64) len + i : i, (i64) 0, (i64) len - 1);
+        i64 jj = clamp(j < 0 ? (i64) len + j : j, (i64) 0, (i64) len - 1);
+        DEBUG_ASSERT(ii <= jj, "i > j: {} ({}) < {} ({})", ii, i, jj, j);
+
+        Array<T> c = *this;
+        c.data = c.data + ii;
+        c.len = jj - ii + 1;
+        return c;
+    }
+
+    inline bool operator<(const Array<T>& o) const {
+        size_t n = len < o.len ? len : o.len;
+        for(size_t i = 0; i < n; ++i) {
+            if(o.data[i] < data[i])
+                return false;
+            else if(data[i] < o.data[i])
+                return true;
+        }
+        return len < o.len;
+    }
+
+    inline bool operator==(const Array<T>& o) const {
+        if(len != o.len) return false;
+        for(size_t i = 0; i < len; ++i) {
+            if(!(data[i] == o.data[i])) return false;
+        }
+        return true;
+    }
+
+    inline bool operator!=(const Array<T>& o) const {
+        return !(*this == o);
+    }
+
+    inline bool operator>(const Array<T>& o) const {
+        return o < *this;
+    }
+
+    inline operator Array<T>() const {
+        return *reinterpret_cast<const Array<T>*>(this);
+    }
+
+    // ** SECTION: iterator methods
+    inline T* begin() {
+        return data;
+    }
+    inline T* end() {
+        return data + len;
+    }
+    inline const T* begin() const {
+        return data;
+    }
+    inline const T* end() const {
+        return data + len;
+    }
+
+    // ** SECTION: allocator-related methods
+    inline MArray<T>& copy_(Allocator* to_allocator = &heap_alloc) {
+        *this = move(this->copy(to_allocator));
+        return *this;
+    }
+
+    CXB_ALLOC_ENTRY MArray<T> copy(Allocator* to_allocator = nullptr) {
+        CXB_ALLOC_SITE();
+        if(to_allocator == nullptr) to_allocator = allocator;
+        ASSERT(to_allocator != nullptr);
+
+        MArray<T> result{nullptr, 0, to_allocator};
+        result.reserve(len);
+        if(data && len > 0) {
+            ::copy(result.data, data, len);
+        }
+        result.len = len;
+        return result;
+    }
+
+    inline void destroy() {
+        if(data && allocator) {
+            ::destroy(data, len);
+            allocator->free(data, capacity);
+            data = nullptr;
+        }
+    }
+
+    CXB_ALLOC_ENTRY void reserve(size_t cap) {
+        CXB_ALLOC_SITE();
+        ASSERT(allocator != nullptr);
+
+        size_t old_count = capacity;
+        size_t new_count = cap < CXB_STR_MIN_CAP ? CXB_STR_MIN_CAP : cap;
+        if(new_count > old_count) {
+            data = allocator->realloc(data, old_count, false, new_count);
+            capacity = new_count;
+        }
+    }
+
+    CXB_ALLOC_ENTRY void resize(size_t new_len) {
+        CXB_ALLOC_SITE();
+        ASSERT(UNLIKELY(allocator != nullptr));
+
+        if(capacity < new_len) {
+            reserve(new_len);
+        }
+
+        ::construct(data + len, new_len - len);
+        len = new_len;
+    }
+
+    CXB_ALLOC_ENTRY void resize(size_t new_len, T value) {
+        CXB_ALLOC_SITE();
+        ASSERT(UNLIKELY(allocator != nullptr));
+
+        if(capacity < new_len) {
+            reserve(new_len);
+        }
+
+        ::construct(data + len, new_len - len, value);
+        len = new_len;
+    }
+
+    CXB_ALLOC_ENTRY void push_back(T value) {
+        CXB_ALLOC_SITE();
+        ASSERT(UNLIKELY(allocator != nullptr));
+        size_t c = capacity;
+        if(len + 1 >= c) {
+            c = CXB_SEQ_GROW_FN(c);
+            reserve(c);
+        }
+
+        data[len++] = move(value);
+    }
+
+    CXB_ALLOC_ENTRY T& push() {
+        CXB_ALLOC_SITE();
+        reserve(len + 1);
+        data[this->len++] = T{};
+        return data[this->len - 1];
+    }
+
+    inline T pop_back() {
+        ASSERT(len > 0);
+        T ret = move(data[len - 1]);
+        data[len - 1].~T();
+        len--;
+        return ret;
+    }
+
+    CXB_ALLOC_ENTRY T& get_or_add_until(size_t idx) {
+        CXB_ALLOC_SITE();
+        if(idx >= len) {
+            resize(idx + 1);
+        }
+        return data[idx];
+    }
+
+    template <typename O>
+    void release(O& out) {
+        out.data = data;
+        out.len = len;
+        out.capacity = capacity;
+        out.allocator = allocator;
+        allocator = nullptr;
+    }
+
+    CXB_ALLOC_ENTRY void extend(Array<T> other) {
+        CXB_ALLOC_SITE();
+        if(other.len == 0) return;
+        reserve(len + other.len);
+        ::copy(data + len, other.data, other.len);
+        len += other.len;
+    }
+};
+
+template <typename T, typename O>
+static constexpr MArray<T> marray_from_pod(O o, Allocator* allocator) {
+    return MArray<T>{o.data, o.len, o.capacity, allocator};
+}
+
+template <typename T, typename O>
+static constexpr MArray<T> marray_from_pod(O* o, Allocator* allocator) {
+    return MArray<T>{o->data, o->len, o->capacity, allocator};
+}
+
+template <typename T>
+struct AArray : MArray<T> {
+    AArray(Allocator* allocator = &heap_alloc) : MArray<T>(allocator) {}
+    AArray(T* data, size_t len, Allocator* allocator = &heap_alloc) : MArray<T>(data, len, allocator) {}
+    AArray(std::initializer_list<T> xs, Allocator* allocator = &heap_alloc) : MArray<T>(xs, allocator) {}
+    AArray(T* data, size_t len, size_t capacity, Allocator* allocator) : MArray<T>(data, len, capacity, allocator) {}
+    AArray(const AArray<T>& o) = delete;
+    AArray<T>& operator=(const AArray<T>& o) = delete;
+
+    AArray(AArray<T>&& o) : MArray<T>{o.data, o.len, o.capacity, o.allocator} {
+        o.allocator = nullptr;
+    }
+    AArray(MArray<T>&& o) : MArray<T>{o.data, o.len, o.capacity, o.allocator} {
+        o.allocator = nullptr;
+    }
+    AArray<T>& operator=(AArray<T>&& o) {
+        this->allocator = o.allocator;
+        o.allocator = nullptr;
+        this->data = o.data;
+        this->len = o.len;
+        this->capacity = o.capacity;
+        return *this;
+    }
+    AArray<T>& operator=(MArray<T>&& o) {
+        this->allocator = o.allocator;
+        o.allocator = nullptr;
+        this->data = o.data;
+        this->len = o.len;
+        this->capacity = o.capacity;
+        return *this;
+    }
+
+    ~AArray() {
+        this->destroy();
+    }
+
+    MArray<T> release() {
+        MArray<T> self = *this;
+        this->allocator = nullptr;
+        return self;
+    }
+};
+
+/* SECTION: algorithms */
+struct LessThan {
+    template <typename T>
+    bool operator()(const T& a, const T& b) const {
+        return a < b;
+    }
+};
+
+template <typename T, typename Compare>
+static void merge_sort_impl(T* data, T* tmp, u64 left, u64 right, const Compare& cmp) {
+    if(right - left <= 1) return;
+
+    u64 mid = left + ((right - left) >> 1);
+    merge_sort_impl(data, tmp, left, mid, cmp);
+    merge_sort_impl(data, tmp, mid, right, cmp);
+
+    u64 i = left;
+    u64 j = mid;
+    u64 k = 0;
+    while(i < mid && j < right) {
+        if(cmp(data[j], data[i])) {
+            tmp[k++] = ::move(data[j++]);
+        } else {
+            tmp[k++] = ::move(data[i++]);
+        }
+    }
+    while(i < mid) tmp[k++] = ::move(data[i++]);
+    while(j < right) tmp[k++] = ::move(data[j++]);
+    for(u64 t = 0; t < k; ++t) {
+        data[left + t] = ::move(tmp[t]);
+    }
+}
+
+template <typename T, typename Compare = LessThan>
+inline void merge_sort(T* data, u64 len, const Compare& cmp = Compare{}) {
+    if(len <= 1) return;
+    AArenaTmp scratch = begin_scratch();
+    T* tmp = arena_push_fast<T>(scratch.arena, len);
+    merge_sort_impl(data, tmp, 0, len, cmp);
+}
+
+/* SECTION: extern templates */
+#ifdef CXB_EXTERN_TEMPLATES
+CXB_EXTERN_TEMPLATE struct MArray<u8>;
+CXB_EXTERN_TEMPLATE struct MArray<char>;
+CXB_EXTERN_TEMPLATE struct MArray<i32>;
+CXB_EXTERN_TEMPLATE struct MArray<u32>;
+CXB_EXTERN_TEMPLATE struct MArray<i64>;
+CXB_EXTERN_TEMPLATE struct MArray<u64>;
+CXB_EXTERN_TEMPLATE struct MArray<f32>;
+CXB_EXTERN_TEMPLATE struct MArray<f64>;
+CXB_EXTERN_TEMPLATE struct AArray<u8>;
+CXB_EXTERN_TEMPLATE struct AArray<char>;
+CXB_EXTERN_TEMPLATE struct AArray<i32>;
+CXB_EXTERN_TEMPLATE struct AArray<u32>;
+CXB_EXTERN_TEMPLATE struct AArray<i64>;
+CXB_EXTERN_TEMPLATE struct AArray<u64>;
+CXB_EXTERN_TEMPLATE struct AArray<f32>;
+CXB_EXTERN_TEMPLATE struct AArray<f64>;
+
+CXB_EXTERN_TEMPLATE void merge_sort(i32* data, u64 len, const LessThan& cmp);
+CXB_EXTERN_TEMPLATE void merge_sort(u32* data, u64 len, const LessThan& cmp);
+CXB_EXTERN_TEMPLATE void merge_sort(i64* data, u64 len, const LessThan& cmp);
+CXB_EXTERN_TEMPLATE void merge_sort(u64* data, u64 len, const LessThan& cmp);
+CXB_EXTERN_TEMPLATE void merge_sort(f32* data, u64 len, const LessThan& cmp);
+CXB_EXTERN_TEMPLATE void merge_sort(f64* data, u64 len, const LessThan& cmp);
+#endif
+
+#endif /* CXB_ARRAY_H */
@@ -0,0 +1,255 @@
+/*
+# cxb/atomic: atomics
+
+* `atomic_i32`, `atomic_u64`, ...: C-compatible atomic integers (`_Atomic(T)` with `CXB_USE_C11_ATOMICS`)
+* `Atomic<T>`: a non-copyable wrapper of integral and pointer types, `memory_order_*` as in `<atomic>`
+* `heap_alloc_data`: byte counters of `heap_alloc`
+
+This is the only layer that includes `<atomic>`.
+*/
+#ifndef CXB_ATOMIC_H
+#define CXB_ATOMIC_H
+
+#include "core.h"
+
+#ifdef CXB_USE_C11_ATOMICS
+CXB_C_COMPAT_BEGIN
+#include <stdatomic.h> // _Atomic(T)
+CXB_C_COMPAT_END
+#else
+#include <atomic>
+#endif
+
+#ifndef CXB_USE_C11_ATOMICS
+using memory_order = std::memory_order;
+using std::memory_order_acq_rel;
+using std::memory_order_acquire;
+using std::memory_order_consume;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
+#endif
+
+/* SECTION: atomic primitives */
+CXB_C_COMPAT_BEGIN
+#ifdef CXB_USE_C11_ATOMICS
+typedef _Atomic(i32) atomic_i32;
+typedef _Atomic(i64) atomic_i64;
+typedef _Atomic(u32) atomic_u32;
+typedef _Atomic(u64) atomic_u64;
+#if defined(__GNUC__)
+typedef _Atomic(i128) atomic_i128;
+typedef _Atomic(u128) atomic_u128;
+#endif
+
+#if defined(__STDC_NO_ATOMICS__)
+#error "C11 _Atomic is not available, compile with C++23"
+#endif
+#else
+typedef std::atomic<i32> atomic_i32;
+typedef std::atomic<i64> atomic_i64;
+typedef std::atomic<u32> atomic_u32;
+typedef std::atomic<u64> atomic_u64;
+#if defined(__GNUC__)
+typedef std::atomic<i128> atomic_i128;
+typedef std::atomic<u128> atomic_u128;
+#endif
+#endif
+CXB_C_COMPAT_END
+
+/* SECTION: Atomic<T> */
+template <typename T>
+struct Atomic {
+    static_assert(std::is_integral_v<T> || std::is_pointer_v<T>,
+                  "Atomic wrapper only supports integral and pointer types");
+
+#ifdef CXB_USE_C11_ATOMICS
+    _Atomic(T) value;
+#else
+    std::atomic<T> value;
+#endif
+
+    constexpr Atomic(T desired = T{}) noexcept : value(desired) {}
+
+#ifdef CXB_USE_C11_ATOMICS
+    constexpr Atomic(_Atomic(T) desired) noexcept : value(desired) {}
+#endif
+
+    Atomic(const Atomic&) = delete;
+    Atomic& operator=(const Atomic&) = delete;
+    Atomic(Atomic&&) = delete;
+    Atomic& operator=(Atomic&&) = delete;
+
+    CXB_INLINE void store(T desired, memory_order order = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        atomic_store_explicit(&value, desired, order);
+#else
+        value.store(desired, order);
+#endif
+    }
+
+    CXB_INLINE T load(memory_order order = memory_order_seq_cst) const noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_load_explicit(&value, order);
+#else
+        return value.load(order);
+#endif
+    }
+
+    CXB_INLINE T exchange(T desired, memory_order order = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_exchange_explicit(&value, desired, order);
+#else
+        return value.exchange(desired, order);
+#endif
+    }
+
+    CXB_INLINE bool compare_exchange_weak(T& expected,
+                                          T desired,
+                                          memory_order success = memory_order_seq_cst,
+                                          memory_order failure = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_compare_exchange_weak_explicit(&value, &expected, desired, success, failure);
+#else
+        return value.compare_exchange_weak(expected, desired, success, failure);
+#endif
+    }
+
+    CXB_INLINE bool compare_exchange_strong(T& expected,
+                                            T desired,
+                                            memory_order success = memory_order_seq_cst,
+                                            memory_order failure = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_compare_exchange_strong_explicit(&value, &expected, desired, success, failure);
+#else
+        return value.compare_exchange_strong(expected, desired, success, failure);
+#endif
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> fetch_add(
+        T arg, memory_order order = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_fetch_add_explicit(&value, arg, order);
+#else
+        return value.fetch_add(arg, order);
+#endif
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> fetch_sub(
+        T arg, memory_order order = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_fetch_sub_explicit(&value, arg, order);
+#else
+        return value.fetch_sub(arg, order);
+#endif
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> fetch_and(
+        T arg, memory_order order = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_fetch_and_explicit(&value, arg, order);
+#else
+        return value.fetch_and(arg, order);
+#endif
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> fetch_or(
+        T arg, memory_order order = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_fetch_or_explicit(&value, arg, order);
+#else
+        return value.fetch_or(arg, order);
+#endif
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> fetch_xor(
+        T arg, memory_order order = memory_order_seq_cst) noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_fetch_xor_explicit(&value, arg, order);
+#else
+        return value.fetch_xor(arg, order);
+#endif
+    }
+
+    CXB_INLINE operator T() const noexcept {
+        return load();
+    }
+
+    CXB_INLINE T operator=(T desired) noexcept {
+        store(desired);
+        return desired;
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator++() noexcept {
+        return fetch_add(1) + 1;
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator++(int) noexcept {
+        return fetch_add(1);
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator--() noexcept {
+        return fetch_sub(1) - 1;
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator--(int) noexcept {
+        return fetch_sub(1);
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator+=(T arg) noexcept {
+        return fetch_add(arg) + arg;
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator-=(T arg) noexcept {
+        return fetch_sub(arg) - arg;
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator&=(T arg) noexcept {
+        return fetch_and(arg) & arg;
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator|=(T arg) noexcept {
+        return fetch_or(arg) | arg;
+    }
+
+    template <typename U = T>
+    CXB_INLINE typename std::enable_if_t<std::is_integral_v<U>, T> operator^=(T arg) noexcept {
+        return fetch_xor(arg) ^ arg;
+    }
+
+    bool is_lock_free() const noexcept {
+#ifdef CXB_USE_C11_ATOMICS
+        return atomic_is_lock_free(&value);
+#else
+        return value.is_lock_free();
+#endif
+    }
+
+#ifdef CXB_USE_C11_ATOMICS
+    static constexpr bool is_always_lock_free = true;
+#else
+    static constexpr bool is_always_lock_free = std::atomic<T>::is_always_lock_free;
+#endif
+};
+
+struct HeapAllocData {
+    Atomic<i64> n_active_bytes;
+    Atomic<i64> n_allocated_bytes;
+    Atomic<i64> n_freed_bytes;
+};
+extern HeapAllocData heap_alloc_data;
+
+#endif /* CXB_ATOMIC_H */
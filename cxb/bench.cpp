@@ -0,0 +1,562 @@
+#include "bench.h"
+
+#include "format.h"
+#include "histogram.h"
+#include "io.h"
+#include "profile.h"
+
+#include <math.h>
+
+#if defined(CXB_PLATFORM_LINUX)
+#include <sched.h>
+#endif
+
+INTERNAL BenchCase* bench_cases_head = nullptr;
+INTERNAL BenchCase* bench_cases_tail = nullptr;
+
+int bench_register(BenchCase* c) {
+    // cases run in registration order, i.e. in the order of the source file
+    if(bench_cases_tail) {
+        bench_cases_tail->next = c;
+    } else {
+        bench_cases_head = c;
+    }
+    bench_cases_tail = c;
+    return 0;
+}
+
+/* SECTION: running */
+bool bench_enabled(const Bencher* b, String8 name) {
+    String8 filter = b->params.filter;
+    return filter.len == 0 || string8_contains(S8_CSTR(b->case_name), filter) || string8_contains(name, filter);
+}
+
+void _bench_run(Bencher* b, String8 name, void (*call)(void* ctx, u64 n), void* ctx) {
+    const BenchParams& p = b->params;
+    f64 ns_per_tick = 1.0 / profile_ticks_per_ns();
+
+    // warmup: double the calls per round until warmup_ms elapsed, the last round estimates the time per call
+    u64 n = 1;
+    f64 warmup_ns = 0;
+    f64 call_ns = 0;
+    while(true) {
+        u64 begin = profile_now();
+        call(ctx, n);
+        f64 round_ns = (f64) (profile_now() - begin) * ns_per_tick;
+        warmup_ns += round_ns;
+        call_ns = round_ns / (f64) n;
+        if(warmup_ns >= p.warmup_ms * 1e6 || round_ns >= p.sample_ms * 1e6) break;
+        n *= 2;
+    }
+
+    u64 n_iters = max((u64) (p.sample_ms * 1e6 / max(call_ns, 1e-3)), (u64) 1);
+    f64 sample_ns = call_ns * (f64) n_iters;
+    u64 n_samples = max(p.n_samples, 1u);
+    if(sample_ns * (f64) n_samples > p.max_ms * 1e6) {
+        n_samples = clamp((u64) (p.max_ms * 1e6 / max(sample_ns, 1.0)), min(n_samples, (u64) 5), n_samples);
+    }
+
+    Array<f64> samples = arena_push_array<f64>(b->arena, n_samples);
+    for(u64 i = 0; i < n_samples; ++i) {
+        u64 begin = profile_now();
+        call(ctx, n_iters);
+        samples[i] = (f64) (profile_now() - begin) * ns_per_tick / (f64) n_iters;
+    }
+
+    BenchResult r = {.name = format(b->arena, "{}: {}", b->case_name, name),
+                     .samples_ns = {},
+                     .n_iters = n_iters,
+                     .n_outliers = 0,
+                     .median_ns = 0,
+                     .mean_ns = 0,
+                     .stddev_ns = 0,
+                     .min_ns = 0,
+                     .max_ns = 0,
+                     .p50_ns = 0,
+                     .p99_ns = 0,
+                     .p999_ns = 0,
+                     .perf = {}};
+    if(p.perf && perf_counters_any(b->perf)) {
+        perf_counters_start(b->perf);
+        call(ctx, n_iters);
+        r.perf = perf_counters_stop(b->perf, n_iters);
+    }
+
+    // latencies: one more sample with each call timed on its own
+    AArenaTmp tmp = begin_scratch();
+    Histogram* latencies = arena_push<Histogram>(tmp.arena);
+    u64 n_latencies = min(n_iters, BENCH_MAX_LATENCY_CALLS);
+    for(u64 i = 0; i < n_latencies; ++i) {
+        u64 begin = profile_now();
+        call(ctx, 1);
+        histogram_record(latencies, profile_now() - begin);
+    }
+    r.p50_ns = (f64) histogram_percentile(latencies, 0.5) * ns_per_tick;
+    r.p99_ns = (f64) histogram_percentile(latencies, 0.99) * ns_per_tick;
+    r.p999_ns = (f64) histogram_percentile(latencies, 0.999) * ns_per_tick;
+
+    bench_summarize(r, samples);
+    b->results.push_back(r);
+
+    print(stdout,
+          tmp.arena,
+          "{}: median={.2}ns mean={.2}ns sd={.2}ns min={.2}ns max={.2}ns p50={.2}ns p99={.2}ns p999={.2}ns "
+          "({} samples x {} iters, {} outliers)\n",
+          r.name,
+          r.median_ns,
+          r.mean_ns,
+          r.stddev_ns,
+          r.min_ns,
+          r.max_ns,
+          r.p50_ns,
+          r.p99_ns,
+          r.p999_ns,
+          r.samples_ns.len,
+          r.n_iters,
+          r.n_outliers);
+    if(p.perf) perf_print(stdout, r.name, r.perf);
+}
+
+/* SECTION: statistics */
+// linear interpolation between the closest ranks
+INTERNAL f64 _bench_quantile(Array<f64> sorted, f64 q) {
+    if(sorted.len == 0) return 0;
+    f64 pos = q * (f64) (sorted.len - 1);
+    size_t i = (size_t) pos;
+    if(i + 1 >= sorted.len) return sorted[sorted.len - 1];
+    return sorted[i] + (pos - (f64) i) * (sorted[i + 1] - sorted[i]);
+}
+
+// fills the summary of r from its sorted samples
+INTERNAL void _bench_describe(BenchResult& r) {
+    Array<f64> xs = r.samples_ns;
+    if(xs.len == 0) return;
+    f64 sum = 0;
+    for(f64 x : xs) sum += x;
+    r.mean_ns = sum / (f64) xs.len;
+    f64 sq = 0;
+    for(f64 x : xs) sq += (x - r.mean_ns) * (x - r.mean_ns);
+    r.stddev_ns = xs.len > 1 ? sqrt(sq / (f64) (xs.len - 1)) : 0;
+    r.median_ns = _bench_quantile(xs, 0.5);
+    r.min_ns = xs[0];
+    r.max_ns = xs[xs.len - 1];
+}
+
+void bench_summarize(BenchResult& r, Array<f64> samples_ns) {
+    merge_sort(samples_ns.data, samples_ns.len);
+    f64 q1 = _bench_quantile(samples_ns, 0.25);
+    f64 q3 = _bench_quantile(samples_ns, 0.75);
+    f64 lo = q1 - 1.5 * (q3 - q1);
+    f64 hi = q3 + 1.5 * (q3 - q1);
+
+    // samples stay sorted, the kept ones are a contiguous range
+    size_t begin = 0;
+    size_t end = samples_ns.len;
+    while(begin < end && samples_ns[begin] < lo) begin += 1;
+    while(end > begin && samples_ns[end - 1] > hi) end -= 1;
+    r.samples_ns = Array<f64>{samples_ns.data + begin, end - begin};
+    r.n_outliers = (u32) (samples_ns.len - (end - begin));
+    _bench_describe(r);
+}
+
+struct _BenchRank {
+    f64 value;
+    bool is_x;
+};
+
+f64 mann_whitney_p(Array<f64> x, Array<f64> y) {
+    if(x.len == 0 || y.len == 0) return 1;
+    AArenaTmp tmp = begin_scratch();
+    size_t n = x.len + y.len;
+    _BenchRank* all = arena_push_fast<_BenchRank>(tmp.arena, n);
+    for(size_t i = 0; i < x.len; ++i) all[i] = {x[i], true};
+    for(size_t i = 0; i < y.len; ++i) all[x.len + i] = {y[i], false};
+    merge_sort(all, n, [](const _BenchRank& a, const _BenchRank& b) { return a.value < b.value; });
+
+    // ties get the average of their ranks
+    f64 rank_sum_x = 0;
+    f64 ties = 0;
+    for(size_t i = 0; i < n;) {
+        size_t j = i + 1;
+        while(j < n && all[j].value == all[i].value) j += 1;
+        f64 rank = (f64) (i + 1 + j) / 2.0;
+        for(size_t k = i; k < j; ++k) rank_sum_x += all[k].is_x ? rank : 0;
+        f64 t = (f64) (j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    f64 n1 = (f64) x.len;
+    f64 n2 = (f64) y.len;
+    f64 u = rank_sum_x - n1 * (n1 + 1) / 2;
+    f64 mu = n1 * n2 / 2;
+    f64 sigma = sqrt(n1 * n2 / 12 * ((f64) n + 1 - ties / ((f64) n * ((f64) n - 1))));
+    if(!(sigma > 0)) return 1;
+    // continuity correction
+    f64 z = max(fabs(u - mu) - 0.5, 0.0) / sigma;
+    return erfc(z / M_SQRT2);
+}
+
+// z such that a standard normal variable exceeds |z| with probability p
+INTERNAL f64 _bench_z_two_sided(f64 p) {
+    f64 lo = 0;
+    f64 hi = 40;
+    for(int i = 0; i < 100; ++i) {
+        f64 mid = (lo + hi) / 2;
+        if(erfc(mid / M_SQRT2) > p) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo + hi) / 2;
+}
+
+BenchComparison bench_compare(const BenchResult& base, const BenchResult& cur, f64 alpha, f64 threshold) {
+    BenchComparison c = {.name = cur.name,
+                         .base_median_ns = base.median_ns,
+                         .new_median_ns = cur.median_ns,
+                         .ratio = 1,
+                         .ratio_lo = 1,
+                         .ratio_hi = 1,
+                         .p_value = mann_whitney_p(base.samples_ns, cur.samples_ns),
+                         .verdict = BENCH_UNCHANGED};
+    size_t n1 = base.samples_ns.len;
+    size_t n2 = cur.samples_ns.len;
+    if(n1 == 0 || n2 == 0) return c;
+
+    // Hodges-Lehmann: the median of the pairwise differences of log times, the confidence interval from the
+    // normal approximation of the rank sum
+    AArenaTmp tmp = begin_scratch();
+    size_t m = n1 * n2;
+    f64* d = arena_push_fast<f64>(tmp.arena, m);
+    for(size_t i = 0; i < n1; ++i) {
+        f64 log_base = log(max(base.samples_ns[i], 1e-3));
+        for(size_t j = 0; j < n2; ++j) d[i * n2 + j] = log(max(cur.samples_ns[j], 1e-3)) - log_base;
+    }
+    merge_sort(d, m);
+    Array<f64> ds{d, m};
+    f64 z = _bench_z_two_sided(alpha);
+    f64 k = floor((f64) m / 2 - z * sqrt((f64) n1 * (f64) n2 * (f64) (n1 + n2 + 1) / 12));
+    size_t k_lo = (size_t) clamp(k, 0.0, (f64) (m - 1));
+    c.ratio = exp(_bench_quantile(ds, 0.5));
+    c.ratio_lo = exp(d[k_lo]);
+    c.ratio_hi = exp(d[m - 1 - k_lo]);
+
+    if(c.p_value < alpha) {
+        if(c.ratio > 1 + threshold) {
+            c.verdict = BENCH_SLOWER;
+        } else if(c.ratio < 1 - threshold) {
+            c.verdict = BENCH_FASTER;
+        }
+    }
+    return c;
+}
+
+/* SECTION: results */
+INTERNAL void _bench_json_string(Arena* a, String8& dst, String8 s) {
+    string8_push_back(dst, a, '"');
+    for(size_t i = 0; i < s.len; ++i) {
+        u8 c = (u8) s.data[i];
+        if(c < 0x20) {
+            // control characters are not allowed in JSON strings
+            const char* hex = "0123456789abcdef";
+            char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+            for(char e : escaped) string8_push_back(dst, a, e);
+            continue;
+        }
+        if(s.data[i] == '"' || s.data[i] == '\\') {
+            string8_push_back(dst, a, '\\');
+        }
+        string8_push_back(dst, a, s.data[i]);
+    }
+    string8_push_back(dst, a, '"');
+}
+
+String8 bench_results_json(Arena* a, Array<BenchResult> results, i32 cpu) {
+    // NOTE: braces are format placeholders, they are pushed separately
+    String8 dst = arena_push_string8(a);
+    string8_push_back(dst, a, '{');
+    _format_impl(a, dst, "\"cpu\":{},\"benchmarks\":[\n", cpu);
+    for(size_t i = 0; i < results.len; ++i) {
+        const BenchResult& r = results[i];
+        string8_extend(dst, a, S8_LIT("{\"name\":"));
+        _bench_json_string(a, dst, r.name);
+        _format_impl(a,
+                     dst,
+                     ",\"n_iters\":{},\"n_outliers\":{},\"median_ns\":{.3},\"mean_ns\":{.3},\"stddev_ns\":{.3},"
+                     "\"min_ns\":{.3},\"max_ns\":{.3},\"p50_ns\":{.3},\"p99_ns\":{.3},\"p999_ns\":{.3},\"perf\":",
+                     r.n_iters,
+                     r.n_outliers,
+                     r.median_ns,
+                     r.mean_ns,
+                     r.stddev_ns,
+                     r.min_ns,
+                     r.max_ns,
+                     r.p50_ns,
+                     r.p99_ns,
+                     r.p999_ns);
+        string8_push_back(dst, a, '{');
+        bool first = true;
+        for(u32 j = 0; j < PERF_COUNTER_CNT; ++j) {
+            if(!r.perf.valid[j]) continue;
+            _format_impl(a, dst, "{}\"{}\":{.3}", first ? "" : ",", PERF_COUNTER_NAMES[j], r.perf.values[j]);
+            first = false;
+        }
+        string8_push_back(dst, a, '}');
+        string8_extend(dst, a, S8_LIT(",\"samples_ns\":["));
+        for(size_t j = 0; j < r.samples_ns.len; ++j) {
+            _format_impl(a, dst, "{}{.3}", j ? "," : "", r.samples_ns[j]);
+        }
+        string8_extend(dst, a, S8_LIT("]}"));
+        string8_extend(dst, a, i + 1 < results.len ? S8_LIT(",\n") : S8_LIT("\n"));
+    }
+    string8_extend(dst, a, S8_LIT("]}\n"));
+    return dst;
+}
+
+// returns the rest of s after the first occurrence of key, empty if key does not occur
+INTERNAL String8 _bench_json_skip_to(String8 s, String8 key) {
+    size_t i = string8_find(s, key);
+    if(i == SIZE_MAX) return S8_DATA(s.data + s.len, 0);
+    return S8_DATA(s.data + i + key.len, s.len - i - key.len);
+}
+
+Array<BenchResult> bench_results_parse(Arena* a, String8 json) {
+    AArray<BenchResult> results{};
+    String8 rest = json;
+    while(true) {
+        rest = _bench_json_skip_to(rest, S8_LIT("{\"name\":\""));
+        if(rest.len == 0) break;
+
+        String8 name = arena_push_string8(a);
+        size_t i = 0;
+        for(; i < rest.len && rest.data[i] != '"'; ++i) {
+            if(rest.data[i] == '\\' && i + 5 < rest.len && rest.data[i + 1] == 'u') {
+                // only control characters are written as \u00XX
+                u32 c = 0;
+                for(size_t j = i + 2; j < i + 6; ++j) {
+                    char h = rest.data[j];
+                    c = c * 16 + (h >= 'a' ? h - 'a' + 10 : h >= 'A' ? h - 'A' + 10 : h - '0');
+                }
+                string8_push_back(name, a, (char) c);
+                i += 5;
+                continue;
+            }
+            if(rest.data[i] == '\\' && i + 1 < rest.len) i += 1;
+            string8_push_back(name, a, rest.data[i]);
+        }
+        rest = _bench_json_skip_to(rest, S8_LIT("\"samples_ns\":["));
+
+        Array<f64> samples = {};
+        while(rest.len > 0 && rest.data[0] != ']') {
+            // NOTE: string8_parse<f64> consumes the whole string, i.e. the number is delimited first
+            size_t n = 0;
+            while(n < rest.len && rest.data[n] != ',' && rest.data[n] != ']') n += 1;
+            array_push_back(samples, a, string8_parse<f64>(S8_DATA(rest.data, n)).value);
+            n += n < rest.len && rest.data[n] == ',';
+            rest = S8_DATA(rest.data + n, rest.len - n);
+        }
+
+        BenchResult r = {.name = name,
+                         .samples_ns = samples,
+                         .n_iters = 0,
+                         .n_outliers = 0,
+                         .median_ns = 0,
+                         .mean_ns = 0,
+                         .stddev_ns = 0,
+                         .min_ns = 0,
+                         .max_ns = 0,
+                         .p50_ns = 0,
+                         .p99_ns = 0,
+                         .p999_ns = 0,
+                         .perf = {}};
+        merge_sort(r.samples_ns.data, r.samples_ns.len);
+        _bench_describe(r);
+        results.push_back(r);
+    }
+    return results.len > 0 ? arena_push_array(a, Array<BenchResult>(results)) : Array<BenchResult>{};
+}
+
+void bench_print_comparison(FILE* f, const BenchComparison& c) {
+    const char* verdict = c.verdict == BENCH_SLOWER ? "SLOWER" : c.verdict == BENCH_FASTER ? "faster" : "unchanged";
+    AArenaTmp tmp = begin_scratch();
+    print(f,
+          tmp.arena,
+          "{}: {.2}ns -> {.2}ns ratio={.3} [{.3}, {.3}] p={.4} {}\n",
+          c.name,
+          c.base_median_ns,
+          c.new_median_ns,
+          c.ratio,
+          c.ratio_lo,
+          c.ratio_hi,
+          c.p_value,
+          verdict);
+}
+
+/* SECTION: main */
+INTERNAL Result<Array<BenchResult>, FileErr> _bench_load(Arena* a, String8 path) {
+    auto file = memfile_open(a, path, MemFileParams{.mode = MEMFILE_MODE_READ});
+    if(file) return {.value = {}, .error = file.error, .reason = file.reason};
+    Array<BenchResult> results = bench_results_parse(a, S8_DATA(file.value.data.data, file.value.data.len));
+    memfile_close(file.value);
+    return {.value = results, .error = {}, .reason = {}};
+}
+
+// prints the comparison per benchmark, returns the number of benchmarks that got slower
+INTERNAL u32 _bench_compare_all(const BenchParams& p, Array<BenchResult> base, Array<BenchResult> cur) {
+    u32 n_slower = 0;
+    for(const BenchResult& r : cur) {
+        const BenchResult* b = nullptr;
+        for(const BenchResult& x : base) {
+            if(x.name == r.name) {
+                b = &x;
+                break;
+            }
+        }
+        if(!b) {
+            print("{}: only in new\n", r.name);
+            continue;
+        }
+        BenchComparison c = bench_compare(*b, r, p.alpha, p.threshold);
+        bench_print_comparison(stdout, c);
+        n_slower += c.verdict == BENCH_SLOWER;
+    }
+    for(const BenchResult& x : base) {
+        bool found = false;
+        for(const BenchResult& r : cur) found |= x.name == r.name;
+        if(!found) print("{}: only in base\n", x.name);
+    }
+    return n_slower;
+}
+
+// pins the calling thread to cpu, -2 picks the current CPU, returns the CPU or -1 if not pinned
+INTERNAL i32 _bench_pin_cpu(i32 cpu) {
+#if defined(CXB_PLATFORM_LINUX)
+    if(cpu == -1) return -1;
+    if(cpu < -1) cpu = sched_getcpu();
+    if(cpu < 0) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? cpu : -1;
+#else
+    (void) cpu;
+    return -1;
+#endif
+}
+
+INTERNAL const char* BENCH_USAGE =
+    "usage: %s [options]\n"
+    "  --samples N            samples per benchmark (default 30)\n"
+    "  --warmup-ms X          warmup per benchmark (default 100)\n"
+    "  --sample-ms X          target duration of a sample (default 10)\n"
+    "  --max-ms X             measurement budget per benchmark, at least 5 samples (default 5000)\n"
+    "  --cpu N                pin to CPU N, -1: no pinning (default: the current CPU)\n"
+    "  --perf                 report hardware counters per call\n"
+    "  --filter S             run the benchmarks whose case or name contains S\n"
+    "  --json PATH            write the results to PATH\n"
+    "  --compare BASE [NEW]   compare NEW (default: this run) against BASE, exit code 1 if slower\n"
+    "  --alpha X              significance level of the comparison (default 0.05)\n"
+    "  --threshold X          relative change reported as unchanged (default 0.02)\n";
+
+int bench_main(int argc, char** argv) {
+    Bencher b = {};
+    BenchParams& p = b.params;
+    for(int i = 1; i < argc; ++i) {
+        String8 arg = S8_CSTR(argv[i]);
+        bool has_value = i + 1 < argc;
+        // NOTE: S8_CSTR evaluates its argument twice
+        String8 value = has_value ? S8_CSTR(argv[i + 1]) : S8_LIT("");
+        if(arg == S8_LIT("--help") || arg == S8_LIT("-h")) {
+            printf(BENCH_USAGE, argv[0]);
+            return 0;
+        } else if(arg == S8_LIT("--perf")) {
+            p.perf = true;
+        } else if(arg == S8_LIT("--samples") && has_value) {
+            p.n_samples = (u32) string8_parse<u64>(value).value;
+            i += 1;
+        } else if(arg == S8_LIT("--warmup-ms") && has_value) {
+            p.warmup_ms = string8_parse<f64>(value).value;
+            i += 1;
+        } else if(arg == S8_LIT("--sample-ms") && has_value) {
+            p.sample_ms = string8_parse<f64>(value).value;
+            i += 1;
+        } else if(arg == S8_LIT("--max-ms") && has_value) {
+            p.max_ms = string8_parse<f64>(value).value;
+            i += 1;
+        } else if(arg == S8_LIT("--cpu") && has_value) {
+            p.cpu = (i32) string8_parse<i64>(value).value;
+            i += 1;
+        } else if(arg == S8_LIT("--filter") && has_value) {
+            p.filter = value;
+            i += 1;
+        } else if(arg == S8_LIT("--json") && has_value) {
+            p.json_path = value;
+            i += 1;
+        } else if(arg == S8_LIT("--compare") && has_value) {
+            p.compare_base_path = value;
+            i += 1;
+            if(i + 1 < argc && argv[i + 1][0] != '-') {
+                p.compare_new_path = S8_CSTR(argv[i + 1]);
+                i += 1;
+            }
+        } else if(arg == S8_LIT("--alpha") && has_value) {
+            p.alpha = string8_parse<f64>(value).value;
+            i += 1;
+        } else if(arg == S8_LIT("--threshold") && has_value) {
+            p.threshold = string8_parse<f64>(value).value;
+            i += 1;
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            fprintf(stderr, BENCH_USAGE, argv[0]);
+            return 2;
+        }
+    }
+
+    b.arena = arena_make(
+        ArenaParams{.reserve_bytes = GB(1), .max_n_blocks = 1, .name = "bench", .decommit_threshold = 0});
+    int exit_code = 0;
+    Array<BenchResult> results = {};
+    if(p.compare_new_path.len > 0) {
+        auto loaded = _bench_load(b.arena, p.compare_new_path);
+        if(loaded) {
+            fprintf(stderr, "failed to read %s\n", p.compare_new_path.c_str_maybe_copy(b.arena));
+            arena_destroy(b.arena);
+            return 2;
+        }
+        results = loaded.value;
+    } else {
+        i32 cpu = _bench_pin_cpu(p.cpu);
+        if(p.perf) b.perf = perf_counters_open();
+        for(BenchCase* c = bench_cases_head; c; c = c->next) {
+            b.case_name = c->name;
+            c->fn(&b);
+        }
+        if(p.perf) perf_counters_close(b.perf);
+        results = Array<BenchResult>(b.results);
+
+        if(p.json_path.len > 0) {
+            String8 json = bench_results_json(b.arena, results, cpu);
+            FILE* f = fopen(p.json_path.c_str_maybe_copy(b.arena), "wb");
+            bool ok = f && fwrite(json.data, 1, json.len, f) == json.len;
+            ok &= f && fclose(f) == 0;
+            if(!ok) {
+                fprintf(stderr, "failed to write %s\n", p.json_path.c_str_maybe_copy(b.arena));
+                exit_code = 2;
+            }
+        }
+    }
+
+    if(p.compare_base_path.len > 0) {
+        auto base = _bench_load(b.arena, p.compare_base_path);
+        if(base) {
+            fprintf(stderr, "failed to read %s\n", p.compare_base_path.c_str_maybe_copy(b.arena));
+            exit_code = 2;
+        } else if(_bench_compare_all(p, base.value, results) > 0) {
+            exit_code = max(exit_code, 1);
+        }
+    }
+    arena_destroy(b.arena);
+    return exit_code;
+}
@@ -0,0 +1,174 @@
+/*
+# cxb/bench: in-process benchmark harness
+
+* `BENCH_CASE("name") { ... }` registers a group of benchmarks, `bench_run(b, "name", fn)` measures calls to `fn`.
+  Code in the case around `bench_run` (setup, teardown) is not measured. `BENCH_MAIN()` defines `main`
+* per benchmark:
+    - warmup: `fn` is called for `--warmup-ms`, doubling the calls per round, which also calibrates the number of
+      calls per sample (`n_iters`) such that a sample takes `--sample-ms`
+    - `--samples` samples of `n_iters` calls each, fewer if they would exceed `--max-ms`
+    - outliers are rejected with Tukey's fences: samples outside [Q1 - 1.5 IQR, Q3 + 1.5 IQR]
+    - the kept samples are summarized as median, mean, standard deviation, min and max ns per call
+    - latency percentiles p50, p99 and p999: one extra sample of at most BENCH_MAX_LATENCY_CALLS calls, each call
+      timed on its own into a `Histogram` (cxb/histogram.h). They include the timer's overhead, and p999 is only
+      meaningful with 1000+ calls per sample
+    - `--perf`: hardware counters per call (cxb/perf.h), from one extra sample
+* on Linux the process is pinned to a CPU: `--cpu N`, by default the CPU it starts on, `--cpu -1` disables pinning
+* `--json path` writes the results including the kept samples, `--filter s` runs the benchmarks whose case or name
+  contains s
+* `--compare base.json [new.json]` compares two result files, or the current run against base.json. Per benchmark:
+    - a two-sided Mann-Whitney U test (normal approximation with tie correction) of the samples gives the p-value
+    - the Hodges-Lehmann estimate of the log ratio new/base gives the ratio and its confidence interval
+      (1 - `--alpha`)
+    - a benchmark is reported slower (faster) if p < alpha and the ratio is above (below) 1 +- `--threshold`
+  The exit code is 1 if a benchmark got slower
+
+```
+BENCH_CASE("AHashMap") {
+    AHashMap<int, int> hm;
+    for(int i = 0; i < 1000; ++i) hm.put({i, i});
+    bench_run(b, "AHashMap<int,int> lookup", [&] { return hm.contains(42); });
+}
+BENCH_MAIN()
+```
+*/
+#ifndef CXB_BENCH_H
+#define CXB_BENCH_H
+
+#include "hashmap.h"
+#include "string8.h"
+#include "perf.h"
+
+// calls of the latency sample, bounds its time for benchmarks with many calls per sample
+constexpr u64 BENCH_MAX_LATENCY_CALLS = 1 << 16;
+
+struct BenchParams {
+    u32 n_samples = 30;
+    f64 warmup_ms = 100;
+    f64 sample_ms = 10;
+    f64 max_ms = 5000; // per benchmark, at least 5 samples are taken
+    i32 cpu = -2;      // -2: the CPU the process starts on, -1: no pinning
+    bool perf = false;
+    String8 filter;
+    String8 json_path;
+    String8 compare_base_path;
+    String8 compare_new_path; // empty: compare the current run
+    f64 alpha = 0.05;
+    f64 threshold = 0.02; // relative change below which a significant difference is reported as unchanged
+};
+
+struct BenchResult {
+    String8 name;
+    Array<f64> samples_ns; // ns per call, outliers removed, sorted
+    u64 n_iters;           // calls per sample
+    u32 n_outliers;
+    f64 median_ns;
+    f64 mean_ns;
+    f64 stddev_ns;
+    f64 min_ns;
+    f64 max_ns;
+    f64 p50_ns; // per call latencies, 0 for results read from a file
+    f64 p99_ns;
+    f64 p999_ns;
+    PerfSample perf; // valid[] is false without --perf
+};
+
+enum BenchVerdict {
+    BENCH_UNCHANGED = 0,
+    BENCH_FASTER,
+    BENCH_SLOWER,
+};
+
+struct BenchComparison {
+    String8 name;
+    f64 base_median_ns;
+    f64 new_median_ns;
+    f64 ratio; // new / base
+    f64 ratio_lo;
+    f64 ratio_hi;
+    f64 p_value;
+    BenchVerdict verdict;
+};
+
+struct Bencher {
+    BenchParams params;
+    Arena* arena;
+    const char* case_name;
+    AArray<BenchResult> results;
+    PerfCounters perf;
+};
+
+/* SECTION: registration */
+typedef void (*BenchCaseFn)(Bencher* b);
+
+struct BenchCase {
+    const char* name;
+    BenchCaseFn fn;
+    BenchCase* next;
+};
+
+int bench_register(BenchCase* c);
+
+#define _BENCH_CONCAT2(a, b) a##b
+#define _BENCH_CONCAT(a, b) _BENCH_CONCAT2(a, b)
+#define BENCH_CASE(name)                                                                 \
+    INTERNAL void _BENCH_CONCAT(_bench_case_fn_, __LINE__)(Bencher*);                    \
+    INTERNAL BenchCase _BENCH_CONCAT(_bench_case_, __LINE__) = {                         \
+        name, _BENCH_CONCAT(_bench_case_fn_, __LINE__), nullptr};                        \
+    INTERNAL int _BENCH_CONCAT(_bench_case_registered_, __LINE__) =                      \
+        bench_register(&_BENCH_CONCAT(_bench_case_, __LINE__));                          \
+    INTERNAL void _BENCH_CONCAT(_bench_case_fn_, __LINE__)([[maybe_unused]] Bencher * b)
+
+// parses the arguments, runs the registered cases, writes --json and runs --compare, returns the exit code
+int bench_main(int argc, char** argv);
+#define BENCH_MAIN()                   \
+    int main(int argc, char** argv) {  \
+        return bench_main(argc, argv); \
+    }
+
+/* SECTION: running */
+// prevents the compiler from optimizing x (and its computation) away
+template <typename T>
+CXB_INLINE void bench_keep(const T& x) {
+    asm volatile("" : : "r,m"(x) : "memory");
+}
+
+bool bench_enabled(const Bencher* b, String8 name);
+void _bench_run(Bencher* b, String8 name, void (*call)(void* ctx, u64 n), void* ctx);
+
+template <typename F>
+void bench_run(Bencher* b, String8 name, F&& fn) {
+    if(!bench_enabled(b, name)) return;
+    using Fn = std::remove_reference_t<F>;
+    auto call = [](void* ctx, u64 n) {
+        Fn& f = *(Fn*) ctx;
+        for(u64 i = 0; i < n; ++i) {
+            if constexpr(std::is_void_v<decltype(f())>) {
+                f();
+            } else {
+                bench_keep(f());
+            }
+        }
+    };
+    _bench_run(b, name, call, (void*) &fn);
+}
+
+template <typename F>
+void bench_run(Bencher* b, const char* name, F&& fn) {
+    bench_run(b, S8_CSTR(name), forward<F>(fn));
+}
+
+/* SECTION: statistics */
+// rejects outliers from samples_ns (sorted in place) and fills the summary of r
+void bench_summarize(BenchResult& r, Array<f64> samples_ns);
+// two-sided p-value that x and y are drawn from the same distribution
+f64 mann_whitney_p(Array<f64> x, Array<f64> y);
+BenchComparison bench_compare(const BenchResult& base, const BenchResult& cur, f64 alpha, f64 threshold);
+
+/* SECTION: results */
+String8 bench_results_json(Arena* a, Array<BenchResult> results, i32 cpu);
+// reads a file written by bench_results_json, only the name and the samples are read back
+Array<BenchResult> bench_results_parse(Arena* a, String8 json);
+void bench_print_comparison(FILE* f, const BenchComparison& c);
+
+#endif /* CXB_BENCH_H */
@@ -0,0 +1,431 @@
+/*
+# cxb/core: configuration, macros, primitive types & functions
+
+The base layer of every other cxb header: `u8`..`u64`, `f32`, `f64`, `KB`/`MB`/`GB`, `ASSERT`, `LIKELY`, platform
+macros, `min`/`max`/`clamp`/`swap`/`move`/`forward`, `construct`/`destroy`/`copy` and the C-compatible math types.
+
+Include only this (or the lightest layer that has what you need) to keep compile times down, see `cxb.h` for the
+layers.
+*/
+#ifndef CXB_CORE_H
+#define CXB_CORE_H
+
+// #define CXB_USE_C11_ATOMICS
+
+/* SECTION: configuration */
+#if __cpp_concepts
+#include <concepts>
+#define CXB_USE_CXX_CONCEPTS
+#endif
+
+#define CXB_SEQ_MIN_CAP 32
+#define CXB_SEQ_GROW_FN(x) (x) + (x) / 2 /* 3/2, reducing chance to overflow */
+#define CXB_STR_MIN_CAP 32
+#define CXB_STR_GROW_FN(x) (x) + (x) / 2 /* 3/2, reducing chance to overflow  */
+#define CXB_HM_MIN_CAP 64
+#define CXB_HM_LOAD_CAP_THRESHOLD 0.75
+
+// NOTE: to generate cxb-c.h (C header)
+#define CXB_C_COMPAT_BEGIN
+#define CXB_C_COMPAT_END
+#define CXB_C_TYPE
+
+/* SECTION: includes */
+CXB_C_COMPAT_BEGIN
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h> // atof
+#include <string.h>
+CXB_C_COMPAT_END
+
+#include <initializer_list>
+#include <limits>
+#include <new>
+#include <type_traits> // 27ms
+#if defined(__APPLE__)
+#include <TargetConditionals.h>
+#endif
+
+#ifdef __cplusplus
+#define CXB_C_EXPORT extern "C"
+#define CXB_C_IMPORT extern "C"
+#define C_DECL_BEGIN extern "C" {
+#define C_DECL_END }
+#else
+#define CXB_C_EXPORT
+#define CXB_C_IMPORT
+#define C_DECL_BEGIN
+#define C_DECL_END
+#endif
+
+/* SECTION: macros */
+// NOTE some macros are copied/modified from Blend2D, see:
+// https://github.com/blend2d/blend2d/blob/bae3b6c600186a69a9f212243ed9700dc93a314a/src/blend2d/api.h#L563
+CXB_C_COMPAT_BEGIN
+#define CXB_EXPORT
+#define CXB_INTERNAL static
+#define COUNTOF_LIT(a) (size_t) (sizeof(a) / sizeof(*(a)))
+#define LENGTHOF_LIT(s) (COUNTOF_LIT(s) - 1)
+
+// see: https://github.com/EpicGamesExt/raddebugger/blob/master/src/base/base_core.h
+#define BYTES(n) ((u64) (n))
+#define KB(n) ((u64) (n) << 10)
+#define MB(n) ((u64) (n) << 20)
+#define GB(n) ((u64) (n) << 30)
+#define TB(n) ((u64) (n) << 40)
+#define PB(n) ((u64) (n) << 50)
+
+#define Thousands(x) ((x) * 1000LL)
+#define Millions(x) (Thousands(x) * 1000LL)
+#define Billions(x) (Millions(x) * 1000ULL)
+#define Trillions(x) (Billions(x) * 1000ULL)
+
+#if defined(__clang__)
+#define BREAKPOINT() __builtin_debugtrap()
+#elif defined(__GNUC__)
+#define BREAKPOINT() __builtin_trap()
+#else
+#define BREAKPOINT() abort()
+#endif
+#if defined(__clang__) || defined(__GNUC__)
+#define LIKELY(x) __builtin_expect(!!(x), 1)
+#define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define LIKELY(x) (x)
+#define UNLIKELY(x) (x)
+#endif
+
+/* Platform detection */
+#if defined(__APPLE__)
+#define CXB_PLATFORM_DARWIN 1
+#if defined(TARGET_OS_OSX) && TARGET_OS_OSX
+#define CXB_PLATFORM_MACOS 1
+#endif
+#if defined(TARGET_OS_IOS) && TARGET_OS_IOS
+#define CXB_PLATFORM_IOS 1
+#endif
+#if defined(TARGET_OS_IPHONE) && TARGET_OS_IPHONE
+#define CXB_PLATFORM_IPHONE 1
+#endif
+#if defined(TARGET_OS_IPAD) && TARGET_OS_IPAD
+#define CXB_PLATFORM_IPAD 1
+#endif
+#if defined(TARGET_OS_WATCH) && TARGET_OS_WATCH
+#define CXB_PLATFORM_APPLE_WATCH 1
+#endif
+#endif
+
+#if defined(__linux__)
+#define CXB_PLATFORM_LINUX 1
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+#define CXB_PLATFORM_WINDOWS 1
+#endif
+
+#if defined(CXB_PLATFORM_LINUX) || defined(CXB_PLATFORM_DARWIN)
+#define CXB_PLATFORM_UNIX 1
+#endif
+
+#define INTERNAL static
+#define GLOBAL static
+
+#if defined(_MSC_VER)
+#if defined(__SANITIZE_ADDRESS__)
+#define ASAN_ENABLED 1
+#define NO_ASAN __declspec(no_sanitize_address)
+#else
+#define NO_ASAN
+#endif
+#elif defined(__clang__)
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || defined(__SANITIZE_ADDRESS__)
+#define ASAN_ENABLED 1
+#endif
+#endif
+#define NO_ASAN __attribute__((no_sanitize("address")))
+#else
+#define NO_ASAN
+#endif
+
+#if ASAN_ENABLED
+CXB_C_IMPORT void __asan_poison_memory_region(void const volatile* addr, size_t size);
+CXB_C_IMPORT void __asan_unpoison_memory_region(void const volatile* addr, size_t size);
+#define ASAN_POISON_MEMORY_REGION(addr, size) __asan_poison_memory_region((addr), (size))
+#define ASAN_UNPOISON_MEMORY_REGION(addr, size) __asan_unpoison_memory_region((addr), (size))
+#else
+#define ASAN_POISON_MEMORY_REGION(addr, size) ((void) (addr), (void) (size))
+#define ASAN_UNPOISON_MEMORY_REGION(addr, size) ((void) (addr), (void) (size))
+#endif
+
+#define inline inline
+#if defined(__GNUC__)
+#define CXB_INLINE inline __attribute__((__always_inline__))
+#elif defined(_MSC_VER)
+#define CXB_INLINE __forceinline
+#else
+#define CXB_INLINE inline
+#endif
+
+CXB_C_COMPAT_END
+
+// NOTE: these are C++ only, as they use a C++ formatting library
+#define DEBUG_ASSERT(x, ...) \
+    if(!(x)) BREAKPOINT()
+#define ASSERT(x, ...)    \
+    if(!(x)) BREAKPOINT()
+#define INVALID_CODEPATH(msg) \
+    /* TODO: output msg */    \
+    BREAKPOINT()
+
+/* * SECTION: primitives */
+CXB_C_COMPAT_BEGIN
+typedef uint8_t byte8;
+// TODO
+// typedef _Float16 f16;
+typedef float f32;
+typedef double f64;
+typedef int32_t i32;
+typedef int64_t i64;
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int64_t ll;
+typedef int32_t rune;
+
+#if defined(__GNUC__)
+typedef __uint128_t u128;
+typedef __int128_t i128;
+// TODO: support MSVC
+#endif
+
+#if defined(__GNUC__)
+#define CXB_INLINE inline __attribute__((__always_inline__))
+#elif defined(_MSC_VER)
+#define CXB_INLINE __forceinline
+#else
+#define CXB_INLINE inline
+#endif
+CXB_C_COMPAT_END
+
+#if defined(__clang_major__) && __clang_major__ >= 6
+#define CXB_PURE constexpr __attribute__((__pure__))
+#elif defined(__GNUC__) && __GNUC__ >= 6
+#define CXB_PURE constexpr __attribute__((__pure__))
+#else
+#define CXB_PURE constexpr
+#endif
+
+// with CXB_EXTERN_TEMPLATES, common instantiations are declared `CXB_EXTERN_TEMPLATE` in the headers and compiled once
+// in cxb.cpp, which defines it as `template`
+#ifndef CXB_EXTERN_TEMPLATE
+#define CXB_EXTERN_TEMPLATE extern template
+#endif
+
+template <typename T>
+static inline const T& min(const T& a, const T& b) {
+    return a < b ? a : b;
+}
+
+template <typename T>
+static inline const T& max(const T& a, const T& b) {
+    return a > b ? a : b;
+}
+
+/* NOTE: #include <utility>  // takes 98ms */
+template <typename T>
+static inline typename std::remove_reference<T>::type&& move(T&& v) noexcept {
+    return static_cast<typename std::remove_reference<T>::type&&>(v);
+}
+
+template <typename T>
+static inline T&& forward(typename std::remove_reference<T>::type& v) noexcept {
+    return static_cast<T&&>(v);
+}
+
+template <typename T>
+static inline T&& forward(typename std::remove_reference<T>::type&& v) noexcept {
+    return static_cast<T&&>(v);
+}
+
+/* SECTION: primitive functions */
+template <typename T>
+inline void construct(T* xs, size_t len) {
+    ASSERT(len > 0);
+    if constexpr(!std::is_trivially_default_constructible_v<T>) {
+        for(size_t i = 0; i < len; ++i) {
+            new(xs + i) T{};
+        }
+    } else {
+        memset(xs, 0, sizeof(T) * len);
+    }
+}
+
+template <typename T>
+inline void construct(T* xs, size_t len, T default_value) {
+    ASSERT(len > 0);
+    if constexpr(!std::is_trivially_default_constructible_v<T>) {
+        for(size_t i = 0; i < len; ++i) {
+            new(xs + i) T{default_value};
+        }
+    } else {
+        for(size_t i = 0; i < len; ++i) {
+            memcpy((void*) (xs + i), (void*) (&default_value), sizeof(T));
+        }
+    }
+}
+
+template <typename T, typename... Args>
+inline void construct(T* xs, size_t len, Args&&... args) {
+    ASSERT(len > 0);
+    if constexpr(!std::is_trivially_default_constructible_v<T>) {
+        for(size_t i = 0; i < len; ++i) {
+            new(xs + i) T{args...};
+        }
+    } else {
+        // TODO: optimize?
+        for(size_t i = 0; i < len; ++i) {
+            new(xs + i) T{args...};
+        }
+    }
+}
+
+template <typename T>
+inline void destroy(T* xs, size_t len) {
+    if constexpr(!std::is_trivially_destructible_v<T>) {
+        for(size_t i = 0; i < len; ++i) {
+            xs[i].~T();
+        }
+    }
+}
+
+template <typename T>
+inline void copy(T* dst, const T* src, size_t n) {
+    if constexpr(std::is_trivially_assignable_v<T, T>) {
+        memcpy(dst, src, n * sizeof(T));
+    } else {
+        for(size_t i = 0; i < n; ++i) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+template <typename T>
+CXB_PURE const T& clamp(const T& x, const T& a, const T& b) {
+    return a < b ? max(min(b, x), a) : min(max(a, x), b);
+}
+
+template <typename T>
+static inline void swap(T& t1, T& t2) noexcept {
+    T temp(move(t1));
+    t1 = move(t2);
+    t2 = move(temp);
+}
+
+static CXB_INLINE u64 pow2mod(u64 x, u64 b) {
+    DEBUG_ASSERT(b != 0 && (b & (b - 1)) == 0, "{} is not a power of 2", b);
+    return x & (b - 1);
+}
+
+// ref: https://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
+static CXB_INLINE u64 round_up_pow2(u64 x) {
+    if(x <= 1) return 1;
+    x--;
+    x |= x >> 1;
+    x |= x >> 2;
+    x |= x >> 4;
+    x |= x >> 8;
+    x |= x >> 16;
+#if UINTPTR_MAX > 0xFFFFFFFFu
+    x |= x >> 32;
+#endif
+    x++;
+    return x;
+}
+
+/* SECTION: math types */
+CXB_C_TYPE struct Vec2f {
+    CXB_C_COMPAT_BEGIN
+    f32 x, y;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Vec2i {
+    CXB_C_COMPAT_BEGIN
+    i32 x, y;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Size2i {
+    CXB_C_COMPAT_BEGIN
+    i32 w, h;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Vec3f {
+    CXB_C_COMPAT_BEGIN
+    f32 x, y, z;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Vec3i {
+    CXB_C_COMPAT_BEGIN
+    i32 x, y, z;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Rect2f {
+    CXB_C_COMPAT_BEGIN
+    f32 x, y;
+    f32 w, h;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Rect2ui {
+    CXB_C_COMPAT_BEGIN
+    u32 x, y;
+    u32 w, h;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Color4f {
+    CXB_C_COMPAT_BEGIN
+    f32 r, g, b, a;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Color4i {
+    CXB_C_COMPAT_BEGIN
+    byte8 r, g, b, a;
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Mat33f {
+    CXB_C_COMPAT_BEGIN
+    f32 arr[9];
+    CXB_C_COMPAT_END
+};
+
+CXB_C_TYPE struct Mat44f {
+    CXB_C_COMPAT_BEGIN
+    f32 arr[16];
+    CXB_C_COMPAT_END
+};
+
+static const Mat44f identity4x4 = {.arr = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+static const Mat33f identity3x3 = {.arr = {
+                                       1,
+                                       0,
+                                       0,
+                                       0,
+                                       1,
+                                       0,
+                                       0,
+                                       0,
+                                       1,
+                                   }};
+
+#endif /* CXB_CORE_H */
@@ -157,6 +157,9 @@ typedef _Atomic(u128) atomic_u128;
 struct ArenaParams {
     size_t reserve_bytes;
     size_t max_n_blocks;
+    const char* name; // shown by arena_registry_snapshot, must outlive the arena
+    // popping below the committed bytes by more than this returns the excess to the OS (arena_decommit), 0: never
+    size_t decommit_threshold;
 };
 
 struct Arena {
@@ -170,6 +173,15 @@ struct Arena {
     Arena* prev;
     size_t n_blocks;
 
+    // telemetry, see arena_stats
+    size_t commit_pos; // highest pos since the last decommit, i.e. pages below it may be resident
+    size_t high_water; // highest pos before the last decommit, the high-water mark is max(high_water, commit_pos)
+    size_t n_pushes;
+
+    // registry of live arenas
+    Arena* registry_next;
+    Arena* registry_prev;
+
     // TODO: freelist
 };
 
@@ -1,11 +1,14 @@
+#ifndef CXB_EXTERN_TEMPLATE
+// the explicit instantiations of CXB_EXTERN_TEMPLATES
+#define CXB_EXTERN_TEMPLATE template
+#endif
 #include "cxb.h"
 
+#include <pthread.h>
 #include <stdlib.h> // for malloc, free, realloc, calloc
 #include <sys/mman.h>
 
-#ifdef __APPLE__
 #include <unistd.h> // for sysconf()
-#endif
 
 /*
 NOTES on Arenas
@@ -24,6 +27,38 @@ To de-commit memory, call mprotect:
     mprotect(decommit_addr, decommit, PROT_NONE);
 */
 
+// registry of live arenas, see arena_registry_snapshot
+INTERNAL pthread_mutex_t arena_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+INTERNAL Arena* arena_registry = nullptr;
+
+size_t os_page_size() {
+    static size_t page_size = 0;
+    if(UNLIKELY(page_size == 0)) {
+        page_size = (size_t) sysconf(_SC_PAGESIZE);
+    }
+    return page_size;
+}
+
+INTERNAL void _arena_register(Arena* arena) {
+    pthread_mutex_lock(&arena_registry_mutex);
+    arena->registry_prev = nullptr;
+    arena->registry_next = arena_registry;
+    if(arena_registry) arena_registry->registry_prev = arena;
+    arena_registry = arena;
+    pthread_mutex_unlock(&arena_registry_mutex);
+}
+
+INTERNAL void _arena_unregister(Arena* arena) {
+    pthread_mutex_lock(&arena_registry_mutex);
+    if(arena->registry_prev) {
+        arena->registry_prev->registry_next = arena->registry_next;
+    } else {
+        arena_registry = arena->registry_next;
+    }
+    if(arena->registry_next) arena->registry_next->registry_prev = arena->registry_prev;
+    pthread_mutex_unlock(&arena_registry_mutex);
+}
+
 CXB_C_EXPORT Arena* arena_make(ArenaParams params) {
     if(params.reserve_bytes == 0) {
         params.reserve_bytes = MB(1);
@@ -45,25 +80,18 @@ CXB_C_EXPORT Arena* arena_make(ArenaParams params) {
     result->pos = sizeof(Arena);
     result->end = result->start + params.reserve_bytes;
     result->n_blocks = 1;
+    result->commit_pos = result->pos;
+    _arena_register(result);
     return result;
 }
 
 CXB_C_EXPORT Arena* arena_make_nbytes(size_t n_bytes) {
-    return arena_make(ArenaParams{.reserve_bytes = n_bytes, .max_n_blocks = 1});
+    return arena_make(
+        ArenaParams{.reserve_bytes = n_bytes, .max_n_blocks = 1, .name = nullptr, .decommit_threshold = 0});
 }
 
 CXB_C_EXPORT void* arena_push_bytes(Arena* arena, size_t size, size_t align) {
-    ASSERT(UNLIKELY(arena != nullptr), "expected an arena");
-    u64 padding = (-arena->pos) & (align - 1);
-    arena->pos += padding;
-    ASSERT(arena->start + arena->pos + size < arena->end, "arena will spill");
-
-    void* data = arena->start + arena->pos;
-    // data % align == 0, but align = 2^x
-    DEBUG_ASSERT(((u64) data & (align - 1)) == 0);
-    ASAN_UNPOISON_MEMORY_REGION(data, size);
-    arena->pos += size;
-    return data;
+    return arena_push_bytes_inline(arena, size, align);
 }
 
 CXB_C_EXPORT void arena_pop_to(Arena* arena, u64 pos) {
@@ -75,18 +103,91 @@ CXB_C_EXPORT void arena_pop_to(Arena* arena, u64 pos) {
     u64 old_pos = arena->pos;
     arena->pos = pos;
     ASAN_POISON_MEMORY_REGION(arena->start + old_pos, old_pos - pos);
+    if(UNLIKELY(arena->params.decommit_threshold && arena->commit_pos - pos > arena->params.decommit_threshold)) {
+        arena_decommit(arena, 0);
+    }
 }
 
 CXB_C_EXPORT void arena_clear(Arena* arena) {
     arena->pos = sizeof(Arena);
+    if(UNLIKELY(arena->params.decommit_threshold &&
+                arena->commit_pos - arena->pos > arena->params.decommit_threshold)) {
+        arena_decommit(arena, 0);
+    }
+}
+
+CXB_C_EXPORT void arena_decommit(Arena* arena, size_t keep_bytes) {
+    size_t page = os_page_size();
+    size_t keep = max(arena->pos, keep_bytes);
+    size_t from = (keep + page - 1) & ~(page - 1);
+    size_t to = min((arena->commit_pos + page - 1) & ~(page - 1), (size_t) (arena->end - arena->start));
+    if(to > from) {
+        // NOTE: private anonymous pages read back as zero once touched again
+        madvise(arena->start + from, to - from, MADV_DONTNEED);
+    }
+    arena->high_water = max(arena->high_water, arena->commit_pos);
+    arena->commit_pos = min(arena->commit_pos, keep);
 }
 
 CXB_C_EXPORT void arena_destroy(Arena* arena) {
     ASSERT(arena != nullptr);
     ASSERT(arena->start != nullptr);
+    _arena_unregister(arena);
     munmap(arena->start, arena->end - arena->start);
 }
 
+ArenaStats arena_stats(const Arena* arena) {
+    size_t page = os_page_size();
+    return ArenaStats{
+        .name = arena->params.name ? arena->params.name : "",
+        .arena = arena,
+        .pos = arena->pos,
+        .high_water = max(arena->high_water, arena->commit_pos),
+        .committed = (arena->commit_pos + page - 1) & ~(page - 1),
+        .reserved = (size_t) (arena->end - arena->start),
+        .n_pushes = arena->n_pushes,
+    };
+}
+
+Array<ArenaStats> arena_registry_snapshot(Arena* a) {
+    pthread_mutex_lock(&arena_registry_mutex);
+    size_t len = 0;
+    for(Arena* x = arena_registry; x; x = x->registry_next) len += 1;
+    // NOTE: pushed before reading the stats, such that the stats of `a` include the snapshot itself
+    ArenaStats* stats = len > 0 ? arena_push_fast<ArenaStats>(a, len) : nullptr;
+    size_t i = 0;
+    for(Arena* x = arena_registry; x; x = x->registry_next) {
+        stats[i++] = arena_stats(x);
+    }
+    pthread_mutex_unlock(&arena_registry_mutex);
+
+    merge_sort(stats, len, [](const ArenaStats& x, const ArenaStats& y) { return x.committed > y.committed; });
+    return Array<ArenaStats>{stats, len};
+}
+
+size_t arena_registry_committed() {
+    size_t committed = 0;
+    pthread_mutex_lock(&arena_registry_mutex);
+    for(Arena* x = arena_registry; x; x = x->registry_next) {
+        committed += arena_stats(x).committed;
+    }
+    pthread_mutex_unlock(&arena_registry_mutex);
+    return committed;
+}
+
+void format_value(Arena* a, String8& dst, String8 args, const ArenaStats& s) {
+    (void) args;
+    _format_impl(a,
+                 dst,
+                 "{}: pos={} high_water={} committed={} reserved={} pushes={}",
+                 s.name[0] ? s.name : "<unnamed>",
+                 s.pos,
+                 s.high_water,
+                 s.committed,
+                 s.reserved,
+                 s.n_pushes);
+}
+
 // * SECTION: allocators
 void* heap_alloc_proc(void* head, size_t n_bytes, size_t alignment, size_t old_n_bytes, bool fill_zeros, void* data);
 void heap_free_proc(void* head, size_t n_bytes, void* data);
@@ -396,9 +497,13 @@ static CxbRuntimeParams runtime_params = {};
 
 CXB_INLINE void _maybe_init_runtime() {
     if(UNLIKELY(!cxb_runtime.perm)) {
-        cxb_runtime.perm = arena_make(runtime_params.perm_params);
-        cxb_runtime.scratch[0] = arena_make(runtime_params.scratch_params);
-        cxb_runtime.scratch[1] = arena_make(runtime_params.scratch_params);
+        ArenaParams perm_params = runtime_params.perm_params;
+        ArenaParams scratch_params = runtime_params.scratch_params;
+        perm_params.name = perm_params.name ? perm_params.name : "perm";
+        scratch_params.name = scratch_params.name ? scratch_params.name : "scratch";
+        cxb_runtime.perm = arena_make(perm_params);
+        cxb_runtime.scratch[0] = arena_make(scratch_params);
+        cxb_runtime.scratch[1] = arena_make(scratch_params);
         cxb_runtime.scratch_idx = 0;
     }
 }
@@ -0,0 +1,170 @@
+/*
+# cxb/format: formatting
+
+`format(arena, "{} {}", x, y)`, `print`, `println`, `write`, `writeln`. Provide `format_value` to format your own types.
+*/
+#ifndef CXB_FORMAT_H
+#define CXB_FORMAT_H
+
+#include "string8.h"
+
+// *SECTION*: formatting library
+template <typename T, typename... Args>
+void _format_impl(Arena* a, String8& dst, const char* fmt, const T& first, const Args&... rest);
+
+template <typename... Args>
+String8 format(Arena* a, const char* fmt, const Args&... args) {
+    String8 dst = arena_push_string8(a);
+    _format_impl(a, dst, fmt, args...);
+    return dst;
+}
+
+template <typename... Args>
+void print(FILE* f, Arena* a, const char* fmt, const Args&... args) {
+    String8 str = format(a, fmt, args...);
+    if(str.data) {
+        fwrite(&str[0], sizeof(char), str.len, f);
+    }
+}
+
+template <typename... Args>
+void write(FILE* f, const char* fmt, const Args&... args) {
+    ArenaTmp a = begin_scratch();
+    String8 str = format(a.arena, fmt, args...);
+    if(str.data) {
+        fwrite(&str[0], sizeof(char), str.len, f);
+    }
+    end_scratch(a);
+}
+
+template <typename... Args>
+CXB_INLINE void print(const char* fmt, const Args&... args) {
+    ArenaTmp a = begin_scratch();
+    print(stdout, a.arena, fmt, args...);
+    end_scratch(a);
+}
+
+template <typename... Args>
+CXB_INLINE void println(const char* fmt, const Args&... args) {
+    ArenaTmp a = begin_scratch();
+    String8 str = format(a.arena, fmt, args...);
+    print("{}\n", str);
+    end_scratch(a);
+}
+
+template <typename... Args>
+CXB_INLINE void writeln(FILE* f, const char* fmt, const Args&... args) {
+    ArenaTmp a = begin_scratch();
+    String8 str = format(a.arena, fmt, args...);
+    write(f, "{}\n", str);
+    end_scratch(a);
+}
+
+/*
+to format your own type T, provide an overloaded version of:
+
+void format_value(Arena* a, String8& dst, String8 args, T x);
+*/
+void format_value(Arena* a, String8& dst, String8 args, const char* s);
+void format_value(Arena* a, String8& dst, String8 args, String8 s);
+
+static constexpr char BASE_16_CHARS[] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+template <typename T>
+void format_value(Arena* a, String8& dst, String8 args, T* s) {
+    (void) args;
+    constexpr i64 N = (sizeof(u64) * 8);
+
+    u64 v = reinterpret_cast<u64>(s);
+
+    char buf[N] = {};
+    int i = 0;
+    while(v > 0) {
+        buf[i++] = BASE_16_CHARS[(v % 16)];
+        v /= 16;
+    }
+
+    string8_push_back(dst, a, '0');
+    string8_push_back(dst, a, 'x');
+    if(i == 0) {
+        string8_push_back(dst, a, '0');
+    }
+    for(i64 j = i - 1; j >= 0; --j) {
+        string8_push_back(dst, a, buf[j]);
+    }
+}
+
+template <typename T>
+std::enable_if_t<std::is_integral_v<T>, void> format_value(Arena* a, String8& dst, String8 args, T value) {
+    (void) args;
+    constexpr i64 N = (sizeof(u64) * 8);
+
+    char buf[N] = {};
+    bool neg = value < 0;
+    u64 v = neg ? static_cast<u64>(-value) : static_cast<u64>(value);
+    int i = 0;
+    do {
+        buf[i++] = '0' + (v % 10);
+        v /= 10;
+    } while(v > 0);
+
+    if(neg) {
+        string8_push_back(dst, a, '-');
+    }
+    for(i64 j = i - 1; j >= 0; --j) {
+        string8_push_back(dst, a, buf[j]);
+    }
+}
+
+void format_value(Arena* a, String8& dst, String8 args, bool value);
+void format_value(Arena* a, String8& dst, String8 args, f32 value);
+void format_value(Arena* a, String8& dst, String8 args, f64 value);
+
+template <typename T, typename... Args>
+void _format_impl(Arena* a, String8& dst, const char* fmt, const T& first, const Args&... rest) {
+    String8 s = {};
+    s.data = (char*) fmt;
+
+    i64 args_i = -1;
+    u64 i = 0;
+    while(*fmt) {
+        s.len += 1;
+
+        char curr = s[i];
+        if(curr == '{') {
+            args_i = i;
+        } else if(curr == '}') {
+            String8 args = s.slice(args_i + 1, (i64) i - 1);
+            format_value(a, dst, args, first);
+            _format_impl(a, dst, s.data + i + 1, rest...);
+            break;
+        } else if(args_i < 0) {
+            string8_push_back(dst, a, curr);
+        }
+        ++i;
+        ++fmt;
+    }
+}
+
+inline void _format_impl(Arena* a, String8& dst, const char* fmt) {
+    while(*fmt) {
+        if(*fmt == '{' && *(fmt + 1) != '{') {
+            DEBUG_ASSERT(false, "not enough parameters given to format string");
+            break;
+        }
+        string8_push_back(dst, a, *fmt++);
+    }
+}
+
+/* SECTION: extern templates */
+#ifdef CXB_EXTERN_TEMPLATES
+CXB_EXTERN_TEMPLATE void format_value(Arena* a, String8& dst, String8 args, u8 value);
+CXB_EXTERN_TEMPLATE void format_value(Arena* a, String8& dst, String8 args, u16 value);
+CXB_EXTERN_TEMPLATE void format_value(Arena* a, String8& dst, String8 args, i32 value);
+CXB_EXTERN_TEMPLATE void format_value(Arena* a, String8& dst, String8 args, u32 value);
+CXB_EXTERN_TEMPLATE void format_value(Arena* a, String8& dst, String8 args, i64 value);
+CXB_EXTERN_TEMPLATE void format_value(Arena* a, String8& dst, String8 args, u64 value);
+CXB_EXTERN_TEMPLATE void format_value(Arena* a, String8& dst, String8 args, void* value);
+#endif
+
+#endif /* CXB_FORMAT_H */
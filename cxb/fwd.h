@@ -0,0 +1,68 @@
+/*
+# cxb/fwd: forward declarations
+
+Declares the cxb types without their definitions, e.g. for headers that only pass them by pointer or reference:
+
+```
+#include <cxb/fwd.h>
+
+struct Parser;
+Parser* parser_make(Arena* arena, String8 src);
+```
+
+Default template arguments are declared here (only), i.e. `MHashMap<K, V>` is `MHashMap<K, V, DefaultHasher>`.
+*/
+#ifndef CXB_FWD_H
+#define CXB_FWD_H
+
+#include <stddef.h>
+
+/* SECTION: arena */
+struct Arena;
+struct ArenaParams;
+struct ArenaTmp;
+struct AArenaTmp;
+struct ArenaStats;
+struct Allocator;
+
+/* SECTION: atomic */
+template <typename T>
+struct Atomic;
+
+/* SECTION: arrays */
+template <typename T>
+struct Array;
+template <typename T, size_t N>
+struct StaticArray;
+template <typename T>
+struct MArray;
+template <typename T>
+struct AArray;
+
+/* SECTION: strings */
+struct String8;
+struct String8SplitIterator;
+struct MString8;
+struct AString8;
+struct Utf8Iter;
+struct Utf8IterBatch;
+
+/* SECTION: variant types */
+template <typename T, typename EC>
+struct Result;
+template <typename T>
+struct Optional;
+template <typename T>
+struct ParseResult;
+
+/* SECTION: hash maps */
+struct DefaultHasher;
+struct DefaultHasherBuiltin;
+template <typename K, typename V>
+struct KvPair;
+template <typename K, typename V, typename Hasher = DefaultHasher>
+struct MHashMap;
+template <typename K, typename V, typename Hasher = DefaultHasher>
+struct AHashMap;
+
+#endif /* CXB_FWD_H */
@@ -0,0 +1,477 @@
+/*
+# cxb/hashmap: open addressing hash maps
+
+`MHashMap<K, V, Hasher>` (manual) and `AHashMap<K, V, Hasher>` (RAII), given an `Allocator`. `DefaultHasher` calls
+`hash(key)`: provide `size_t hash(const K&)` for your key types. `DefaultHasherBuiltin` needs no definitions, it hashes
+32 and 64-bit integers and byte strings (e.g. `String8`).
+
+NOTE: `hash` of fundamental types (e.g. `int`) has no argument-dependent lookup, it is only found when declared before
+this header.
+*/
+#ifndef CXB_HASHMAP_H
+#define CXB_HASHMAP_H
+
+#include "array.h"
+
+enum HashMapState {
+    HM_STATE_EMPTY = 0,
+    HM_STATE_OCCUPIED,
+    HM_STATE_TOMBSTONE,
+};
+
+// murmur3's finalizer: every input bit affects the low bits, which select the slot
+CXB_INLINE u64 hash_mix64(u64 h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// FNV-1a
+CXB_INLINE u64 hash_bytes(const void* data, size_t n) {
+    u64 h = 0xcbf29ce484222325ull;
+    for(size_t i = 0; i < n; ++i) {
+        h ^= ((const u8*) data)[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+struct DefaultHasherBuiltin {
+    size_t operator()(i32 x) const {
+        return hash_mix64((u32) x);
+    }
+    size_t operator()(u32 x) const {
+        return hash_mix64(x);
+    }
+    size_t operator()(i64 x) const {
+        return hash_mix64((u64) x);
+    }
+    size_t operator()(u64 x) const {
+        return hash_mix64(x);
+    }
+    // anything with .data and .len, e.g. String8
+    template <class S>
+    size_t operator()(const S& x) const {
+        return hash_bytes(x.data, x.len * sizeof(*x.data));
+    }
+};
+
+struct DefaultHasher {
+    template <class T>
+    size_t operator()(const T& x) const {
+        return hash(x);
+    }
+};
+
+template <typename K, typename V>
+struct KvPair {
+    K key;
+    V value;
+};
+
+template <typename K, typename V, typename Hasher>
+struct MHashMap {
+    using Kv = KvPair<K, V>;
+
+    /* NOTE: key and value are not default constructed, due allocation function in Allocator* */
+    struct Entry {
+        Kv kv;
+        HashMapState state /* NOTE: ZII = HM_STATE_EMPTY */;
+    };
+
+    using Table = Array<Entry>;
+
+    struct Iterator {
+        MHashMap& hm;
+        size_t idx;
+
+        Entry& operator*() {
+            return hm.table[idx];
+        }
+        Iterator& ensure_occupied() {
+            if(UNLIKELY(hm.table.len == 0)) return *this;
+            while(LIKELY(hm.table.len != idx) && hm.table[idx].state != HM_STATE_OCCUPIED) {
+                idx += 1;
+            }
+            return *this;
+        }
+        Iterator& operator++() {
+            if(UNLIKELY(hm.table.len == 0)) return *this;
+            // NOTE: no wrap around, end() is idx == table.len
+            idx += 1;
+            return ensure_occupied();
+        }
+        bool operator==(const Iterator& it) const {
+            return idx == it.idx && LIKELY(&hm == &it.hm);
+        }
+        bool operator!=(const Iterator& it) const {
+            return !(*this == it);
+        }
+    };
+
+    Table table;
+    size_t len;
+    size_t n_tombstones; // erased entries, they count towards the load until the next rehash
+    Allocator* allocator;
+    Hasher hasher;
+
+    MHashMap(Allocator* allocator = &heap_alloc) : table{}, len{0}, n_tombstones{0}, allocator{allocator}, hasher{} {}
+    explicit MHashMap(size_t bucket_size, Allocator* allocator = &heap_alloc) : MHashMap(allocator) {
+        reserve(bucket_size);
+    }
+    MHashMap(Arena* arena, std::initializer_list<Kv> xs) : MHashMap(push_arena_alloc(arena)) {
+        extend(xs);
+    }
+    MHashMap(std::initializer_list<Kv> xs, Allocator* allocator = &heap_alloc) : MHashMap(allocator) {
+        extend(xs);
+    }
+    MHashMap(const MHashMap&) = delete;
+    MHashMap& operator=(const MHashMap&) = delete;
+
+    MHashMap(MHashMap&& o)
+        : table{o.table},
+          len{o.len},
+          n_tombstones{o.n_tombstones},
+          allocator{o.allocator ? o.allocator : &heap_alloc},
+          hasher{o.hasher} {
+        o.table.data = nullptr;
+        o.table.len = 0;
+        o.len = 0;
+        o.n_tombstones = 0;
+        o.allocator = nullptr;
+    }
+    MHashMap& operator=(MHashMap&& o) {
+        if(this != &o) {
+            destroy();
+            table = o.table;
+            len = o.len;
+            n_tombstones = o.n_tombstones;
+            hasher = o.hasher;
+            allocator = o.allocator;
+            o.table.data = nullptr;
+            o.table.len = 0;
+            o.len = 0;
+            o.n_tombstones = 0;
+            o.allocator = nullptr;
+        }
+        return *this;
+    }
+    ~MHashMap() = default;
+
+    f64 load_factor() const {
+        if(table.len == 0) return 0.0;
+        return (f64) (len) / (f64) (table.len);
+    }
+    bool needs_rehash() const {
+        return UNLIKELY(!table.data) || (f64) (len + n_tombstones) / (f64) table.len >= CXB_HM_LOAD_CAP_THRESHOLD;
+    }
+
+    template <class T>
+    inline size_t _key_hash_index(const T& x) const {
+        DEBUG_ASSERT(table.len > 0, "hash map table not initialized");
+        size_t h = hasher(x);
+        return pow2mod(h, table.len);
+    }
+
+    inline Iterator begin() {
+        return Iterator{*this, 0}.ensure_occupied();
+    }
+
+    inline Iterator end() {
+        return Iterator{*this, table.len};
+    }
+
+    CXB_ALLOC_ENTRY bool extend(Array<Kv> xs) {
+        CXB_ALLOC_SITE();
+        for(auto& x : xs) {
+            if(!put(x)) return false;
+        }
+        return true;
+    }
+    CXB_ALLOC_ENTRY bool extend(std::initializer_list<Kv> xs) {
+        CXB_ALLOC_SITE();
+        for(const auto& x : xs) {
+            if(!put(x)) return false;
+        }
+        return true;
+    }
+
+    CXB_ALLOC_ENTRY void maybe_rehash() {
+        CXB_ALLOC_SITE();
+        if(needs_rehash()) {
+            size_t capacity = table.len == 0 ? CXB_HM_MIN_CAP : table.len * 2;
+            // mostly tombstones, e.g. after insert/erase churn: rehash without growing
+            if(load_factor() < CXB_HM_LOAD_CAP_THRESHOLD / 2) capacity = table.len;
+            if(capacity < CXB_HM_MIN_CAP) capacity = CXB_HM_MIN_CAP;
+            _reserve(capacity);
+        }
+    }
+
+    CXB_ALLOC_ENTRY void reserve(size_t bucket_size) {
+        CXB_ALLOC_SITE();
+        size_t cap = (size_t) round_up_pow2(bucket_size);
+        if(cap < CXB_HM_MIN_CAP) cap = CXB_HM_MIN_CAP;
+        if(!table.data || cap > table.len) {
+            _reserve(cap);
+        }
+    }
+
+    CXB_ALLOC_ENTRY bool put(Kv kv) {
+        CXB_ALLOC_SITE();
+        maybe_rehash();
+
+        size_t ii = _key_hash_index(kv.key);
+        size_t i = ii;
+        size_t tombstone = SIZE_MAX;
+        while(table[i].state != HM_STATE_EMPTY) {
+            if(table[i].state == HM_STATE_OCCUPIED && table[i].kv.key == kv.key) {
+                return false;
+            }
+            if(table[i].state == HM_STATE_TOMBSTONE && tombstone == SIZE_MAX) {
+                tombstone = i;
+            }
+            i = pow2mod(i + 1, table.len); // TODO: quad probe?
+            if(i == ii) {
+                break;
+            }
+        }
+        // reuse the first tombstone on the probe sequence, once the key is known to be absent
+        if(tombstone != SIZE_MAX) {
+            i = tombstone;
+            n_tombstones -= 1;
+        }
+        DEBUG_ASSERT(table[i].state != HM_STATE_OCCUPIED);
+        ::construct(&table[i].kv.key, 1, kv.key);
+        ::construct(&table[i].kv.value, 1, kv.value);
+        table[i].state = HM_STATE_OCCUPIED;
+        len++;
+        return true;
+    }
+
+    inline bool erase(const K& key) {
+        if(!table.data || table.len == 0) return false;
+        size_t ii = _key_hash_index(key);
+        size_t i = ii;
+        do {
+            Entry& entry = table[i];
+            if(entry.state == HM_STATE_OCCUPIED && entry.kv.key == key) {
+                entry.state = HM_STATE_TOMBSTONE;
+                ::destroy(&entry.kv.key, 1);
+                ::destroy(&entry.kv.value, 1);
+                len -= 1;
+                n_tombstones += 1;
+                return true;
+            } else if(entry.state == HM_STATE_EMPTY) {
+                break;
+            }
+            i = pow2mod(i + 1, table.len); // TODO: quad probe?
+        } while(i != ii);
+        return false;
+    }
+
+    inline const Entry* occupied_entry_for(const K& key) const {
+        if(!table.data || table.len == 0) return nullptr;
+        size_t ii = _key_hash_index(key);
+        size_t i = ii;
+        do {
+            const Entry& entry = table[i];
+            if(entry.state == HM_STATE_OCCUPIED && entry.kv.key == key) {
+                return &entry;
+            } else if(entry.state == HM_STATE_EMPTY) {
+                break;
+            }
+            i = pow2mod(i + 1, table.len); // TODO: quad probe?
+        } while(i != ii);
+        return nullptr;
+    }
+
+    inline Entry* occupied_entry_for(const K& key) {
+        if(!table.data || table.len == 0) return nullptr;
+        size_t ii = _key_hash_index(key);
+        size_t i = ii;
+        do {
+            Entry& entry = table[i];
+            if(entry.state == HM_STATE_OCCUPIED && entry.kv.key == key) {
+                return &entry;
+            } else if(entry.state == HM_STATE_EMPTY) {
+                break;
+            }
+            i = pow2mod(i + 1, table.len); // TODO: quad probe?
+        } while(i != ii);
+        return nullptr;
+    }
+
+    inline bool contains(const K& key) const {
+        return occupied_entry_for(key) != nullptr;
+    }
+
+    inline V& operator[](const K& key) {
+        Entry* entry = occupied_entry_for(key);
+        DEBUG_ASSERT(entry != nullptr, "entry not present");
+        return entry->kv.value;
+    }
+
+    inline const V& operator[](const K& key) const {
+        const Entry* entry = occupied_entry_for(key);
+        DEBUG_ASSERT(entry != nullptr, "entry not present");
+        return entry->kv.value;
+    }
+
+    inline void destroy() {
+        if(!table.data || !allocator) return;
+        for(size_t i = 0; i < table.len; ++i) {
+            if(table[i].state == HM_STATE_OCCUPIED) {
+                ::destroy(&table[i].kv.key, 1);
+                ::destroy(&table[i].kv.value, 1);
+            }
+        }
+        allocator->free(table.data, table.len);
+        table.data = nullptr;
+        table.len = 0;
+        len = 0;
+        n_tombstones = 0;
+    }
+
+    CXB_ALLOC_ENTRY void _reserve(size_t cap) {
+        CXB_ALLOC_SITE();
+        size_t capacity = cap < CXB_HM_MIN_CAP ? CXB_HM_MIN_CAP : cap;
+        DEBUG_ASSERT(round_up_pow2(capacity) == capacity, "{} is not a power of 2", capacity);
+        ASSERT(allocator != nullptr);
+
+        Table old_table{};
+        old_table.data = table.data;
+        old_table.len = table.len;
+
+        table.data = allocator->calloc<Entry>(0, capacity);
+        table.len = capacity;
+        len = 0;
+        n_tombstones = 0;
+
+        for(size_t i = 0; i < old_table.len; ++i) {
+            if(old_table[i].state == HM_STATE_OCCUPIED) {
+                Kv kv{::move(old_table[i].kv.key), ::move(old_table[i].kv.value)};
+                bool inserted = insert_no_dupe_check(::move(kv));
+                DEBUG_ASSERT(inserted);
+                ::destroy(&old_table[i].kv.key, 1);
+                ::destroy(&old_table[i].kv.value, 1);
+            }
+        }
+        allocator->free(old_table.data, old_table.len);
+    }
+
+    inline bool insert_no_dupe_check(Kv&& kv) {
+        DEBUG_ASSERT(table.data != nullptr && table.len > 0, "hash map table not initialized");
+        size_t ii = _key_hash_index(kv.key);
+        size_t i = ii;
+
+        while(table[i].state != HM_STATE_EMPTY) {
+            i = pow2mod(i + 1, table.len); // TODO: quad probe?
+            if(i == ii) {
+                return false;
+            }
+        }
+
+        ::construct(&table[i].kv.key, 1, ::move(kv.key));
+        ::construct(&table[i].kv.value, 1, ::move(kv.value));
+        table[i].state = HM_STATE_OCCUPIED;
+        len += 1;
+        return true;
+    }
+};
+
+template <typename K, typename V, typename Hasher>
+struct AHashMap : MHashMap<K, V, Hasher> {
+    using Base = MHashMap<K, V, Hasher>;
+    using Kv = KvPair<K, V>;
+
+    AHashMap(Allocator* allocator = &heap_alloc) : Base{allocator} {}
+    explicit AHashMap(size_t bucket_size, Allocator* allocator = &heap_alloc) : Base{allocator} {
+        this->reserve(bucket_size);
+    }
+    AHashMap(std::initializer_list<Kv> xs, Allocator* allocator = &heap_alloc) : Base{allocator} {
+        this->extend(xs);
+    }
+    AHashMap(const AHashMap&) = delete;
+    AHashMap& operator=(const AHashMap&) = delete;
+
+    AHashMap(AHashMap&& o) : Base{o.allocator ? o.allocator : &heap_alloc} {
+        this->table = o.table;
+        this->len = o.len;
+        this->n_tombstones = o.n_tombstones;
+        this->hasher = o.hasher;
+        this->allocator = o.allocator;
+        o.table.data = nullptr;
+        o.table.len = 0;
+        o.len = 0;
+        o.n_tombstones = 0;
+        o.allocator = nullptr;
+    }
+    AHashMap(Base&& o) : Base{o.allocator ? o.allocator : &heap_alloc} {
+        this->table = o.table;
+        this->len = o.len;
+        this->n_tombstones = o.n_tombstones;
+        this->hasher = o.hasher;
+        this->allocator = o.allocator;
+        o.table.data = nullptr;
+        o.table.len = 0;
+        o.len = 0;
+        o.n_tombstones = 0;
+        o.allocator = nullptr;
+    }
+
+    AHashMap& operator=(AHashMap&& o) {
+        if(this != &o) {
+            this->destroy();
+            this->table = o.table;
+            this->len = o.len;
+            this->n_tombstones = o.n_tombstones;
+            this->hasher = o.hasher;
+            this->allocator = o.allocator;
+            o.table.data = nullptr;
+            o.table.len = 0;
+            o.len = 0;
+            o.n_tombstones = 0;
+            o.allocator = nullptr;
+        }
+        return *this;
+    }
+    AHashMap& operator=(Base&& o) {
+        this->destroy();
+        this->table = o.table;
+        this->len = o.len;
+        this->n_tombstones = o.n_tombstones;
+        this->hasher = o.hasher;
+        this->allocator = o.allocator;
+        o.table.data = nullptr;
+        o.table.len = 0;
+        o.len = 0;
+        o.n_tombstones = 0;
+        o.allocator = nullptr;
+        return *this;
+    }
+
+    ~AHashMap() {
+        this->destroy();
+    }
+
+    Base release() {
+        Base out{this->allocator ? this->allocator : &heap_alloc};
+        out.table = this->table;
+        out.len = this->len;
+        out.n_tombstones = this->n_tombstones;
+        out.hasher = this->hasher;
+        out.allocator = this->allocator;
+
+        this->allocator = nullptr;
+        this->table.data = nullptr;
+        this->table.len = 0;
+        this->len = 0;
+        this->n_tombstones = 0;
+        return out;
+    }
+};
+
+#endif /* CXB_HASHMAP_H */
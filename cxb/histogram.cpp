@@ -0,0 +1,188 @@
+#include "histogram.h"
+#include "format.h"
+
+#include <new>
+
+thread_local u32 _histogram_thread_slot = UINT32_MAX;
+INTERNAL Atomic<u32> histogram_next_slot = 0;
+
+u64 histogram_bucket_low(u32 bucket) {
+    if(bucket < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    u32 shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    u64 m = bucket % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+    return m << shift;
+}
+
+u64 histogram_bucket_high(u32 bucket) {
+    if(bucket < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    u32 shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    return histogram_bucket_low(bucket) + ((1ull << shift) - 1);
+}
+
+void histogram_reset(Histogram* h) {
+    for(u32 i = 0; i < HISTOGRAM_N_BUCKETS; ++i) h->counts[i].store(0, memory_order_relaxed);
+    h->total.store(0, memory_order_relaxed);
+    h->sum.store(0, memory_order_relaxed);
+    h->min.store(UINT64_MAX, memory_order_relaxed);
+    h->max.store(0, memory_order_relaxed);
+}
+
+void histogram_merge(Histogram* dst, const Histogram* src) {
+    for(u32 i = 0; i < HISTOGRAM_N_BUCKETS; ++i) {
+        u64 c = src->counts[i].load(memory_order_relaxed);
+        if(c) dst->counts[i].store(dst->counts[i].load(memory_order_relaxed) + c, memory_order_relaxed);
+    }
+    dst->total.store(dst->total.load(memory_order_relaxed) + src->total.load(memory_order_relaxed),
+                     memory_order_relaxed);
+    dst->sum.store(dst->sum.load(memory_order_relaxed) + src->sum.load(memory_order_relaxed), memory_order_relaxed);
+    dst->min.store(min(dst->min.load(memory_order_relaxed), src->min.load(memory_order_relaxed)),
+                   memory_order_relaxed);
+    dst->max.store(max(dst->max.load(memory_order_relaxed), src->max.load(memory_order_relaxed)),
+                   memory_order_relaxed);
+}
+
+u64 histogram_percentile(const Histogram* h, f64 q) {
+    u64 total = h->total.load(memory_order_relaxed);
+    if(total == 0) return 0;
+
+    // rank of the value, 1-based: the smallest value with at least q * total values at or below it
+    f64 q_total = clamp(q, 0.0, 1.0) * (f64) total;
+    u64 rank = (u64) q_total;
+    // ceil, except for the rounding error of q * total, e.g. 0.9 * 100000 is 90000.00000000001
+    if((f64) rank < q_total * (1 - 1e-12)) rank += 1;
+    rank = clamp(rank, (u64) 1, total);
+    u64 seen = 0;
+    for(u32 i = 0; i < HISTOGRAM_N_BUCKETS; ++i) {
+        seen += h->counts[i].load(memory_order_relaxed);
+        if(seen >= rank) {
+            u64 value = histogram_bucket_high(i);
+            return clamp(value, h->min.load(memory_order_relaxed), h->max.load(memory_order_relaxed));
+        }
+    }
+    // counts and total were read while recording, the total may be ahead
+    return h->max.load(memory_order_relaxed);
+}
+
+f64 histogram_mean(const Histogram* h) {
+    u64 total = h->total.load(memory_order_relaxed);
+    return total ? (f64) h->sum.load(memory_order_relaxed) / (f64) total : 0;
+}
+
+String8 histogram_format(Arena* a, const Histogram* h) {
+    u64 total = h->total.load(memory_order_relaxed);
+    return format(a,
+                  "n={} min={} p50={} p90={} p99={} p999={} max={} mean={.1}",
+                  total,
+                  total ? h->min.load(memory_order_relaxed) : 0,
+                  histogram_percentile(h, 0.5),
+                  histogram_percentile(h, 0.9),
+                  histogram_percentile(h, 0.99),
+                  histogram_percentile(h, 0.999),
+                  h->max.load(memory_order_relaxed),
+                  histogram_mean(h));
+}
+
+void histogram_print(FILE* f, String8 name, const Histogram* h) {
+    AArenaTmp tmp = begin_scratch();
+    print(f, tmp.arena, "{}: {}\n", name, histogram_format(tmp.arena, h));
+}
+
+/* SECTION: sharded */
+Histogram* _sharded_histogram_shard(ShardedHistogram* sh) {
+    if(_histogram_thread_slot == UINT32_MAX) {
+        _histogram_thread_slot = histogram_next_slot.fetch_add(1) % HISTOGRAM_MAX_SHARDS;
+    }
+    Atomic<Histogram*>& shard = sh->shards[_histogram_thread_slot];
+    Histogram* h = shard.load(memory_order_acquire);
+    if(h) return h;
+
+    // NOTE: not on an arena, shards are freed individually by sharded_histogram_destroy
+    void* mem = calloc(1, sizeof(Histogram));
+    ASSERT(mem, "could not allocate a histogram shard");
+    Histogram* new_h = new(mem) Histogram{};
+    if(!shard.compare_exchange_strong(h, new_h)) {
+        // another thread sharing the slot won
+        new_h->~Histogram();
+        free(new_h);
+        return h;
+    }
+    return new_h;
+}
+
+void sharded_histogram_merge(Histogram* dst, const ShardedHistogram* sh) {
+    for(u32 i = 0; i < HISTOGRAM_MAX_SHARDS; ++i) {
+        const Histogram* h = sh->shards[i].load(memory_order_acquire);
+        if(h) histogram_merge(dst, h);
+    }
+}
+
+void sharded_histogram_destroy(ShardedHistogram* sh) {
+    for(u32 i = 0; i < HISTOGRAM_MAX_SHARDS; ++i) {
+        Histogram* h = sh->shards[i].exchange(nullptr);
+        if(h) {
+            h->~Histogram();
+            free(h);
+        }
+    }
+}
+
+/* SECTION: serialization */
+void serialize_value(Arena* a, String8& dst, const Histogram& h) {
+    u32 n_nonzero = 0;
+    for(u32 i = 0; i < HISTOGRAM_N_BUCKETS; ++i) n_nonzero += h.counts[i].load(memory_order_relaxed) != 0;
+
+    serial_write_varint(a, dst, HISTOGRAM_PRECISION_BITS);
+    serial_write_varint(a, dst, h.sum.load(memory_order_relaxed));
+    serial_write_varint(a, dst, h.min.load(memory_order_relaxed));
+    serial_write_varint(a, dst, h.max.load(memory_order_relaxed));
+    serial_write_varint(a, dst, n_nonzero);
+    // (bucket - previous bucket, count) pairs
+    u32 prev = 0;
+    for(u32 i = 0; i < HISTOGRAM_N_BUCKETS; ++i) {
+        u64 c = h.counts[i].load(memory_order_relaxed);
+        if(!c) continue;
+        serial_write_varint(a, dst, i - prev);
+        serial_write_varint(a, dst, c);
+        prev = i;
+    }
+}
+
+void deserialize_value(Arena* a, SerialReader& r, Histogram& h) {
+    (void) a;
+    histogram_reset(&h);
+    u64 precision_bits = serial_read_varint(r);
+    if(precision_bits != HISTOGRAM_PRECISION_BITS) {
+        // NOTE: written with a different bucket layout
+        r.failed = true;
+        return;
+    }
+    u64 sum = serial_read_varint(r);
+    u64 lo = serial_read_varint(r);
+    u64 hi = serial_read_varint(r);
+    size_t n_nonzero = serial_read_len(r, 2);
+
+    u64 total = 0;
+    u64 bucket = 0;
+    for(size_t i = 0; i < n_nonzero && !r.failed; ++i) {
+        bucket += serial_read_varint(r);
+        u64 c = serial_read_varint(r);
+        if(bucket >= HISTOGRAM_N_BUCKETS) {
+            r.failed = true;
+            break;
+        }
+        h.counts[bucket].store(c, memory_order_relaxed);
+        total += c;
+    }
+    if(r.failed) {
+        histogram_reset(&h);
+        return;
+    }
+    h.total.store(total, memory_order_relaxed);
+    h.sum.store(sum, memory_order_relaxed);
+    h.min.store(lo, memory_order_relaxed);
+    h.max.store(hi, memory_order_relaxed);
+}
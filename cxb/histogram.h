@@ -0,0 +1,107 @@
+/*
+# cxb/histogram: high dynamic range histograms
+
+* `Histogram` counts u64 values (e.g. latencies in ns) in log-linear buckets: values below 2^HISTOGRAM_PRECISION_BITS
+  are exact, larger values fall in one of 2^HISTOGRAM_PRECISION_BITS buckets per power of two, i.e. a relative error
+  below 2^-HISTOGRAM_PRECISION_BITS (< 1%) across the whole u64 range with fixed memory
+* `histogram_record` is O(1): a count leading zeros, a shift and an increment
+* `histogram_percentile(h, 0.99)` returns the highest value of the bucket holding the percentile (clamped to the max
+  recorded value)
+* `ShardedHistogram` records from many threads without locks: each thread records into its own shard, which is
+  allocated on the thread's first record. `sharded_histogram_merge` sums the shards into a `Histogram`, it may run
+  while other threads record
+* histograms serialize (cxb/serialize.h) sparsely: only non-empty buckets are written, as varints
+
+`Histogram` is a single-writer type, counts are relaxed atomics such that it can be read (merged, serialized) while
+its owner records.
+*/
+#ifndef CXB_HISTOGRAM_H
+#define CXB_HISTOGRAM_H
+
+#include "atomic.h"
+#include "string8.h"
+#include "serialize.h"
+
+constexpr u32 HISTOGRAM_PRECISION_BITS = 7;
+constexpr u32 HISTOGRAM_SUB_BUCKETS = 1u << HISTOGRAM_PRECISION_BITS;
+constexpr u32 HISTOGRAM_N_BUCKETS = (64 - HISTOGRAM_PRECISION_BITS + 1) * HISTOGRAM_SUB_BUCKETS;
+// threads beyond this share shards, with atomic increments it stays exact but contended
+constexpr u32 HISTOGRAM_MAX_SHARDS = 64;
+
+struct Histogram {
+    Atomic<u64> counts[HISTOGRAM_N_BUCKETS];
+    Atomic<u64> total;
+    Atomic<u64> sum; // wraps on overflow, see histogram_mean
+    Atomic<u64> min = UINT64_MAX;
+    Atomic<u64> max;
+};
+
+struct ShardedHistogram {
+    Atomic<Histogram*> shards[HISTOGRAM_MAX_SHARDS];
+};
+
+CXB_INLINE u32 histogram_bucket(u64 value) {
+    u32 msb = 63 - (u32) __builtin_clzll(value | 1);
+    if(msb < HISTOGRAM_PRECISION_BITS) {
+        return (u32) value;
+    }
+    u32 shift = msb - HISTOGRAM_PRECISION_BITS;
+    // (value >> shift) is in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (u32) (value >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+// lowest and highest value counted by a bucket
+u64 histogram_bucket_low(u32 bucket);
+u64 histogram_bucket_high(u32 bucket);
+
+CXB_INLINE void histogram_record(Histogram* h, u64 value, u64 count = 1) {
+    // NOTE: single writer, a load and a store instead of a locked read-modify-write
+    Atomic<u64>& c = h->counts[histogram_bucket(value)];
+    c.store(c.load(memory_order_relaxed) + count, memory_order_relaxed);
+    h->total.store(h->total.load(memory_order_relaxed) + count, memory_order_relaxed);
+    h->sum.store(h->sum.load(memory_order_relaxed) + value * count, memory_order_relaxed);
+    if(UNLIKELY(value < h->min.load(memory_order_relaxed))) h->min.store(value, memory_order_relaxed);
+    if(UNLIKELY(value > h->max.load(memory_order_relaxed))) h->max.store(value, memory_order_relaxed);
+}
+
+void histogram_reset(Histogram* h);
+void histogram_merge(Histogram* dst, const Histogram* src);
+u64 histogram_percentile(const Histogram* h, f64 q);
+f64 histogram_mean(const Histogram* h);
+// "n=... min=... p50=... p99=... p999=... max=... mean=..."
+String8 histogram_format(Arena* a, const Histogram* h);
+void histogram_print(FILE* f, String8 name, const Histogram* h);
+
+/* SECTION: sharded */
+Histogram* _sharded_histogram_shard(ShardedHistogram* sh);
+extern thread_local u32 _histogram_thread_slot; // UINT32_MAX until the thread's first record
+
+CXB_INLINE void sharded_histogram_record(ShardedHistogram* sh, u64 value, u64 count = 1) {
+    u32 slot = _histogram_thread_slot;
+    Histogram* h = LIKELY(slot != UINT32_MAX) ? sh->shards[slot].load(memory_order_acquire) : nullptr;
+    if(UNLIKELY(!h)) {
+        h = _sharded_histogram_shard(sh);
+    }
+    // NOTE: a shard can be shared by more than HISTOGRAM_MAX_SHARDS threads, i.e. increments must be atomic
+    h->counts[histogram_bucket(value)].fetch_add(count, memory_order_relaxed);
+    h->total.fetch_add(count, memory_order_relaxed);
+    h->sum.fetch_add(value * count, memory_order_relaxed);
+    u64 lo = h->min.load(memory_order_relaxed);
+    while(UNLIKELY(value < lo) && !h->min.compare_exchange_weak(lo, value)) {
+    }
+    u64 hi = h->max.load(memory_order_relaxed);
+    while(UNLIKELY(value > hi) && !h->max.compare_exchange_weak(hi, value)) {
+    }
+}
+
+void sharded_histogram_merge(Histogram* dst, const ShardedHistogram* sh);
+// frees the shards, no thread may record concurrently
+void sharded_histogram_destroy(ShardedHistogram* sh);
+
+/* SECTION: serialization
+NOTE: `Histogram` is not movable, use deserialize_value with a SerialReader instead of deserialize<Histogram>
+*/
+void serialize_value(Arena* a, String8& dst, const Histogram& h);
+void deserialize_value(Arena* a, SerialReader& r, Histogram& h);
+
+#endif /* CXB_HISTOGRAM_H */
@@ -0,0 +1,1620 @@
+#include "io.h"
+#include "atomic.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(CXB_PLATFORM_LINUX)
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+INTERNAL CXB_INLINE size_t _round_up_to(size_t x, size_t align) {
+    return (x + align - 1) & ~(align - 1);
+}
+
+template <typename T>
+INTERNAL CXB_INLINE Result<T, FileErr> _file_err(FileErr error, String8 reason) {
+    return Result<T, FileErr>{.value = {}, .error = error, .reason = reason};
+}
+
+template <typename T>
+INTERNAL CXB_INLINE Result<T, FileErr> _file_ok(T value) {
+    return Result<T, FileErr>{.value = value, .error = FileErr::Success, .reason = {}};
+}
+
+// * SECTION: memory-mapped files
+INTERNAL bool _memfile_page_range(const MemFile& file, size_t offset, size_t len, char** addr, size_t* n) {
+    if(offset > file.data.len) {
+        return false;
+    }
+    len = min(len, file.data.len - offset);
+
+    size_t page = os_page_size();
+    size_t begin = offset & ~(page - 1);
+    size_t end = _round_up_to(offset + len, page);
+    *addr = file.data.data + begin;
+    *n = end - begin;
+    return true;
+}
+
+INTERNAL Result<MemFile, FileErr> _memfile_open_err(int fd, FileErr error, String8 reason) {
+    if(fd >= 0) {
+        close(fd);
+    }
+    Result<MemFile, FileErr> result = _file_err<MemFile>(error, reason);
+    result.value.fd = -1;
+    return result;
+}
+
+INTERNAL bool _memfile_apply_advice(char* addr, size_t n, u32 advice) {
+    if(advice == MEMFILE_ADVICE_NORMAL) {
+        return madvise(addr, n, MADV_NORMAL) == 0;
+    }
+    if((advice & MEMFILE_ADVICE_SEQUENTIAL) && madvise(addr, n, MADV_SEQUENTIAL) != 0) {
+        return false;
+    }
+    if((advice & MEMFILE_ADVICE_RANDOM) && madvise(addr, n, MADV_RANDOM) != 0) {
+        return false;
+    }
+    if((advice & MEMFILE_ADVICE_WILLNEED) && madvise(addr, n, MADV_WILLNEED) != 0) {
+        return false;
+    }
+#if defined(MADV_HUGEPAGE)
+    if((advice & MEMFILE_ADVICE_HUGEPAGE) && madvise(addr, n, MADV_HUGEPAGE) != 0) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+Result<MemFile, FileErr> memfile_open(Arena* arena, String8 filepath, MemFileParams params) {
+    int flags = params.mode == MEMFILE_MODE_READ ? O_RDONLY : O_RDWR;
+    if(params.mode == MEMFILE_MODE_CREATE) {
+        flags |= O_CREAT;
+    }
+
+    AArenaTmp tmp = begin_scratch();
+    int fd = open(filepath.c_str_maybe_copy(tmp.arena), flags | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        return _memfile_open_err(fd, FileErr::CouldNotOpen, S8_LIT("open failed"));
+    }
+
+    struct stat sb;
+    if(fstat(fd, &sb) != 0) {
+        return _memfile_open_err(fd, FileErr::CouldNotStat, S8_LIT("fstat failed"));
+    }
+    if(!S_ISREG(sb.st_mode)) {
+        return _memfile_open_err(fd, FileErr::IsNotFile, S8_LIT("not a regular file"));
+    }
+
+    size_t size = (size_t) sb.st_size;
+    if(params.mode == MEMFILE_MODE_CREATE && params.size > size) {
+        if(ftruncate(fd, (off_t) params.size) != 0) {
+            return _memfile_open_err(fd, FileErr::CouldNotResize, S8_LIT("ftruncate failed"));
+        }
+        size = params.size;
+    }
+
+    size_t page = os_page_size();
+    size_t reserved = _round_up_to(size, page);
+    if(params.mode != MEMFILE_MODE_READ) {
+        reserved = max(reserved, _round_up_to(params.reserve_bytes, page));
+    }
+
+    char* data = nullptr;
+    if(reserved > 0) {
+        int prot = params.mode == MEMFILE_MODE_READ ? PROT_READ : PROT_READ | PROT_WRITE;
+        int map_flags = params.mode == MEMFILE_MODE_READ ? MAP_PRIVATE : MAP_SHARED;
+#if defined(MAP_POPULATE)
+        if(params.populate) {
+            map_flags |= MAP_POPULATE;
+        }
+#endif
+        // NOTE: mapping past EOF is allowed, those pages become accessible once the file is grown
+        void* addr = mmap(nullptr, reserved, prot, map_flags, fd, 0);
+        if(addr == MAP_FAILED) {
+            return _memfile_open_err(fd, FileErr::CouldNotMap, S8_LIT("mmap failed"));
+        }
+        data = (char*) addr;
+
+        if(params.advice != MEMFILE_ADVICE_NORMAL && !_memfile_apply_advice(data, reserved, params.advice)) {
+            munmap(data, reserved);
+            return _memfile_open_err(fd, FileErr::CouldNotAdvise, S8_LIT("madvise failed"));
+        }
+    }
+
+    Result<MemFile, FileErr> result = {};
+    result.value.data = Array<char>{data, size};
+    result.value.filepath = arena_push_string8(arena, filepath);
+    result.value.fd = fd;
+    result.value.mode = params.mode;
+    result.value.reserved = reserved;
+    return result;
+}
+
+void memfile_close(MemFile& file) {
+    if(file.data.data) {
+        munmap(file.data.data, file.reserved);
+    }
+    if(file.fd >= 0) {
+        close(file.fd);
+    }
+    file.data.data = nullptr;
+    file.data.len = 0;
+    file.fd = -1;
+    file.reserved = 0;
+}
+
+Result<size_t, FileErr> memfile_resize(MemFile& file, size_t new_size) {
+    if(file.mode == MEMFILE_MODE_READ) {
+        return _file_err<size_t>(FileErr::ReadOnly, S8_LIT("file is mapped read-only"));
+    }
+    if(ftruncate(file.fd, (off_t) new_size) != 0) {
+        return _file_err<size_t>(FileErr::CouldNotResize, S8_LIT("ftruncate failed"));
+    }
+
+    size_t needed = _round_up_to(new_size, os_page_size());
+    if(needed > file.reserved) {
+        size_t new_reserved = max(needed, file.reserved * 2);
+        void* addr = MAP_FAILED;
+        if(file.data.data == nullptr) {
+            addr = mmap(nullptr, new_reserved, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+        } else {
+#if defined(CXB_PLATFORM_LINUX)
+            addr = mremap(file.data.data, file.reserved, new_reserved, MREMAP_MAYMOVE);
+#else
+            addr = mmap(nullptr, new_reserved, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+            if(addr != MAP_FAILED) {
+                munmap(file.data.data, file.reserved);
+            }
+#endif
+        }
+        if(addr == MAP_FAILED) {
+            // the file keeps the size of the mapping
+            if(ftruncate(file.fd, (off_t) file.data.len) != 0) {
+                return _file_err<size_t>(FileErr::CouldNotResize, S8_LIT("could not grow mapping nor undo ftruncate"));
+            }
+            return _file_err<size_t>(FileErr::CouldNotMap, S8_LIT("could not grow mapping"));
+        }
+        file.data.data = (char*) addr;
+        file.reserved = new_reserved;
+    }
+
+    file.data.len = new_size;
+    return _file_ok(new_size);
+}
+
+Result<size_t, FileErr> memfile_advise(MemFile& file, u32 advice, size_t offset, size_t len) {
+    char* addr = nullptr;
+    size_t n = 0;
+    if(!_memfile_page_range(file, offset, len, &addr, &n)) {
+        return _file_err<size_t>(FileErr::OutOfRange, S8_LIT("offset out of range"));
+    }
+    if(n > 0 && !_memfile_apply_advice(addr, n, advice)) {
+        return _file_err<size_t>(FileErr::CouldNotAdvise, S8_LIT("madvise failed"));
+    }
+    return _file_ok(n);
+}
+
+Result<size_t, FileErr> memfile_prefetch(MemFile& file, size_t offset, size_t len) {
+    return memfile_advise(file, MEMFILE_ADVICE_WILLNEED, offset, len);
+}
+
+Result<size_t, FileErr> memfile_evict(MemFile& file, size_t offset, size_t len) {
+    char* addr = nullptr;
+    size_t n = 0;
+    if(!_memfile_page_range(file, offset, len, &addr, &n)) {
+        return _file_err<size_t>(FileErr::OutOfRange, S8_LIT("offset out of range"));
+    }
+    if(n == 0) {
+        return _file_ok(n);
+    }
+
+    // NOTE: dirty pages of a shared mapping are kept in the page cache, only the mapping is dropped
+    if(madvise(addr, n, MADV_DONTNEED) != 0) {
+        return _file_err<size_t>(FileErr::CouldNotAdvise, S8_LIT("madvise failed"));
+    }
+#if defined(POSIX_FADV_DONTNEED)
+    // drop clean pages from the page cache too, otherwise the next fault is a minor fault
+    if(posix_fadvise(file.fd, (off_t) (addr - file.data.data), (off_t) n, POSIX_FADV_DONTNEED) != 0) {
+        return _file_err<size_t>(FileErr::CouldNotAdvise, S8_LIT("posix_fadvise failed"));
+    }
+#endif
+    return _file_ok(n);
+}
+
+Result<size_t, FileErr> memfile_sync(MemFile& file, bool async, size_t offset, size_t len) {
+    char* addr = nullptr;
+    size_t n = 0;
+    if(!_memfile_page_range(file, offset, len, &addr, &n)) {
+        return _file_err<size_t>(FileErr::OutOfRange, S8_LIT("offset out of range"));
+    }
+    if(n > 0 && msync(addr, n, async ? MS_ASYNC : MS_SYNC) != 0) {
+        return _file_err<size_t>(FileErr::CouldNotSync, S8_LIT("msync failed"));
+    }
+    return _file_ok(n);
+}
+
+// * SECTION: async I/O
+struct AioUring {
+    int ring_fd;
+    u32* sq_head;
+    u32* sq_tail;
+    u32* sq_mask;
+    u32* sq_array;
+    u32* cq_head;
+    u32* cq_tail;
+    u32* cq_mask;
+    void* sqes;
+    void* cqes;
+
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+
+    u32 n_unsubmitted; // in the SQ ring, not yet consumed by the kernel
+};
+
+struct AioThreads {
+    pthread_t* threads;
+    u32 n_threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t has_work;
+    pthread_cond_t has_done;
+    bool stop;
+
+    // ring buffers of capacity queue_depth
+    AioOp* ops;
+    u32 ops_head;
+    u32 ops_len;
+    AioCompletion* done;
+    u32 done_head;
+    u32 done_len;
+
+    Array<int> files;
+};
+
+struct AsyncIo {
+    AioBackend backend;
+    u32 queue_depth;
+    u32 n_pending; // submitted, not yet reaped
+    int notify_fd;
+    Arena* arena;
+
+    AioUring uring;
+    AioThreads threads;
+};
+
+INTERNAL void _aio_notify(int fd) {
+    if(fd < 0) return;
+    u64 one = 1;
+    ssize_t n = write(fd, &one, sizeof(one));
+    (void) n;
+}
+
+// ** SECTION: io_uring backend
+#if defined(CXB_PLATFORM_LINUX)
+INTERNAL int _aio_uring_enter(int ring_fd, u32 to_submit, u32 min_complete, u32 flags) {
+    int ret = (int) syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0);
+    return ret < 0 ? -errno : ret;
+}
+
+INTERNAL int _aio_uring_register(int ring_fd, u32 opcode, const void* arg, u32 n_args) {
+    int ret = (int) syscall(__NR_io_uring_register, ring_fd, opcode, arg, n_args);
+    return ret < 0 ? -errno : ret;
+}
+
+INTERNAL void _aio_uring_destroy(AioUring& r) {
+    if(r.sqes) munmap(r.sqes, r.sqes_size);
+    if(r.cq_ring && r.cq_ring != r.sq_ring) munmap(r.cq_ring, r.cq_ring_size);
+    if(r.sq_ring) munmap(r.sq_ring, r.sq_ring_size);
+    if(r.ring_fd >= 0) close(r.ring_fd);
+    r = {};
+    r.ring_fd = -1;
+}
+
+INTERNAL bool _aio_uring_supports_ops(int ring_fd) {
+    AArenaTmp tmp = begin_scratch();
+    size_t n_ops = 256;
+    size_t probe_size = sizeof(io_uring_probe) + n_ops * sizeof(io_uring_probe_op);
+    io_uring_probe* probe = (io_uring_probe*) arena_push_bytes(tmp.arena, probe_size, alignof(io_uring_probe));
+    memset(probe, 0, probe_size);
+    if(_aio_uring_register(ring_fd, IORING_REGISTER_PROBE, probe, n_ops) < 0) {
+        return false;
+    }
+
+    u8 required[] = {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED};
+    for(u8 op : required) {
+        if(op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+INTERNAL bool _aio_uring_init(AioUring& r, u32 queue_depth, u32* out_depth) {
+    r = {};
+    r.ring_fd = -1;
+
+    io_uring_params p = {};
+    int ring_fd = (int) syscall(__NR_io_uring_setup, queue_depth, &p);
+    if(ring_fd < 0) {
+        return false;
+    }
+    r.ring_fd = ring_fd;
+
+    if(!(p.features & IORING_FEAT_NODROP) || !_aio_uring_supports_ops(ring_fd)) {
+        _aio_uring_destroy(r);
+        return false;
+    }
+
+    r.sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(u32);
+    r.cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if(single_mmap) {
+        r.sq_ring_size = max(r.sq_ring_size, r.cq_ring_size);
+        r.cq_ring_size = r.sq_ring_size;
+    }
+
+    void* sq_ring =
+        mmap(nullptr, r.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if(sq_ring == MAP_FAILED) {
+        _aio_uring_destroy(r);
+        return false;
+    }
+    r.sq_ring = sq_ring;
+
+    void* cq_ring = sq_ring;
+    if(!single_mmap) {
+        cq_ring = mmap(
+            nullptr, r.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if(cq_ring == MAP_FAILED) {
+            _aio_uring_destroy(r);
+            return false;
+        }
+    }
+    r.cq_ring = cq_ring;
+
+    r.sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes =
+        mmap(nullptr, r.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if(sqes == MAP_FAILED) {
+        _aio_uring_destroy(r);
+        return false;
+    }
+    r.sqes = sqes;
+
+    char* sq = (char*) sq_ring;
+    char* cq = (char*) cq_ring;
+    r.sq_head = (u32*) (sq + p.sq_off.head);
+    r.sq_tail = (u32*) (sq + p.sq_off.tail);
+    r.sq_mask = (u32*) (sq + p.sq_off.ring_mask);
+    r.sq_array = (u32*) (sq + p.sq_off.array);
+    r.cq_head = (u32*) (cq + p.cq_off.head);
+    r.cq_tail = (u32*) (cq + p.cq_off.tail);
+    r.cq_mask = (u32*) (cq + p.cq_off.ring_mask);
+    r.cqes = cq + p.cq_off.cqes;
+
+    // NOTE: the CQ ring is at least as large as the SQ ring, bounding in-flight ops by sq_entries avoids overflow
+    *out_depth = p.sq_entries;
+    return true;
+}
+
+INTERNAL u32 _aio_uring_reap(AsyncIo* aio, AioCompletion* out, u32 n) {
+    AioUring& r = aio->uring;
+    u32 head = *r.cq_head;
+    u32 tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+    u32 mask = *r.cq_mask;
+    u32 got = 0;
+    while(head != tail && got < n) {
+        io_uring_cqe* cqe = (io_uring_cqe*) r.cqes + (head & mask);
+        out[got++] = AioCompletion{.user_data = cqe->user_data, .result = cqe->res};
+        head++;
+    }
+    __atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+    aio->n_pending -= got;
+    return got;
+}
+
+INTERNAL void _aio_uring_push(AsyncIo* aio, Array<AioOp> ops) {
+    AioUring& r = aio->uring;
+    u32 tail = *r.sq_tail;
+    u32 mask = *r.sq_mask;
+    for(const AioOp& op : ops) {
+        u32 idx = tail & mask;
+        io_uring_sqe* sqe = (io_uring_sqe*) r.sqes + idx;
+        memset(sqe, 0, sizeof(*sqe));
+
+        bool fixed_buf = op.buf_index >= 0;
+        if(op.kind == AIO_OP_READ) {
+            sqe->opcode = fixed_buf ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        } else {
+            sqe->opcode = fixed_buf ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        }
+        sqe->flags = op.fixed_file ? IOSQE_FIXED_FILE : 0;
+        sqe->fd = op.fd;
+        sqe->off = op.offset;
+        sqe->addr = (u64) (uintptr_t) op.buf.data;
+        sqe->len = (u32) op.buf.len;
+        sqe->buf_index = fixed_buf ? (u16) op.buf_index : 0;
+        sqe->user_data = op.user_data;
+
+        r.sq_array[idx] = idx;
+        tail++;
+    }
+    __atomic_store_n(r.sq_tail, tail, __ATOMIC_RELEASE);
+    r.n_unsubmitted += (u32) ops.len;
+}
+
+// returns < 0 on error (-errno)
+INTERNAL int _aio_uring_flush(AsyncIo* aio, u32 min_complete) {
+    AioUring& r = aio->uring;
+    u32 flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int ret = 0;
+    do {
+        ret = _aio_uring_enter(r.ring_fd, r.n_unsubmitted, min_complete, flags);
+    } while(ret == -EINTR);
+    if(ret > 0) {
+        r.n_unsubmitted -= min((u32) ret, r.n_unsubmitted);
+    }
+    return ret;
+}
+#endif
+
+// ** SECTION: thread pool backend
+INTERNAL void* _aio_worker(void* arg) {
+    AsyncIo* aio = (AsyncIo*) arg;
+    AioThreads& t = aio->threads;
+
+    pthread_mutex_lock(&t.mutex);
+    for(;;) {
+        while(t.ops_len == 0 && !t.stop) {
+            pthread_cond_wait(&t.has_work, &t.mutex);
+        }
+        if(t.ops_len == 0 && t.stop) {
+            break;
+        }
+        AioOp op = t.ops[t.ops_head];
+        t.ops_head = (t.ops_head + 1) % aio->queue_depth;
+        t.ops_len -= 1;
+        int fd = op.fixed_file ? t.files[op.fd] : op.fd;
+        pthread_mutex_unlock(&t.mutex);
+
+        ssize_t n = op.kind == AIO_OP_READ ? pread(fd, op.buf.data, op.buf.len, (off_t) op.offset)
+                                           : pwrite(fd, op.buf.data, op.buf.len, (off_t) op.offset);
+        i64 result = n < 0 ? -(i64) errno : (i64) n;
+
+        pthread_mutex_lock(&t.mutex);
+        u32 idx = (t.done_head + t.done_len) % aio->queue_depth;
+        t.done[idx] = AioCompletion{.user_data = op.user_data, .result = result};
+        t.done_len += 1;
+        pthread_cond_signal(&t.has_done);
+        _aio_notify(aio->notify_fd);
+    }
+    pthread_mutex_unlock(&t.mutex);
+    return nullptr;
+}
+
+INTERNAL void _aio_threads_destroy(AsyncIo* aio) {
+    AioThreads& t = aio->threads;
+    pthread_mutex_lock(&t.mutex);
+    t.stop = true;
+    pthread_cond_broadcast(&t.has_work);
+    pthread_mutex_unlock(&t.mutex);
+    for(u32 i = 0; i < t.n_threads; ++i) {
+        pthread_join(t.threads[i], nullptr);
+    }
+    pthread_cond_destroy(&t.has_done);
+    pthread_cond_destroy(&t.has_work);
+    pthread_mutex_destroy(&t.mutex);
+    t.n_threads = 0;
+}
+
+INTERNAL bool _aio_threads_init(AsyncIo* aio, Arena* arena, u32 n_threads) {
+    AioThreads& t = aio->threads;
+    t = {};
+    t.ops = arena_push<AioOp>(arena, aio->queue_depth);
+    t.done = arena_push<AioCompletion>(arena, aio->queue_depth);
+    t.threads = arena_push<pthread_t>(arena, max(n_threads, 1u));
+    pthread_mutex_init(&t.mutex, nullptr);
+    pthread_cond_init(&t.has_work, nullptr);
+    pthread_cond_init(&t.has_done, nullptr);
+
+    for(u32 i = 0; i < max(n_threads, 1u); ++i) {
+        if(pthread_create(&t.threads[i], nullptr, _aio_worker, aio) != 0) {
+            _aio_threads_destroy(aio);
+            return false;
+        }
+        t.n_threads += 1;
+    }
+    return true;
+}
+
+// ** SECTION: AsyncIo API
+Result<AsyncIo*, FileErr> aio_make(Arena* arena, AioParams params) {
+    AsyncIo* aio = arena_push<AsyncIo>(arena);
+    aio->queue_depth = max(params.queue_depth, 1u);
+    aio->notify_fd = -1;
+    aio->arena = arena;
+    aio->uring.ring_fd = -1;
+
+    if(params.notify_fd) {
+#if defined(CXB_PLATFORM_LINUX)
+        aio->notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#endif
+        if(aio->notify_fd < 0) {
+            return _file_err<AsyncIo*>(FileErr::CouldNotOpen, S8_LIT("could not create notification fd"));
+        }
+    }
+
+#if defined(CXB_PLATFORM_LINUX)
+    if(!params.force_fallback && _aio_uring_init(aio->uring, aio->queue_depth, &aio->queue_depth)) {
+        aio->backend = AIO_BACKEND_IO_URING;
+        if(aio->notify_fd >= 0 &&
+           _aio_uring_register(aio->uring.ring_fd, IORING_REGISTER_EVENTFD, &aio->notify_fd, 1) < 0) {
+            _aio_uring_destroy(aio->uring);
+            close(aio->notify_fd);
+            return _file_err<AsyncIo*>(FileErr::CouldNotRegister, S8_LIT("could not register eventfd"));
+        }
+        return _file_ok(aio);
+    }
+#endif
+
+    aio->backend = AIO_BACKEND_THREADS;
+    if(!_aio_threads_init(aio, arena, params.n_threads)) {
+        if(aio->notify_fd >= 0) close(aio->notify_fd);
+        return _file_err<AsyncIo*>(FileErr::CouldNotCreateThread, S8_LIT("pthread_create failed"));
+    }
+    return _file_ok(aio);
+}
+
+void aio_destroy(AsyncIo* aio) {
+    if(aio->backend == AIO_BACKEND_IO_URING) {
+#if defined(CXB_PLATFORM_LINUX)
+        _aio_uring_destroy(aio->uring);
+#endif
+    } else {
+        _aio_threads_destroy(aio);
+    }
+    if(aio->notify_fd >= 0) {
+        close(aio->notify_fd);
+        aio->notify_fd = -1;
+    }
+}
+
+AioBackend aio_backend(const AsyncIo* aio) {
+    return aio->backend;
+}
+
+u32 aio_queue_depth(const AsyncIo* aio) {
+    return aio->queue_depth;
+}
+
+u32 aio_pending(const AsyncIo* aio) {
+    return aio->n_pending;
+}
+
+int aio_notify_fd(const AsyncIo* aio) {
+    return aio->notify_fd;
+}
+
+Result<u32, FileErr> aio_register_files(AsyncIo* aio, Array<int> fds) {
+    if(aio->backend == AIO_BACKEND_IO_URING) {
+#if defined(CXB_PLATFORM_LINUX)
+        _aio_uring_register(aio->uring.ring_fd, IORING_UNREGISTER_FILES, nullptr, 0);
+        if(fds.len > 0 && _aio_uring_register(aio->uring.ring_fd, IORING_REGISTER_FILES, fds.data, fds.len) < 0) {
+            return _file_err<u32>(FileErr::CouldNotRegister, S8_LIT("IORING_REGISTER_FILES failed"));
+        }
+#endif
+    } else {
+        pthread_mutex_lock(&aio->threads.mutex);
+        aio->threads.files = fds.len > 0 ? arena_push_array(aio->arena, fds) : Array<int>{};
+        pthread_mutex_unlock(&aio->threads.mutex);
+    }
+    return _file_ok((u32) fds.len);
+}
+
+Result<u32, FileErr> aio_register_buffers(AsyncIo* aio, Array<Array<char>> bufs) {
+    if(aio->backend == AIO_BACKEND_IO_URING) {
+#if defined(CXB_PLATFORM_LINUX)
+        _aio_uring_register(aio->uring.ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        if(bufs.len > 0) {
+            AArenaTmp tmp = begin_scratch();
+            iovec* iovs = arena_push<iovec>(tmp.arena, bufs.len);
+            for(size_t i = 0; i < bufs.len; ++i) {
+                iovs[i] = iovec{.iov_base = bufs[i].data, .iov_len = bufs[i].len};
+            }
+            if(_aio_uring_register(aio->uring.ring_fd, IORING_REGISTER_BUFFERS, iovs, bufs.len) < 0) {
+                return _file_err<u32>(FileErr::CouldNotRegister, S8_LIT("IORING_REGISTER_BUFFERS failed"));
+            }
+        }
+#endif
+    }
+    // NOTE: the thread pool backend reads into the op's buffer directly, there is nothing to register
+    return _file_ok((u32) bufs.len);
+}
+
+Result<u32, FileErr> aio_submit(AsyncIo* aio, Array<AioOp> ops) {
+    u32 n = (u32) min((size_t) (aio->queue_depth - aio->n_pending), ops.len);
+    if(n == 0) {
+        if(ops.len == 0) return _file_ok(0u);
+        return _file_err<u32>(FileErr::QueueFull, S8_LIT("too many operations in flight"));
+    }
+    ops.len = n;
+
+    if(aio->backend == AIO_BACKEND_IO_URING) {
+#if defined(CXB_PLATFORM_LINUX)
+        _aio_uring_push(aio, ops);
+        aio->n_pending += n;
+        // NOTE: ops the kernel did not consume stay in the SQ ring and are flushed by aio_poll
+        int ret = _aio_uring_flush(aio, 0);
+        if(ret < 0 && ret != -EAGAIN && ret != -EBUSY) {
+            // the kernel consumed nothing, take this call's ops back out so a retry does not submit them twice
+            AioUring& r = aio->uring;
+            __atomic_store_n(r.sq_tail, *r.sq_tail - n, __ATOMIC_RELEASE);
+            r.n_unsubmitted -= n;
+            aio->n_pending -= n;
+            return _file_err<u32>(FileErr::CouldNotSubmit, S8_LIT("io_uring_enter failed"));
+        }
+#endif
+    } else {
+        AioThreads& t = aio->threads;
+        pthread_mutex_lock(&t.mutex);
+        for(const AioOp& op : ops) {
+            t.ops[(t.ops_head + t.ops_len) % aio->queue_depth] = op;
+            t.ops_len += 1;
+        }
+        aio->n_pending += n;
+        if(n == 1) {
+            pthread_cond_signal(&t.has_work);
+        } else {
+            pthread_cond_broadcast(&t.has_work);
+        }
+        pthread_mutex_unlock(&t.mutex);
+    }
+    return _file_ok(n);
+}
+
+Result<u32, FileErr> aio_poll(AsyncIo* aio, Array<AioCompletion> out, u32 min_complete) {
+    min_complete = (u32) min((size_t) min_complete, min(out.len, (size_t) aio->n_pending));
+
+    u32 got = 0;
+    if(aio->backend == AIO_BACKEND_IO_URING) {
+#if defined(CXB_PLATFORM_LINUX)
+        got = _aio_uring_reap(aio, out.data, (u32) out.len);
+        while(got < min_complete || aio->uring.n_unsubmitted > 0) {
+            u32 wait_for = got < min_complete ? min_complete - got : 0;
+            int ret = _aio_uring_flush(aio, wait_for);
+            got += _aio_uring_reap(aio, out.data + got, (u32) out.len - got);
+            // EAGAIN / EBUSY: the kernel is short on resources or the CQ ring is full, reaping above makes progress
+            if(ret < 0 && ret != -EAGAIN && ret != -EBUSY && got < min_complete) {
+                auto res = _file_err<u32>(FileErr::CouldNotPoll, S8_LIT("io_uring_enter failed"));
+                res.value = got;
+                return res;
+            }
+            if(ret < 0 || wait_for == 0) {
+                break;
+            }
+        }
+#endif
+    } else {
+        AioThreads& t = aio->threads;
+        pthread_mutex_lock(&t.mutex);
+        while(t.done_len < min_complete) {
+            pthread_cond_wait(&t.has_done, &t.mutex);
+        }
+        got = (u32) min((size_t) t.done_len, out.len);
+        for(u32 i = 0; i < got; ++i) {
+            out.data[i] = t.done[t.done_head];
+            t.done_head = (t.done_head + 1) % aio->queue_depth;
+        }
+        t.done_len -= got;
+        aio->n_pending -= got;
+        pthread_mutex_unlock(&t.mutex);
+    }
+    return _file_ok(got);
+}
+
+Array<char> aio_push_buffer(Arena* arena, size_t n) {
+    char* data = (char*) arena_push_bytes(arena, n, os_page_size());
+    return Array<char>{data, n};
+}
+
+// * SECTION: streaming reads
+INTERNAL Result<FileReader, FileErr> _filereader_open_err(int fd, FileErr error, String8 reason) {
+    if(fd >= 0) {
+        close(fd);
+    }
+    Result<FileReader, FileErr> result = _file_err<FileReader>(error, reason);
+    result.value.fd = -1;
+    return result;
+}
+
+INTERNAL Result<bool, FileErr> _filereader_submit(FileReader& r) {
+    if(r.read_offset >= r.file_size) {
+        r.in_flight = false;
+        return _file_ok(false);
+    }
+
+    Array<char>& buf = r.bufs[1 - r.cur];
+    AioOp op = aio_op_read(r.fd, r.read_offset, Array<char>{buf.data + r.max_carry, r.chunk_size}, 1 - r.cur);
+    auto submitted = aio_submit(r.aio, Array<AioOp>{&op, 1});
+    if(submitted) {
+        return _file_err<bool>(submitted.error, submitted.reason);
+    }
+    r.in_flight = true;
+    return _file_ok(true);
+}
+
+Result<FileReader, FileErr> filereader_open(Arena* arena, String8 filepath, FileReaderParams params) {
+    ASSERT(params.chunk_size > 0, "chunk_size must be non-zero");
+    AArenaTmp tmp = begin_scratch();
+    int fd = open(filepath.c_str_maybe_copy(tmp.arena), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return _filereader_open_err(fd, FileErr::CouldNotOpen, S8_LIT("open failed"));
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        return _filereader_open_err(fd, FileErr::CouldNotStat, S8_LIT("fstat failed"));
+    }
+    if(!S_ISREG(st.st_mode)) {
+        return _filereader_open_err(fd, FileErr::IsNotFile, S8_LIT("not a regular file"));
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    auto aio = aio_make(arena, params.aio);
+    if(aio) {
+        return _filereader_open_err(fd, aio.error, aio.reason);
+    }
+
+    FileReader r = {};
+    r.fd = fd;
+    r.file_size = (u64) st.st_size;
+    r.aio = aio.value;
+    r.chunk_size = params.chunk_size;
+    r.max_carry = params.max_carry > 0 ? params.max_carry : params.chunk_size;
+    r.bufs[0] = aio_push_buffer(arena, r.max_carry + r.chunk_size);
+    r.bufs[1] = aio_push_buffer(arena, r.max_carry + r.chunk_size);
+    r.cur = 1;
+    r.window = String8{.data = r.bufs[1].data + r.max_carry, .len = 0, .not_null_term = true};
+    r.eof = r.file_size == 0;
+
+    auto submitted = _filereader_submit(r);
+    if(submitted) {
+        aio_destroy(r.aio);
+        return _filereader_open_err(fd, submitted.error, submitted.reason);
+    }
+    return _file_ok(r);
+}
+
+void filereader_close(FileReader& r) {
+    if(r.in_flight) {
+        AioCompletion c;
+        aio_poll(r.aio, Array<AioCompletion>{&c, 1}, 1);
+        r.in_flight = false;
+    }
+    if(r.aio) {
+        aio_destroy(r.aio);
+    }
+    if(r.fd >= 0) {
+        close(r.fd);
+    }
+    r = {};
+    r.fd = -1;
+}
+
+Result<bool, FileErr> filereader_next(FileReader& r, size_t consumed) {
+    DEBUG_ASSERT(consumed <= r.window.len);
+    size_t carry = r.window.len - consumed;
+    if(carry > r.max_carry) {
+        return _file_err<bool>(FileErr::OutOfRange, S8_LIT("unconsumed bytes exceed max_carry"));
+    }
+
+    if(!r.in_flight) {
+        r.window = String8{.data = r.window.data + consumed, .len = carry, .not_null_term = true};
+        r.offset += consumed;
+        r.eof = true;
+        return _file_ok(false);
+    }
+
+    AioCompletion c;
+    auto polled = aio_poll(r.aio, Array<AioCompletion>{&c, 1}, 1);
+    if(polled.value == 0) {
+        return _file_err<bool>(polled.error, polled.reason);
+    }
+    r.in_flight = false;
+    if(c.result < 0) {
+        return _file_err<bool>(FileErr::CouldNotRead, S8_LIT("read failed"));
+    }
+
+    // NOTE: the consumer is done with the current buffer once the tail is copied out, it is refilled next
+    u32 next = 1 - r.cur;
+    char* start = r.bufs[next].data + r.max_carry - carry;
+    memcpy(start, r.window.data + consumed, carry);
+    r.offset = r.read_offset - carry;
+    r.window = String8{.data = start, .len = carry + (size_t) c.result, .not_null_term = true};
+    r.cur = next;
+
+    if(c.result == 0) {
+        // the file was truncated while reading
+        r.file_size = r.read_offset;
+    }
+    r.read_offset += (u64) c.result;
+
+    auto submitted = _filereader_submit(r);
+    if(submitted) {
+        return submitted;
+    }
+    r.eof = !r.in_flight;
+    return _file_ok(c.result > 0);
+}
+
+String8 filereader_lines(const FileReader& r) {
+    if(r.eof) {
+        return r.window;
+    }
+    for(size_t i = r.window.len; i > 0; --i) {
+        if(r.window.data[i - 1] == '\n') {
+            return String8{.data = r.window.data, .len = i, .not_null_term = true};
+        }
+    }
+    return String8{.data = r.window.data, .len = 0, .not_null_term = true};
+}
+
+// * SECTION: file-backed arrays
+Result<MemFile, FileErr> filearray_open_file(
+    Arena* arena, String8 filepath, size_t elem_size, size_t elem_align, FileArrayParams params) {
+    // NOTE: size 0, an existing file is not resized before its header is validated
+    auto opened = memfile_open(arena,
+                               filepath,
+                               MemFileParams{.mode = MEMFILE_MODE_CREATE,
+                                             .advice = params.advice,
+                                             .size = 0,
+                                             .reserve_bytes = params.reserve_bytes});
+    if(opened) {
+        return opened;
+    }
+
+    MemFile& file = opened.value;
+    if(file.data.len == 0) {
+        // a new file
+        auto resized = memfile_resize(file, sizeof(FileArrayHeader));
+        if(resized) {
+            memfile_close(file);
+            return _memfile_open_err(-1, resized.error, resized.reason);
+        }
+        *(FileArrayHeader*) file.data.data = FileArrayHeader{.magic = CXB_FILEARRAY_MAGIC,
+                                                             .version = CXB_FILEARRAY_VERSION,
+                                                             .elem_size = elem_size,
+                                                             .elem_align = elem_align,
+                                                             .len = 0,
+                                                             ._pad = {}};
+        return opened;
+    }
+
+    const FileArrayHeader* header = (const FileArrayHeader*) file.data.data;
+    size_t n_bytes = 0;
+    FileErr error = FileErr::Success;
+    String8 reason = {};
+    if(file.data.len < sizeof(FileArrayHeader)) {
+        error = FileErr::BadHeader;
+        reason = S8_LIT("file is shorter than a header");
+    } else if(header->magic != CXB_FILEARRAY_MAGIC || header->version != CXB_FILEARRAY_VERSION) {
+        error = FileErr::BadHeader;
+        reason = S8_LIT("not a FileArray file");
+    } else if(header->elem_size != elem_size || header->elem_align != elem_align) {
+        error = FileErr::BadHeader;
+        reason = S8_LIT("element type does not match");
+    } else if(__builtin_mul_overflow(header->len, (u64) elem_size, &n_bytes) ||
+              n_bytes > file.data.len - sizeof(FileArrayHeader)) {
+        error = FileErr::BadHeader;
+        reason = S8_LIT("file is shorter than its length");
+    }
+    if(error != FileErr::Success) {
+        memfile_close(file);
+        return _memfile_open_err(-1, error, reason);
+    }
+    return opened;
+}
+
+Result<size_t, FileErr> filearray_grow_file(MemFile& file, size_t min_bytes) {
+    size_t page = os_page_size();
+    return memfile_resize(file, _round_up_to(sizeof(FileArrayHeader) + min_bytes, page));
+}
+
+Result<size_t, FileErr> filearray_close_file(MemFile& file, size_t n_bytes) {
+    Result<size_t, FileErr> result = _file_ok(sizeof(FileArrayHeader) + n_bytes);
+    if(file.data.data) {
+        result = memfile_resize(file, sizeof(FileArrayHeader) + n_bytes);
+    }
+    memfile_close(file);
+    return result;
+}
+
+// * SECTION: directory traversal
+struct DirJob {
+    String8 path;
+    u32 depth;
+};
+
+struct DirWorker {
+    pthread_mutex_t mutex;
+    MArray<DirJob> jobs; // the owner pops from the back, thieves take from `head`
+    size_t head;
+
+    MArray<DirEntry> entries;
+    Arena* arena;
+    char* getdents_buf;
+};
+
+struct DirWalk {
+    DirWalkParams params;
+    DirWorker* workers;
+    u32 n_workers;
+    Atomic<u64> n_pending; // queued or in-progress directories
+    Atomic<u64> n_queued;  // in a deque
+    Atomic<u64> n_errors;
+
+    // workers with nothing to pop or steal sleep on has_work until a job is queued or the walk is done
+    pthread_mutex_t idle_mutex;
+    pthread_cond_t has_work;
+    Atomic<u32> n_idle;
+};
+
+struct DirWalkThread {
+    DirWalk* walk;
+    u32 idx;
+};
+
+INTERNAL void _dirwalk_wake(DirWalk* walk, bool all) {
+    pthread_mutex_lock(&walk->idle_mutex);
+    if(all) {
+        pthread_cond_broadcast(&walk->has_work);
+    } else {
+        pthread_cond_signal(&walk->has_work);
+    }
+    pthread_mutex_unlock(&walk->idle_mutex);
+}
+
+INTERNAL void _dirwalk_push_job(DirWalk* walk, DirWorker& w, DirJob job) {
+    pthread_mutex_lock(&w.mutex);
+    w.jobs.push_back(job);
+    pthread_mutex_unlock(&w.mutex);
+    // NOTE: n_queued is written before n_idle is read and a sleeper does the opposite, one of them sees the other
+    walk->n_queued.fetch_add(1);
+    if(walk->n_idle.load() > 0) {
+        _dirwalk_wake(walk, false);
+    }
+}
+
+INTERNAL bool _dirwalk_pop_job(DirWalk* walk, DirWorker& w, DirJob* job) {
+    pthread_mutex_lock(&w.mutex);
+    bool ok = w.jobs.len > w.head;
+    if(ok) {
+        *job = w.jobs.pop_back();
+        if(w.jobs.len == w.head) {
+            w.jobs.len = 0;
+            w.head = 0;
+        }
+    }
+    pthread_mutex_unlock(&w.mutex);
+    if(ok) walk->n_queued.fetch_sub(1);
+    return ok;
+}
+
+INTERNAL bool _dirwalk_steal_job(DirWalk* walk, u32 thief, DirJob* job) {
+    for(u32 i = 1; i < walk->n_workers; ++i) {
+        DirWorker& victim = walk->workers[(thief + i) % walk->n_workers];
+        if(pthread_mutex_trylock(&victim.mutex) != 0) {
+            continue;
+        }
+        // NOTE: steal the oldest job, it is the closest to the root and likely has the most work under it
+        bool ok = victim.jobs.len > victim.head;
+        if(ok) {
+            *job = victim.jobs[victim.head++];
+            if(victim.jobs.len == victim.head) {
+                victim.jobs.len = 0;
+                victim.head = 0;
+            }
+        }
+        pthread_mutex_unlock(&victim.mutex);
+        if(ok) {
+            walk->n_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+INTERNAL String8 _dirwalk_join(Arena* arena, String8 dir, const char* name, size_t name_len) {
+    bool needs_sep = dir.len > 0 && dir.data[dir.len - 1] != '/';
+    size_t len = dir.len + needs_sep + name_len;
+    char* data = (char*) arena_push_bytes(arena, len + 1, 1);
+    memcpy(data, dir.data, dir.len);
+    if(needs_sep) data[dir.len] = '/';
+    memcpy(data + dir.len + needs_sep, name, name_len);
+    data[len] = '\0';
+    return String8{.data = data, .len = len, .not_null_term = false};
+}
+
+INTERNAL DirEntryKind _dirwalk_kind_from_mode(u32 mode) {
+    if(S_ISREG(mode)) return DIRENT_FILE;
+    if(S_ISDIR(mode)) return DIRENT_DIR;
+    if(S_ISLNK(mode)) return DIRENT_SYMLINK;
+    return DIRENT_OTHER;
+}
+
+INTERNAL DirEntryKind _dirwalk_kind_from_dtype(u8 d_type) {
+    switch(d_type) {
+        case DT_REG:
+            return DIRENT_FILE;
+        case DT_DIR:
+            return DIRENT_DIR;
+        case DT_LNK:
+            return DIRENT_SYMLINK;
+        case DT_UNKNOWN:
+            return DIRENT_UNKNOWN;
+        default:
+            return DIRENT_OTHER;
+    }
+}
+
+INTERNAL bool _dirwalk_stat(int dir_fd, const char* name, DirEntry& e) {
+#if defined(CXB_PLATFORM_LINUX) && defined(STATX_BASIC_STATS)
+    struct statx stx;
+    u32 mask = STATX_TYPE | STATX_MODE | STATX_INO | STATX_SIZE | STATX_MTIME;
+    if(statx(dir_fd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, mask, &stx) != 0) {
+        return false;
+    }
+    e.mode = stx.stx_mode;
+    e.ino = stx.stx_ino;
+    e.size = stx.stx_size;
+    e.mtime_ns = (i64) stx.stx_mtime.tv_sec * 1000000000 + stx.stx_mtime.tv_nsec;
+#else
+    struct stat st;
+    if(fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return false;
+    }
+    e.mode = (u32) st.st_mode;
+    e.ino = (u64) st.st_ino;
+    e.size = (u64) st.st_size;
+#if defined(CXB_PLATFORM_DARWIN)
+    e.mtime_ns = (i64) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    e.mtime_ns = (i64) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+#endif
+    e.kind = _dirwalk_kind_from_mode(e.mode);
+    return true;
+}
+
+INTERNAL void _dirwalk_visit(DirWalk* walk, DirWorker& w, int dir_fd, DirJob job, const char* name, u8 d_type) {
+    size_t name_len = strlen(name);
+    if(name[0] == '.' && (name_len == 1 || (name_len == 2 && name[1] == '.'))) {
+        return;
+    }
+
+    const DirWalkParams& params = walk->params;
+    DirEntry e = {};
+    e.path = _dirwalk_join(w.arena, job.path, name, name_len);
+    e.kind = _dirwalk_kind_from_dtype(d_type);
+    e.depth = job.depth;
+
+    if(e.kind == DIRENT_UNKNOWN) {
+        // some filesystems do not fill in d_type
+        DirEntry st = {};
+        if(_dirwalk_stat(dir_fd, name, st)) {
+            e.kind = st.kind;
+        }
+    }
+    if(params.filter && !params.filter(e, params.filter_data)) {
+        return;
+    }
+    if(params.stat && !_dirwalk_stat(dir_fd, name, e)) {
+        walk->n_errors.fetch_add(1);
+    }
+    w.entries.push_back(e);
+
+    if(e.kind == DIRENT_DIR && job.depth < params.max_depth) {
+        walk->n_pending.fetch_add(1);
+        _dirwalk_push_job(walk, w, DirJob{.path = e.path, .depth = job.depth + 1});
+    }
+}
+
+INTERNAL void _dirwalk_process(DirWalk* walk, DirWorker& w, DirJob job) {
+    int dir_fd = open(job.path.data, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(dir_fd < 0) {
+        walk->n_errors.fetch_add(1);
+        return;
+    }
+
+#if defined(CXB_PLATFORM_LINUX)
+    struct linux_dirent64 {
+        u64 d_ino;
+        i64 d_off;
+        u16 d_reclen;
+        u8 d_type;
+        char d_name[];
+    };
+
+    for(;;) {
+        long n = syscall(SYS_getdents64, dir_fd, w.getdents_buf, walk->params.getdents_bytes);
+        if(n < 0) {
+            walk->n_errors.fetch_add(1);
+            break;
+        }
+        if(n == 0) {
+            break;
+        }
+        for(long off = 0; off < n;) {
+            linux_dirent64* d = (linux_dirent64*) (w.getdents_buf + off);
+            _dirwalk_visit(walk, w, dir_fd, job, d->d_name, d->d_type);
+            off += d->d_reclen;
+        }
+    }
+    close(dir_fd);
+#else
+    DIR* dir = fdopendir(dir_fd);
+    if(!dir) {
+        close(dir_fd);
+        walk->n_errors.fetch_add(1);
+        return;
+    }
+    while(dirent* d = readdir(dir)) {
+        _dirwalk_visit(walk, w, dir_fd, job, d->d_name, d->d_type);
+    }
+    closedir(dir);
+#endif
+}
+
+INTERNAL void* _dirwalk_worker(void* arg) {
+    DirWalkThread* t = (DirWalkThread*) arg;
+    DirWalk* walk = t->walk;
+    DirWorker& w = walk->workers[t->idx];
+
+    for(;;) {
+        DirJob job;
+        if(_dirwalk_pop_job(walk, w, &job) || _dirwalk_steal_job(walk, t->idx, &job)) {
+            _dirwalk_process(walk, w, job);
+            if(walk->n_pending.fetch_sub(1) == 1) {
+                _dirwalk_wake(walk, true);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&walk->idle_mutex);
+        walk->n_idle.fetch_add(1);
+        while(walk->n_queued.load() == 0 && walk->n_pending.load() > 0) {
+            pthread_cond_wait(&walk->has_work, &walk->idle_mutex);
+        }
+        walk->n_idle.fetch_sub(1);
+        pthread_mutex_unlock(&walk->idle_mutex);
+        if(walk->n_pending.load() == 0) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+Result<DirWalkResult, FileErr> dirwalk(Arena* arena, String8 root, DirWalkParams params) {
+    AArenaTmp tmp = begin_scratch();
+    const char* root_cstr = root.c_str_maybe_copy(tmp.arena);
+    struct stat st;
+    if(stat(root_cstr, &st) != 0) {
+        return _file_err<DirWalkResult>(FileErr::CouldNotOpen, S8_LIT("could not stat root"));
+    }
+    if(!S_ISDIR(st.st_mode)) {
+        return _file_err<DirWalkResult>(FileErr::CouldNotReadDir, S8_LIT("root is not a directory"));
+    }
+
+    DirWalk walk = {};
+    walk.params = params;
+    walk.n_workers = max(params.n_threads, 1u);
+    walk.workers = arena_push<DirWorker>(tmp.arena, walk.n_workers);
+    DirWalkResult result = {};
+    result.arenas = arena_push_array<Arena*>(arena, walk.n_workers);
+    for(u32 i = 0; i < walk.n_workers; ++i) {
+        DirWorker& w = walk.workers[i];
+        pthread_mutex_init(&w.mutex, nullptr);
+        w.jobs = MArray<DirJob>{};
+        w.entries = MArray<DirEntry>{};
+        w.arena = arena_make_nbytes(params.arena_reserve);
+        w.getdents_buf = (char*) arena_push_bytes(w.arena, params.getdents_bytes, 8);
+        result.arenas[i] = w.arena;
+    }
+
+    // strip trailing separators, the root path is copied into the first arena as it prefixes every path
+    size_t root_len = root.len;
+    while(root_len > 1 && root.data[root_len - 1] == '/') root_len--;
+    char* root_data = (char*) arena_push_bytes(walk.workers[0].arena, root_len + 1, 1);
+    memcpy(root_data, root.data, root_len);
+    root_data[root_len] = '\0';
+    String8 root_path = String8{.data = root_data, .len = root_len, .not_null_term = false};
+    pthread_mutex_init(&walk.idle_mutex, nullptr);
+    pthread_cond_init(&walk.has_work, nullptr);
+    walk.n_pending.store(1);
+    _dirwalk_push_job(&walk, walk.workers[0], DirJob{.path = root_path, .depth = 0});
+
+    DirWalkThread* threads = arena_push<DirWalkThread>(tmp.arena, walk.n_workers);
+    pthread_t* handles = arena_push<pthread_t>(tmp.arena, walk.n_workers);
+    u32 n_spawned = 0;
+    for(u32 i = 1; i < walk.n_workers; ++i) {
+        threads[i] = DirWalkThread{.walk = &walk, .idx = i};
+        if(pthread_create(&handles[i], nullptr, _dirwalk_worker, &threads[i]) != 0) {
+            break;
+        }
+        n_spawned = i;
+    }
+    // NOTE: the calling thread is worker 0, if fewer threads could be spawned it steals their (empty) deques
+    threads[0] = DirWalkThread{.walk = &walk, .idx = 0};
+    _dirwalk_worker(&threads[0]);
+    for(u32 i = 1; i <= n_spawned; ++i) {
+        pthread_join(handles[i], nullptr);
+    }
+    pthread_cond_destroy(&walk.has_work);
+    pthread_mutex_destroy(&walk.idle_mutex);
+
+    size_t n_entries = 0;
+    for(u32 i = 0; i < walk.n_workers; ++i) {
+        n_entries += walk.workers[i].entries.len;
+    }
+    if(n_entries > 0) {
+        result.entries = arena_push_array<DirEntry>(arena, n_entries);
+    }
+    size_t at = 0;
+    for(u32 i = 0; i < walk.n_workers; ++i) {
+        DirWorker& w = walk.workers[i];
+        if(w.entries.len > 0) {
+            memcpy(result.entries.data + at, w.entries.data, w.entries.len * sizeof(DirEntry));
+        }
+        at += w.entries.len;
+        w.entries.destroy();
+        w.jobs.destroy();
+        pthread_mutex_destroy(&w.mutex);
+    }
+    result.n_errors = walk.n_errors.load();
+    return _file_ok(result);
+}
+
+void dirwalk_destroy(DirWalkResult& result) {
+    for(Arena* a : result.arenas) {
+        arena_destroy(a);
+    }
+    result = {};
+}
+
+// * SECTION: copying files
+struct FileCopyState {
+    int dst_fd;
+    u64 dst_offset;
+    int src_fd;
+    u64 src_offset;
+    u64 remaining;
+    u64 n_bytes;
+    bool src_eof;
+};
+
+INTERNAL CXB_INLINE void _file_copy_advance(FileCopyState& s, u64 n) {
+    s.dst_offset += n;
+    s.src_offset += n;
+    s.remaining -= n;
+    s.n_bytes += n;
+}
+
+// the errors that mean "this method does not apply to these files", as opposed to an I/O error
+INTERNAL bool _file_copy_unsupported(int err) {
+    return err == ENOSYS || err == EXDEV || err == EINVAL || err == EOPNOTSUPP || err == ENOTTY;
+}
+
+// each method copies until done or until it fails, returns 0 or errno
+#if defined(CXB_PLATFORM_LINUX)
+INTERNAL int _file_copy_clone(FileCopyState& s, const FileCopyParams&) {
+    file_clone_range range = {.src_fd = s.src_fd,
+                              .src_offset = s.src_offset,
+                              .src_length = s.remaining,
+                              .dest_offset = s.dst_offset};
+    struct stat st;
+    if(fstat(s.src_fd, &st) != 0) {
+        return errno;
+    }
+    // NOTE: clones are block granular, except for a range that ends at the end of src
+    u64 src_size = (u64) st.st_size;
+    if(s.src_offset >= src_size) {
+        s.src_eof = true;
+        return 0;
+    }
+    if(s.src_offset + s.remaining >= src_size) {
+        range.src_length = src_size - s.src_offset;
+    }
+    if(ioctl(s.dst_fd, FICLONERANGE, &range) != 0) {
+        return errno;
+    }
+    _file_copy_advance(s, range.src_length);
+    s.src_eof = s.src_offset >= src_size;
+    return 0;
+}
+
+INTERNAL int _file_copy_range(FileCopyState& s, const FileCopyParams&) {
+    while(s.remaining > 0) {
+        loff_t src_off = (loff_t) s.src_offset;
+        loff_t dst_off = (loff_t) s.dst_offset;
+        ssize_t n = copy_file_range(s.src_fd, &src_off, s.dst_fd, &dst_off, min(s.remaining, (u64) GB(1)), 0);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        if(n == 0) {
+            s.src_eof = true;
+            break;
+        }
+        _file_copy_advance(s, (u64) n);
+    }
+    return 0;
+}
+
+INTERNAL int _file_copy_sendfile(FileCopyState& s, const FileCopyParams&) {
+    // NOTE: sendfile writes at the file position of dst_fd
+    if(lseek(s.dst_fd, (off_t) s.dst_offset, SEEK_SET) < 0) {
+        return errno;
+    }
+    while(s.remaining > 0) {
+        off_t src_off = (off_t) s.src_offset;
+        ssize_t n = sendfile(s.dst_fd, s.src_fd, &src_off, min(s.remaining, (u64) GB(1)));
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        if(n == 0) {
+            s.src_eof = true;
+            break;
+        }
+        _file_copy_advance(s, (u64) n);
+    }
+    return 0;
+}
+
+INTERNAL int _file_copy_splice(FileCopyState& s, const FileCopyParams& params) {
+    int pipe_fds[2];
+    if(pipe2(pipe_fds, O_CLOEXEC) != 0) {
+        return errno;
+    }
+    fcntl(pipe_fds[1], F_SETPIPE_SZ, (int) params.buffer_bytes);
+
+    int err = 0;
+    while(s.remaining > 0) {
+        loff_t src_off = (loff_t) s.src_offset;
+        ssize_t in = splice(s.src_fd, &src_off, pipe_fds[1], nullptr, min(s.remaining, (u64) params.buffer_bytes),
+                            SPLICE_F_MOVE);
+        if(in < 0) {
+            if(errno == EINTR) continue;
+            err = errno;
+            break;
+        }
+        if(in == 0) {
+            s.src_eof = true;
+            break;
+        }
+
+        // drain the pipe completely, such that an error leaves no bytes in flight
+        ssize_t out = 0;
+        while(out < in) {
+            loff_t dst_off = (loff_t) (s.dst_offset + out);
+            ssize_t n = splice(pipe_fds[0], nullptr, s.dst_fd, &dst_off, (size_t) (in - out), SPLICE_F_MOVE);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) {
+                err = n < 0 ? errno : EIO;
+                break;
+            }
+            out += n;
+        }
+        _file_copy_advance(s, (u64) out);
+        if(err) {
+            // NOTE: bytes left in the pipe are re-read from src by the next method, src_offset only advanced by what
+            // was written
+            break;
+        }
+    }
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    return err;
+}
+#endif
+
+INTERNAL int _file_copy_buffered(FileCopyState& s, const FileCopyParams& params) {
+    AArenaTmp tmp = begin_scratch();
+    size_t buf_len = max(params.buffer_bytes, (size_t) KB(4));
+    char* buf = (char*) arena_push_bytes(tmp.arena, buf_len, os_page_size());
+    while(s.remaining > 0) {
+        ssize_t n = pread(s.src_fd, buf, min(s.remaining, (u64) buf_len), (off_t) s.src_offset);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        if(n == 0) {
+            s.src_eof = true;
+            break;
+        }
+        ssize_t written = 0;
+        while(written < n) {
+            ssize_t w = pwrite(s.dst_fd, buf + written, (size_t) (n - written), (off_t) (s.dst_offset + written));
+            if(w < 0) {
+                if(errno == EINTR) continue;
+                return errno;
+            }
+            written += w;
+        }
+        _file_copy_advance(s, (u64) n);
+    }
+    return 0;
+}
+
+typedef int (*FileCopyFn)(FileCopyState& s, const FileCopyParams& params);
+
+INTERNAL FileCopyFn _file_copy_fn(FileCopyMethod method) {
+    switch(method) {
+#if defined(CXB_PLATFORM_LINUX)
+        case FILE_COPY_CLONE:
+            return _file_copy_clone;
+        case FILE_COPY_RANGE:
+            return _file_copy_range;
+        case FILE_COPY_SENDFILE:
+            return _file_copy_sendfile;
+        case FILE_COPY_SPLICE:
+            return _file_copy_splice;
+#endif
+        case FILE_COPY_BUFFERED:
+            return _file_copy_buffered;
+        default:
+            return nullptr;
+    }
+}
+
+Result<FileCopyResult, FileErr> file_copy_fd(
+    int dst_fd, u64 dst_offset, int src_fd, u64 src_offset, u64 len, FileCopyParams params) {
+    FileCopyState s = {.dst_fd = dst_fd,
+                       .dst_offset = dst_offset,
+                       .src_fd = src_fd,
+                       .src_offset = src_offset,
+                       .remaining = len,
+                       .n_bytes = 0,
+                       .src_eof = false};
+    FileCopyResult result = {.n_bytes = 0, .method = params.method, .err = 0};
+
+    FileCopyMethod first = params.method == FILE_COPY_AUTO ? FILE_COPY_CLONE : params.method;
+    FileCopyMethod last = params.method == FILE_COPY_AUTO ? FILE_COPY_BUFFERED : params.method;
+    for(int m = first; m <= last && s.remaining > 0 && !s.src_eof; ++m) {
+        FileCopyFn fn = _file_copy_fn((FileCopyMethod) m);
+        if(!fn) {
+            if(params.method != FILE_COPY_AUTO) {
+                return _file_err<FileCopyResult>(FileErr::CouldNotCopy, S8_LIT("copy method unavailable"));
+            }
+            continue;
+        }
+
+        u64 before = s.n_bytes;
+        int err = fn(s, params);
+        if(s.n_bytes > before || err == 0) {
+            result.method = (FileCopyMethod) m;
+        }
+        if(err == 0) {
+            break;
+        }
+        result.err = err;
+        if(!_file_copy_unsupported(err) || params.method != FILE_COPY_AUTO) {
+            break;
+        }
+    }
+    result.n_bytes = s.n_bytes;
+    if(s.remaining > 0 && !s.src_eof) {
+        auto res = _file_err<FileCopyResult>(FileErr::CouldNotCopy, S8_LIT("copy failed"));
+        res.value = result;
+        return res;
+    }
+    result.err = 0;
+    return _file_ok(result);
+}
+
+INTERNAL int _file_copy_open_dst(String8 dst, mode_t mode) {
+    AArenaTmp tmp = begin_scratch();
+    return open(dst.c_str_maybe_copy(tmp.arena), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+}
+
+INTERNAL int _file_copy_open_src(String8 src, u64* size, mode_t* mode) {
+    AArenaTmp tmp = begin_scratch();
+    int fd = open(src.c_str_maybe_copy(tmp.arena), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+    *size = (u64) st.st_size;
+    *mode = st.st_mode & 0777;
+    return fd;
+}
+
+Result<FileCopyResult, FileErr> file_copy(String8 dst, String8 src, FileCopyParams params) {
+    return file_concat(dst, Array<String8>{&src, 1}, params);
+}
+
+// whether `dst` exists and is the same file as one of `srcs`
+INTERNAL bool _file_copy_dst_is_src(String8 dst, Array<String8> srcs) {
+    AArenaTmp tmp = begin_scratch();
+    struct stat dst_st;
+    if(stat(dst.c_str_maybe_copy(tmp.arena), &dst_st) != 0) {
+        return false;
+    }
+    for(size_t i = 0; i < srcs.len; ++i) {
+        struct stat src_st;
+        if(stat(srcs[i].c_str_maybe_copy(tmp.arena), &src_st) == 0 && src_st.st_dev == dst_st.st_dev &&
+           src_st.st_ino == dst_st.st_ino) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Result<FileCopyResult, FileErr> file_concat(String8 dst, Array<String8> srcs, FileCopyParams params) {
+    // NOTE: dst is truncated when opened, which would empty that source
+    if(_file_copy_dst_is_src(dst, srcs)) {
+        return _file_err<FileCopyResult>(FileErr::CouldNotCopy, S8_LIT("destination is one of the sources"));
+    }
+    int dst_fd = -1;
+    FileCopyResult result = {.n_bytes = 0, .method = params.method, .err = 0};
+    for(size_t i = 0; i < srcs.len; ++i) {
+        u64 size = 0;
+        mode_t mode = 0644;
+        int src_fd = _file_copy_open_src(srcs[i], &size, &mode);
+        if(src_fd < 0) {
+            if(dst_fd >= 0) close(dst_fd);
+            auto res = _file_err<FileCopyResult>(FileErr::CouldNotOpen, S8_LIT("could not open source file"));
+            res.value = result;
+            return res;
+        }
+        if(dst_fd < 0) {
+            dst_fd = _file_copy_open_dst(dst, mode);
+            if(dst_fd < 0) {
+                close(src_fd);
+                return _file_err<FileCopyResult>(FileErr::CouldNotOpen, S8_LIT("could not open destination file"));
+            }
+        }
+
+        auto copied = file_copy_fd(dst_fd, result.n_bytes, src_fd, 0, size, params);
+        close(src_fd);
+        if(copied) {
+            close(dst_fd);
+            // the bytes of dst that are valid: the previous sources and the part of this one
+            copied.value.n_bytes += result.n_bytes;
+            return copied;
+        }
+        result.n_bytes += copied.value.n_bytes;
+        result.method = copied.value.method;
+    }
+    if(dst_fd < 0) {
+        dst_fd = _file_copy_open_dst(dst, 0644);
+        if(dst_fd < 0) {
+            return _file_err<FileCopyResult>(FileErr::CouldNotOpen, S8_LIT("could not open destination file"));
+        }
+    }
+    close(dst_fd);
+    return _file_ok(result);
+}
@@ -0,0 +1,493 @@
+/*
+# cxb/io: file I/O
+
+## Memory-mapped files
+
+* `MemFile`: a file mapped into the address space, `data` is a view of the file's bytes
+    - `MEMFILE_MODE_READ`: read-only, private mapping
+    - `MEMFILE_MODE_WRITE`: read/write, shared mapping of an existing file
+    - `MEMFILE_MODE_CREATE`: read/write, shared mapping, the file is created if it does not exist and may be grown
+      with `memfile_resize`
+* Access-pattern hints (`MemFileAdvice`) are applied to the whole mapping on open, `memfile_advise`,
+  `memfile_prefetch` and `memfile_evict` operate on byte ranges (rounded out to page boundaries)
+
+Writable mappings reserve `MemFileParams::reserve_bytes` of address space up front. Growing the file within the
+reservation is a single `ftruncate`, i.e. `data.data` does not move. Growing past the reservation remaps (`mremap`
+on Linux) and may move `data.data`.
+
+## Async I/O
+
+* `AsyncIo`: batched reads and writes with completion polling
+    - Linux: io_uring (raw syscalls, no liburing dependency), supports registered (fixed) files and buffers
+    - Fallback: a pool of threads issuing `pread`/`pwrite`, used when io_uring is unavailable (old kernels, seccomp
+      filters, non-Linux platforms) or when `AioParams::force_fallback` is set
+* Completions are reaped with `aio_poll`. With `AioParams::notify_fd` the engine also signals a file descriptor
+  (`aio_notify_fd`) on completion, such that it can be driven from an existing event loop or scheduler
+
+## Streaming reads
+
+* `FileReader`: reads a file in fixed-size chunks into two buffers, the next chunk is read (via `AsyncIo`) while the
+  consumer processes the current `window`
+* `filereader_next(reader, consumed)` carries the unconsumed tail of the window (e.g. a partial token or line) over to
+  the front of the next window, the tail may be at most `FileReaderParams::max_carry` bytes
+
+## File-backed arrays
+
+* `FileArray<T>`: a growable array of trivially copyable `T` whose storage is a `MEMFILE_MODE_CREATE` mapping
+    - the file is a 64-byte `FileArrayHeader` followed by the elements, i.e. reopening is an `mmap` and no
+      deserialization
+    - growth doubles the file with `ftruncate`, `FileArrayParams::reserve_bytes` of address space is reserved up front
+      such that growing does not move `data`
+    - `filearray_sync` is a checkpoint (`msync`), `filearray_close` trims the file to the used length
+* `FileArray<T>` is slice compatible and converts to `Array<T>`, the view is invalidated when the array grows past
+  the reservation
+
+## Directory traversal
+
+* `dirwalk`: recursive traversal over a pool of threads, each thread owns a deque of directories and steals from the
+  others when it runs out
+    - Linux: `getdents64` with a large buffer (`DirWalkParams::getdents_bytes`) and `statx`, elsewhere
+      `readdir`/`fstatat`
+    - paths are `String8`s allocated in per-thread arenas (`DirWalkResult::arenas`), the merged `entries` only copy
+      the `DirEntry` headers
+    - `DirWalkParams::filter` is called for every entry, returning false drops the entry (and does not descend into it)
+
+## Copying files
+
+* `file_copy`, `file_concat` and `file_copy_fd` move bytes between files without going through user buffers where
+  the kernel allows it. `FILE_COPY_AUTO` tries, in order:
+    - `FICLONERANGE` (reflink, Btrfs/XFS/...), offsets must be block aligned
+    - `copy_file_range`
+    - `sendfile`
+    - `splice` through a pipe
+    - a buffered `pread`/`pwrite` loop, the only method outside of Linux
+  a method that is unsupported for the given files falls through to the next one, from where it stopped
+*/
+#ifndef CXB_IO_H
+#define CXB_IO_H
+
+#include "string8.h"
+
+/* SECTION: errors */
+enum class FileErr {
+    Success = 0,
+    IsNotFile = 1,
+    CouldNotOpen = 2,
+    CouldNotStat = 3,
+    CouldNotMap = 4,
+    CouldNotResize = 5,
+    CouldNotAdvise = 6,
+    CouldNotSync = 7,
+    OutOfRange = 8,
+    ReadOnly = 9,
+    CouldNotRegister = 10,
+    QueueFull = 11,
+    CouldNotCreateThread = 12,
+    CouldNotRead = 13,
+    BadHeader = 14,
+    CouldNotReadDir = 15,
+    CouldNotCopy = 16,
+    CouldNotSubmit = 17,
+    CouldNotPoll = 18,
+    Cnt,
+};
+
+/* SECTION: memory-mapped files */
+enum MemFileMode {
+    MEMFILE_MODE_READ = 0,
+    MEMFILE_MODE_WRITE = 1,
+    MEMFILE_MODE_CREATE = 2,
+};
+
+enum MemFileAdvice : u32 {
+    MEMFILE_ADVICE_NORMAL = 0,
+    MEMFILE_ADVICE_SEQUENTIAL = 1 << 0, // MADV_SEQUENTIAL
+    MEMFILE_ADVICE_RANDOM = 1 << 1,     // MADV_RANDOM
+    MEMFILE_ADVICE_WILLNEED = 1 << 2,   // MADV_WILLNEED
+    MEMFILE_ADVICE_HUGEPAGE = 1 << 3,   // MADV_HUGEPAGE (Linux only, ignored elsewhere)
+};
+
+struct MemFileParams {
+    MemFileMode mode = MEMFILE_MODE_READ;
+    u32 advice = MEMFILE_ADVICE_NORMAL; // MemFileAdvice flags
+    bool populate = false;              // MAP_POPULATE (Linux only), pre-fault the mapping
+    size_t size = 0;                    // MEMFILE_MODE_CREATE: minimum initial file size
+    size_t reserve_bytes = 0;           // writable modes: address space to reserve, 0 => file size rounded to a page
+};
+
+struct MemFile {
+    Array<char> data;
+    String8 filepath;
+    int fd;
+    MemFileMode mode;
+    size_t reserved; // bytes mapped at data.data, >= data.len
+};
+
+Result<MemFile, FileErr> memfile_open(Arena* arena, String8 filepath, MemFileParams params = {});
+void memfile_close(MemFile& file);
+
+// grows or shrinks the file to `new_size` bytes, returns the new size
+Result<size_t, FileErr> memfile_resize(MemFile& file, size_t new_size);
+
+// the functions below return the number of bytes (after page rounding) the operation was applied to
+Result<size_t, FileErr> memfile_advise(MemFile& file, u32 advice, size_t offset = 0, size_t len = SIZE_MAX);
+Result<size_t, FileErr> memfile_prefetch(MemFile& file, size_t offset, size_t len);
+Result<size_t, FileErr> memfile_evict(MemFile& file, size_t offset, size_t len);
+Result<size_t, FileErr> memfile_sync(MemFile& file, bool async = false, size_t offset = 0, size_t len = SIZE_MAX);
+
+/* SECTION: async I/O */
+enum AioOpKind {
+    AIO_OP_READ = 0,
+    AIO_OP_WRITE = 1,
+};
+
+enum AioBackend {
+    AIO_BACKEND_IO_URING = 0,
+    AIO_BACKEND_THREADS = 1,
+};
+
+struct AioOp {
+    AioOpKind kind;
+    i32 fd;          // a file descriptor, or an index into the registered files if `fixed_file`
+    bool fixed_file; // see aio_register_files
+    i32 buf_index;   // index into the registered buffers (see aio_register_buffers), -1 if not registered
+    u64 offset;
+    Array<char> buf;
+    u64 user_data;
+};
+
+struct AioCompletion {
+    u64 user_data;
+    i64 result; // bytes transferred or -errno
+};
+
+struct AioParams {
+    u32 queue_depth = 256; // max in-flight operations
+    u32 n_threads = 4;     // fallback worker threads
+    bool force_fallback = false;
+    bool notify_fd = false;
+};
+
+struct AsyncIo;
+
+Result<AsyncIo*, FileErr> aio_make(Arena* arena, AioParams params = {});
+void aio_destroy(AsyncIo* aio);
+
+AioBackend aio_backend(const AsyncIo* aio);
+u32 aio_queue_depth(const AsyncIo* aio);
+u32 aio_pending(const AsyncIo* aio);
+int aio_notify_fd(const AsyncIo* aio);
+
+// registration replaces previously registered files/buffers, returns the number registered
+Result<u32, FileErr> aio_register_files(AsyncIo* aio, Array<int> fds);
+Result<u32, FileErr> aio_register_buffers(AsyncIo* aio, Array<Array<char>> bufs);
+
+// submits as many ops as there is queue space for, returns the number submitted
+Result<u32, FileErr> aio_submit(AsyncIo* aio, Array<AioOp> ops);
+
+// fills `out` with up to `out.len` completions, blocks until at least `min_complete` are available, returns the number
+// filled. On error fewer may be filled, the value is still the number written to `out`
+Result<u32, FileErr> aio_poll(AsyncIo* aio, Array<AioCompletion> out, u32 min_complete = 0);
+
+// page-aligned buffer, usable with O_DIRECT and registered buffers
+Array<char> aio_push_buffer(Arena* arena, size_t n);
+
+CXB_INLINE AioOp aio_op_read(i32 fd, u64 offset, Array<char> buf, u64 user_data) {
+    return AioOp{.kind = AIO_OP_READ,
+                 .fd = fd,
+                 .fixed_file = false,
+                 .buf_index = -1,
+                 .offset = offset,
+                 .buf = buf,
+                 .user_data = user_data};
+}
+
+CXB_INLINE AioOp aio_op_write(i32 fd, u64 offset, Array<char> buf, u64 user_data) {
+    return AioOp{.kind = AIO_OP_WRITE,
+                 .fd = fd,
+                 .fixed_file = false,
+                 .buf_index = -1,
+                 .offset = offset,
+                 .buf = buf,
+                 .user_data = user_data};
+}
+
+/* SECTION: streaming reads */
+struct FileReaderParams {
+    size_t chunk_size = MB(1); // bytes read per refill
+    size_t max_carry = 0;      // longest tail carried between windows, 0 => chunk_size
+    AioParams aio = {.queue_depth = 2, .n_threads = 1};
+};
+
+struct FileReader {
+    String8 window; // carried-over bytes followed by the latest chunk
+    u64 offset;     // file offset of window.data[0]
+    bool eof;       // window ends at the end of the file
+
+    int fd;
+    u64 file_size;
+    AsyncIo* aio;
+    Array<char> bufs[2]; // max_carry + chunk_size bytes each, chunks are read to bufs[i].data + max_carry
+    u32 cur;             // index of the buffer holding window
+    size_t chunk_size;
+    size_t max_carry;
+    u64 read_offset; // file offset of the in-flight read
+    bool in_flight;
+};
+
+Result<FileReader, FileErr> filereader_open(Arena* arena, String8 filepath, FileReaderParams params = {});
+void filereader_close(FileReader& reader);
+
+// advances to the next window, the last `window.len - consumed` bytes of the current window are carried over to the
+// front of it. Returns false when no more bytes could be read, `window` then holds the carried-over bytes only
+Result<bool, FileErr> filereader_next(FileReader& reader, size_t consumed);
+
+// the prefix of the window up to and including its last '\n', or the whole window at the end of the file
+String8 filereader_lines(const FileReader& reader);
+
+/* SECTION: file-backed arrays */
+#define CXB_FILEARRAY_MAGIC 0x61627863u // "cxba"
+#define CXB_FILEARRAY_VERSION 1u
+
+struct FileArrayHeader {
+    u32 magic;
+    u32 version;
+    u64 elem_size;
+    u64 elem_align;
+    u64 len;
+    u8 _pad[32];
+};
+static_assert(sizeof(FileArrayHeader) == 64);
+
+struct FileArrayParams {
+    size_t reserve_bytes = GB(1); // address space to reserve
+    u32 advice = MEMFILE_ADVICE_NORMAL;
+};
+
+// opens or creates a file with a FileArrayHeader for elements of the given size, validates the header on reopen
+Result<MemFile, FileErr> filearray_open_file(Arena* arena,
+                                             String8 filepath,
+                                             size_t elem_size,
+                                             size_t elem_align,
+                                             FileArrayParams params);
+// grows the file such that it can hold at least `min_bytes` of elements (after the header)
+Result<size_t, FileErr> filearray_grow_file(MemFile& file, size_t min_bytes);
+Result<size_t, FileErr> filearray_close_file(MemFile& file, size_t n_bytes);
+
+template <typename T>
+struct FileArray {
+    static_assert(std::is_trivially_copyable_v<T>, "FileArray<T> requires a trivially copyable T");
+    static_assert(alignof(T) <= sizeof(FileArrayHeader), "FileArray<T> elements are stored after a 64-byte header");
+
+    T* data;
+    size_t len;
+    size_t capacity;
+    MemFile file;
+
+    // ** SECTION: slice compatible methods
+    inline size_t size() const {
+        return len;
+    }
+    inline bool empty() const {
+        return len == 0;
+    }
+    inline T& operator[](size_t idx) {
+        DEBUG_ASSERT(idx < len, "index out of bounds {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline const T& operator[](size_t idx) const {
+        DEBUG_ASSERT(idx < len, "index out of bounds {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline T& back() {
+        return data[len - 1];
+    }
+    inline operator Array<T>() const {
+        return Array<T>{data, len};
+    }
+
+    // ** SECTION: iterator methods
+    inline T* begin() {
+        return data;
+    }
+    inline T* end() {
+        return data + len;
+    }
+    inline const T* begin() const {
+        return data;
+    }
+    inline const T* end() const {
+        return data + len;
+    }
+
+    inline FileArrayHeader* header() const {
+        return (FileArrayHeader*) file.data.data;
+    }
+};
+
+template <typename T>
+INTERNAL CXB_INLINE void _filearray_sync_view(FileArray<T>& xs) {
+    xs.data = (T*) (xs.file.data.data + sizeof(FileArrayHeader));
+    xs.capacity = (xs.file.data.len - sizeof(FileArrayHeader)) / sizeof(T);
+}
+
+template <typename T>
+Result<FileArray<T>, FileErr> filearray_open(Arena* arena, String8 filepath, FileArrayParams params = {}) {
+    Result<FileArray<T>, FileErr> result = {};
+    auto file = filearray_open_file(arena, filepath, sizeof(T), alignof(T), params);
+    if(file) {
+        result.error = file.error;
+        result.reason = file.reason;
+        result.value.file.fd = -1;
+        return result;
+    }
+
+    FileArray<T>& xs = result.value;
+    xs.file = file.value;
+    _filearray_sync_view(xs);
+    xs.len = xs.header()->len;
+    return result;
+}
+
+template <typename T>
+Result<size_t, FileErr> filearray_reserve(FileArray<T>& xs, size_t capacity) {
+    if(capacity <= xs.capacity) {
+        return Result<size_t, FileErr>{.value = xs.capacity, .error = FileErr::Success, .reason = {}};
+    }
+    auto grown = filearray_grow_file(xs.file, max(capacity, xs.capacity * 2) * sizeof(T));
+    if(grown) {
+        return grown;
+    }
+    _filearray_sync_view(xs);
+    return Result<size_t, FileErr>{.value = xs.capacity, .error = FileErr::Success, .reason = {}};
+}
+
+template <typename T>
+Result<size_t, FileErr> filearray_resize(FileArray<T>& xs, size_t new_len) {
+    auto reserved = filearray_reserve(xs, new_len);
+    if(reserved) {
+        return reserved;
+    }
+    if(new_len > xs.len) {
+        memset((void*) (xs.data + xs.len), 0, (new_len - xs.len) * sizeof(T));
+    }
+    xs.len = new_len;
+    xs.header()->len = new_len;
+    return Result<size_t, FileErr>{.value = new_len, .error = FileErr::Success, .reason = {}};
+}
+
+template <typename T>
+Result<size_t, FileErr> filearray_extend(FileArray<T>& xs, Array<T> to_append) {
+    auto reserved = filearray_reserve(xs, xs.len + to_append.len);
+    if(reserved) {
+        return reserved;
+    }
+    if(to_append.len > 0) {
+        memcpy((void*) (xs.data + xs.len), to_append.data, to_append.len * sizeof(T));
+    }
+    xs.len += to_append.len;
+    xs.header()->len = xs.len;
+    return Result<size_t, FileErr>{.value = xs.len, .error = FileErr::Success, .reason = {}};
+}
+
+template <typename T>
+Result<size_t, FileErr> filearray_push(FileArray<T>& xs, const T& x) {
+    if(UNLIKELY(xs.len == xs.capacity)) {
+        auto reserved = filearray_reserve(xs, xs.len + 1);
+        if(reserved) {
+            return reserved;
+        }
+    }
+    xs.data[xs.len++] = x;
+    xs.header()->len = xs.len;
+    return Result<size_t, FileErr>{.value = xs.len, .error = FileErr::Success, .reason = {}};
+}
+
+// checkpoint: flushes the header and elements to the file
+template <typename T>
+Result<size_t, FileErr> filearray_sync(FileArray<T>& xs, bool async = false) {
+    return memfile_sync(xs.file, async, 0, sizeof(FileArrayHeader) + xs.len * sizeof(T));
+}
+
+// trims the file to the used length and unmaps it
+template <typename T>
+Result<size_t, FileErr> filearray_close(FileArray<T>& xs) {
+    auto closed = filearray_close_file(xs.file, xs.len * sizeof(T));
+    xs.data = nullptr;
+    xs.len = 0;
+    xs.capacity = 0;
+    return closed;
+}
+
+/* SECTION: directory traversal */
+enum DirEntryKind : u8 {
+    DIRENT_UNKNOWN = 0,
+    DIRENT_FILE = 1,
+    DIRENT_DIR = 2,
+    DIRENT_SYMLINK = 3,
+    DIRENT_OTHER = 4,
+};
+
+struct DirEntry {
+    String8 path; // null terminated, relative to the walk's root (which it is prefixed with)
+    DirEntryKind kind;
+    u32 depth; // 0 for the root's children
+
+    // filled if DirWalkParams::stat
+    u32 mode;
+    u64 ino;
+    u64 size;
+    i64 mtime_ns;
+};
+
+typedef bool (*DirWalkFilter)(const DirEntry& entry, void* user_data);
+
+struct DirWalkParams {
+    u32 n_threads = 4;
+    u32 max_depth = UINT32_MAX; // directories at this depth are listed but not descended into
+    bool stat = false;
+    DirWalkFilter filter = nullptr; // called before `stat` is applied, i.e. on path, kind and depth
+    void* filter_data = nullptr;
+    size_t getdents_bytes = KB(64); // per-thread buffer for getdents64
+    size_t arena_reserve = GB(1);   // address space reserved for each thread's arena
+};
+
+struct DirWalkResult {
+    Array<DirEntry> entries; // unordered
+    Array<Arena*> arenas;    // own the path bytes, see dirwalk_destroy
+    u64 n_errors;            // directories or entries that could not be read
+};
+
+Result<DirWalkResult, FileErr> dirwalk(Arena* arena, String8 root, DirWalkParams params = {});
+void dirwalk_destroy(DirWalkResult& result);
+
+/* SECTION: copying files */
+enum FileCopyMethod {
+    FILE_COPY_AUTO = 0,
+    FILE_COPY_CLONE = 1,
+    FILE_COPY_RANGE = 2,
+    FILE_COPY_SENDFILE = 3,
+    FILE_COPY_SPLICE = 4,
+    FILE_COPY_BUFFERED = 5,
+    FILE_COPY_CNT,
+};
+
+struct FileCopyParams {
+    FileCopyMethod method = FILE_COPY_AUTO; // anything but AUTO does not fall back
+    size_t buffer_bytes = KB(256);          // buffered copies and splice pipe size
+};
+
+struct FileCopyResult {
+    u64 n_bytes;           // also set on failure: the bytes written to dst before it
+    FileCopyMethod method; // the method that copied the last bytes
+    int err;               // errno of the last method that failed, set with FileErr::CouldNotCopy
+};
+
+// copies `len` bytes from src_fd at src_offset to dst_fd at dst_offset, stops early at the end of src
+Result<FileCopyResult, FileErr> file_copy_fd(
+    int dst_fd, u64 dst_offset, int src_fd, u64 src_offset, u64 len, FileCopyParams params = {});
+// creates or truncates `dst`, which must not be one of the sources
+Result<FileCopyResult, FileErr> file_copy(String8 dst, String8 src, FileCopyParams params = {});
+Result<FileCopyResult, FileErr> file_concat(String8 dst, Array<String8> srcs, FileCopyParams params = {});
+
+#endif /* CXB_IO_H */
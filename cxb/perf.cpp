@@ -0,0 +1,158 @@
+#include "perf.h"
+#include "format.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#if defined(CXB_PLATFORM_LINUX)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+const char* PERF_COUNTER_NAMES[PERF_COUNTER_CNT] = {
+    "cycles",
+    "instructions",
+    "l1d_misses",
+    "llc_misses",
+    "branch_misses",
+    "dtlb_misses",
+};
+
+#if defined(CXB_PLATFORM_LINUX)
+INTERNAL u64 _perf_cache_config(u64 cache, u64 op, u64 result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+INTERNAL int _perf_open(PerfCounter counter) {
+    perf_event_attr attr = {};
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1; // allowed with perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch(counter) {
+        case PERF_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = _perf_cache_config(
+                PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = _perf_cache_config(
+                PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PERF_DTLB_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = _perf_cache_config(
+                PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PERF_COUNTER_CNT:
+            return -1;
+    }
+    // NOTE: not grouped, a group is only scheduled if all of its events fit on the PMU at once, i.e. one unsupported
+    // or contended counter would disable all of them
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+#endif
+
+PerfCounters perf_counters_open() {
+    PerfCounters pc = {};
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+#if defined(CXB_PLATFORM_LINUX)
+        pc.fds[i] = _perf_open((PerfCounter) i);
+        pc.open_errno[i] = pc.fds[i] < 0 ? errno : 0;
+#else
+        pc.fds[i] = -1;
+        pc.open_errno[i] = ENOSYS;
+#endif
+    }
+    return pc;
+}
+
+void perf_counters_close(PerfCounters& pc) {
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+        if(pc.fds[i] >= 0) {
+            close(pc.fds[i]);
+        }
+        pc.fds[i] = -1;
+    }
+}
+
+bool perf_counters_any(const PerfCounters& pc) {
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+        if(pc.fds[i] >= 0) return true;
+    }
+    return false;
+}
+
+void perf_counters_start(PerfCounters& pc) {
+#if defined(CXB_PLATFORM_LINUX)
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+        if(pc.fds[i] < 0) continue;
+        ioctl(pc.fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pc.fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#else
+    (void) pc;
+#endif
+}
+
+PerfSample perf_counters_stop(PerfCounters& pc, u64 n_iters) {
+    PerfSample sample = {};
+    sample.n_iters = n_iters;
+#if defined(CXB_PLATFORM_LINUX)
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+        if(pc.fds[i] >= 0) ioctl(pc.fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+        if(pc.fds[i] < 0) continue;
+        u64 data[3] = {}; // value, time enabled, time running
+        if(read(pc.fds[i], data, sizeof(data)) != (ssize_t) sizeof(data) || data[2] == 0) continue;
+        // scale up when the counter was multiplexed with others
+        f64 value = (f64) data[0] * ((f64) data[1] / (f64) data[2]);
+        sample.values[i] = value / (f64) max(n_iters, (u64) 1);
+        sample.valid[i] = true;
+    }
+#else
+    (void) pc;
+#endif
+    return sample;
+}
+
+String8 perf_sample_format(Arena* a, const PerfSample& sample) {
+    String8 dst = arena_push_string8(a);
+    const f64* v = sample.values;
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+        if(i > 0) string8_push_back(dst, a, ' ');
+        if(!sample.valid[i]) {
+            _format_impl(a, dst, "{}=n/a", PERF_COUNTER_NAMES[i]);
+        } else if(i >= PERF_L1D_MISSES && sample.valid[PERF_INSTRUCTIONS] && v[PERF_INSTRUCTIONS] > 0) {
+            f64 per_1k_instr = 1000 * v[i] / v[PERF_INSTRUCTIONS];
+            _format_impl(a, dst, "{}={.1} ({.2}/1k instr)", PERF_COUNTER_NAMES[i], v[i], per_1k_instr);
+        } else {
+            _format_impl(a, dst, "{}={.1}", PERF_COUNTER_NAMES[i], v[i]);
+        }
+    }
+    if(sample.valid[PERF_CYCLES] && sample.valid[PERF_INSTRUCTIONS] && v[PERF_CYCLES] > 0) {
+        _format_impl(a, dst, " ipc={.2}", v[PERF_INSTRUCTIONS] / v[PERF_CYCLES]);
+    }
+    return dst;
+}
+
+void perf_print(FILE* f, String8 name, const PerfSample& sample) {
+    AArenaTmp tmp = begin_scratch();
+    print(f, tmp.arena, "{} (per iteration, n={}): {}\n", name, sample.n_iters, perf_sample_format(tmp.arena, sample));
+}
@@ -0,0 +1,62 @@
+/*
+# cxb/perf: hardware performance counters
+
+* `perf_counters_open` opens cycles, instructions, L1d/LLC read misses, branch misses and dTLB read misses for the
+  calling thread via `perf_event_open` (user space only)
+* `perf_counters_start` / `perf_counters_stop` scope the counters around a region, `perf_measure` runs a function
+  `n_iters` times within them. Samples are per iteration and scaled for multiplexing when the PMU has fewer counters
+  than requested
+* `perf_sample_format` / `perf_print` render a sample as a single line, including IPC and misses per 1k instructions
+
+Counters open independently: when perf events are restricted (`perf_event_paranoid`, containers, VMs without a PMU) or
+a counter is not supported, it is marked unavailable and reported as `n/a`, the remaining counters still work.
+On platforms other than Linux no counter is available.
+*/
+#ifndef CXB_PERF_H
+#define CXB_PERF_H
+
+#include "string8.h"
+
+enum PerfCounter {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_COUNTER_CNT,
+};
+
+extern const char* PERF_COUNTER_NAMES[PERF_COUNTER_CNT];
+
+struct PerfCounters {
+    int fds[PERF_COUNTER_CNT]; // -1 if unavailable
+    int open_errno[PERF_COUNTER_CNT];
+};
+
+struct PerfSample {
+    f64 values[PERF_COUNTER_CNT]; // per iteration
+    bool valid[PERF_COUNTER_CNT];
+    u64 n_iters;
+};
+
+PerfCounters perf_counters_open();
+void perf_counters_close(PerfCounters& pc);
+bool perf_counters_any(const PerfCounters& pc);
+
+void perf_counters_start(PerfCounters& pc);
+PerfSample perf_counters_stop(PerfCounters& pc, u64 n_iters = 1);
+
+template <typename F>
+PerfSample perf_measure(PerfCounters& pc, u64 n_iters, F&& fn) {
+    perf_counters_start(pc);
+    for(u64 i = 0; i < n_iters; ++i) {
+        fn();
+    }
+    return perf_counters_stop(pc, n_iters);
+}
+
+String8 perf_sample_format(Arena* a, const PerfSample& sample);
+void perf_print(FILE* f, String8 name, const PerfSample& sample);
+
+#endif /* CXB_PERF_H */
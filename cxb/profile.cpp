@@ -0,0 +1,212 @@
+#include "profile.h"
+#include "atomic.h"
+#include "format.h"
+
+#include <time.h>
+
+thread_local ProfileThread* _profile_thread = nullptr;
+
+INTERNAL ProfileParams profile_params = {};
+INTERNAL Atomic<ProfileThread*> profile_threads = nullptr;
+INTERNAL Atomic<u32> profile_next_tid = 0;
+
+void profile_init(ProfileParams params) {
+    profile_params = params;
+}
+
+ProfileThread* _profile_thread_init() {
+    // NOTE: the ring lives on the thread's permanent arena, which is never released, i.e. exports can still read the
+    // zones of threads that have exited
+    Arena* perm = get_perm();
+    u64 capacity = round_up_pow2(max(profile_params.ring_capacity, (u64) 2));
+
+    ProfileThread* t = arena_push<ProfileThread>(perm);
+    t->events = arena_push_fast<ProfileEvent>(perm, capacity);
+    t->capacity = capacity;
+    t->tid = profile_next_tid.fetch_add(1);
+
+    ProfileThread* head = profile_threads.load();
+    do {
+        t->next = head;
+    } while(!profile_threads.compare_exchange_weak(head, t));
+
+    _profile_thread = t;
+    return t;
+}
+
+void profile_reset() {
+    for(ProfileThread* t = profile_threads.load(); t; t = t->next) {
+        t->count = 0;
+    }
+}
+
+INTERNAL u64 _profile_clock_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64) ts.tv_sec * 1000000000ull + (u64) ts.tv_nsec;
+}
+
+f64 profile_ticks_per_ns() {
+    static f64 ticks_per_ns = 0;
+    if(LIKELY(ticks_per_ns > 0)) {
+        return ticks_per_ns;
+    }
+#if defined(__x86_64__) || defined(_M_X64)
+    // NOTE: assumes an invariant TSC, calibrated against the monotonic clock over ~10ms
+    u64 ns_begin = _profile_clock_ns();
+    u64 ticks_begin = profile_now();
+    u64 ns_end = ns_begin;
+    while(ns_end - ns_begin < 10000000) {
+        ns_end = _profile_clock_ns();
+    }
+    u64 ticks_end = profile_now();
+    ticks_per_ns = (f64) (ticks_end - ticks_begin) / (f64) (ns_end - ns_begin);
+#elif defined(__aarch64__)
+    u64 freq;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+    ticks_per_ns = (f64) freq / 1e9;
+#else
+    ticks_per_ns = 1.0;
+#endif
+    return ticks_per_ns;
+}
+
+INTERNAL CXB_INLINE u64 _profile_first_event(const ProfileThread* t) {
+    return t->count > t->capacity ? t->count - t->capacity : 0;
+}
+
+INTERNAL void _profile_json_string(Arena* a, String8& dst, const char* s) {
+    string8_push_back(dst, a, '"');
+    for(; *s; ++s) {
+        u8 c = (u8) *s;
+        if(c < 0x20) {
+            // control characters are not allowed in JSON strings
+            const char* hex = "0123456789abcdef";
+            char escaped[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+            for(char e : escaped) string8_push_back(dst, a, e);
+            continue;
+        }
+        if(*s == '"' || *s == '\\') {
+            string8_push_back(dst, a, '\\');
+        }
+        string8_push_back(dst, a, *s);
+    }
+    string8_push_back(dst, a, '"');
+}
+
+String8 profile_chrome_trace(Arena* a) {
+    f64 ns_per_tick = 1.0 / profile_ticks_per_ns();
+
+    u64 t0 = UINT64_MAX;
+    for(ProfileThread* t = profile_threads.load(); t; t = t->next) {
+        for(u64 i = _profile_first_event(t); i < t->count; ++i) {
+            t0 = min(t0, t->events[i & (t->capacity - 1)].begin);
+        }
+    }
+
+    String8 dst = arena_push_string8(a);
+    string8_extend(dst, a, S8_LIT("{\"traceEvents\":["));
+    bool first = true;
+    for(ProfileThread* t = profile_threads.load(); t; t = t->next) {
+        for(u64 i = _profile_first_event(t); i < t->count; ++i) {
+            const ProfileEvent& e = t->events[i & (t->capacity - 1)];
+            if(!first) string8_push_back(dst, a, ',');
+            first = false;
+
+            // NOTE: braces are format placeholders, they are pushed separately
+            string8_extend(dst, a, S8_LIT("{\"name\":"));
+            _profile_json_string(a, dst, e.name);
+            f64 ts_us = (f64) (e.begin - t0) * ns_per_tick / 1000.0;
+            f64 dur_us = (f64) (e.end - e.begin) * ns_per_tick / 1000.0;
+            _format_impl(a,
+                         dst,
+                         ",\"cat\":\"zone\",\"ph\":\"X\",\"ts\":{.3},\"dur\":{.3},\"pid\":1,\"tid\":{}",
+                         ts_us,
+                         dur_us,
+                         t->tid);
+            string8_push_back(dst, a, '}');
+        }
+    }
+    string8_extend(dst, a, S8_LIT("]}\n"));
+    return dst;
+}
+
+bool profile_write_chrome_trace(String8 filepath) {
+    u64 n_events = 0;
+    for(ProfileThread* t = profile_threads.load(); t; t = t->next) {
+        n_events += t->count - _profile_first_event(t);
+    }
+
+    Arena* arena = arena_make_nbytes(MB(1) + n_events * 256);
+    if(!arena) return false;
+    String8 json = profile_chrome_trace(arena);
+
+    AArenaTmp tmp = begin_scratch();
+    FILE* f = fopen(filepath.c_str_maybe_copy(tmp.arena), "wb");
+    bool ok = f != nullptr;
+    if(f) {
+        ok = fwrite(json.data, 1, json.len, f) == json.len;
+        ok &= fclose(f) == 0;
+    }
+    arena_destroy(arena);
+    return ok;
+}
+
+Array<ProfileZoneStats> profile_summary(Arena* a) {
+    constexpr u32 MAX_DEPTH = 64;
+    AArray<ProfileZoneStats> stats{};
+    for(ProfileThread* t = profile_threads.load(); t; t = t->next) {
+        // zones are recorded when they end, i.e. children before their parent: child_ticks[d] accumulates the
+        // inclusive time of finished zones at depth d until their parent (at depth d - 1) ends
+        u64 child_ticks[MAX_DEPTH + 1] = {};
+        for(u64 i = _profile_first_event(t); i < t->count; ++i) {
+            const ProfileEvent& e = t->events[i & (t->capacity - 1)];
+            u32 depth = min(e.depth, MAX_DEPTH - 1);
+            u64 inclusive = e.end - e.begin;
+            u64 self = inclusive - min(inclusive, child_ticks[depth + 1]);
+            child_ticks[depth + 1] = 0;
+            child_ticks[depth] += inclusive;
+
+            ProfileZoneStats* s = nullptr;
+            for(ProfileZoneStats& x : stats) {
+                if(x.name == e.name || strcmp(x.name, e.name) == 0) {
+                    s = &x;
+                    break;
+                }
+            }
+            if(!s) {
+                stats.push_back(ProfileZoneStats{.name = e.name, .count = 0, .inclusive_ns = 0, .self_ns = 0});
+                s = &stats.back();
+            }
+            s->count += 1;
+            s->inclusive_ns += (f64) inclusive;
+            s->self_ns += (f64) self;
+        }
+    }
+
+    f64 ns_per_tick = 1.0 / profile_ticks_per_ns();
+    for(ProfileZoneStats& x : stats) {
+        x.inclusive_ns *= ns_per_tick;
+        x.self_ns *= ns_per_tick;
+    }
+    merge_sort(stats.data, stats.len, [](const ProfileZoneStats& x, const ProfileZoneStats& y) {
+        return x.self_ns > y.self_ns;
+    });
+    return stats.len > 0 ? arena_push_array(a, Array<ProfileZoneStats>(stats)) : Array<ProfileZoneStats>{};
+}
+
+void profile_print_summary(FILE* f) {
+    AArenaTmp tmp = begin_scratch();
+    Array<ProfileZoneStats> stats = profile_summary(tmp.arena);
+    print(f, tmp.arena, "{} zones\n", stats.len);
+    for(const ProfileZoneStats& s : stats) {
+        print(f,
+              tmp.arena,
+              "{}: count={} self={.3}ms inclusive={.3}ms self/call={.1}ns\n",
+              s.name,
+              s.count,
+              s.self_ns / 1e6,
+              s.inclusive_ns / 1e6,
+              s.self_ns / (f64) s.count);
+    }
+}
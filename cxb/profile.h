@@ -0,0 +1,123 @@
+/*
+# cxb/profile: scoped zone profiler
+
+* `PROFILE_ZONE("name")` / `PROFILE_FUNCTION()` time the enclosing scope. The macros compile to nothing unless
+  `CXB_PROFILE` is defined, i.e. zones can be left in hot paths
+* zones record begin/end timestamps (`rdtsc` on x86-64, `cntvct_el0` on arm64, `clock_gettime` elsewhere) into a
+  per-thread ring buffer, allocated on the thread's permanent arena (`get_perm`) on its first zone. Once the ring is
+  full the oldest zones are overwritten
+* `profile_chrome_trace` exports the recorded zones as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+* `profile_summary` aggregates zones by name into call counts, inclusive and self time (inclusive time minus the
+  time spent in nested zones)
+
+Exporting reads every thread's ring buffer without synchronization, call it while no zones are being recorded.
+Zone names must outlive the export, e.g. string literals or `__func__`.
+*/
+#ifndef CXB_PROFILE_H
+#define CXB_PROFILE_H
+
+#include "string8.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+struct ProfileEvent {
+    const char* name;
+    u64 begin; // ticks, see profile_ticks_per_ns
+    u64 end;
+    u32 depth;
+};
+
+struct ProfileThread {
+    ProfileEvent* events;
+    u64 capacity; // power of 2
+    u64 count;    // events ever recorded, the ring holds the last min(count, capacity)
+    u32 depth;
+    u32 tid;
+    ProfileThread* next;
+};
+
+struct ProfileParams {
+    u64 ring_capacity = 4096; // events per thread, rounded up to a power of 2
+};
+
+struct ProfileZoneStats {
+    const char* name;
+    u64 count;
+    f64 inclusive_ns;
+    f64 self_ns;
+};
+
+// applies to threads that have not recorded a zone yet
+void profile_init(ProfileParams params);
+void profile_reset();
+
+CXB_INLINE u64 profile_now() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    u64 ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64) ts.tv_sec * 1000000000ull + (u64) ts.tv_nsec;
+#endif
+}
+
+f64 profile_ticks_per_ns();
+
+ProfileThread* _profile_thread_init();
+extern thread_local ProfileThread* _profile_thread;
+
+CXB_INLINE void profile_record(const char* name, u64 begin, u64 end, u32 depth) {
+    ProfileThread* t = _profile_thread;
+    ProfileEvent& e = t->events[t->count & (t->capacity - 1)];
+    e.name = name;
+    e.begin = begin;
+    e.end = end;
+    e.depth = depth;
+    t->count += 1;
+}
+
+struct ProfileZone {
+    const char* name;
+    u64 begin;
+
+    CXB_INLINE explicit ProfileZone(const char* name) : name{name} {
+        if(UNLIKELY(!_profile_thread)) {
+            _profile_thread_init();
+        }
+        _profile_thread->depth += 1;
+        begin = profile_now();
+    }
+    CXB_INLINE ~ProfileZone() {
+        u64 end = profile_now();
+        u32 depth = --_profile_thread->depth;
+        profile_record(name, begin, end, depth);
+    }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define _PROFILE_CONCAT2(a, b) a##b
+#define _PROFILE_CONCAT(a, b) _PROFILE_CONCAT2(a, b)
+#ifdef CXB_PROFILE
+#define PROFILE_ZONE(name) ProfileZone _PROFILE_CONCAT(_profile_zone_, __LINE__){name}
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#else
+#define PROFILE_ZONE(name) ((void) 0)
+#define PROFILE_FUNCTION() ((void) 0)
+#endif
+
+// {"traceEvents": [...]} with one complete ("X") event per recorded zone
+String8 profile_chrome_trace(Arena* a);
+bool profile_write_chrome_trace(String8 filepath);
+
+// sorted by self time, descending
+Array<ProfileZoneStats> profile_summary(Arena* a);
+void profile_print_summary(FILE* f);
+
+#endif /* CXB_PROFILE_H */
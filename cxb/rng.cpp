@@ -0,0 +1,187 @@
+#include "rng.h"
+
+/* SECTION: xoshiro256++ */
+Xoshiro256 xoshiro256_make(u64 seed) {
+    Xoshiro256 g;
+    for(u64& x : g.s) x = splitmix64(seed);
+    return g;
+}
+
+INTERNAL void xoshiro256_apply_jump(Xoshiro256& g, const u64 (&poly)[4]) {
+    u64 s[4] = {};
+    for(u64 word : poly) {
+        for(int b = 0; b < 64; ++b) {
+            if(word & (1ull << b)) {
+                for(int i = 0; i < 4; ++i) s[i] ^= g.s[i];
+            }
+            rng_u64(g);
+        }
+    }
+    for(int i = 0; i < 4; ++i) g.s[i] = s[i];
+}
+
+void xoshiro256_jump(Xoshiro256& g) {
+    static const u64 JUMP[4] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+    xoshiro256_apply_jump(g, JUMP);
+}
+
+void xoshiro256_long_jump(Xoshiro256& g) {
+    static const u64 LONG_JUMP[4] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+    xoshiro256_apply_jump(g, LONG_JUMP);
+}
+
+Xoshiro256 xoshiro256_stream(u64 seed, u64 stream) {
+    // NOTE: O(stream) long jumps, meant for per-thread streams
+    Xoshiro256 g = xoshiro256_make(seed);
+    for(u64 i = 0; i < stream; ++i) xoshiro256_long_jump(g);
+    return g;
+}
+
+/* SECTION: pcg32 */
+Pcg32 pcg32_make(u64 seed, u64 stream) {
+    Pcg32 g = {.state = 0, .inc = (stream << 1) | 1};
+    rng_u32(g);
+    g.state += seed;
+    rng_u32(g);
+    return g;
+}
+
+void pcg32_advance(Pcg32& g, u64 n) {
+    // state_n = A * state + C, by squaring the step (mult, plus) for each bit of n
+    u64 acc_mult = 1;
+    u64 acc_plus = 0;
+    u64 mult = PCG32_MULTIPLIER;
+    u64 plus = g.inc;
+    for(; n > 0; n >>= 1) {
+        if(n & 1) {
+            acc_mult *= mult;
+            acc_plus = acc_plus * mult + plus;
+        }
+        plus = (mult + 1) * plus;
+        mult *= mult;
+    }
+    g.state = acc_mult * g.state + acc_plus;
+}
+
+/* SECTION: batches */
+Xoshiro256x4 xoshiro256x4_make(u64 seed, u64 stream) {
+    Xoshiro256x4 g;
+    Xoshiro256 lane = xoshiro256_stream(seed, stream);
+    for(int j = 0; j < 4; ++j) {
+        for(int i = 0; i < 4; ++i) g.s[i][j] = lane.s[i];
+        xoshiro256_jump(lane);
+    }
+    return g;
+}
+
+// GCC/Clang vector extensions: AVX2 (or SSE2 pairs, NEON) for the 4 lanes
+typedef u64 RngU64x4 __attribute__((vector_size(32)));
+typedef u32 RngU32x8 __attribute__((vector_size(32)));
+typedef i32 RngI32x8 __attribute__((vector_size(32)));
+typedef f32 RngF32x8 __attribute__((vector_size(32)));
+
+// calls f(i, block) with the i-th block of 4 outputs, one per lane
+template <typename F>
+INTERNAL CXB_INLINE void xoshiro256x4_blocks(Xoshiro256x4& g, size_t n_blocks, F&& f) {
+    RngU64x4 s0, s1, s2, s3;
+    memcpy(&s0, g.s[0], sizeof(s0));
+    memcpy(&s1, g.s[1], sizeof(s1));
+    memcpy(&s2, g.s[2], sizeof(s2));
+    memcpy(&s3, g.s[3], sizeof(s3));
+    for(size_t i = 0; i < n_blocks; ++i) {
+        RngU64x4 x = s0 + s3;
+        RngU64x4 result = ((x << 23) | (x >> 41)) + s0;
+        RngU64x4 t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = (s3 << 45) | (s3 >> 19);
+        f(i, result);
+    }
+    memcpy(g.s[0], &s0, sizeof(s0));
+    memcpy(g.s[1], &s1, sizeof(s1));
+    memcpy(g.s[2], &s2, sizeof(s2));
+    memcpy(g.s[3], &s3, sizeof(s3));
+}
+
+// fills n_bytes with blocks of 32 bytes, the last one partially
+INTERNAL void xoshiro256x4_fill_bytes(Xoshiro256x4& g, u8* out, size_t n_bytes) {
+    size_t n_blocks = n_bytes / sizeof(RngU64x4);
+    xoshiro256x4_blocks(g, n_blocks, [&](size_t i, const RngU64x4& block) {
+        memcpy(out + i * sizeof(block), &block, sizeof(block));
+    });
+    size_t rest = n_bytes % sizeof(RngU64x4);
+    if(rest) {
+        xoshiro256x4_blocks(g, 1, [&](size_t, const RngU64x4& block) {
+            memcpy(out + n_blocks * sizeof(block), &block, rest);
+        });
+    }
+}
+
+void rng_fill_u64(Xoshiro256x4& g, Array<u64> xs) {
+    xoshiro256x4_fill_bytes(g, (u8*) xs.data, xs.len * sizeof(u64));
+}
+
+void rng_fill_u32(Xoshiro256x4& g, Array<u32> xs) {
+    xoshiro256x4_fill_bytes(g, (u8*) xs.data, xs.len * sizeof(u32));
+}
+
+void rng_fill_f32(Xoshiro256x4& g, Array<f32> xs) {
+    // same bits as rng_fill_u32: xs[k] is (k-th u32 >> 8) * 2^-24, exact in a f32
+    auto to_f32 = [](const RngU64x4& block, RngF32x8* y) {
+        RngI32x8 x = (RngI32x8) ((RngU32x8) block >> 8);
+        *y = __builtin_convertvector(x, RngF32x8) * 0x1p-24f;
+    };
+    size_t n_blocks = xs.len / 8;
+    xoshiro256x4_blocks(g, n_blocks, [&](size_t i, const RngU64x4& block) {
+        RngF32x8 y;
+        to_f32(block, &y);
+        memcpy(xs.data + i * 8, &y, sizeof(y));
+    });
+    size_t rest = xs.len % 8;
+    if(rest) {
+        xoshiro256x4_blocks(g, 1, [&](size_t, const RngU64x4& block) {
+            RngF32x8 y;
+            to_f32(block, &y);
+            memcpy(xs.data + n_blocks * 8, &y, rest * sizeof(f32));
+        });
+    }
+}
+
+void rng_fill_bounded_u32(Xoshiro256x4& g, Array<u32> xs, u32 n) {
+    DEBUG_ASSERT(n > 0, "empty range");
+    constexpr size_t CHUNK = 1024;
+    u32 t = (0u - n) % n;
+    u32 bits[CHUNK];
+    u32 spare[8];
+    u32 n_spare = 0;
+    for(size_t start = 0; start < xs.len; start += CHUNK) {
+        size_t len = xs.len - start < CHUNK ? xs.len - start : CHUNK;
+        u32* out = xs.data + start;
+        rng_fill_u32(g, Array<u32>{bits, len});
+
+        // branch free multiply-shift, vectorized (a bool flag is not), then the (rare) rejected values are redrawn
+        u32 any_rejected = 0;
+        for(size_t i = 0; i < len; ++i) {
+            u64 m = (u64) bits[i] * n;
+            any_rejected |= (u32) m < t ? 1 : 0;
+            out[i] = (u32) (m >> 32);
+        }
+        if(LIKELY(!any_rejected)) continue;
+
+        for(size_t i = 0; i < len; ++i) {
+            u64 m = (u64) bits[i] * n;
+            while((u32) m < t) {
+                if(n_spare == 0) {
+                    rng_fill_u32(g, Array<u32>{spare, 8});
+                    n_spare = 8;
+                }
+                n_spare -= 1;
+                m = (u64) spare[n_spare] * n;
+            }
+            out[i] = (u32) (m >> 32);
+        }
+    }
+}
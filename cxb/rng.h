@@ -0,0 +1,250 @@
+/*
+# cxb/rng: fast non-cryptographic random number generators
+
+* `Xoshiro256` (xoshiro256++): 256 bits of state, period 2^256 - 1, the default
+    - `xoshiro256_jump` advances 2^128 outputs, `xoshiro256_long_jump` 2^192: `xoshiro256_stream(seed, i)` is the
+      i-th of 2^64 non-overlapping streams of 2^192 outputs, e.g. one per thread
+* `WyRand`: 64 bits of state, period 2^64, the fastest scalar generator. `wyrand_advance` skips n outputs in O(1),
+  `wyrand_stream(seed, i)` is the i-th of 2^16 non-overlapping streams of 2^48 outputs
+* `Pcg32` (PCG-XSH-RR): 32-bit outputs, 2^63 streams selected by the increment, `pcg32_make(seed, stream)` is the
+  reference `pcg32_srandom_r`. `pcg32_advance` skips n outputs in O(log n)
+* xoshiro256 and wyrand seeds are expanded with splitmix64, any seed (including 0) is fine
+* for any generator `g`:
+    - `rng_u64(g)`, `rng_u32(g)`: uniform bits
+    - `rng_bounded_u32(g, n)`, `rng_bounded_u64(g, n)`: unbiased in [0, n) with Lemire's multiply-shift, a division
+      only when the rare rejection path is taken. `rng_range(g, lo, hi)`: unbiased in [lo, hi]
+    - `rng_f64(g)`, `rng_f32(g)`: uniform in [0, 1) from the top 53 (24) bits, `rng_uniform(g, lo, hi)`
+    - `rng_normal(g, mean, sd)` (Box-Muller, two uniforms per value), `rng_lognormal(g, mu, sigma)`
+* the generators are UniformRandomBitGenerators: they work with std::shuffle and <random>'s distributions
+* `Xoshiro256x4` runs 4 xoshiro256++ streams (a jump apart) in SIMD lanes, `rng_fill_*` fill arrays in batches:
+  `rng_fill_u64`, `rng_fill_u32`, `rng_fill_f32`, `rng_fill_bounded_u32`. Values are written in blocks of 4 u64:
+  `xs[4 * i + j]` is the i-th output of lane j, the unused rest of a partial last block is discarded
+
+```
+Xoshiro256 rng = xoshiro256_make(42);
+u32 die = rng_bounded_u32(rng, 6) + 1;
+f64 x = rng_uniform(rng, -1.0, 1.0);
+
+Xoshiro256x4 batch = xoshiro256x4_make(42, thread_index);
+rng_fill_f32(batch, arena_push_array<f32>(arena, 1 << 20));
+```
+
+NOTE: none of these are suitable for cryptography.
+*/
+#ifndef CXB_RNG_H
+#define CXB_RNG_H
+
+#include "array.h"
+
+#include <math.h>
+
+CXB_INLINE u64 splitmix64(u64& state) {
+    u64 z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+CXB_INLINE u64 rotl64(u64 x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+CXB_INLINE u32 rotr32(u32 x, u32 k) {
+    return (x >> k) | (x << ((0u - k) & 31));
+}
+
+struct Xoshiro256 {
+    u64 s[4];
+
+    using result_type = u64;
+    static constexpr u64 min() {
+        return 0;
+    }
+    static constexpr u64 max() {
+        return UINT64_MAX;
+    }
+    u64 operator()();
+};
+
+struct WyRand {
+    u64 state;
+
+    using result_type = u64;
+    static constexpr u64 min() {
+        return 0;
+    }
+    static constexpr u64 max() {
+        return UINT64_MAX;
+    }
+    u64 operator()();
+};
+
+struct Pcg32 {
+    u64 state;
+    u64 inc; // odd, selects the stream
+
+    using result_type = u32;
+    static constexpr u32 min() {
+        return 0;
+    }
+    static constexpr u32 max() {
+        return UINT32_MAX;
+    }
+    u32 operator()();
+};
+
+struct Xoshiro256x4 {
+    alignas(32) u64 s[4][4]; // s[word][lane]
+};
+
+/* SECTION: xoshiro256++ */
+Xoshiro256 xoshiro256_make(u64 seed);
+Xoshiro256 xoshiro256_stream(u64 seed, u64 stream);
+void xoshiro256_jump(Xoshiro256& g);
+void xoshiro256_long_jump(Xoshiro256& g);
+
+CXB_INLINE u64 rng_u64(Xoshiro256& g) {
+    u64* s = g.s;
+    u64 result = rotl64(s[0] + s[3], 23) + s[0];
+    u64 t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+    return result;
+}
+
+CXB_INLINE u32 rng_u32(Xoshiro256& g) {
+    return (u32) (rng_u64(g) >> 32);
+}
+
+inline u64 Xoshiro256::operator()() {
+    return rng_u64(*this);
+}
+
+/* SECTION: wyrand */
+constexpr u64 WYRAND_INCREMENT = 0xa0761d6478bd642full;
+
+CXB_INLINE WyRand wyrand_make(u64 seed) {
+    return WyRand{splitmix64(seed)};
+}
+
+CXB_INLINE void wyrand_advance(WyRand& g, u64 n) {
+    g.state += n * WYRAND_INCREMENT;
+}
+
+CXB_INLINE WyRand wyrand_stream(u64 seed, u64 stream) {
+    WyRand g = wyrand_make(seed);
+    wyrand_advance(g, stream << 48);
+    return g;
+}
+
+CXB_INLINE u64 rng_u64(WyRand& g) {
+    g.state += WYRAND_INCREMENT;
+    u128 m = (u128) g.state * (g.state ^ 0xe7037ed1a0b428dbull);
+    return (u64) (m >> 64) ^ (u64) m;
+}
+
+CXB_INLINE u32 rng_u32(WyRand& g) {
+    return (u32) (rng_u64(g) >> 32);
+}
+
+inline u64 WyRand::operator()() {
+    return rng_u64(*this);
+}
+
+/* SECTION: pcg32 */
+constexpr u64 PCG32_MULTIPLIER = 6364136223846793005ull;
+
+Pcg32 pcg32_make(u64 seed, u64 stream = 0);
+void pcg32_advance(Pcg32& g, u64 n);
+
+CXB_INLINE u32 rng_u32(Pcg32& g) {
+    u64 old = g.state;
+    g.state = old * PCG32_MULTIPLIER + g.inc;
+    u32 xorshifted = (u32) (((old >> 18) ^ old) >> 27);
+    return rotr32(xorshifted, (u32) (old >> 59));
+}
+
+CXB_INLINE u64 rng_u64(Pcg32& g) {
+    u64 hi = rng_u32(g);
+    return (hi << 32) | rng_u32(g);
+}
+
+inline u32 Pcg32::operator()() {
+    return rng_u32(*this);
+}
+
+/* SECTION: distributions */
+template <typename G>
+CXB_INLINE u32 rng_bounded_u32(G& g, u32 n) {
+    DEBUG_ASSERT(n > 0, "empty range");
+    u64 m = (u64) rng_u32(g) * n;
+    if(UNLIKELY((u32) m < n)) {
+        // reject the 2^32 mod n lowest products, they would bias the low results
+        u32 t = (0u - n) % n;
+        while((u32) m < t) m = (u64) rng_u32(g) * n;
+    }
+    return (u32) (m >> 32);
+}
+
+template <typename G>
+CXB_INLINE u64 rng_bounded_u64(G& g, u64 n) {
+    DEBUG_ASSERT(n > 0, "empty range");
+    u128 m = (u128) rng_u64(g) * n;
+    if(UNLIKELY((u64) m < n)) {
+        u64 t = (0ull - n) % n;
+        while((u64) m < t) m = (u128) rng_u64(g) * n;
+    }
+    return (u64) (m >> 64);
+}
+
+template <typename G>
+CXB_INLINE i64 rng_range(G& g, i64 lo, i64 hi) {
+    DEBUG_ASSERT(lo <= hi, "empty range");
+    u64 span = (u64) hi - (u64) lo + 1;
+    // span == 0: the full i64 range
+    u64 x = span == 0 ? rng_u64(g) : span <= UINT32_MAX ? rng_bounded_u32(g, (u32) span) : rng_bounded_u64(g, span);
+    return (i64) ((u64) lo + x);
+}
+
+template <typename G>
+CXB_INLINE f64 rng_f64(G& g) {
+    return (f64) (rng_u64(g) >> 11) * 0x1p-53;
+}
+
+template <typename G>
+CXB_INLINE f32 rng_f32(G& g) {
+    return (f32) (rng_u32(g) >> 8) * 0x1p-24f;
+}
+
+template <typename G>
+CXB_INLINE f64 rng_uniform(G& g, f64 lo, f64 hi) {
+    return lo + (hi - lo) * rng_f64(g);
+}
+
+template <typename G>
+CXB_INLINE f64 rng_normal(G& g, f64 mean = 0.0, f64 sd = 1.0) {
+    // u in (0, 1]: log(0) is -inf
+    f64 u = 1.0 - rng_f64(g);
+    f64 v = rng_f64(g);
+    return mean + sd * sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
+
+// exp of a normal with mean mu and standard deviation sigma, i.e. std::lognormal_distribution(mu, sigma)
+template <typename G>
+CXB_INLINE f64 rng_lognormal(G& g, f64 mu, f64 sigma) {
+    return exp(rng_normal(g, mu, sigma));
+}
+
+/* SECTION: batches */
+// lane j is xoshiro256_stream(seed, stream) after j jumps
+Xoshiro256x4 xoshiro256x4_make(u64 seed, u64 stream = 0);
+void rng_fill_u64(Xoshiro256x4& g, Array<u64> xs);
+void rng_fill_u32(Xoshiro256x4& g, Array<u32> xs);
+void rng_fill_f32(Xoshiro256x4& g, Array<f32> xs);
+void rng_fill_bounded_u32(Xoshiro256x4& g, Array<u32> xs, u32 n);
+
+#endif /* CXB_RNG_H */
@@ -0,0 +1,66 @@
+#include "serialize.h"
+
+void _serial_write_varint_slow(Arena* a, String8& dst, u64 x) {
+    char buf[10];
+    size_t n = 0;
+    while(x >= 0x80) {
+        buf[n++] = (char) ((x & 0x7f) | 0x80);
+        x >>= 7;
+    }
+    buf[n++] = (char) x;
+    serial_write_bytes(a, dst, buf, n);
+}
+
+u64 _serial_read_varint_slow(SerialReader& r) {
+    u64 x = 0;
+    for(u32 shift = 0; shift < 64; shift += 7) {
+        const char* b = serial_read_bytes(r, 1);
+        if(UNLIKELY(!b)) {
+            return 0;
+        }
+        u8 byte = (u8) *b;
+        x |= (u64) (byte & 0x7f) << shift;
+        if(!(byte & 0x80)) {
+            return x;
+        }
+    }
+    // more than 10 bytes, not a valid u64
+    r.failed = true;
+    return 0;
+}
+
+Allocator* serial_reader_alloc(Arena* a, SerialReader& r) {
+    if(UNLIKELY(!r.alloc)) {
+        r.alloc = push_arena_alloc(a);
+    }
+    return r.alloc;
+}
+
+void serialize_value(Arena* a, String8& dst, const String8& x) {
+    serial_write_varint(a, dst, x.len);
+    serial_write_bytes(a, dst, x.data, x.len);
+}
+
+void deserialize_value(Arena* a, SerialReader& r, String8& x) {
+    (void) a;
+    size_t len = serial_read_len(r, 1);
+    const char* data = serial_read_bytes(r, len);
+    x = String8{.data = (char*) data, .len = data ? len : 0, .not_null_term = true};
+}
+
+void serialize_value(Arena* a, String8& dst, const MString8& x) {
+    serial_write_varint(a, dst, x.len);
+    serial_write_bytes(a, dst, x.data, x.len);
+}
+
+// NOTE: the result is a view of the input, it has no allocator and must be copied to be modified
+void deserialize_value(Arena* a, SerialReader& r, MString8& x) {
+    String8 s = {};
+    deserialize_value(a, r, s);
+    x.destroy();
+    x.data = s.data;
+    x.len = s.len;
+    x.not_null_term = true;
+    x.capacity = 0;
+    x.allocator = nullptr;
+}
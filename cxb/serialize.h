@@ -0,0 +1,276 @@
+/*
+# cxb/serialize: compact binary serialization
+
+* `serialize(arena, x)` appends the encoding of `x` to a `String8` allocated on `arena`
+* `deserialize<T>(arena, bytes)` decodes a `T`, containers are allocated on `arena`
+
+Encoding:
+* lengths are unsigned LEB128 varints
+* scalars (`SerializePod<T>`: arithmetic types but bool, and enum types by default) are their native bytes, the
+  encoding assumes a little-endian host. Enums are read as any value of their underlying type: give them a fixed
+  one (`enum class E` or `enum E : u8`)
+* bools are a byte, 0 or 1
+* arrays of `SerializePod` elements are a length followed by a single `memcpy` of the elements
+* strings are a length followed by their bytes, decoded strings point into the input buffer (zero-copy), i.e. the
+  input must outlive the decoded value. They are not null terminated (`not_null_term`)
+* hash maps are a length followed by key/value pairs
+
+To serialize your own type T, provide overloaded versions of:
+
+void serialize_value(Arena* a, String8& dst, const T& x);
+void deserialize_value(Arena* a, SerialReader& src, T& x);
+
+or, if T is trivially copyable and holds no pointers, specialize `SerializePod<T>` to std::true_type.
+`deserialize_value` does not return errors, a failed read (truncated input or an invalid value) marks `src.failed` and
+leaves `x` zeroed, such that implementations can read all fields unconditionally.
+*/
+#ifndef CXB_SERIALIZE_H
+#define CXB_SERIALIZE_H
+
+#include "hashmap.h"
+#include "string8.h"
+
+#include <bit>
+
+static_assert(std::endian::native == std::endian::little, "the encoding of SerializePod types is little-endian");
+
+/* SECTION: errors */
+enum class SerializeErr {
+    Success = 0,
+    Truncated = 1, // also an invalid value, e.g. a bool byte other than 0 or 1
+    TrailingBytes = 2,
+    Cnt,
+};
+
+// NOTE: not bool, a byte other than 0 or 1 is not a valid bool
+template <typename T>
+struct SerializePod
+    : std::bool_constant<(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>> {};
+
+struct SerialReader {
+    String8 src;
+    size_t pos;
+    bool failed;
+    Allocator* alloc; // arena allocator for containers, created on first use
+};
+
+/* SECTION: primitives */
+CXB_INLINE void serial_write_bytes(Arena* a, String8& dst, const void* data, size_t n) {
+    if(n == 0) return;
+    DEBUG_ASSERT(dst.data == nullptr || (void*) (dst.data + dst.len) == (void*) (a->start + a->pos),
+                 "cannot serialize unless dst is at the end of the arena");
+    // NOTE: serialization is a stream of small writes, avoid the call
+    char* out = (char*) arena_push_bytes_inline(a, n, 1);
+    dst.data = UNLIKELY(dst.data == nullptr) ? out : dst.data;
+    memcpy(out, data, n);
+    dst.len += n;
+}
+
+void _serial_write_varint_slow(Arena* a, String8& dst, u64 x);
+CXB_INLINE void serial_write_varint(Arena* a, String8& dst, u64 x) {
+    if(LIKELY(x < 0x80)) {
+        char byte = (char) x;
+        serial_write_bytes(a, dst, &byte, 1);
+    } else {
+        _serial_write_varint_slow(a, dst, x);
+    }
+}
+
+// returns nullptr and marks the reader as failed if fewer than n bytes remain
+CXB_INLINE const char* serial_read_bytes(SerialReader& r, size_t n) {
+    if(UNLIKELY(r.failed || n > r.src.len - r.pos)) {
+        r.failed = true;
+        return nullptr;
+    }
+    const char* data = r.src.data + r.pos;
+    r.pos += n;
+    return data;
+}
+
+u64 _serial_read_varint_slow(SerialReader& r);
+CXB_INLINE u64 serial_read_varint(SerialReader& r) {
+    if(LIKELY(!r.failed && r.pos < r.src.len && !(r.src.data[r.pos] & 0x80))) {
+        return (u8) r.src.data[r.pos++];
+    }
+    return _serial_read_varint_slow(r);
+}
+Allocator* serial_reader_alloc(Arena* a, SerialReader& r);
+
+// reads a length and checks it against the remaining input, such that corrupt input can not cause huge allocations
+CXB_INLINE size_t serial_read_len(SerialReader& r, size_t min_elem_bytes) {
+    u64 n = serial_read_varint(r);
+    if(UNLIKELY(min_elem_bytes > 0 && n > (r.src.len - r.pos) / min_elem_bytes)) {
+        r.failed = true;
+        return 0;
+    }
+    return (size_t) n;
+}
+
+/* SECTION: scalars */
+template <typename T>
+std::enable_if_t<SerializePod<T>::value, void> serialize_value(Arena* a, String8& dst, const T& x) {
+    serial_write_bytes(a, dst, &x, sizeof(T));
+}
+
+template <typename T>
+std::enable_if_t<SerializePod<T>::value, void> deserialize_value(Arena* a, SerialReader& r, T& x) {
+    (void) a;
+    const char* data = serial_read_bytes(r, sizeof(T));
+    if(LIKELY(data)) {
+        memcpy(&x, data, sizeof(T));
+    } else {
+        x = T{};
+    }
+}
+
+CXB_INLINE void serialize_value(Arena* a, String8& dst, const bool& x) {
+    u8 byte = x ? 1 : 0;
+    serial_write_bytes(a, dst, &byte, 1);
+}
+
+CXB_INLINE void deserialize_value(Arena* a, SerialReader& r, bool& x) {
+    (void) a;
+    const char* data = serial_read_bytes(r, 1);
+    if(UNLIKELY(data && (u8) *data > 1)) r.failed = true;
+    x = data && *data == 1;
+}
+
+/* SECTION: strings */
+void serialize_value(Arena* a, String8& dst, const String8& x);
+void deserialize_value(Arena* a, SerialReader& r, String8& x);
+void serialize_value(Arena* a, String8& dst, const MString8& x);
+void deserialize_value(Arena* a, SerialReader& r, MString8& x);
+
+/* SECTION: arrays */
+template <typename T>
+void _serialize_elems(Arena* a, String8& dst, const T* data, size_t len) {
+    serial_write_varint(a, dst, len);
+    if constexpr(SerializePod<T>::value) {
+        serial_write_bytes(a, dst, data, len * sizeof(T));
+    } else {
+        for(size_t i = 0; i < len; ++i) {
+            serialize_value(a, dst, data[i]);
+        }
+    }
+}
+
+template <typename T>
+T* _deserialize_elems(Arena* a, SerialReader& r, size_t* out_len) {
+    size_t len = serial_read_len(r, SerializePod<T>::value ? sizeof(T) : 1);
+    *out_len = 0;
+    if(r.failed || len == 0) {
+        return nullptr;
+    }
+
+    T* data = arena_push<T>(a, len);
+    if constexpr(SerializePod<T>::value) {
+        memcpy((void*) data, serial_read_bytes(r, len * sizeof(T)), len * sizeof(T));
+    } else {
+        for(size_t i = 0; i < len; ++i) {
+            deserialize_value(a, r, data[i]);
+            // NOTE: the elements read so far stay on the arena, a later allocation (e.g. r.alloc) may follow them
+            if(UNLIKELY(r.failed)) return nullptr;
+        }
+    }
+    *out_len = len;
+    return data;
+}
+
+template <typename T>
+void serialize_value(Arena* a, String8& dst, const Array<T>& xs) {
+    _serialize_elems(a, dst, xs.data, xs.len);
+}
+
+template <typename T>
+void deserialize_value(Arena* a, SerialReader& r, Array<T>& xs) {
+    size_t len = 0;
+    T* data = _deserialize_elems<T>(a, r, &len);
+    xs = Array<T>(data, len); // NOTE: not braces, {data, len} is an initializer_list of T = bool
+}
+
+template <typename T>
+void serialize_value(Arena* a, String8& dst, const MArray<T>& xs) {
+    _serialize_elems(a, dst, xs.data, xs.len);
+}
+
+// NOTE: the result is backed by `a`, it can grow but its memory is only released with the arena
+template <typename T>
+void deserialize_value(Arena* a, SerialReader& r, MArray<T>& xs) {
+    size_t len = 0;
+    T* data = _deserialize_elems<T>(a, r, &len);
+    xs.destroy();
+    xs.data = data;
+    xs.len = len;
+    xs.capacity = len;
+    xs.allocator = serial_reader_alloc(a, r);
+}
+
+/* SECTION: hash maps */
+template <typename K, typename V>
+void serialize_value(Arena* a, String8& dst, const KvPair<K, V>& kv) {
+    serialize_value(a, dst, kv.key);
+    serialize_value(a, dst, kv.value);
+}
+
+template <typename K, typename V>
+void deserialize_value(Arena* a, SerialReader& r, KvPair<K, V>& kv) {
+    deserialize_value(a, r, kv.key);
+    deserialize_value(a, r, kv.value);
+}
+
+template <typename K, typename V, typename H>
+void serialize_value(Arena* a, String8& dst, const MHashMap<K, V, H>& hm) {
+    serial_write_varint(a, dst, hm.len);
+    for(const auto& entry : hm.table) {
+        if(entry.state == HM_STATE_OCCUPIED) {
+            serialize_value(a, dst, entry.kv);
+        }
+    }
+}
+
+template <typename K, typename V, typename H>
+void deserialize_value(Arena* a, SerialReader& r, MHashMap<K, V, H>& hm) {
+    size_t len = serial_read_len(r, 1);
+    hm.destroy();
+    hm.table = {};
+    hm.len = 0;
+    hm.n_tombstones = 0;
+    hm.allocator = serial_reader_alloc(a, r);
+    if(len == 0) return;
+
+    hm.reserve(len * 2);
+    for(size_t i = 0; i < len; ++i) {
+        KvPair<K, V> kv = {};
+        deserialize_value(a, r, kv);
+        if(UNLIKELY(r.failed)) {
+            hm.destroy();
+            return;
+        }
+        hm.put(kv);
+    }
+}
+
+/* SECTION: API */
+template <typename T>
+String8 serialize(Arena* a, const T& x) {
+    String8 dst = {.data = nullptr, .len = 0, .not_null_term = true};
+    serialize_value(a, dst, x);
+    return dst;
+}
+
+template <typename T>
+Result<T, SerializeErr> deserialize(Arena* a, String8 src) {
+    Result<T, SerializeErr> result = {};
+    SerialReader r = {.src = src, .pos = 0, .failed = false, .alloc = nullptr};
+    deserialize_value(a, r, result.value);
+    if(r.failed) {
+        result.error = SerializeErr::Truncated;
+        result.reason = S8_LIT("input ended before the value was complete or holds an invalid value");
+    } else if(r.pos != src.len) {
+        result.error = SerializeErr::TrailingBytes;
+        result.reason = S8_LIT("input has bytes after the value");
+    }
+    return result;
+}
+
+#endif /* CXB_SERIALIZE_H */
@@ -0,0 +1,735 @@
+/*
+# cxb/string8: strings
+
+* `String8`: a view of `data` and `len`, with a flag (`not_null_term`) to indicate if the string is null-terminated.
+  Arena UFCS (`s.push_back(arena, c)`), find/trim/split and `string8_parse<T>`
+* `MString8`: a manually managed string given an `Allocator`, `AString8`: the RAII version
+* `Optional<T>`, `Result<T, EC>`, `ParseResult<T>`
+* `S8_LIT`, `S8_CSTR`, `"..."_s8`
+*/
+#ifndef CXB_STRING8_H
+#define CXB_STRING8_H
+
+#include "array.h"
+
+String8 arena_push_string8(Arena* arena, size_t n = 1);
+String8 arena_push_string8(Arena* arena, String8 to_copy);
+void string8_resize(String8& str, Arena* arena, size_t n, char fill_char = '\0');
+void string8_push_back(String8& str, Arena* arena, char ch);
+void string8_pop_back(String8& str, Arena* arena);
+void string8_pop_all(String8& str, Arena* arena);
+void string8_insert(String8& str, Arena* arena, char ch, size_t i);
+void string8_insert(String8& str, Arena* arena, String8 to_insert, size_t i);
+void string8_extend(String8& str, Arena* arena, String8 to_append);
+CXB_PURE bool string8_contains(const String8& s, String8 needle);
+CXB_PURE bool string8_contains_chars(const String8& s, String8 chars);
+CXB_PURE size_t string8_find(const String8& s, String8 needle);
+CXB_PURE String8 string8_trim(const String8& s, String8 chars, bool leading = true, bool trailing = true);
+CXB_PURE String8 string8_trim_all(const String8& s, String8 chars, bool leading = true, bool trailing = true);
+CXB_PURE bool string8_starts_with(const String8& s, String8 prefix);
+CXB_PURE bool string8_ends_with(const String8& s, String8 suffix);
+
+/* SECTION: basic types */
+CXB_C_TYPE struct String8 {
+    CXB_C_COMPAT_BEGIN
+    char* data;
+    union {
+        struct {
+            size_t len : 63;
+            bool not_null_term : 1;
+        };
+        size_t metadata;
+    };
+    CXB_C_COMPAT_END
+
+    // ** SECTION: slice compatible methods
+    inline size_t n_bytes() const {
+        return len + !not_null_term;
+    }
+    inline size_t size() const {
+        return len;
+    }
+    inline bool empty() const {
+        return len == 0;
+    }
+    inline char& operator[](size_t idx) {
+        return data[idx];
+    }
+    inline const char& operator[](size_t idx) const {
+        return data[idx];
+    }
+    inline char& back() {
+        return data[len - 1];
+    }
+    inline String8 slice(i64 i = 0, i64 j = -1) const {
+        if(!data) {
+            return {};
+        }
+        i64 ii = clamp(i < 0 ? (i64) len + i : i, (i64) 0, len == 0 ? 0 : (i64) len - 1);
+        i64 jj = clamp(j < 0 ? (i64) len + j : j, (i64) 0, len == 0 ? 0 : (i64) len - 1);
+
+        String8 c = *this;
+        c.data = c.data + ii;
+        c.len = max<i64>(0, jj - ii + 1);
+        c.not_null_term = ii + c.len == len ? this->not_null_term : true;
+        return c;
+    }
+
+    inline const char* c_str() const {
+        return not_null_term ? nullptr : data;
+    }
+
+    inline const char* c_str_maybe_copy(Arena* a) const {
+        if(not_null_term) {
+            char* new_data = arena_push_fast<char>(a, len + 1);
+            ::copy(new_data, data, len);
+            new_data[len] = '\0';
+            return new_data;
+        }
+        return data;
+    }
+
+    inline int compare(const String8& o) const {
+        int result = memcmp(data, o.data, len < o.len ? len : o.len);
+        if(result == 0) {
+            return len - o.len;
+        }
+        return result;
+    }
+
+    inline bool operator==(const String8& o) const {
+        return compare(o) == 0;
+    }
+
+    inline bool operator!=(const String8& o) const {
+        return !(*this == o);
+    }
+
+    inline bool operator<(const String8& o) const {
+        size_t n = len < o.len ? len : o.len;
+        int cmp = memcmp(data, o.data, n);
+        if(cmp < 0) return true;
+        if(cmp > 0) return false;
+        return len < o.len;
+    }
+
+    inline bool operator>(const String8& o) const {
+        return o < *this;
+    }
+
+    CXB_INLINE bool contains(String8 needle) const {
+        return string8_contains(*this, needle);
+    }
+    CXB_INLINE bool contains_chars(String8 chars) const {
+        return string8_contains_chars(*this, chars);
+    }
+    CXB_INLINE size_t find(String8 needle) const {
+        return string8_find(*this, needle);
+    }
+    CXB_INLINE bool starts_with(String8 prefix) const {
+        return string8_starts_with(*this, prefix);
+    }
+    CXB_INLINE bool ends_with(String8 suffix) const {
+        return string8_ends_with(*this, suffix);
+    }
+    CXB_INLINE String8 trim(String8 chars, bool leading = true, bool trailing = true) const {
+        return string8_trim(*this, chars, leading, trailing);
+    }
+    CXB_INLINE String8 trim_all(String8 chars, bool leading = true, bool trailing = true) const {
+        return string8_trim_all(*this, chars, leading, trailing);
+    }
+    CXB_INLINE String8 trim_left(String8 chars) const {
+        return string8_trim(*this, chars, true, false);
+    }
+    CXB_INLINE String8 trim_right(String8 chars) const {
+        return string8_trim(*this, chars, false, true);
+    }
+    CXB_INLINE String8 trim_all_left(String8 chars) const {
+        return string8_trim_all(*this, chars, true, false);
+    }
+    CXB_INLINE String8 trim_all_right(String8 chars) const {
+        return string8_trim_all(*this, chars, false, true);
+    }
+
+    // ** SECTION: arena UFCS
+    CXB_INLINE void resize(Arena* arena, size_t n, char fill_char = '\0') {
+        string8_resize(*this, arena, n, fill_char);
+    }
+    CXB_INLINE void push_back(Arena* arena, char ch) {
+        string8_push_back(*this, arena, ch);
+    }
+    CXB_INLINE void pop_back(Arena* arena) {
+        string8_pop_back(*this, arena);
+    }
+    CXB_INLINE void pop_all(Arena* arena) {
+        string8_pop_all(*this, arena);
+    }
+    CXB_INLINE void insert(Arena* arena, char ch, size_t i) {
+        string8_insert(*this, arena, ch, i);
+    }
+    CXB_INLINE void insert(Arena* arena, String8 to_insert, size_t i) {
+        string8_insert(*this, arena, to_insert, i);
+    }
+    CXB_INLINE void extend(Arena* arena, String8 to_append) {
+        string8_extend(*this, arena, to_append);
+    }
+
+    CXB_INLINE String8SplitIterator split(String8 delim) const;
+    CXB_INLINE String8SplitIterator split_any(String8 chars) const;
+
+    // *SECTION*: parsing
+    template <typename T>
+    CXB_INLINE std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>, ParseResult<T>> parse(
+        u64 base = 10) const {
+        return string8_parse<T>(*this, base);
+    }
+};
+
+/* SECTION: variant types */
+template <typename T>
+struct Optional {
+    T value;
+    bool exists;
+
+    inline operator bool() const {
+        return exists;
+    }
+};
+
+template <typename T, typename EC>
+struct Result {
+    T value;
+    EC error;
+    String8 reason;
+
+    inline operator bool() const {
+        return (i64) error != 0;
+    }
+};
+
+// TODO: Result<T> ?
+template <typename T>
+struct ParseResult {
+    T value;
+    bool exists;
+    size_t n_consumed;
+
+    inline operator bool() const {
+        return exists;
+    }
+};
+
+template <typename T>
+inline std::enable_if_t<std::is_integral_v<T>, ParseResult<T>> string8_parse(String8 str, u64 base = 10) {
+    ASSERT(base <= 10, "TODO: support bases > 10");
+    ParseResult<T> result = {.value = {}, .exists = str.len > 0, .n_consumed = 0};
+    u64 num_negs = 0;
+    for(u64 i = 0; i < str.len; ++i) {
+        if(str[i] == '-') {
+            num_negs += 1;
+            result.value *= -1;
+            result.n_consumed += 1;
+            continue;
+            // TODO: support other bases
+        } else if(str[i] >= '0' && str[i] <= '9') {
+            result.value *= base;
+            result.value += str[i] - '0';
+            result.n_consumed += 1;
+        } else {
+            break;
+        }
+    }
+    if constexpr(std::is_unsigned_v<T>) {
+        if(num_negs > 0) result.exists = false;
+    } else {
+        if(num_negs > 1) result.exists = false;
+    }
+    result.exists = result.n_consumed > 0;
+    return result;
+}
+
+template <typename T>
+inline std::enable_if_t<std::is_floating_point_v<T>, ParseResult<T>> string8_parse(String8 str, u64 base = 10) {
+    ASSERT(base == 10, "only base 10 supported for floats");
+    ParseResult<T> result = {.value = {}, .exists = str.len > 0, .n_consumed = 0};
+
+    ArenaTmp tmp = begin_scratch();
+    result.value = atof(str.c_str_maybe_copy(tmp.arena));
+    result.n_consumed = str.len; // TODO
+    result.exists = true;
+    end_scratch(tmp);
+    return result;
+}
+
+template <typename T>
+template <typename U, typename>
+inline String8 Array<T>::as_string8(bool nt_len) const {
+    bool is_nt = (len > 0 && data[len - 1] == '\0');
+    return String8{.data = data, .len = len - (is_nt && nt_len), .not_null_term = !is_nt};
+}
+
+// *SECTION*: String8 splitting
+
+CXB_C_EXPORT bool string8_split_next(String8SplitIterator* iter, String8* out);
+Array<String8> string8_split_collect(Arena* arena, String8SplitIterator iter);
+
+CXB_C_TYPE struct String8SplitIterator {
+    CXB_C_COMPAT_BEGIN
+    String8 s;
+    String8 delim;
+    u64 pos;
+    String8 curr;
+    bool any;
+    CXB_C_COMPAT_END
+
+#ifdef __cplusplus
+    CXB_INLINE bool next(String8& out) {
+        bool has = string8_split_next(this, &out);
+        if(has) curr = out;
+        return has;
+    }
+    CXB_INLINE String8SplitIterator begin() {
+        string8_split_next(this, &curr);
+        return *this;
+    }
+    CXB_INLINE String8SplitIterator end() const {
+        return String8SplitIterator{.s = s, .delim = delim, .pos = s.len + 1, .curr = {}, .any = any};
+    }
+    CXB_INLINE bool operator!=(const String8SplitIterator& o) const {
+        return curr.data != o.curr.data;
+    }
+    CXB_INLINE String8 operator*() const {
+        return curr;
+    }
+    CXB_INLINE String8SplitIterator& operator++() {
+        if(!string8_split_next(this, &curr)) {
+            curr = {};
+            pos = s.len + 1;
+        }
+        return *this;
+    }
+    CXB_INLINE Array<String8> collect(Arena* arena) {
+        return string8_split_collect(arena, *this);
+    }
+#endif // __cplusplus
+};
+
+CXB_INLINE String8SplitIterator string8_split(String8 s, String8 delim) {
+    ASSERT(UNLIKELY(delim.len != 0), "delimiter is an empty string");
+    return String8SplitIterator{.s = s, .delim = delim, .pos = 0, .curr = {}, .any = false};
+}
+
+CXB_INLINE String8SplitIterator string8_split_any(String8 s, String8 chars) {
+    ASSERT(UNLIKELY(chars.len != 0), "delimiter is an empty string");
+    return String8SplitIterator{.s = s, .delim = chars, .pos = 0, .curr = {}, .any = true};
+}
+
+CXB_INLINE Array<String8> string8_split_collect(Arena* arena, String8SplitIterator iter) {
+    Array<String8> out{};
+    String8 part;
+    while(string8_split_next(&iter, &part)) {
+        array_push_back(out, arena, part);
+    }
+    return out;
+}
+
+CXB_INLINE String8SplitIterator String8::split(String8 delim) const {
+    return string8_split(*this, delim);
+}
+
+CXB_INLINE String8SplitIterator String8::split_any(String8 chars) const {
+    return string8_split_any(*this, chars);
+}
+
+/* SECTION: MString8, AString8 */
+CXB_C_TYPE struct MString8 {
+    CXB_C_COMPAT_BEGIN
+    char* data;
+    union {
+        struct {
+            size_t len : 63;
+            bool not_null_term : 1;
+        };
+        size_t metadata;
+    };
+    size_t capacity;
+    Allocator* allocator;
+    CXB_C_COMPAT_END
+
+    // ** SECTION: slice compatible methods - delegate to String8
+    inline size_t n_bytes() const {
+        return len + not_null_term;
+    }
+    inline size_t size() const {
+        return len;
+    }
+    inline bool empty() const {
+        return len == 0;
+    }
+    inline char& operator[](size_t idx) {
+        DEBUG_ASSERT(idx < len, "out of bounds: {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline const char& operator[](size_t idx) const {
+        DEBUG_ASSERT(idx < len, "out of bounds: {} >= {}", idx, len);
+        return data[idx];
+    }
+    inline char& back() {
+        DEBUG_ASSERT(len > 0, "empty string");
+        return data[len - 1];
+    }
+    inline operator String8() const {
+        return *reinterpret_cast<const String8*>(this);
+    }
+
+    inline String8 slice(i64 i = 0, i64 j = -1) const {
+        return reinterpret_cast<const String8*>(this)->slice(i, j);
+    }
+
+    inline const char* c_str() const {
+        return not_null_term ? nullptr : data;
+    }
+
+    inline bool operator==(const String8& o) const {
+        return reinterpret_cast<const String8*>(this)->operator==(o);
+    }
+
+    inline bool operator!=(const String8& o) const {
+        return !(*this == o);
+    }
+
+    inline int compare(const String8& o) const {
+        return reinterpret_cast<const String8*>(this)->compare(o);
+    }
+
+    inline bool operator<(const String8& o) const {
+        return reinterpret_cast<const String8*>(this)->operator<(o);
+    }
+
+    inline bool operator>(const String8& o) const {
+        return o < *this;
+    }
+
+    CXB_INLINE bool contains(String8 needle) const {
+        return reinterpret_cast<const String8*>(this)->contains(needle);
+    }
+    CXB_INLINE bool contains_chars(String8 chars) const {
+        return reinterpret_cast<const String8*>(this)->contains_chars(chars);
+    }
+    CXB_INLINE size_t find(String8 needle) const {
+        return reinterpret_cast<const String8*>(this)->find(needle);
+    }
+    CXB_INLINE String8 trim(String8 chars, bool leading = true, bool trailing = true) const {
+        return reinterpret_cast<const String8*>(this)->trim(chars, leading, trailing);
+    }
+
+    // ** SECTION: allocator-related methods - delegate to UString
+    inline MString8& copy_(Allocator* to_allocator = &heap_alloc) {
+        MString8 temp = *this;
+        *this = move(this->copy(to_allocator));
+        temp.destroy();
+        return *this;
+    }
+
+    CXB_ALLOC_ENTRY MString8 copy(Allocator* to_allocator = nullptr) {
+        CXB_ALLOC_SITE();
+        if(to_allocator == nullptr) to_allocator = allocator;
+        ASSERT(to_allocator != nullptr);
+
+        MString8 result{
+            .data = nullptr, .len = len, .not_null_term = not_null_term, .capacity = 0, .allocator = to_allocator};
+        if(len > 0) {
+            result.reserve(len + not_null_term);
+            memcpy(result.data, data, len);
+            if(!not_null_term) {
+                result.data[len] = '\0';
+            }
+        }
+        return result;
+    }
+
+    inline const char* c_str_maybe_copy(Allocator* copy_alloc_if_not) {
+        if(not_null_term) {
+            ensure_not_null_terminated(copy_alloc_if_not);
+        }
+        return data;
+    }
+
+    inline void destroy() {
+        if(data && allocator) {
+            allocator->free(data, capacity);
+            data = nullptr;
+            capacity = 0;
+        }
+    }
+
+    CXB_ALLOC_ENTRY void reserve(size_t cap) {
+        CXB_ALLOC_SITE();
+        ASSERT(allocator != nullptr);
+
+        size_t old_count = capacity;
+        size_t new_count = cap < CXB_STR_MIN_CAP ? CXB_STR_MIN_CAP : cap;
+        if(new_count > old_count) {
+            data = allocator->realloc(data, old_count, false, new_count);
+            capacity = new_count;
+        }
+    }
+
+    CXB_ALLOC_ENTRY void resize(size_t new_len, char fill_char = '\0') {
+        CXB_ALLOC_SITE();
+        ASSERT(UNLIKELY(allocator != nullptr));
+
+        size_t reserve_size = new_len + !not_null_term;
+        if(capacity < reserve_size) {
+            reserve(reserve_size);
+        }
+
+        size_t old_len = len;
+        if(fill_char != '\0' && new_len > old_len) {
+            memset(data + old_len, fill_char, new_len - old_len);
+        }
+        if(!not_null_term) {
+            data[new_len] = '\0';
+        }
+        len = new_len;
+    }
+
+    CXB_ALLOC_ENTRY void push_back(char ch) {
+        CXB_ALLOC_SITE();
+        if(n_bytes() + 1 >= capacity) {
+            reserve(CXB_STR_GROW_FN(capacity));
+        }
+        data[len] = ch;
+        len += 1;
+        not_null_term = !(!not_null_term || ch == '\0');
+        if(!not_null_term) {
+            data[len] = '\0';
+        }
+    }
+
+    CXB_ALLOC_ENTRY char& push() {
+        CXB_ALLOC_SITE();
+        push_back('\0');
+        return data[len - 1];
+    }
+
+    inline char pop_back() {
+        ASSERT(len > 0);
+        char ret = data[len - 1];
+        len--;
+        data[len] = '\0';
+        not_null_term = false;
+        return ret;
+    }
+
+    CXB_ALLOC_ENTRY void extend(String8 other) {
+        CXB_ALLOC_SITE();
+        if(other.len == 0) return;
+        reserve(len + other.len + !not_null_term);
+        memcpy(data + len, other.data, other.len);
+        len += other.len;
+        if(!not_null_term) {
+            data[len] = '\0';
+        }
+    }
+
+    CXB_ALLOC_ENTRY void operator+=(String8 other) {
+        CXB_ALLOC_SITE();
+        this->extend(other);
+    }
+
+    CXB_ALLOC_ENTRY void extend(const char* str, size_t n = SIZE_MAX) {
+        CXB_ALLOC_SITE();
+        if(!str) {
+            return;
+        }
+        size_t n_len = n == SIZE_MAX ? strlen(str) : n;
+        this->extend(String8{.data = const_cast<char*>(str), .len = n_len, .not_null_term = false});
+    }
+
+    inline void ensure_not_null_terminated(Allocator* copy_alloc_if_not = nullptr) {
+        if(!not_null_term) return;
+
+        ASSERT(allocator != nullptr || copy_alloc_if_not != nullptr);
+        if(allocator == nullptr) {
+            *this = move(this->copy(copy_alloc_if_not));
+        } else {
+            this->push_back('\0');
+        }
+    }
+};
+
+struct AString8 : MString8 {
+    AString8(Allocator* allocator = &heap_alloc)
+        : MString8{.data = nullptr, .len = 0, .not_null_term = false, .capacity = 0, .allocator = allocator} {}
+
+    AString8(const MString8& m)
+        : MString8{.data = m.data,
+                   .len = m.len,
+                   .not_null_term = m.not_null_term,
+                   .capacity = m.capacity,
+                   .allocator = m.allocator} {}
+
+    AString8(const char* cstr, size_t n = SIZE_MAX, bool not_null_term = false, Allocator* allocator = &heap_alloc)
+        : MString8{.data = nullptr,
+                   .len = n == SIZE_MAX ? strlen(cstr) : n,
+                   .not_null_term = not_null_term,
+                   .capacity = 0,
+                   .allocator = allocator} {
+        if(this->allocator == nullptr) {
+            data = const_cast<char*>(cstr);
+        } else {
+            reserve(len + 1);
+            if(len > 0) {
+                memcpy(data, cstr, len);
+            }
+            data[len] = '\0';
+        }
+    }
+
+    AString8(AString8&& o)
+        : MString8{.data = nullptr, .len = 0, .not_null_term = false, .capacity = 0, .allocator = o.allocator} {
+        data = o.data;
+        metadata = o.metadata;
+        capacity = o.capacity;
+        o.allocator = nullptr;
+    }
+
+    CXB_INLINE AString8& operator=(AString8&& o) {
+        allocator = o.allocator;
+        o.allocator = nullptr;
+        data = o.data;
+        metadata = o.metadata;
+        capacity = o.capacity;
+        return *this;
+    }
+
+    AString8(const AString8& o) = delete;
+    AString8& operator=(const AString8& o) = delete;
+
+    inline ~AString8() {
+        destroy();
+    }
+
+    inline AString8& copy_(Allocator* to_allocator = &heap_alloc) {
+        *this = move(this->copy(to_allocator));
+        return *this;
+    }
+
+    inline AString8 copy(Allocator* to_allocator = nullptr) {
+        if(to_allocator == nullptr) to_allocator = allocator;
+        ASSERT(to_allocator != nullptr);
+
+        AString8 result{data, len, not_null_term, to_allocator};
+        return result;
+    }
+
+    inline MString8 release() {
+        MString8 result{
+            .data = data, .len = len, .not_null_term = not_null_term, .capacity = capacity, .allocator = allocator};
+        this->allocator = nullptr;
+        return result;
+    }
+};
+
+CXB_C_COMPAT_BEGIN
+#define S8_LIT(s) (String8{.data = (char*) &(s)[0], .len = LENGTHOF_LIT(s), .not_null_term = false})
+#define S8_DATA(c, l) (String8{.data = (char*) &(c)[0], .len = (l), .not_null_term = false})
+#define S8_CSTR(s) (String8{.data = (char*) (s), .len = (size_t) strlen(s), .not_null_term = false})
+CXB_C_COMPAT_END
+
+#define S8_STR(s) (String8{.data = (char*) s.c_str(), .len = (size_t) s.size(), .not_null_term = false})
+
+CXB_PURE size_t string8_find(const String8& s, String8 needle) {
+    if(needle.len == 0 || needle.len > s.len) {
+        return SIZE_MAX;
+    }
+    for(size_t i = 0; i <= s.len - needle.len; ++i) {
+        if(memcmp(s.data + i, needle.data, needle.len) == 0) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+CXB_PURE bool string8_contains(const String8& s, String8 needle) {
+    return string8_find(s, needle) != SIZE_MAX;
+}
+
+CXB_PURE bool string8_starts_with(const String8& s, String8 prefix) {
+    if(prefix.len > s.len) return false;
+    if(prefix.len == 0) return true;
+    return memcmp(s.data, prefix.data, prefix.len) == 0;
+}
+
+CXB_PURE bool string8_ends_with(const String8& s, String8 suffix) {
+    if(suffix.len > s.len) return false;
+    if(suffix.len == 0) return true;
+    return memcmp(s.data + (s.len - suffix.len), suffix.data, suffix.len) == 0;
+}
+
+CXB_PURE static bool _string8_contains_char(String8 chars, char c) {
+    for(size_t i = 0; i < chars.len; ++i) {
+        if(chars.data[i] == c) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CXB_PURE bool string8_contains_chars(const String8& s, String8 chars) {
+    for(size_t i = 0; i < s.len; ++i) {
+        if(_string8_contains_char(chars, s.data[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CXB_PURE String8 string8_trim(const String8& s, String8 chars, bool leading, bool trailing) {
+    size_t start = 0;
+    size_t end = s.len;
+    if(leading) {
+        while(start < end && _string8_contains_char(chars, s.data[start])) {
+            start++;
+        }
+    }
+    if(trailing) {
+        while(end > start && _string8_contains_char(chars, s.data[end - 1])) {
+            end--;
+        }
+    }
+    return s.slice((i64) start, start < end ? (i64) end - 1 : (i64) start - 1);
+}
+
+CXB_PURE String8 string8_trim_all(const String8& s, String8 chars, bool leading, bool trailing) {
+    if(chars.len == 0) return s;
+
+    size_t start = 0;
+    size_t end = s.len;
+    if(leading) {
+        while(end - start >= chars.len && memcmp(s.data + start, chars.data, chars.len) == 0) {
+            start += chars.len;
+        }
+    }
+    if(trailing) {
+        while(end - start >= chars.len && memcmp(s.data + (end - chars.len), chars.data, chars.len) == 0) {
+            end -= chars.len;
+        }
+    }
+    return s.slice((i64) start, start < end ? (i64) end - 1 : (i64) start - 1);
+}
+
+#define MSTRING_NT(a) (MString8{.data = nullptr, .len = 0, .not_null_term = false, .capacity = 0, .allocator = (a)})
+
+inline String8 operator""_s8(const char* s, size_t len) {
+    return String8{.data = (char*) s, .len = len, .not_null_term = false};
+}
+
+/* SECTION: extern templates */
+#ifdef CXB_EXTERN_TEMPLATES
+CXB_EXTERN_TEMPLATE struct MArray<String8>;
+CXB_EXTERN_TEMPLATE struct AArray<String8>;
+#endif
+
+#endif /* CXB_STRING8_H */
@@ -0,0 +1,52 @@
+/*
+# cxb/utf8: UTF-8 decoding
+
+`Utf8Iter` decodes a `String8` in batches of up to 512 codepoints, `decode_string8` collects all of them on an arena.
+*/
+#ifndef CXB_UTF8_H
+#define CXB_UTF8_H
+
+#include "string8.h"
+
+struct Utf8Iter;
+struct Utf8IterBatch;
+CXB_C_EXPORT bool utf8_iter_next(Utf8Iter* iter, Utf8IterBatch* batch);
+
+CXB_C_TYPE struct Utf8Iter {
+    CXB_C_COMPAT_BEGIN
+    String8 s;
+    u64 pos;
+    CXB_C_COMPAT_END
+
+    CXB_INLINE bool next(Utf8IterBatch& batch) {
+        return utf8_iter_next(this, &batch);
+    };
+};
+CXB_INLINE Utf8Iter make_utf8_iter(String8 s) {
+    return Utf8Iter{s, 0};
+}
+
+CXB_C_TYPE struct Utf8IterBatch {
+    CXB_C_COMPAT_BEGIN
+    u32 data[512];
+    u64 len;
+    CXB_C_COMPAT_END
+
+    Array<u32> as_array() {
+        return Array<u32>{&data[0], len};
+    }
+};
+
+// TODO: with indices?
+inline Array<u32> decode_string8(Arena* a, String8 s) {
+    Utf8Iter iter = make_utf8_iter(s);
+    Utf8IterBatch batch = {};
+
+    Array<u32> codepoints;
+    while(iter.next(batch)) {
+        codepoints.extend(a, batch.as_array());
+    }
+    return codepoints;
+}
+
+#endif /* CXB_UTF8_H */
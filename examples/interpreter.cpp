@@ -1,91 +1,59 @@
-#include "examples/parser.h"
+#include "examples/interpreter.h"
 
-#include <map> // TODO: removeme
-#include <print>
 #include <stdio.h>
 
-struct Interpreter {
-    std::map<std::string, AstNode*> funcs;
-};
-
-int dfs(Interpreter* ctx, Module* mod, AstNode* node) {
-    switch(node->kind) {
-        case NODE_MODULE: {
-            for(size_t i = 0; i < node->kids.len; ++i) {
-                int tmp = dfs(ctx, mod, node->kids[i]);
-                std::println("node[{}] = {}", i, tmp);
-                if(i == node->kids.len - 1) {
-                    return tmp;
-                }
-            }
-        } break;
-        case NODE_FUNC_DECL: {
-            // TODO
-        } break;
-        case NODE_FUNC_CALL: {
-            // TODO
-        } break;
-        case NODE_IF: {
-        } break;
-        case NODE_BIN_OP: {
-            auto lhs = dfs(ctx, mod, node->kids[0]);
-            auto rhs = dfs(ctx, mod, node->kids[1]);
-            switch(node->tok.kind) {
-                case TOK_DIV_OP:
-                    return lhs / rhs;
-                case TOK_MUL_OP:
-                    return lhs * rhs;
-                case TOK_PLUS_OP:
-                    return lhs + rhs;
-                case TOK_MINUS_OP:
-                    return lhs - rhs;
-                default:
-                    std::println("invalid bin op: {}", (int) node->tok.kind);
-                    break;
-            }
-        }
-        case NODE_BOOL_LIT: {
-            return node->data.numeral_literal.value;
-        } break;
-        case NODE_INT_LIT: {
-            return node->data.numeral_literal.value;
-        } break;
-        case NODE_ELIF: {
-            std::println("unexpected elif");
-            exit(1);
-        }
-        case NODE_ELSE: {
-            std::println("unexpected else");
-            exit(1);
+int main(int argc, char* argv[]) {
+    bool use_ast = false;
+    bool dump = false;
+    const char* path = nullptr;
+    for(int i = 1; i < argc; ++i) {
+        String8 arg = S8_CSTR(argv[i]);
+        if(arg == S8_LIT("--ast")) {
+            use_ast = true;
+        } else if(arg == S8_LIT("--dump")) {
+            dump = true;
+        } else {
+            path = argv[i];
         }
-        default: {
-            std::println("invalid node kind: {}", (int) node->kind);
-        } break;
     }
-}
-
-int eval(Interpreter* ctx, Module* mod) {
-    return dfs(ctx, mod, mod->root);
-}
-
-int main(int argc, char* argv[]) {
-    if(argc == 1) {
-        fprintf(stderr, "expected input file, usage:\n%s <input-file>\n", argv[0]);
+    if(path == nullptr) {
+        fprintf(stderr, "expected input file, usage:\n%s [--ast] [--dump] <input-file>\n", argv[0]);
+        fprintf(stderr, "  --ast: walk the AST instead of compiling to bytecode\n");
+        fprintf(stderr, "  --dump: print the bytecode\n");
         return 1;
     }
     Module* mod = module_make(S8_LIT("main"), nullptr, nullptr);
 
-    ParseFileResult parse_result = module_parse_file(mod, S8_CSTR(argv[1]));
+    ParseFileResult parse_result = module_parse_file(mod, S8_CSTR(path));
     if(parse_result) {
-        fprintf(stderr, "Failed to parse: %s\n", argv[1]);
+        fprintf(stderr, "Failed to parse: %s\n", path);
         // TODO
         fprintf(stderr, "Reason: %lld\n", (i64) parse_result.file_err);
+        for(const ParseError& err : Array<ParseError>{mod->parse_errors.data, mod->parse_errors.len}) {
+            writeln(stderr, "{}", err.message);
+        }
         fflush(stderr);
+        module_destroy(mod);
         return 2;
     }
 
-    Interpreter interpreter = {};
-    int result = eval(&interpreter, mod);
-    fprintf(stdout, "%d\n", result);
+    EvalResult result = {};
+    if(use_ast) {
+        Interpreter* interpreter = interpreter_make(mod->arena);
+        result = eval(interpreter, mod);
+    } else {
+        BcProgram* prog = bc_compile(mod->arena, mod);
+        for(const BcCompileError& err : prog->errors) writeln(stderr, "compile error: {}", err.message);
+        if(dump) bc_dump(stdout, prog);
+        Vm* vm = vm_make(mod->arena);
+        result = vm_run(vm, prog);
+    }
+    if(result) {
+        writeln(stderr, "error: {}", result.reason);
+        module_destroy(mod);
+        return 3;
+    }
+    writeln(stdout, "{}", value_format(mod->arena, result.value));
+    module_destroy(mod);
     return 0;
 }
@@ -0,0 +1,438 @@
+/*
+# examples/interpreter: evaluation of a parsed Module
+
+Two evaluators of the same semantics on dynamically typed `Value`s:
+
+* `Interpreter` / `eval`: walks the AST (`dfs`)
+* `bc_compile` + `vm_run`: compiles the AST to register-based bytecode, run by a VM
+
+Both read the flat AST (`Module::ast`), which only exists if the module parsed without errors.
+
+```
+Module* mod = module_make(S8_LIT("main"), nullptr, nullptr);
+module_parse_string(mod, S8_LIT("func sq(x: int) { return x * x }\nsq(7)"));
+BcProgram* prog = bc_compile(arena, mod);
+Vm* vm = vm_make(arena);
+auto result = vm_run(vm, prog); // value_as_int(result.value) == 49
+```
+
+## Values
+
+A `Value` is 64 bits, NaN-boxed: a double, or a quiet NaN with the sign bit set, a tag in bits 48..50 and a 48-bit
+payload (no double has these bits, NaNs are canonicalized to a positive NaN):
+
+* `nil`, `true`, `false`
+* ints: 48-bit signed, results that do not fit are doubles
+* strings: `const String8*`, literals point into the AST, concatenations are allocated on the evaluator's arena
+* objects: `void*`, opaque to the evaluators
+
+Operations on two ints or two doubles check both tags with one mask and run inline (`value_try_*`), everything else
+(int overflow, mixed ints and doubles, strings, type errors) goes through `value_arith`.
+
+## Semantics
+
+* a module is a list of statements, its value is the value of the last one
+* `x := e`, `var x = e`: declares a variable, global at the module level, local to the enclosing function otherwise.
+  `x = e` (and `+=`, `-=`, `*=`, `/=`) assigns the local `x` if there is one, else the global `x`
+* a name declared anywhere in a function (outside of nested functions) is local in all of the function, as in Python:
+  reading or assigning it before its declaration ran is an undefined variable, even if there is a global of that name
+* `func f(a, b) { ... }` defines `f` when the statement is run, functions return nil without a `return`
+* `if` / `else if` / `else`, `while` with `break` and `continue`, `and` / `or` short-circuit and return an operand
+* `nil`, `false`, `0` and `0.0` are false, everything else is true
+* arithmetic on ints and doubles (int / int truncates), `+` concatenates strings, `==` / `!=` compare any values
+* runtime errors: unknown variables and functions, wrong number of arguments, type errors, integer division by zero,
+  stack overflow
+
+## Bytecode
+
+Instructions are 32 bits: an 8-bit opcode and either three 8-bit operands `a`, `b`, `c` or `a` and a signed 16-bit
+`sbx` (`bx` unsigned). `R[i]` is the i-th register of the current call frame and `K[i]` the i-th constant. Calls are
+`CALL a b` followed by a word with the index of the call site in `BcProgram::call_sites`: the `b` arguments are in
+`R[a..a+b)`, which are the first registers of the callee's frame, the result is written to `R[a]`.
+
+## Names
+
+The parser interns identifiers (`Module::symbols`, `ast_sym`). Functions and globals are arrays indexed by
+symbol in both evaluators, locals are registers in the VM and a scan of the current call's symbols in the tree walker.
+Both find a function's locals before running it (`ast_func_locals`) and start them undefined: the VM checks a local
+(`CHKDEF`) only where it is not known to be declared, i.e. unless its declaration was compiled earlier outside of
+branches and loops.
+The VM caches the callee of each call site on its first call: a hit skips the lookup and the arity check.
+*/
+#pragma once
+
+#include "examples/parser.h"
+
+enum InterpErr {
+    INTERP_OK = 0,
+    INTERP_ERR_COMPILE,
+    INTERP_ERR_UNDEFINED,
+    INTERP_ERR_ARGS,
+    INTERP_ERR_TYPE,
+    INTERP_ERR_DIV_BY_ZERO,
+    INTERP_ERR_STACK_OVERFLOW,
+};
+
+/* SECTION: values */
+struct Value {
+    u64 bits;
+};
+
+constexpr u64 VALUE_TAG_MASK = 0xffff000000000000ull;
+constexpr u64 VALUE_PAYLOAD_MASK = 0x0000ffffffffffffull;
+constexpr u64 VALUE_TAG_NIL = 0xfff9000000000000ull; // boxed values are >= VALUE_TAG_NIL, doubles below
+constexpr u64 VALUE_TAG_BOOL = 0xfffa000000000000ull;
+constexpr u64 VALUE_TAG_INT = 0xfffb000000000000ull;
+constexpr u64 VALUE_TAG_STR = 0xfffc000000000000ull;
+constexpr u64 VALUE_TAG_OBJ = 0xfffd000000000000ull;
+constexpr u64 VALUE_CANONICAL_NAN = 0x7ff8000000000000ull;
+constexpr i64 VALUE_INT_MIN = -(1ll << 47);
+constexpr i64 VALUE_INT_MAX = (1ll << 47) - 1;
+
+constexpr Value VALUE_NIL = {VALUE_TAG_NIL};
+constexpr Value VALUE_FALSE = {VALUE_TAG_BOOL};
+constexpr Value VALUE_TRUE = {VALUE_TAG_BOOL | 1};
+
+enum ValueOp {
+    VALUE_ADD,
+    VALUE_SUB,
+    VALUE_MUL,
+    VALUE_DIV,
+    VALUE_LT,
+    VALUE_LE,
+    VALUE_EQ,
+    VALUE_NE,
+};
+
+CXB_INLINE bool value_is_double(Value v) {
+    return v.bits < VALUE_TAG_NIL;
+}
+
+CXB_INLINE bool value_is_int(Value v) {
+    return (v.bits & VALUE_TAG_MASK) == VALUE_TAG_INT;
+}
+
+CXB_INLINE bool value_is_str(Value v) {
+    return (v.bits & VALUE_TAG_MASK) == VALUE_TAG_STR;
+}
+
+CXB_INLINE bool value_is_obj(Value v) {
+    return (v.bits & VALUE_TAG_MASK) == VALUE_TAG_OBJ;
+}
+
+CXB_INLINE bool value_is_bool(Value v) {
+    return (v.bits & VALUE_TAG_MASK) == VALUE_TAG_BOOL;
+}
+
+CXB_INLINE bool value_is_nil(Value v) {
+    return v.bits == VALUE_NIL.bits;
+}
+
+// both are ints: the tag bits of a ^ TAG_INT and b ^ TAG_INT are 0
+CXB_INLINE bool value_both_int(Value a, Value b) {
+    return ((a.bits ^ VALUE_TAG_INT) | (b.bits ^ VALUE_TAG_INT)) < (1ull << 48);
+}
+
+CXB_INLINE Value value_double(f64 x) {
+    // NaNs with the sign bit set may collide with the boxed values
+    if(UNLIKELY(x != x)) return Value{VALUE_CANONICAL_NAN};
+    return Value{__builtin_bit_cast(u64, x)};
+}
+
+CXB_INLINE f64 value_as_double(Value v) {
+    return __builtin_bit_cast(f64, v.bits);
+}
+
+CXB_INLINE Value value_int(i64 x) {
+    DEBUG_ASSERT(x >= VALUE_INT_MIN && x <= VALUE_INT_MAX, "int out of range");
+    return Value{VALUE_TAG_INT | ((u64) x & VALUE_PAYLOAD_MASK)};
+}
+
+CXB_INLINE i64 value_as_int(Value v) {
+    return (i64) (v.bits << 16) >> 16;
+}
+
+// an int if x fits in 48 bits, else a double
+CXB_INLINE Value value_number(i64 x) {
+    return x >= VALUE_INT_MIN && x <= VALUE_INT_MAX ? value_int(x) : value_double((f64) x);
+}
+
+CXB_INLINE Value value_mul_int(i64 x, i64 y) {
+    i64 r;
+    if(UNLIKELY(__builtin_mul_overflow(x, y, &r))) return value_double((f64) x * (f64) y);
+    return value_number(r);
+}
+
+CXB_INLINE Value value_bool(bool x) {
+    return Value{VALUE_TAG_BOOL | (u64) x};
+}
+
+CXB_INLINE Value value_str(const String8* s) {
+    DEBUG_ASSERT(((u64) s & ~VALUE_PAYLOAD_MASK) == 0, "pointer does not fit in 48 bits");
+    return Value{VALUE_TAG_STR | (u64) s};
+}
+
+CXB_INLINE const String8* value_as_str(Value v) {
+    return (const String8*) (v.bits & VALUE_PAYLOAD_MASK);
+}
+
+CXB_INLINE Value value_obj(void* p) {
+    DEBUG_ASSERT(((u64) p & ~VALUE_PAYLOAD_MASK) == 0, "pointer does not fit in 48 bits");
+    return Value{VALUE_TAG_OBJ | (u64) p};
+}
+
+CXB_INLINE void* value_as_obj(Value v) {
+    return (void*) (v.bits & VALUE_PAYLOAD_MASK);
+}
+
+CXB_INLINE bool value_truthy(Value v) {
+    if(v.bits == VALUE_TRUE.bits) return true;
+    if(v.bits == VALUE_FALSE.bits || v.bits == VALUE_NIL.bits) return false;
+    if(value_is_int(v)) return (v.bits & VALUE_PAYLOAD_MASK) != 0;
+    if(value_is_double(v)) return value_as_double(v) != 0.0;
+    return true;
+}
+
+CXB_INLINE bool value_both_double(Value a, Value b) {
+    return max(a.bits, b.bits) < VALUE_TAG_NIL;
+}
+
+// fast paths: int op int and double op double, false for the rest (value_arith), including int overflow.
+// Ints are compared and added as their payload << 16, whose i64 overflow is the overflow of 48 bits
+CXB_INLINE bool value_try_add(Value a, Value b, Value* out) {
+    i64 r;
+    if(LIKELY(value_both_int(a, b))) {
+        if(UNLIKELY(__builtin_add_overflow((i64) (a.bits << 16), (i64) (b.bits << 16), &r))) return false;
+        *out = Value{VALUE_TAG_INT | ((u64) r >> 16)};
+        return true;
+    }
+    if(!value_both_double(a, b)) return false;
+    *out = value_double(value_as_double(a) + value_as_double(b));
+    return true;
+}
+
+CXB_INLINE bool value_try_sub(Value a, Value b, Value* out) {
+    i64 r;
+    if(LIKELY(value_both_int(a, b))) {
+        if(UNLIKELY(__builtin_sub_overflow((i64) (a.bits << 16), (i64) (b.bits << 16), &r))) return false;
+        *out = Value{VALUE_TAG_INT | ((u64) r >> 16)};
+        return true;
+    }
+    if(!value_both_double(a, b)) return false;
+    *out = value_double(value_as_double(a) - value_as_double(b));
+    return true;
+}
+
+CXB_INLINE bool value_try_mul(Value a, Value b, Value* out) {
+    i64 r;
+    if(LIKELY(value_both_int(a, b))) {
+        if(UNLIKELY(__builtin_mul_overflow((i64) (a.bits << 16), value_as_int(b), &r))) return false;
+        *out = Value{VALUE_TAG_INT | ((u64) r >> 16)};
+        return true;
+    }
+    if(!value_both_double(a, b)) return false;
+    *out = value_double(value_as_double(a) * value_as_double(b));
+    return true;
+}
+
+// int division by zero is an error of value_arith
+CXB_INLINE bool value_try_div(Value a, Value b, Value* out) {
+    if(LIKELY(value_both_int(a, b))) {
+        i64 y = value_as_int(b);
+        if(UNLIKELY(y == 0)) return false;
+        *out = value_number(value_as_int(a) / y);
+        return true;
+    }
+    if(!value_both_double(a, b)) return false;
+    *out = value_double(value_as_double(a) / value_as_double(b));
+    return true;
+}
+
+CXB_INLINE bool value_try_lt(Value a, Value b, Value* out) {
+    if(LIKELY(value_both_int(a, b))) {
+        *out = value_bool((i64) (a.bits << 16) < (i64) (b.bits << 16));
+        return true;
+    }
+    if(!value_both_double(a, b)) return false;
+    *out = value_bool(value_as_double(a) < value_as_double(b));
+    return true;
+}
+
+CXB_INLINE bool value_try_le(Value a, Value b, Value* out) {
+    if(LIKELY(value_both_int(a, b))) {
+        *out = value_bool((i64) (a.bits << 16) <= (i64) (b.bits << 16));
+        return true;
+    }
+    if(!value_both_double(a, b)) return false;
+    *out = value_bool(value_as_double(a) <= value_as_double(b));
+    return true;
+}
+
+CXB_INLINE bool value_try_eq(Value a, Value b, Value* out) {
+    if(LIKELY(value_both_int(a, b))) {
+        *out = value_bool(a.bits == b.bits);
+        return true;
+    }
+    if(!value_both_double(a, b)) return false;
+    *out = value_bool(value_as_double(a) == value_as_double(b));
+    return true;
+}
+
+CXB_INLINE bool value_try_ne(Value a, Value b, Value* out) {
+    if(!value_try_eq(a, b, out)) return false;
+    out->bits ^= 1;
+    return true;
+}
+
+typedef Result<Value, InterpErr> EvalResult;
+
+// any operands: numbers, strings for + and comparisons for == and !=, concatenations are allocated on arena
+EvalResult value_arith(Arena* arena, ValueOp op, Value a, Value b);
+EvalResult value_neg(Arena* arena, Value a);
+bool value_equal(Value a, Value b);
+const char* value_type_name(Value v);
+String8 value_format(Arena* arena, Value v);
+
+// an undeclared global or local, never the result of an expression
+constexpr Value VALUE_UNDEFINED = {VALUE_TAG_NIL | 1};
+
+/* SECTION: tree walker */
+struct EvalVar {
+    u32 sym;
+    Value value;
+};
+
+struct EvalLocals {
+    AstId fn;        // AST_NONE if not computed
+    Array<u32> syms; // see ast_func_locals, into Interpreter::local_syms
+};
+
+enum EvalFlow {
+    FLOW_NEXT = 0,
+    FLOW_BREAK,
+    FLOW_CONTINUE,
+    FLOW_RETURN,
+    FLOW_ERROR,
+};
+
+struct Interpreter {
+    Arena* arena;             // error messages, funcs and globals
+    const Ast* ast;           // the module's
+    Array<String8> names;     // by symbol
+    Array<AstId> funcs;       // by symbol, AST_NONE if undefined
+    Array<Value> globals;     // by symbol, VALUE_UNDEFINED if undeclared
+    Array<EvalLocals> locals; // by symbol, of the last function called by that name in this run
+    Array<u32> local_syms;    // EvalLocals::syms, up to max_vars
+
+    // the current call's locals are vars[frame_base, vars.len)
+    Array<EvalVar> vars;
+    u64 max_vars;
+    u64 frame_base;
+    u32 depth;
+
+    EvalFlow flow;
+    Value ret_value;
+    InterpErr err;
+    String8 err_reason;
+};
+
+// arena holds the variables (max_vars) and the symbols of the called functions' locals (max_vars)
+Interpreter* interpreter_make(Arena* arena, u64 max_vars = KB(64));
+EvalResult eval(Interpreter* ctx, Module* mod);
+
+/* SECTION: bytecode */
+enum BcOp : u8 {
+    OP_LOADK,   // R[a] = K[bx]
+    OP_LOADI,   // R[a] = int sbx
+    OP_LOADNIL, // R[a] = nil
+    OP_MOV,     // R[a] = R[b]
+    OP_GETG,    // R[a] = globals[bx]
+    OP_SETG,    // globals[bx] = R[a], globals[bx] is declared
+    OP_DEFG,    // globals[bx] = R[a]
+    OP_ADD,     // R[a] = R[b] + R[c]
+    OP_ADDI,    // R[a] = R[b] + (int8_t) c
+    OP_SUB,     // R[a] = R[b] - R[c]
+    OP_MUL,     // R[a] = R[b] * R[c]
+    OP_DIV,     // R[a] = R[b] / R[c]
+    OP_NEG,     // R[a] = -R[b]
+    OP_LT,      // R[a] = R[b] < R[c]
+    OP_LE,      // R[a] = R[b] <= R[c]
+    OP_EQ,      // R[a] = R[b] == R[c]
+    OP_NE,      // R[a] = R[b] != R[c]
+    OP_JMP,     // ip += sbx
+    OP_JMPF,    // if R[a] is false: ip += sbx
+    OP_JMPT,    // if R[a] is true: ip += sbx
+    OP_CALL,    // R[a] = funcs[call_sites[next word]](R[a], ..., R[a + b - 1])
+    OP_RET,     // return R[a]
+    OP_RETNIL,  // return nil
+    OP_DEFN,    // funcs[protos[bx]->sym] = protos[bx]
+    OP_CHKDEF,  // error if R[a] is undefined: the local names[bx] is used before its declaration ran
+    OP_COUNT,
+};
+
+typedef u32 BcInst;
+
+CXB_INLINE BcInst bc_abc(BcOp op, u32 a, u32 b, u32 c) {
+    return (u32) op | (a << 8) | (b << 16) | (c << 24);
+}
+
+CXB_INLINE BcInst bc_abx(BcOp op, u32 a, i32 sbx) {
+    return (u32) op | (a << 8) | ((u32) (u16) sbx << 16);
+}
+
+#define BC_OP(i) ((BcOp) ((i) & 0xff))
+#define BC_A(i) (((i) >> 8) & 0xff)
+#define BC_B(i) (((i) >> 16) & 0xff)
+#define BC_C(i) ((i) >> 24)
+#define BC_BX(i) ((i) >> 16)
+#define BC_SBX(i) ((i32) (int16_t) ((i) >> 16))
+
+struct BcFunc {
+    String8 name;
+    u32 sym;
+    Array<BcInst> code;
+    Array<Value> k;
+    u32 n_params;
+    u32 n_regs;
+};
+
+struct BcCompileError {
+    AstId node; // AST_NONE if not tied to a node
+    String8 message;
+};
+
+struct BcProgram {
+    BcFunc* main; // the module's statements
+    Array<BcFunc*> protos;
+    Array<String8> names;  // by symbol
+    Array<u32> call_sites; // by call site: the callee's symbol
+    Array<BcCompileError> errors;
+};
+
+// the program is allocated on arena, compile errors are collected in errors
+BcProgram* bc_compile(Arena* arena, Module* mod);
+// writes a listing of the functions' bytecode to f
+void bc_dump(FILE* f, const BcProgram* prog);
+
+/* SECTION: VM */
+struct VmFrame {
+    BcFunc* fn;
+    const BcInst* ret_ip; // the caller's instruction after the call
+    Value* base;          // R[0]
+};
+
+struct Vm {
+    Arena* arena;
+    Array<Value> stack; // registers of the frames
+    Array<VmFrame> frames;
+    Array<BcFunc*> funcs; // by symbol, nullptr if undefined
+    Array<Value> globals; // by symbol, VALUE_UNDEFINED if undeclared
+    // by call site: the callee, its arity checked, nullptr before the first call and after a redefinition
+    Array<BcFunc*> call_cache;
+};
+
+// arena holds the register stack (max_regs) and the call frames (max_depth)
+Vm* vm_make(Arena* arena, u64 max_regs = MB(1), u64 max_depth = KB(64));
+EvalResult vm_run(Vm* vm, BcProgram* prog);
+// vm_run that adds the number of instructions it executes to n_executed, e.g. to report instructions per second
+EvalResult vm_run_counted(Vm* vm, BcProgram* prog, u64* n_executed);
@@ -14,6 +14,9 @@ struct Parser {
     Arena* tree;
     Arena* error_arena;
     ParseErrorArray errors;
+    SymbolTable* symbols;
+    // a stack of the statements of the open lists, each list is copied to tree when it is closed
+    MArray<AstNode*> statements;
 };
 
 static Token lex_next(Parser* ctx);
@@ -52,16 +55,22 @@ C_EXPORT Module* module_make(String8 name, Arena* arena, Arena* tree) {
 
 C_EXPORT ParseFileResult module_parse_file(Module* mod, String8 file_path) {
     ParseFileResult res = {};
-    auto file = open_memfile(mod->arena, file_path);
+    auto file = memfile_open(mod->arena, file_path);
     if(file) {
         res.file_err = file.error;
         return res;
     }
 
     mod->file = file.value;
+    return module_parse_string(mod, mod->file.data.as_string8(false));
+}
+
+C_EXPORT ParseFileResult module_parse_string(Module* mod, String8 src) {
+    ParseFileResult res = {};
+    mod->src = src;
     if(mod->tree == nullptr) {
-        // TODO: test this ratio
-        u64 n_bytes = max((u64) (1 * mod->file.data.len), KB(64));
+        // at most a node and an edge per source byte, only the pages used are committed
+        u64 n_bytes = max((u64) ((sizeof(AstNode) + sizeof(AstNode*)) * src.len), KB(64));
         mod->tree = arena_make_nbytes(n_bytes);
     }
 
@@ -69,18 +78,37 @@ C_EXPORT ParseFileResult module_parse_file(Module* mod, String8 file_path) {
     Parser* parser = mod->parser;
     *parser = {};
     parser->idx = 0;
-    parser->buffer = mod->file.data.as_string8(false);
+    parser->buffer = src;
     parser->tree = mod->tree;
     parser->error_arena = mod->arena;
+    // the names point into src, on the heap: array_push_back of the errors needs them at the end of mod->arena
+    mod->symbols.ids.destroy();
+    mod->symbols.names.destroy();
+    mod->symbols.ids = MHashMap<String8, u32, DefaultHasherBuiltin>();
+    mod->symbols.names = MArray<String8>();
+    parser->symbols = &mod->symbols;
+    u64 tree_pos = mod->tree->pos;
     mod->root = parse_module(mod->parser);
+    parser->statements.destroy();
+    mod->parse_errors = parser->errors;
+    mod->ast = mod->parse_errors.len == 0 ? ast_flatten(mod->arena, mod->root) : nullptr;
+    if(mod->ast != nullptr && !mod->keep_tree) {
+        // the evaluators only read the flat AST, the tree is several times its size
+        arena_pop_to(mod->tree, tree_pos);
+        arena_decommit(mod->tree, 0);
+        mod->root = nullptr;
+    }
 
     res.num_errors = mod->parse_errors.len;
     return res;
 }
 
 C_EXPORT void module_destroy(Module* module) {
-    arena_destroy(module->tree);
-    arena_destroy(module->arena);
+    module->symbols.ids.destroy();
+    module->symbols.names.destroy();
+    // tree is only made once a source is parsed, e.g. not when the file cannot be opened
+    if(module->tree) arena_destroy(module->tree);
+    if(module->arena) arena_destroy(module->arena);
 }
 
 // *SECTION: Parser
@@ -88,8 +116,7 @@ C_EXPORT void module_destroy(Module* module) {
 #define NODE(x) (*x)
 #define LHS(x) NODE(NODE(x).kids.data[0])
 #define RHS(x) NODE(NODE(x).kids.data[1])
-#define ADD_KID(x, k) array_push_back((x)->kids, ctx->tree, static_cast<AstNode*>(k))
-#define ADD_KID_A(x, k, a) array_push_back((x)->kids, a, static_cast<AstNode*>(k))
+#define ADD_KID(x, k) add_kid(ctx->tree, x, k)
 #define INVALID_NODE nullptr
 
 #define ADD_ERR(node, err_msg, ...)                                                  \
@@ -122,19 +149,64 @@ C_EXPORT void module_destroy(Module* module) {
 
 static void parse_statement_list(Parser* ctx, AstNode* node, bool explicit_scope);
 static AstNode* parse_expression(Parser* ctx);
-static inline bool is_binary_op(TokenKind type) {
-    return (int) type >= (int) TOK_IMPL_BIN_OP_BEGIN && (int) type <= (int) TOK_IMPL_BIN_OP_END;
+
+// binding power of a binary operator, higher binds tighter, 0: not a binary operator
+constexpr int PREC_ASSIGN = 1; // right associative
+static inline int bin_op_prec(TokenKind type) {
+    switch(type) {
+        case TOK_MUL_OP:
+        case TOK_DIV_OP:
+            return 7;
+        case TOK_PLUS_OP:
+        case TOK_MINUS_OP:
+            return 6;
+        case TOK_LESS_THAN_OP:
+        case TOK_LESS_THAN_EQUAL_TO_OP:
+        case TOK_GREATER_THAN_OP:
+        case TOK_GREATER_THAN_EQUAL_TO_OP:
+            return 5;
+        case TOK_EQUALITY_OP:
+        case TOK_NOT_EQUAL_OP:
+            return 4;
+        case TOK_AND_OP:
+            return 3;
+        case TOK_OR_OP:
+            return 2;
+        case TOK_EQUALS_OP:
+        case TOK_COLON_EQUALS_OP:
+        case TOK_PLUS_EQUALS_OP:
+        case TOK_MINUS_EQUALS_OP:
+        case TOK_MUL_EQUALS_OP:
+        case TOK_DIV_EQUALS_OP:
+        case TOK_AND_EQUALS_OP:
+            return PREC_ASSIGN;
+        default:
+            return 0;
+    }
 }
 
 static inline bool is_unary_op(TokenKind type) {
     return type >= TOK_IMPL_UNARY_OP_BEGIN && type <= TOK_IMPL_UNARY_OP_END;
 }
 
+// the id of name, a new one if it was not seen before
+static u32 intern(SymbolTable* symbols, String8 name) {
+    auto* entry = symbols->ids.occupied_entry_for(name);
+    if(entry != nullptr) return entry->kv.value;
+    u32 id = (u32) symbols->names.len;
+    ASSERT(id < (1u << 24), "too many symbols");
+    symbols->ids.put({name, id});
+    symbols->names.push_back(name);
+    return id;
+}
+
 static inline AstNode* add_node(Parser* ctx, NodeKind kind, AstNodeData data, Token tok = Token{}, bool err = false) {
+    u32 sym = tok.kind == TOK_IDENTIFIER ? intern(ctx->symbols, tok.ss(ctx->buffer)) : 0;
     AstNode* result = arena_push(ctx->tree,
                                  1,
                                  AstNode{.kind = kind,
                                          .err = err,
+                                         .sym = sym,
                                          .tok = tok,
                                          .data = data,
                                          .kids = {}, // empty arr
@@ -145,6 +217,17 @@ static inline AstNode* add_node(Parser* ctx, NodeKind kind, AstNodeData data, To
     return result;
 }
 
+// kids are pushed at the end of the arena: if nodes were pushed since the last kid, the list is moved there first
+static inline void add_kid(Arena* arena, AstNode* node, AstNode* kid) {
+    AstNodeEdgeList& kids = node->kids;
+    if(kids.data != nullptr && (void*) (kids.data + kids.len) != (void*) (arena->start + arena->pos)) {
+        AstNode** data = arena_push_fast<AstNode*>(arena, kids.len);
+        memcpy(data, kids.data, kids.len * sizeof(AstNode*));
+        kids.data = data;
+    }
+    array_push_back(kids, arena, kid);
+}
+
 static AstNode* parse_expression_base(Parser* ctx) {
     auto next_token = peek_tok(ctx);
 
@@ -316,18 +399,10 @@ static AstNode* parse_expression_base(Parser* ctx) {
             return add_node(ctx, NODE_IDENTIFIER, {}, id);
         }
     } else if(next_token.kind == TOK_FLOAT_LITERAL) {
-        // TODO: parse float
         Token lit = NEXT;
-        auto literal_token = lit.ss(ctx->buffer);
-        AstNode* node = add_node(ctx, NODE_INT_LIT, {}, lit);
+        AstNode* node = add_node(ctx, NODE_FLOAT_LIT, {}, lit);
         if(!lit.err) {
-            auto literal = atoi128(literal_token);
-            if(!literal.exists) {
-                NODE(node).err = 1;
-                ADD_ERR(node, S8_LIT("literal not valid"));
-            } else {
-                NODE(node).data.numeral_literal.value = literal.value;
-            }
+            NODE(node).data.float_literal.value = string8_parse<f64>(lit.ss(ctx->buffer)).value;
         } else {
             NODE(node).err = 1;
         }
@@ -359,48 +434,46 @@ static AstNode* parse_expression_base(Parser* ctx) {
         return node;
     } else if(next_token.kind == TOK_STRING_LITERAL) {
         Token tok = NEXT;
-        return add_node(ctx, NODE_STRING_LIT, {}, tok, tok.err);
+        AstNode* node = add_node(ctx, NODE_STRING_LIT, {}, tok, tok.err);
+        if(!tok.err) {
+            String8 quoted = tok.ss(ctx->buffer);
+            NODE(node).data.string_literal =
+                String8{.data = quoted.data + 1, .len = quoted.len - 2, .not_null_term = true};
+        }
+        return node;
     } else if(next_token.kind != TOK_STATEMENT_END && next_token.kind != TOK_EOF_) {
         ADD_ERR_NO_NODE(S8_LIT("unexpected token"));
     }
     return INVALID_NODE;
 }
 
-AstNode* parse_expression(Parser* ctx) {
-    AstNode* lhs = parse_expression_base(ctx); // 2
-
-    TokenKind lhs_op = TOK_UNINTIALIZED;
-    while(is_binary_op(PEEK.kind)) {
-        auto op_token = NEXT; // +
+// precedence climbing: the operators binding tighter than `op` (or as tight, for assignments) are parsed into its rhs
+static AstNode* parse_binary_rhs(Parser* ctx, AstNode* lhs, int min_prec) {
+    while(bin_op_prec(PEEK.kind) >= min_prec) {
+        Token op = NEXT;
+        int prec = bin_op_prec(op.kind);
         AstNode* rhs = parse_expression_base(ctx);
+        // assignments are right associative
+        for(int next_prec = bin_op_prec(PEEK.kind);
+            next_prec > prec || (next_prec == PREC_ASSIGN && prec == PREC_ASSIGN);
+            next_prec = bin_op_prec(PEEK.kind)) {
+            rhs = parse_binary_rhs(ctx, rhs, next_prec);
+        }
 
-        AstNode* curr = add_node(ctx, NODE_BIN_OP, {}, op_token);
+        AstNode* curr = add_node(ctx, NODE_BIN_OP, {}, op);
         ADD_KID(curr, lhs);
         ADD_KID(curr, rhs);
-
-        // ops to be evaluated first have a smaller integer value
-        // NOTE: the initial state will always cause this to be false
-        if(lhs_op > op_token.kind) {
-            // transform the tree such that the higher priority op is the deeper
-            // node (will be evaluated first)
-            NODE(curr).kids.data[0] = NODE(lhs).kids.data[1]; // curr.lhs = lhs.rhs
-            NODE(lhs).kids.data[1] = curr;                    // lhs.rhs = curr
-            lhs_op = NODE(lhs).tok.kind;
-
-            // update error flags
-            NODE(curr).err = LHS(curr).err || RHS(curr).err;
-            NODE(lhs).err = RHS(lhs).err || RHS(lhs).err;
-        } else {
-            lhs = curr;
-            lhs_op = op_token.kind;
-
-            NODE(curr).err = LHS(curr).err || RHS(curr).err;
-        }
+        NODE(curr).err = lhs == INVALID_NODE || rhs == INVALID_NODE || LHS(curr).err || RHS(curr).err;
+        lhs = curr;
     }
-
     return lhs;
 }
 
+AstNode* parse_expression(Parser* ctx) {
+    AstNode* lhs = parse_expression_base(ctx);
+    return parse_binary_rhs(ctx, lhs, PREC_ASSIGN);
+}
+
 AstNode* parse_type_decl(Parser* ctx) {
     CONSUME_EXPECT(TOK_TYPE_KEYWORD);
 
@@ -552,6 +625,7 @@ static AstNode* parse_func_decl(Parser* ctx) {
     // kids[0] = targs
     // kids[1] = args
     // kids[2] = body
+    // kids[3] = return type or INVALID_NODE
     CONSUME_EXPECT(TOK_FUNCTION_KEYWORD);
 
     Token name = NEXT;
@@ -573,6 +647,13 @@ static AstNode* parse_func_decl(Parser* ctx) {
         CONSUME_EXPECT(TOK_BRACKET_RIGHT);
     }
 
+    // func foo(x: int): int
+    AstNode* ret_type = INVALID_NODE;
+    if(PEEK.kind == TOK_COLON_OP) {
+        CONSUME;
+        ret_type = parse_expression_base(ctx);
+    }
+
     AstNode* body = add_node(ctx, NODE_BODY, {});
     CONSUME_EXPECT(TOK_SCOPE_BRACKET_LEFT);
     parse_statement_list(ctx, body, true);
@@ -580,6 +661,7 @@ static AstNode* parse_func_decl(Parser* ctx) {
     ADD_KID(node, targs);
     ADD_KID(node, args);
     ADD_KID(node, body);
+    ADD_KID(node, ret_type);
     return node;
 }
 
@@ -599,7 +681,8 @@ static AstNode* parse_statement(Parser* ctx) {
 }
 
 static void parse_statement_list(Parser* ctx, AstNode* node, bool explicit_scope) {
-    Arena* scratch = arena_make_nbytes(KB(16)); // TODO: get a scratch arena
+    // nested lists push above base and pop back to it before returning
+    size_t base = ctx->statements.len;
     while(true) {
         while(peek_tok(ctx).kind == TOK_STATEMENT_END) {
             CONSUME;
@@ -619,9 +702,17 @@ static void parse_statement_list(Parser* ctx, AstNode* node, bool explicit_scope
         }
         NODE(statement).statement = true;
         NODE(node).err |= NODE(statement).err;
-        ADD_KID_A(node, statement, scratch);
+        ctx->statements.push_back(statement);
+    }
+
+    size_t n = ctx->statements.len - base;
+    DEBUG_ASSERT(node->kids.len == 0, "statement list already has kids");
+    if(n > 0) {
+        node->kids.data = arena_push_fast<AstNode*>(ctx->tree, n);
+        node->kids.len = n;
+        memcpy(node->kids.data, ctx->statements.data + base, n * sizeof(AstNode*));
     }
-    // TODO: copy node->kids to main arena ?
+    ctx->statements.len = base;
 }
 
 static AstNode* parse_module(Parser* ctx) {
@@ -637,6 +728,114 @@ static AstNode* parse_module(Parser* ctx) {
 #undef CHECK
 #undef EXPECT
 
+// *SECTION: flat AST
+// NOTE: both passes keep an explicit stack, the tree can be deeper than the C stack allows
+struct AstFlattenItem {
+    const AstNode* node;
+    u32 edge; // where the node's id goes, AST_NONE for the root
+};
+
+static void ast_count(const AstNode* root, u64* n_nodes, u64* n_edges) {
+    AArray<const AstNode*> stack;
+    stack.push_back(root);
+    while(stack.len > 0) {
+        const AstNode* node = stack.pop_back();
+        *n_nodes += 1;
+        *n_edges += node->kids.len;
+        for(size_t i = 0; i < node->kids.len; ++i) {
+            if(node->kids[i] != nullptr) stack.push_back(node->kids[i]);
+        }
+    }
+}
+
+Ast* ast_flatten(Arena* arena, const AstNode* root) {
+    u64 n_nodes = 0;
+    u64 n_edges = 0;
+    ast_count(root, &n_nodes, &n_edges);
+    ASSERT(n_nodes + n_edges < AST_NONE, "tree too large");
+
+    Ast* ast = arena_push<Ast>(arena);
+    ast->kind = arena_push_array_fast<u8>(arena, n_nodes);
+    ast->op = arena_push_array_fast<u8>(arena, n_nodes);
+    ast->sym = arena_push_array_fast<u32>(arena, n_nodes);
+    ast->first_kid = arena_push_array_fast<u32>(arena, n_nodes);
+    ast->n_kids = arena_push_array_fast<u32>(arena, n_nodes);
+    ast->src_idx = arena_push_array_fast<u32>(arena, n_nodes);
+    ast->data = arena_push_array_fast<AstNodeData>(arena, n_nodes);
+    ast->edges = arena_push_array_fast<AstId>(arena, max(n_edges, (u64) 1));
+    ast->edges.len = n_edges;
+
+    // pre-order: a node's kid list is reserved when it is visited, so it is contiguous, then its first kid is visited
+    u32 next_id = 0;
+    u32 next_edge = 0;
+    AArray<AstFlattenItem> stack;
+    stack.push_back(AstFlattenItem{root, AST_NONE});
+    while(stack.len > 0) {
+        AstFlattenItem item = stack.pop_back();
+        const AstNode* node = item.node;
+        AstId id = next_id++;
+        if(item.edge != AST_NONE) ast->edges[item.edge] = id;
+        ast->kind[id] = (u8) node->kind;
+        ast->op[id] = (u8) node->tok.kind;
+        ast->sym[id] = node->sym;
+        ast->src_idx[id] = (u32) node->tok.idx;
+        ast->data[id] = node->data;
+
+        u32 first = next_edge;
+        next_edge += (u32) node->kids.len;
+        ast->first_kid[id] = first;
+        ast->n_kids[id] = (u32) node->kids.len;
+        for(size_t i = node->kids.len; i > 0; --i) {
+            const AstNode* kid = node->kids[i - 1];
+            if(kid == nullptr) {
+                ast->edges[first + i - 1] = AST_NONE;
+            } else {
+                stack.push_back(AstFlattenItem{kid, first + (u32) i - 1});
+            }
+        }
+    }
+    ast->root = 0;
+    return ast;
+}
+
+AstId ast_last_descendant(const Ast* ast, AstId id) {
+    while(true) {
+        AstId last = AST_NONE;
+        for(u32 i = ast_n_kids(ast, id); i > 0 && last == AST_NONE; --i) last = ast_kid(ast, id, i - 1);
+        if(last == AST_NONE) return id;
+        id = last;
+    }
+}
+
+Array<u32> ast_func_locals(Arena* arena, const Ast* ast, AstId fn) {
+    // kids[0] = targs, kids[1] = args, kids[2] = body
+    AArray<u32> syms;
+    AstId params = ast_kid(ast, fn, 1);
+    for(u32 i = 0; i < ast_n_kids(ast, params); ++i) syms.push_back(ast_sym(ast, ast_kid(ast, params, i)));
+
+    auto add = [&](u32 sym) {
+        for(u32 x : syms) {
+            if(x == sym) return;
+        }
+        syms.push_back(sym);
+    };
+    AstId body = ast_kid(ast, fn, 2);
+    AstId end = ast_last_descendant(ast, body);
+    for(AstId id = body + 1; id <= end; ++id) {
+        NodeKind kind = ast_kind(ast, id);
+        if(kind == NODE_FUNC_DECL) {
+            // its declarations are its own
+            id = ast_last_descendant(ast, id);
+        } else if(kind == NODE_VAR_DECL) {
+            add(ast_sym(ast, id));
+        } else if(kind == NODE_BIN_OP && ast_op(ast, id) == TOK_COLON_EQUALS_OP) {
+            AstId lhs = ast_kid(ast, id, 0);
+            if(lhs != AST_NONE && ast_kind(ast, lhs) == NODE_IDENTIFIER) add(ast_sym(ast, lhs));
+        }
+    }
+    return syms.len > 0 ? arena_push_array(arena, Array<u32>(syms)) : Array<u32>{};
+}
+
 // *SECTION: Lexer
 #define ALPHA       \
     'A' : case 'B': \
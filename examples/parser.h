@@ -1,8 +1,7 @@
 #pragma once
 
-#include "examples/memfile.h"
-
 #include <cxb/cxb.h>
+#include <cxb/io.h>
 
 // TODO: CXB_C_EXPORT -> C_EXPORT ?
 #define C_EXPORT CXB_C_EXPORT
@@ -97,7 +96,7 @@ struct Token {
     }
 
     inline String8 ss(const String8& sv) const {
-        DEBUG_ASSERT(n < sv.len);
+        DEBUG_ASSERT(idx + n <= sv.len);
         return String8{.data = (char*) (sv.data + idx), .len = (size_t) n, .not_null_term = true};
     }
 };
@@ -193,6 +192,10 @@ typedef struct NumeralLiteral {
     int64_t value;
 } NumeralLiteral;
 
+typedef struct FloatLiteral {
+    double value;
+} FloatLiteral;
+
 typedef struct VarDecl {
     // TODO: bitset for modifiers
     bool is_const;
@@ -213,16 +216,18 @@ typedef struct FuncDecl {
 
 typedef union AstNodeData {
     NumeralLiteral numeral_literal;
+    FloatLiteral float_literal;
     UnionKind union_kind;
-    // StringLiteral string_literal;
+    String8 string_literal; // without the quotes, escapes are not processed
     VarDecl var_decl;
     ParamList param_list;
     FuncDecl func_decl;
 } AstNodeData;
 
 struct AstNode {
-    NodeKind kind; // : 7;
-    bool err;      // : 1;
+    NodeKind kind;         // : 7;
+    bool err;              // : 1;
+    unsigned int sym : 24; // if tok is an identifier: its id in Module::symbols
 
     Token tok;            // 64
     AstNodeData data;     // TODO
@@ -245,12 +250,78 @@ struct ParseErrorArray {
     u64 len;
 };
 
+/* SECTION: flat AST
+The tree of a successful parse as arrays indexed by node id (`Module::ast`), for the evaluators. Ids are in
+pre-order, the kids of a node are `edges[first_kid[id], first_kid[id] + n_kids[id])`. The fields read on every visit
+are packed (14 bytes per node, 4 per edge), the others are side arrays (20 bytes per node), vs 64 bytes per
+`AstNode` and 8 per edge.
+*/
+typedef u32 AstId;
+constexpr AstId AST_NONE = 0xffffffff; // a missing kid, nullptr in the tree
+
+struct Ast {
+    Array<u8> kind;       // NodeKind
+    Array<u8> op;         // TokenKind of tok: operators, assignments, literals
+    Array<u32> sym;       // AstNode::sym
+    Array<u32> first_kid; // into edges
+    Array<u32> n_kids;
+    Array<AstId> edges;
+
+    // rarely read
+    Array<u32> src_idx; // tok.idx, the line and column are found from the source
+    Array<AstNodeData> data;
+
+    AstId root;
+};
+
+// flattens the tree at root onto arena
+Ast* ast_flatten(Arena* arena, const AstNode* root);
+// the subtree of id is [id, ast_last_descendant(ast, id)]
+AstId ast_last_descendant(const Ast* ast, AstId id);
+// the locals of the function declared at fn: its parameters, then the names declared in its body (outside of nested
+// functions) that are not parameters, each once
+Array<u32> ast_func_locals(Arena* arena, const Ast* ast, AstId fn);
+
+CXB_INLINE NodeKind ast_kind(const Ast* ast, AstId id) {
+    return (NodeKind) ast->kind.data[id];
+}
+
+CXB_INLINE TokenKind ast_op(const Ast* ast, AstId id) {
+    return (TokenKind) ast->op.data[id];
+}
+
+CXB_INLINE u32 ast_sym(const Ast* ast, AstId id) {
+    return ast->sym.data[id];
+}
+
+CXB_INLINE u32 ast_n_kids(const Ast* ast, AstId id) {
+    return ast->n_kids.data[id];
+}
+
+CXB_INLINE AstId ast_kid(const Ast* ast, AstId id, u32 i) {
+    return ast->edges.data[ast->first_kid.data[id] + i];
+}
+
+CXB_INLINE const AstNodeData& ast_data(const Ast* ast, AstId id) {
+    return ast->data.data[id];
+}
+
+// interned identifiers: equal names have equal ids, dense from 0 in order of first appearance
+struct SymbolTable {
+    MHashMap<String8, u32, DefaultHasherBuiltin> ids;
+    MArray<String8> names; // by id, into the source
+};
+
 struct Parser;
 struct Module {
     String8 name;
     MemFile file;
+    String8 src; // the parsed source, tokens index into it
 
-    AstNode* root;
+    AstNode* root; // nullptr after a successful parse unless keep_tree, the errors point into it
+    SymbolTable symbols;
+    Ast* ast; // root flattened, nullptr if there are parse errors
+    bool keep_tree; // keep root and its nodes in tree once flattened, e.g. to compare the layouts
 
     Parser* parser;
     ParseErrorArray parse_errors;
@@ -261,16 +332,17 @@ struct Module {
 
 struct ParseFileResult {
     i64 num_errors;
-    FileOpenErr file_err;
+    FileErr file_err;
     String8 message;
 
 #ifdef __cplusplus
     inline operator bool() {
-        return !(num_errors == 0 && file_err == FileOpenErr::Success);
+        return !(num_errors == 0 && file_err == FileErr::Success);
     }
 #endif
 };
 
 C_EXPORT Module* module_make(String8 name, Arena* arena, Arena* tree);
 C_EXPORT ParseFileResult module_parse_file(Module* mod, String8 file_path);
+C_EXPORT ParseFileResult module_parse_string(Module* mod, String8 src);
 C_EXPORT void module_destroy(Module* module);
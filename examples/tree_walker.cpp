@@ -0,0 +1,416 @@
+#include "examples/interpreter.h"
+
+// native recursion per call, bounded well before the C stack is (Python defaults to 1000)
+constexpr u32 EVAL_MAX_DEPTH = 1024;
+constexpr u32 EVAL_MAX_ARGS = 64;
+
+Interpreter* interpreter_make(Arena* arena, u64 max_vars) {
+    Interpreter* ctx = arena_push<Interpreter>(arena);
+    ctx->arena = arena;
+    ctx->vars = Array<EvalVar>{arena_push_fast<EvalVar>(arena, max_vars), 0};
+    ctx->local_syms = Array<u32>{arena_push_fast<u32>(arena, max_vars), 0};
+    ctx->max_vars = max_vars;
+    return ctx;
+}
+
+INTERNAL Value eval_error(Interpreter* ctx, InterpErr err, String8 reason) {
+    ctx->err = err;
+    ctx->err_reason = reason;
+    ctx->flow = FLOW_ERROR;
+    return VALUE_NIL;
+}
+
+// the local sym of the current call, else the global sym, nullptr if it is undefined
+INTERNAL Value* find_var(Interpreter* ctx, u32 sym) {
+    for(u64 i = ctx->vars.len; i > ctx->frame_base; --i) {
+        Value* local = &ctx->vars[i - 1].value;
+        if(ctx->vars[i - 1].sym == sym) return local->bits == VALUE_UNDEFINED.bits ? nullptr : local;
+    }
+    Value* global = &ctx->globals[sym];
+    return global->bits == VALUE_UNDEFINED.bits ? nullptr : global;
+}
+
+INTERNAL Value declare_var(Interpreter* ctx, u32 sym, Value value) {
+    if(ctx->depth == 0) {
+        ctx->globals[sym] = value;
+        return value;
+    }
+    for(u64 i = ctx->frame_base; i < ctx->vars.len; ++i) {
+        if(ctx->vars[i].sym == sym) {
+            ctx->vars[i].value = value;
+            return value;
+        }
+    }
+    if(ctx->vars.len == ctx->max_vars) return eval_error(ctx, INTERP_ERR_STACK_OVERFLOW, S8_LIT("too many variables"));
+    ctx->vars.data[ctx->vars.len++] = EvalVar{sym, value};
+    return value;
+}
+
+INTERNAL Value dfs(Interpreter* ctx, AstId node);
+
+INTERNAL Value eval_body(Interpreter* ctx, AstId node) {
+    const Ast* ast = ctx->ast;
+    Value result = VALUE_NIL;
+    for(u32 i = 0; i < ast_n_kids(ast, node); ++i) {
+        result = dfs(ctx, ast_kid(ast, node, i));
+        if(ctx->flow != FLOW_NEXT) break;
+    }
+    return result;
+}
+
+INTERNAL Value eval_call(Interpreter* ctx, AstId node) {
+    const Ast* ast = ctx->ast;
+    u32 sym = ast_sym(ast, node);
+    AstId fn = ctx->funcs[sym];
+    if(fn == AST_NONE) {
+        return eval_error(ctx, INTERP_ERR_UNDEFINED, format(ctx->arena, "undefined function: {}", ctx->names[sym]));
+    }
+    // kids[0] = targs, kids[1] = args, kids[2] = body
+    AstId params = ast_kid(ast, fn, 1);
+    AstId args = ast_kid(ast, node, 0);
+    u32 n_params = ast_n_kids(ast, params);
+    u32 n_args = ast_n_kids(ast, args);
+    if(n_args != n_params) {
+        return eval_error(ctx,
+                          INTERP_ERR_ARGS,
+                          format(ctx->arena, "{} expects {} arguments, got {}", ctx->names[sym], n_params, n_args));
+    }
+    if(n_args > EVAL_MAX_ARGS) return eval_error(ctx, INTERP_ERR_ARGS, S8_LIT("too many arguments"));
+    if(ctx->depth == EVAL_MAX_DEPTH) return eval_error(ctx, INTERP_ERR_STACK_OVERFLOW, S8_LIT("stack overflow"));
+
+    // found on the first call of each function of a run
+    EvalLocals& locals = ctx->locals[sym];
+    if(locals.fn != fn) {
+        ArenaTmp tmp = begin_scratch();
+        Array<u32> syms = ast_func_locals(tmp.arena, ast, fn);
+        if(ctx->local_syms.len + syms.len > ctx->max_vars) {
+            end_scratch(tmp);
+            return eval_error(ctx, INTERP_ERR_STACK_OVERFLOW, S8_LIT("too many variables"));
+        }
+        locals = EvalLocals{fn, Array<u32>{ctx->local_syms.data + ctx->local_syms.len, syms.len}};
+        for(u64 i = 0; i < syms.len; ++i) locals.syms[i] = syms[i];
+        ctx->local_syms.len += syms.len;
+        end_scratch(tmp);
+    }
+
+    // the arguments are evaluated in the caller's frame
+    Value values[EVAL_MAX_ARGS];
+    for(u32 i = 0; i < n_args; ++i) {
+        values[i] = dfs(ctx, ast_kid(ast, args, i));
+        if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+    }
+
+    u64 caller_base = ctx->frame_base;
+    ctx->frame_base = ctx->vars.len;
+    ctx->depth += 1;
+    for(u32 i = 0; i < n_params; ++i) declare_var(ctx, ast_sym(ast, ast_kid(ast, params, i)), values[i]);
+    // the other locals are undefined until their declaration runs
+    for(u64 i = n_params; i < locals.syms.len && ctx->flow == FLOW_NEXT; ++i) {
+        declare_var(ctx, locals.syms[i], VALUE_UNDEFINED);
+    }
+    eval_body(ctx, ast_kid(ast, fn, 2));
+    ctx->depth -= 1;
+    ctx->vars.len = ctx->frame_base;
+    ctx->frame_base = caller_base;
+
+    switch(ctx->flow) {
+        case FLOW_NEXT:
+            return VALUE_NIL;
+        case FLOW_RETURN:
+            ctx->flow = FLOW_NEXT;
+            return ctx->ret_value;
+        case FLOW_BREAK:
+        case FLOW_CONTINUE:
+            return eval_error(ctx, INTERP_ERR_COMPILE, S8_LIT("break or continue outside of a loop"));
+        case FLOW_ERROR:
+            return VALUE_NIL;
+    }
+    return VALUE_NIL;
+}
+
+// lhs op rhs, ints and doubles inline
+INTERNAL Value eval_arith(Interpreter* ctx, ValueOp op, Value lhs, Value rhs) {
+    Value out;
+    bool fast = false;
+    switch(op) {
+        case VALUE_ADD:
+            fast = value_try_add(lhs, rhs, &out);
+            break;
+        case VALUE_SUB:
+            fast = value_try_sub(lhs, rhs, &out);
+            break;
+        case VALUE_MUL:
+            fast = value_try_mul(lhs, rhs, &out);
+            break;
+        case VALUE_DIV:
+            fast = value_try_div(lhs, rhs, &out);
+            break;
+        case VALUE_LT:
+            fast = value_try_lt(lhs, rhs, &out);
+            break;
+        case VALUE_LE:
+            fast = value_try_le(lhs, rhs, &out);
+            break;
+        case VALUE_EQ:
+            fast = value_try_eq(lhs, rhs, &out);
+            break;
+        case VALUE_NE:
+            fast = value_try_ne(lhs, rhs, &out);
+            break;
+    }
+    if(LIKELY(fast)) return out;
+    EvalResult result = value_arith(ctx->arena, op, lhs, rhs);
+    if(result) return eval_error(ctx, result.error, result.reason);
+    return result.value;
+}
+
+INTERNAL ValueOp value_op(TokenKind kind) {
+    switch(kind) {
+        case TOK_PLUS_OP:
+        case TOK_PLUS_EQUALS_OP:
+            return VALUE_ADD;
+        case TOK_MINUS_OP:
+        case TOK_MINUS_EQUALS_OP:
+            return VALUE_SUB;
+        case TOK_MUL_OP:
+        case TOK_MUL_EQUALS_OP:
+            return VALUE_MUL;
+        case TOK_DIV_OP:
+        case TOK_DIV_EQUALS_OP:
+            return VALUE_DIV;
+        case TOK_LESS_THAN_OP:
+            return VALUE_LT;
+        case TOK_LESS_THAN_EQUAL_TO_OP:
+            return VALUE_LE;
+        case TOK_EQUALITY_OP:
+            return VALUE_EQ;
+        default:
+            return VALUE_NE;
+    }
+}
+
+INTERNAL Value eval_assign(Interpreter* ctx, AstId node) {
+    const Ast* ast = ctx->ast;
+    AstId lhs = ast_kid(ast, node, 0);
+    if(lhs == AST_NONE || ast_kind(ast, lhs) != NODE_IDENTIFIER) {
+        return eval_error(ctx, INTERP_ERR_COMPILE, S8_LIT("can only assign to a variable"));
+    }
+    Value rhs = dfs(ctx, ast_kid(ast, node, 1));
+    if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+
+    u32 sym = ast_sym(ast, lhs);
+    TokenKind op = ast_op(ast, node);
+    if(op == TOK_COLON_EQUALS_OP) return declare_var(ctx, sym, rhs);
+    Value* var = find_var(ctx, sym);
+    if(var == nullptr) {
+        return eval_error(ctx, INTERP_ERR_UNDEFINED, format(ctx->arena, "undefined variable: {}", ctx->names[sym]));
+    }
+    switch(op) {
+        case TOK_EQUALS_OP:
+            *var = rhs;
+            return rhs;
+        case TOK_PLUS_EQUALS_OP:
+        case TOK_MINUS_EQUALS_OP:
+        case TOK_MUL_EQUALS_OP:
+        case TOK_DIV_EQUALS_OP: {
+            Value value = eval_arith(ctx, value_op(op), *var, rhs);
+            if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+            *var = value;
+            return value;
+        }
+        default:
+            return eval_error(ctx, INTERP_ERR_COMPILE, S8_LIT("unsupported assignment"));
+    }
+}
+
+INTERNAL Value eval_bin_op(Interpreter* ctx, AstId node) {
+    const Ast* ast = ctx->ast;
+    TokenKind op = ast_op(ast, node);
+    switch(op) {
+        case TOK_EQUALS_OP:
+        case TOK_COLON_EQUALS_OP:
+        case TOK_PLUS_EQUALS_OP:
+        case TOK_MINUS_EQUALS_OP:
+        case TOK_MUL_EQUALS_OP:
+        case TOK_DIV_EQUALS_OP:
+            return eval_assign(ctx, node);
+        case TOK_AND_OP: {
+            Value lhs = dfs(ctx, ast_kid(ast, node, 0));
+            if(ctx->flow != FLOW_NEXT || !value_truthy(lhs)) return lhs;
+            return dfs(ctx, ast_kid(ast, node, 1));
+        }
+        case TOK_OR_OP: {
+            Value lhs = dfs(ctx, ast_kid(ast, node, 0));
+            if(ctx->flow != FLOW_NEXT || value_truthy(lhs)) return lhs;
+            return dfs(ctx, ast_kid(ast, node, 1));
+        }
+        default:
+            break;
+    }
+
+    Value lhs = dfs(ctx, ast_kid(ast, node, 0));
+    if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+    Value rhs = dfs(ctx, ast_kid(ast, node, 1));
+    if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+    switch(op) {
+        case TOK_PLUS_OP:
+        case TOK_MINUS_OP:
+        case TOK_MUL_OP:
+        case TOK_DIV_OP:
+        case TOK_LESS_THAN_OP:
+        case TOK_LESS_THAN_EQUAL_TO_OP:
+        case TOK_EQUALITY_OP:
+        case TOK_NOT_EQUAL_OP:
+            return eval_arith(ctx, value_op(op), lhs, rhs);
+        case TOK_GREATER_THAN_OP:
+            return eval_arith(ctx, VALUE_LT, rhs, lhs);
+        case TOK_GREATER_THAN_EQUAL_TO_OP:
+            return eval_arith(ctx, VALUE_LE, rhs, lhs);
+        default:
+            return eval_error(ctx, INTERP_ERR_COMPILE, format(ctx->arena, "invalid bin op: {}", (int) op));
+    }
+}
+
+INTERNAL Value dfs(Interpreter* ctx, AstId node) {
+    if(node == AST_NONE) return eval_error(ctx, INTERP_ERR_COMPILE, S8_LIT("invalid node"));
+
+    const Ast* ast = ctx->ast;
+    NodeKind kind = ast_kind(ast, node);
+    switch(kind) {
+        case NODE_MODULE:
+        case NODE_BODY:
+            return eval_body(ctx, node);
+        case NODE_FUNC_DECL:
+            ctx->funcs[ast_sym(ast, node)] = node;
+            return VALUE_NIL;
+        case NODE_FUNC_CALL:
+            return eval_call(ctx, node);
+        case NODE_VAR_DECL: {
+            Value value = VALUE_NIL;
+            if(ast_n_kids(ast, node) > 1 && ast_kid(ast, node, 1) != AST_NONE) {
+                value = dfs(ctx, ast_kid(ast, node, 1));
+                if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+            }
+            return declare_var(ctx, ast_sym(ast, node), value);
+        }
+        case NODE_IDENTIFIER: {
+            u32 sym = ast_sym(ast, node);
+            Value* var = find_var(ctx, sym);
+            if(var == nullptr) {
+                return eval_error(
+                    ctx, INTERP_ERR_UNDEFINED, format(ctx->arena, "undefined variable: {}", ctx->names[sym]));
+            }
+            return *var;
+        }
+        case NODE_IF: {
+            // kid(0) == cond, kid(1) == body, kid(2..) == elif/else
+            Value cond = dfs(ctx, ast_kid(ast, node, 0));
+            if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+            if(value_truthy(cond)) return dfs(ctx, ast_kid(ast, node, 1));
+            for(u32 i = 2; i < ast_n_kids(ast, node); ++i) {
+                AstId branch = ast_kid(ast, node, i);
+                if(ast_kind(ast, branch) == NODE_ELSE) return dfs(ctx, ast_kid(ast, branch, 0));
+                cond = dfs(ctx, ast_kid(ast, branch, 0));
+                if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+                if(value_truthy(cond)) return dfs(ctx, ast_kid(ast, branch, 1));
+            }
+            return VALUE_NIL;
+        }
+        case NODE_WHILE: {
+            while(true) {
+                Value cond = dfs(ctx, ast_kid(ast, node, 0));
+                if(ctx->flow != FLOW_NEXT || !value_truthy(cond)) break;
+                dfs(ctx, ast_kid(ast, node, 1));
+                if(ctx->flow == FLOW_BREAK) {
+                    ctx->flow = FLOW_NEXT;
+                    break;
+                } else if(ctx->flow == FLOW_CONTINUE) {
+                    ctx->flow = FLOW_NEXT;
+                } else if(ctx->flow != FLOW_NEXT) {
+                    break;
+                }
+            }
+            return VALUE_NIL;
+        }
+        case NODE_BREAK:
+            ctx->flow = FLOW_BREAK;
+            return VALUE_NIL;
+        case NODE_CONT:
+            ctx->flow = FLOW_CONTINUE;
+            return VALUE_NIL;
+        case NODE_RET: {
+            Value value = VALUE_NIL;
+            if(ast_n_kids(ast, node) > 0) {
+                value = dfs(ctx, ast_kid(ast, node, 0));
+                if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+            }
+            ctx->ret_value = value;
+            ctx->flow = FLOW_RETURN;
+            return value;
+        }
+        case NODE_BIN_OP:
+            return eval_bin_op(ctx, node);
+        case NODE_UNARY_OP: {
+            Value value = dfs(ctx, ast_kid(ast, node, 0));
+            if(ctx->flow != FLOW_NEXT) return VALUE_NIL;
+            TokenKind op = ast_op(ast, node);
+            if(op == TOK_PLUS_OP) return value;
+            if(op != TOK_MINUS_OP) return eval_error(ctx, INTERP_ERR_COMPILE, S8_LIT("invalid unary op"));
+            if(value_is_int(value)) return value_number(-value_as_int(value));
+            EvalResult result = value_neg(ctx->arena, value);
+            if(result) return eval_error(ctx, result.error, result.reason);
+            return result.value;
+        }
+        case NODE_INT_LIT:
+            return value_number(ast_data(ast, node).numeral_literal.value);
+        case NODE_FLOAT_LIT:
+            return value_double(ast_data(ast, node).float_literal.value);
+        case NODE_BOOL_LIT:
+            return value_bool(ast_data(ast, node).numeral_literal.value != 0);
+        case NODE_STRING_LIT:
+            return value_str(&ast_data(ast, node).string_literal);
+        case NODE_NIL_LIT:
+            return VALUE_NIL;
+        case NODE_ELIF:
+        case NODE_ELSE:
+            return eval_error(ctx, INTERP_ERR_COMPILE, S8_LIT("unexpected elif/else"));
+        default:
+            return eval_error(ctx, INTERP_ERR_COMPILE, format(ctx->arena, "unsupported node kind: {}", (int) kind));
+    }
+}
+
+EvalResult eval(Interpreter* ctx, Module* mod) {
+    if(mod->ast == nullptr) {
+        return EvalResult{
+            .value = VALUE_NIL, .error = INTERP_ERR_COMPILE, .reason = S8_LIT("the module has parse errors")};
+    }
+
+    // each call runs the module from scratch
+    ctx->ast = mod->ast;
+    u64 n_symbols = mod->symbols.names.len;
+    if(n_symbols > ctx->funcs.len) {
+        ctx->funcs = arena_push_array_fast<AstId>(ctx->arena, n_symbols);
+        ctx->globals = arena_push_array_fast<Value>(ctx->arena, n_symbols);
+        ctx->locals = arena_push_array_fast<EvalLocals>(ctx->arena, n_symbols);
+    }
+    for(u64 i = 0; i < n_symbols; ++i) {
+        ctx->funcs[i] = AST_NONE;
+        ctx->globals[i] = VALUE_UNDEFINED;
+        ctx->locals[i].fn = AST_NONE;
+    }
+    ctx->local_syms.len = 0;
+    ctx->names = Array<String8>{mod->symbols.names.data, n_symbols};
+    ctx->vars.len = 0;
+    ctx->frame_base = 0;
+    ctx->depth = 0;
+    ctx->flow = FLOW_NEXT;
+    ctx->err = INTERP_OK;
+    Value value = dfs(ctx, mod->ast->root);
+    if(ctx->flow == FLOW_RETURN) {
+        value = ctx->ret_value;
+    } else if(ctx->flow == FLOW_BREAK || ctx->flow == FLOW_CONTINUE) {
+        eval_error(ctx, INTERP_ERR_COMPILE, S8_LIT("break or continue outside of a loop"));
+    }
+    ctx->flow = FLOW_NEXT;
+    return EvalResult{.value = value, .error = ctx->err, .reason = ctx->err_reason};
+}
@@ -0,0 +1,165 @@
+#include "examples/interpreter.h"
+
+GLOBAL const char* VALUE_OP_NAMES[] = {"+", "-", "*", "/", "<", "<=", "==", "!="};
+
+INTERNAL bool value_is_number(Value v) {
+    return value_is_int(v) || value_is_double(v);
+}
+
+INTERNAL f64 value_to_f64(Value v) {
+    return value_is_int(v) ? (f64) value_as_int(v) : value_as_double(v);
+}
+
+INTERNAL EvalResult value_ok(Value v) {
+    return EvalResult{.value = v, .error = INTERP_OK, .reason = {}};
+}
+
+INTERNAL EvalResult int_arith(ValueOp op, i64 x, i64 y) {
+    switch(op) {
+        case VALUE_ADD:
+            return value_ok(value_number(x + y));
+        case VALUE_SUB:
+            return value_ok(value_number(x - y));
+        case VALUE_MUL:
+            return value_ok(value_mul_int(x, y));
+        case VALUE_DIV:
+            if(y == 0) {
+                return EvalResult{
+                    .value = VALUE_NIL, .error = INTERP_ERR_DIV_BY_ZERO, .reason = S8_LIT("division by zero")};
+            }
+            return value_ok(value_number(x / y));
+        case VALUE_LT:
+            return value_ok(value_bool(x < y));
+        case VALUE_LE:
+            return value_ok(value_bool(x <= y));
+        case VALUE_EQ:
+            return value_ok(value_bool(x == y));
+        case VALUE_NE:
+            return value_ok(value_bool(x != y));
+    }
+    return value_ok(VALUE_NIL);
+}
+
+INTERNAL Value double_arith(ValueOp op, f64 x, f64 y) {
+    switch(op) {
+        case VALUE_ADD:
+            return value_double(x + y);
+        case VALUE_SUB:
+            return value_double(x - y);
+        case VALUE_MUL:
+            return value_double(x * y);
+        case VALUE_DIV:
+            return value_double(x / y);
+        case VALUE_LT:
+            return value_bool(x < y);
+        case VALUE_LE:
+            return value_bool(x <= y);
+        case VALUE_EQ:
+            return value_bool(x == y);
+        case VALUE_NE:
+            return value_bool(x != y);
+    }
+    return VALUE_NIL;
+}
+
+EvalResult value_arith(Arena* arena, ValueOp op, Value a, Value b) {
+    if(value_both_int(a, b)) return int_arith(op, value_as_int(a), value_as_int(b));
+    // ints are exact as doubles
+    if(value_is_number(a) && value_is_number(b)) return value_ok(double_arith(op, value_to_f64(a), value_to_f64(b)));
+
+    switch(op) {
+        case VALUE_EQ:
+            return value_ok(value_bool(value_equal(a, b)));
+        case VALUE_NE:
+            return value_ok(value_bool(!value_equal(a, b)));
+        case VALUE_ADD:
+            if(value_is_str(a) && value_is_str(b)) {
+                const String8* x = value_as_str(a);
+                const String8* y = value_as_str(b);
+                String8* s = arena_push<String8>(arena);
+                s->data = arena_push_fast<char>(arena, x->len + y->len);
+                s->len = x->len + y->len;
+                s->not_null_term = true;
+                memcpy(s->data, x->data, x->len);
+                memcpy(s->data + x->len, y->data, y->len);
+                return value_ok(value_str(s));
+            }
+            break;
+        default:
+            break;
+    }
+    return EvalResult{
+        .value = VALUE_NIL,
+        .error = INTERP_ERR_TYPE,
+        .reason = format(arena,
+                         "unsupported operands for {}: {} and {}",
+                         VALUE_OP_NAMES[op],
+                         value_type_name(a),
+                         value_type_name(b)),
+    };
+}
+
+EvalResult value_neg(Arena* arena, Value a) {
+    if(value_is_int(a)) return value_ok(value_number(-value_as_int(a)));
+    if(value_is_double(a)) return value_ok(value_double(-value_as_double(a)));
+    return EvalResult{
+        .value = VALUE_NIL,
+        .error = INTERP_ERR_TYPE,
+        .reason = format(arena, "unsupported operand for -: {}", value_type_name(a)),
+    };
+}
+
+bool value_equal(Value a, Value b) {
+    if(value_is_number(a) && value_is_number(b)) {
+        if(value_both_int(a, b)) return a.bits == b.bits;
+        return value_to_f64(a) == value_to_f64(b);
+    }
+    if(value_is_str(a) && value_is_str(b)) return *value_as_str(a) == *value_as_str(b);
+    return a.bits == b.bits;
+}
+
+const char* value_type_name(Value v) {
+    if(value_is_double(v)) return "float";
+    switch(v.bits & VALUE_TAG_MASK) {
+        case VALUE_TAG_NIL:
+            return "nil";
+        case VALUE_TAG_BOOL:
+            return "bool";
+        case VALUE_TAG_INT:
+            return "int";
+        case VALUE_TAG_STR:
+            return "str";
+        default:
+            return "object";
+    }
+}
+
+// the shortest representation that reads back as x, with a ".0" if it would read as an int
+INTERNAL String8 format_double(Arena* arena, f64 x) {
+    char buf[32];
+    int n = 0;
+    for(int precision = 1; precision <= 17; ++precision) {
+        n = snprintf(buf, sizeof(buf), "%.*g", precision, x);
+        if(strtod(buf, nullptr) == x) break;
+    }
+    String8 s = String8{.data = buf, .len = (size_t) n, .not_null_term = true};
+    // not an exponent, inf or nan either
+    if(strpbrk(buf, ".ein") == nullptr) return format(arena, "{}.0", s);
+    return format(arena, "{}", s);
+}
+
+String8 value_format(Arena* arena, Value v) {
+    if(value_is_double(v)) return format_double(arena, value_as_double(v));
+    switch(v.bits & VALUE_TAG_MASK) {
+        case VALUE_TAG_NIL:
+            return v.bits == VALUE_UNDEFINED.bits ? S8_LIT("undefined") : S8_LIT("nil");
+        case VALUE_TAG_BOOL:
+            return v.bits == VALUE_TRUE.bits ? S8_LIT("true") : S8_LIT("false");
+        case VALUE_TAG_INT:
+            return format(arena, "{}", value_as_int(v));
+        case VALUE_TAG_STR:
+            return *value_as_str(v);
+        default:
+            return format(arena, "<object {}>", (u64) value_as_obj(v));
+    }
+}
@@ -0,0 +1,1011 @@
+#include "examples/interpreter.h"
+
+/* SECTION: compiler */
+constexpr i32 REG_ANY = -1;  // a local's own register or a new temporary
+constexpr i32 REG_NONE = -2; // the value is unused
+constexpr u32 BC_MAX_REGS = 256;
+constexpr u32 BC_MAX_BX = UINT16_MAX; // constant and function indices
+constexpr u32 BC_UNDECLARED = UINT32_MAX;
+
+struct BcLocal {
+    u32 sym;
+    u32 reg;
+    u32 declared_at; // the n_cond of a declaration that ran on every path to the code being compiled, or BC_UNDECLARED
+};
+
+struct BcLoop {
+    u64 start;
+    AArray<u64> breaks;
+};
+
+struct Compiler;
+
+struct FuncState {
+    Compiler* c;
+    bool is_main; // declarations are globals
+    AArray<BcInst> code;
+    AArray<Value> k;
+    AHashMap<u64, u32, DefaultHasherBuiltin> k_index; // bits -> index into k
+    AArray<BcLocal> locals; // locals[i].reg == i, all of the function's from its entry
+    u32 n_cond;             // > 0 while compiling code that may not run: branches, loops, the rhs of and/or
+    u32 next_reg;
+    u32 max_regs;
+    BcLoop* loop;
+};
+
+struct Compiler {
+    Arena* arena;
+    const Ast* ast;
+    Array<String8> names; // by symbol
+    AArray<BcFunc*> protos;
+    AArray<u32> call_sites;
+    AArray<BcCompileError> errors;
+};
+
+INTERNAL u32 compile_expr(FuncState* fs, AstId node, i32 dst);
+
+INTERNAL void compile_error(FuncState* fs, AstId node, String8 message) {
+    fs->c->errors.push_back(BcCompileError{node, message});
+}
+
+INTERNAL u64 emit(FuncState* fs, BcInst inst) {
+    fs->code.push_back(inst);
+    return fs->code.len - 1;
+}
+
+// points the jump at `at` to target
+INTERNAL void patch_jump(FuncState* fs, u64 at, u64 target) {
+    i64 offset = (i64) target - (i64) (at + 1);
+    if(offset < INT16_MIN || offset > INT16_MAX) {
+        compile_error(fs, AST_NONE, S8_LIT("jump too far"));
+        return;
+    }
+    fs->code[at] = bc_abx(BC_OP(fs->code[at]), BC_A(fs->code[at]), (i32) offset);
+}
+
+INTERNAL u32 alloc_reg(FuncState* fs) {
+    if(fs->next_reg == BC_MAX_REGS) {
+        compile_error(fs, AST_NONE, S8_LIT("too many registers"));
+        return BC_MAX_REGS - 1;
+    }
+    fs->next_reg += 1;
+    fs->max_regs = max(fs->max_regs, fs->next_reg);
+    return fs->next_reg - 1;
+}
+
+INTERNAL u32 target_reg(FuncState* fs, i32 dst) {
+    return dst >= 0 ? (u32) dst : alloc_reg(fs);
+}
+
+INTERNAL u32 add_k(FuncState* fs, AstId node, Value value) {
+    auto* entry = fs->k_index.occupied_entry_for(value.bits);
+    if(entry != nullptr) return entry->kv.value;
+    if(fs->k.len > BC_MAX_BX) {
+        compile_error(fs, node, S8_LIT("too many constants"));
+        return 0;
+    }
+    u32 idx = (u32) fs->k.len;
+    fs->k.push_back(value);
+    fs->k_index.put({value.bits, idx});
+    return idx;
+}
+
+// the bx of GETG, SETG, DEFG and CHKDEF for the variable named by node
+INTERNAL i32 global_operand(FuncState* fs, AstId node) {
+    u32 sym = ast_sym(fs->c->ast, node);
+    if(sym > UINT16_MAX) compile_error(fs, node, S8_LIT("too many names"));
+    return (i32) sym;
+}
+
+INTERNAL i32 find_local(FuncState* fs, u32 sym) {
+    for(u64 i = fs->locals.len; i > 0; --i) {
+        if(fs->locals[i - 1].sym == sym) return (i32) fs->locals[i - 1].reg;
+    }
+    return -1;
+}
+
+// an error if the local reg named by node is used before its declaration ran
+INTERNAL void emit_check_declared(FuncState* fs, AstId node, u32 reg) {
+    if(fs->locals[reg].declared_at == BC_UNDECLARED) emit(fs, bc_abx(OP_CHKDEF, reg, global_operand(fs, node)));
+}
+
+INTERNAL void begin_cond(FuncState* fs) {
+    fs->n_cond += 1;
+}
+
+// the declarations compiled since the matching begin_cond may not have run
+INTERNAL void end_cond(FuncState* fs) {
+    fs->n_cond -= 1;
+    for(BcLocal& local : fs->locals) {
+        if(local.declared_at != BC_UNDECLARED && local.declared_at > fs->n_cond) local.declared_at = BC_UNDECLARED;
+    }
+}
+
+INTERNAL void emit_mov(FuncState* fs, u32 dst, u32 src) {
+    if(dst != src) emit(fs, bc_abc(OP_MOV, dst, src, 0));
+}
+
+INTERNAL void emit_value(FuncState* fs, AstId node, u32 dst, Value value) {
+    if(value_is_int(value) && value_as_int(value) >= INT16_MIN && value_as_int(value) <= INT16_MAX) {
+        emit(fs, bc_abx(OP_LOADI, dst, (i32) value_as_int(value)));
+    } else if(value_is_nil(value)) {
+        emit(fs, bc_abc(OP_LOADNIL, dst, 0, 0));
+    } else {
+        emit(fs, bc_abx(OP_LOADK, dst, (i32) add_k(fs, node, value)));
+    }
+}
+
+// compiles a statement, temporaries are released after it
+INTERNAL void compile_stmt(FuncState* fs, AstId node, i32 dst) {
+    u32 save = fs->next_reg;
+    compile_expr(fs, node, dst);
+    fs->next_reg = max(save, (u32) fs->locals.len);
+}
+
+// a body's value is the value of its last statement
+INTERNAL void compile_block(FuncState* fs, AstId node, i32 dst) {
+    const Ast* ast = fs->c->ast;
+    if(node == AST_NONE || (ast_kind(ast, node) != NODE_BODY && ast_kind(ast, node) != NODE_MODULE)) {
+        compile_stmt(fs, node, dst);
+        return;
+    }
+    u32 n = ast_n_kids(ast, node);
+    if(n == 0) {
+        if(dst >= 0) emit(fs, bc_abc(OP_LOADNIL, dst, 0, 0));
+        return;
+    }
+    for(u32 i = 0; i + 1 < n; ++i) compile_stmt(fs, ast_kid(ast, node, i), REG_NONE);
+    compile_stmt(fs, ast_kid(ast, node, n - 1), dst);
+}
+
+// compiles cond, returns the position of the jump taken when it is false
+INTERNAL u64 compile_cond_jump(FuncState* fs, AstId cond) {
+    u32 save = fs->next_reg;
+    u32 r = compile_expr(fs, cond, REG_ANY);
+    fs->next_reg = save;
+    return emit(fs, bc_abx(OP_JMPF, r, 0));
+}
+
+INTERNAL BcFunc* compile_func(Compiler* c, AstId node);
+
+// name is the declared identifier: the NODE_VAR_DECL itself or the lhs of :=
+INTERNAL u32 compile_var_decl(FuncState* fs, AstId name, AstId init, i32 dst) {
+    if(fs->is_main) {
+        u32 r = init == AST_NONE ? target_reg(fs, dst) : compile_expr(fs, init, dst);
+        if(init == AST_NONE) emit(fs, bc_abc(OP_LOADNIL, r, 0, 0));
+        emit(fs, bc_abx(OP_DEFG, r, global_operand(fs, name)));
+        return r;
+    }
+
+    i32 reg = find_local(fs, ast_sym(fs->c->ast, name));
+    ASSERT(reg >= 0, "the locals are allocated at the function's entry");
+    if(init == AST_NONE) {
+        emit(fs, bc_abc(OP_LOADNIL, reg, 0, 0));
+    } else {
+        compile_expr(fs, init, reg);
+    }
+    if(fs->locals[reg].declared_at == BC_UNDECLARED) fs->locals[reg].declared_at = fs->n_cond;
+    if(dst >= 0) emit_mov(fs, dst, reg);
+    return reg;
+}
+
+INTERNAL BcOp arith_op(TokenKind kind) {
+    switch(kind) {
+        case TOK_PLUS_OP:
+        case TOK_PLUS_EQUALS_OP:
+            return OP_ADD;
+        case TOK_MINUS_OP:
+        case TOK_MINUS_EQUALS_OP:
+            return OP_SUB;
+        case TOK_MUL_OP:
+        case TOK_MUL_EQUALS_OP:
+            return OP_MUL;
+        case TOK_DIV_OP:
+        case TOK_DIV_EQUALS_OP:
+            return OP_DIV;
+        default:
+            return OP_COUNT;
+    }
+}
+
+// rb op rhs into t, with ADDI for small integer literals
+INTERNAL void emit_arith(FuncState* fs, BcOp op, u32 t, u32 rb, AstId rhs) {
+    const Ast* ast = fs->c->ast;
+    if((op == OP_ADD || op == OP_SUB) && rhs != AST_NONE && ast_kind(ast, rhs) == NODE_INT_LIT) {
+        i64 value = ast_data(ast, rhs).numeral_literal.value;
+        i64 imm = op == OP_ADD ? value : -value;
+        // a negative immediate is a subtraction, for the error messages of non-numbers
+        if(imm >= INT8_MIN && imm <= INT8_MAX && (op == OP_ADD) == (imm >= 0)) {
+            emit(fs, bc_abc(OP_ADDI, t, rb, (u8) (int8_t) imm));
+            return;
+        }
+    }
+    u32 save = fs->next_reg;
+    u32 rc = compile_expr(fs, rhs, REG_ANY);
+    fs->next_reg = save;
+    emit(fs, bc_abc(op, t, rb, rc));
+}
+
+INTERNAL u32 compile_assign(FuncState* fs, AstId node, i32 dst) {
+    const Ast* ast = fs->c->ast;
+    AstId lhs = ast_kid(ast, node, 0);
+    AstId rhs = ast_kid(ast, node, 1);
+    if(lhs == AST_NONE || ast_kind(ast, lhs) != NODE_IDENTIFIER) {
+        compile_error(fs, node, S8_LIT("can only assign to a variable"));
+        return 0;
+    }
+    TokenKind kind = ast_op(ast, node);
+    if(kind == TOK_COLON_EQUALS_OP) return compile_var_decl(fs, lhs, rhs, dst);
+
+    BcOp op = arith_op(kind);
+    if(op == OP_COUNT && kind != TOK_EQUALS_OP) {
+        compile_error(fs, node, S8_LIT("unsupported assignment"));
+        return 0;
+    }
+
+    i32 local = fs->is_main ? -1 : find_local(fs, ast_sym(ast, lhs));
+    if(local >= 0 && fs->locals[local].declared_at == BC_UNDECLARED) {
+        // the rhs runs before the check, as in the tree walker
+        u32 save = fs->next_reg;
+        u32 rc = compile_expr(fs, rhs, REG_ANY);
+        fs->next_reg = save;
+        emit_check_declared(fs, lhs, local);
+        if(op == OP_COUNT) {
+            emit_mov(fs, local, rc);
+        } else {
+            emit(fs, bc_abc(op, local, local, rc));
+        }
+        if(dst >= 0) emit_mov(fs, dst, local);
+        return local;
+    }
+    if(local >= 0) {
+        if(op == OP_COUNT) {
+            compile_expr(fs, rhs, local);
+        } else {
+            emit_arith(fs, op, local, local, rhs);
+        }
+        if(dst >= 0) emit_mov(fs, dst, local);
+        return local;
+    }
+
+    i32 global = global_operand(fs, lhs);
+    u32 t = target_reg(fs, dst);
+    if(op == OP_COUNT) {
+        compile_expr(fs, rhs, t);
+    } else {
+        emit(fs, bc_abx(OP_GETG, t, global));
+        emit_arith(fs, op, t, t, rhs);
+    }
+    emit(fs, bc_abx(OP_SETG, t, global));
+    return t;
+}
+
+INTERNAL u32 compile_bin_op(FuncState* fs, AstId node, i32 dst) {
+    const Ast* ast = fs->c->ast;
+    TokenKind kind = ast_op(ast, node);
+    switch(kind) {
+        case TOK_EQUALS_OP:
+        case TOK_COLON_EQUALS_OP:
+        case TOK_PLUS_EQUALS_OP:
+        case TOK_MINUS_EQUALS_OP:
+        case TOK_MUL_EQUALS_OP:
+        case TOK_DIV_EQUALS_OP:
+            return compile_assign(fs, node, dst);
+        case TOK_AND_OP:
+        case TOK_OR_OP: {
+            // into a temporary: dst may be a local read by the rhs
+            u32 t = alloc_reg(fs);
+            compile_expr(fs, ast_kid(ast, node, 0), t);
+            u64 jump = emit(fs, bc_abx(kind == TOK_AND_OP ? OP_JMPF : OP_JMPT, t, 0));
+            begin_cond(fs);
+            compile_expr(fs, ast_kid(ast, node, 1), t);
+            end_cond(fs);
+            patch_jump(fs, jump, fs->code.len);
+            if(dst >= 0) {
+                emit_mov(fs, dst, t);
+                return dst;
+            }
+            return t;
+        }
+        default:
+            break;
+    }
+
+    AstId lhs = ast_kid(ast, node, 0);
+    AstId rhs = ast_kid(ast, node, 1);
+    BcOp op = arith_op(kind);
+    if(op != OP_COUNT) {
+        u32 save = fs->next_reg;
+        u32 rb = compile_expr(fs, lhs, REG_ANY);
+        u32 t = dst >= 0 ? (u32) dst : save;
+        emit_arith(fs, op, t, rb, rhs);
+        fs->next_reg = save;
+        if(dst < 0) alloc_reg(fs);
+        return t;
+    }
+
+    bool swap = false;
+    switch(kind) {
+        case TOK_LESS_THAN_OP:
+            op = OP_LT;
+            break;
+        case TOK_LESS_THAN_EQUAL_TO_OP:
+            op = OP_LE;
+            break;
+        case TOK_GREATER_THAN_OP:
+            op = OP_LT;
+            swap = true;
+            break;
+        case TOK_GREATER_THAN_EQUAL_TO_OP:
+            op = OP_LE;
+            swap = true;
+            break;
+        case TOK_EQUALITY_OP:
+            op = OP_EQ;
+            break;
+        case TOK_NOT_EQUAL_OP:
+            op = OP_NE;
+            break;
+        default:
+            compile_error(fs, node, S8_LIT("invalid bin op"));
+            return 0;
+    }
+    u32 save = fs->next_reg;
+    u32 rb = compile_expr(fs, lhs, REG_ANY);
+    u32 rc = compile_expr(fs, rhs, REG_ANY);
+    fs->next_reg = save;
+    u32 t = target_reg(fs, dst);
+    emit(fs, swap ? bc_abc(op, t, rc, rb) : bc_abc(op, t, rb, rc));
+    return t;
+}
+
+INTERNAL u32 compile_call(FuncState* fs, AstId node, i32 dst) {
+    const Ast* ast = fs->c->ast;
+    AstId args = ast_kid(ast, node, 0);
+    u32 n_args = ast_n_kids(ast, args);
+    if(n_args >= BC_MAX_REGS) {
+        compile_error(fs, node, S8_LIT("too many arguments"));
+        return 0;
+    }
+
+    // the arguments are the first registers of the callee's frame, above every live register
+    u32 save = fs->next_reg;
+    u32 base = fs->next_reg;
+    for(u32 i = 0; i < max(n_args, 1u); ++i) alloc_reg(fs);
+    for(u32 i = 0; i < n_args; ++i) compile_expr(fs, ast_kid(ast, args, i), (i32) (base + i));
+    emit(fs, bc_abc(OP_CALL, base, n_args, 0));
+    fs->c->call_sites.push_back(ast_sym(ast, node));
+    emit(fs, (BcInst) (fs->c->call_sites.len - 1));
+    fs->next_reg = save;
+
+    if(dst >= 0) {
+        emit_mov(fs, dst, base);
+        return dst;
+    }
+    return alloc_reg(fs);
+}
+
+INTERNAL u32 compile_if(FuncState* fs, AstId node, i32 dst) {
+    // kid(0) == cond, kid(1) == body, kid(2..) == elif/else
+    const Ast* ast = fs->c->ast;
+    u32 t = dst == REG_ANY ? alloc_reg(fs) : (u32) dst;
+    i32 body_dst = dst == REG_NONE ? REG_NONE : (i32) t;
+    AstId else_body = AST_NONE;
+    u32 n_branches = 1;
+    for(u32 i = 2; i < ast_n_kids(ast, node); ++i) {
+        AstId branch = ast_kid(ast, node, i);
+        if(ast_kind(ast, branch) == NODE_ELSE) {
+            else_body = ast_kid(ast, branch, 0);
+            break;
+        }
+        n_branches += 1;
+    }
+
+    AArray<u64> ends;
+    for(u32 i = 0; i < n_branches; ++i) {
+        AstId branch = i == 0 ? node : ast_kid(ast, node, i + 1);
+        u64 jump_false = compile_cond_jump(fs, ast_kid(ast, branch, 0));
+        // only the first condition always runs
+        if(i == 0) begin_cond(fs);
+        begin_cond(fs);
+        compile_block(fs, ast_kid(ast, branch, 1), body_dst);
+        end_cond(fs);
+        bool is_last = i + 1 == n_branches;
+        if(!is_last || else_body != AST_NONE || body_dst != REG_NONE) {
+            ends.push_back(emit(fs, bc_abx(OP_JMP, 0, 0)));
+        }
+        patch_jump(fs, jump_false, fs->code.len);
+    }
+    if(else_body != AST_NONE) {
+        begin_cond(fs);
+        compile_block(fs, else_body, body_dst);
+        end_cond(fs);
+    } else if(body_dst != REG_NONE) {
+        emit(fs, bc_abc(OP_LOADNIL, t, 0, 0));
+    }
+    end_cond(fs);
+    for(u64 at : ends) patch_jump(fs, at, fs->code.len);
+    return t;
+}
+
+INTERNAL u32 compile_while(FuncState* fs, AstId node, i32 dst) {
+    const Ast* ast = fs->c->ast;
+    BcLoop loop = {.start = fs->code.len, .breaks = {}};
+    BcLoop* outer = fs->loop;
+    fs->loop = &loop;
+    begin_cond(fs);
+    u64 jump_false = compile_cond_jump(fs, ast_kid(ast, node, 0));
+    compile_block(fs, ast_kid(ast, node, 1), REG_NONE);
+    end_cond(fs);
+    patch_jump(fs, emit(fs, bc_abx(OP_JMP, 0, 0)), loop.start);
+    patch_jump(fs, jump_false, fs->code.len);
+    for(u64 at : loop.breaks) patch_jump(fs, at, fs->code.len);
+    fs->loop = outer;
+
+    if(dst == REG_NONE) return 0;
+    u32 t = target_reg(fs, dst);
+    emit(fs, bc_abc(OP_LOADNIL, t, 0, 0));
+    return t;
+}
+
+INTERNAL Value literal_value(const Ast* ast, AstId node) {
+    const AstNodeData& data = ast_data(ast, node);
+    switch(ast_kind(ast, node)) {
+        case NODE_INT_LIT:
+            return value_number(data.numeral_literal.value);
+        case NODE_FLOAT_LIT:
+            return value_double(data.float_literal.value);
+        case NODE_BOOL_LIT:
+            return value_bool(data.numeral_literal.value != 0);
+        case NODE_STRING_LIT:
+            // points into the AST, which outlives the program
+            return value_str(&data.string_literal);
+        default:
+            return VALUE_NIL;
+    }
+}
+
+INTERNAL u32 compile_expr(FuncState* fs, AstId node, i32 dst) {
+    if(node == AST_NONE) {
+        compile_error(fs, node, S8_LIT("invalid node"));
+        return 0;
+    }
+
+    const Ast* ast = fs->c->ast;
+    NodeKind kind = ast_kind(ast, node);
+    switch(kind) {
+        case NODE_INT_LIT:
+        case NODE_FLOAT_LIT:
+        case NODE_BOOL_LIT:
+        case NODE_STRING_LIT:
+        case NODE_NIL_LIT: {
+            u32 t = target_reg(fs, dst);
+            emit_value(fs, node, t, literal_value(ast, node));
+            return t;
+        }
+        case NODE_IDENTIFIER: {
+            i32 local = fs->is_main ? -1 : find_local(fs, ast_sym(ast, node));
+            if(local >= 0) {
+                emit_check_declared(fs, node, local);
+                if(dst < 0) return local;
+                emit_mov(fs, dst, local);
+                return dst;
+            }
+            u32 t = target_reg(fs, dst);
+            emit(fs, bc_abx(OP_GETG, t, global_operand(fs, node)));
+            return t;
+        }
+        case NODE_VAR_DECL: {
+            AstId init = ast_n_kids(ast, node) > 1 ? ast_kid(ast, node, 1) : AST_NONE;
+            return compile_var_decl(fs, node, init, dst);
+        }
+        case NODE_BIN_OP:
+            return compile_bin_op(fs, node, dst);
+        case NODE_UNARY_OP: {
+            AstId kid = ast_kid(ast, node, 0);
+            TokenKind op = ast_op(ast, node);
+            if(op == TOK_PLUS_OP) return compile_expr(fs, kid, dst);
+            if(op != TOK_MINUS_OP) {
+                compile_error(fs, node, S8_LIT("invalid unary op"));
+                return 0;
+            }
+            if(kid != AST_NONE && (ast_kind(ast, kid) == NODE_INT_LIT || ast_kind(ast, kid) == NODE_FLOAT_LIT)) {
+                EvalResult neg = value_neg(fs->c->arena, literal_value(ast, kid));
+                u32 t = target_reg(fs, dst);
+                emit_value(fs, node, t, neg.value);
+                return t;
+            }
+            u32 save = fs->next_reg;
+            u32 rb = compile_expr(fs, kid, REG_ANY);
+            fs->next_reg = save;
+            u32 t = target_reg(fs, dst);
+            emit(fs, bc_abc(OP_NEG, t, rb, 0));
+            return t;
+        }
+        case NODE_FUNC_CALL:
+            return compile_call(fs, node, dst);
+        case NODE_FUNC_DECL: {
+            BcFunc* fn = compile_func(fs->c, node);
+            if(fs->c->protos.len > BC_MAX_BX) {
+                compile_error(fs, node, S8_LIT("too many functions"));
+            }
+            fs->c->protos.push_back(fn);
+            emit(fs, bc_abx(OP_DEFN, 0, (i32) (fs->c->protos.len - 1)));
+            if(dst == REG_NONE) return 0;
+            u32 t = target_reg(fs, dst);
+            emit(fs, bc_abc(OP_LOADNIL, t, 0, 0));
+            return t;
+        }
+        case NODE_MODULE:
+        case NODE_BODY: {
+            u32 t = dst == REG_ANY ? alloc_reg(fs) : (u32) dst;
+            compile_block(fs, node, dst == REG_NONE ? REG_NONE : (i32) t);
+            return t;
+        }
+        case NODE_IF:
+            return compile_if(fs, node, dst);
+        case NODE_WHILE:
+            return compile_while(fs, node, dst);
+        case NODE_BREAK:
+        case NODE_CONT: {
+            if(fs->loop == nullptr) {
+                compile_error(fs, node, S8_LIT("break or continue outside of a loop"));
+                return 0;
+            }
+            u64 at = emit(fs, bc_abx(OP_JMP, 0, 0));
+            if(kind == NODE_BREAK) {
+                fs->loop->breaks.push_back(at);
+            } else {
+                patch_jump(fs, at, fs->loop->start);
+            }
+            return dst >= 0 ? (u32) dst : 0;
+        }
+        case NODE_RET: {
+            if(ast_n_kids(ast, node) > 0) {
+                u32 save = fs->next_reg;
+                u32 r = compile_expr(fs, ast_kid(ast, node, 0), REG_ANY);
+                fs->next_reg = save;
+                emit(fs, bc_abc(OP_RET, r, 0, 0));
+            } else {
+                emit(fs, bc_abc(OP_RETNIL, 0, 0, 0));
+            }
+            return dst >= 0 ? (u32) dst : 0;
+        }
+        default:
+            compile_error(fs, node, format(fs->c->arena, "unsupported node kind: {}", (int) kind));
+            return 0;
+    }
+}
+
+// arena_push_array does not take empty arrays
+template <typename T>
+INTERNAL Array<T> copy_array(Arena* arena, Array<T> xs) {
+    return xs.len > 0 ? arena_push_array(arena, xs) : Array<T>{};
+}
+
+INTERNAL BcFunc* finish_func(FuncState* fs, String8 name, u32 sym, u32 n_params) {
+    Arena* arena = fs->c->arena;
+    BcFunc* fn = arena_push<BcFunc>(arena);
+    fn->name = name;
+    fn->sym = sym;
+    fn->code = copy_array(arena, Array<BcInst>(fs->code));
+    fn->k = copy_array(arena, Array<Value>(fs->k));
+    fn->n_params = n_params;
+    fn->n_regs = fs->max_regs;
+    return fn;
+}
+
+INTERNAL BcFunc* compile_func(Compiler* c, AstId node) {
+    // kids[0] = targs, kids[1] = args, kids[2] = body
+    const Ast* ast = c->ast;
+    FuncState fs = {};
+    fs.c = c;
+    AstId params = ast_kid(ast, node, 1);
+    u32 n_params = ast_n_kids(ast, params);
+    for(u32 i = 0; i < n_params; ++i) {
+        AstId param = ast_kid(ast, params, i);
+        u32 sym = ast_sym(ast, param);
+        if(find_local(&fs, sym) >= 0) compile_error(&fs, param, S8_LIT("duplicate parameter"));
+        fs.locals.push_back(BcLocal{sym, alloc_reg(&fs), 0});
+    }
+    // the other locals are undefined until their declaration runs
+    Array<u32> locals = ast_func_locals(c->arena, ast, node);
+    for(u64 i = n_params; i < locals.len; ++i) {
+        u32 reg = alloc_reg(&fs);
+        fs.locals.push_back(BcLocal{locals[i], reg, BC_UNDECLARED});
+        emit(&fs, bc_abx(OP_LOADK, reg, (i32) add_k(&fs, node, VALUE_UNDEFINED)));
+    }
+    compile_block(&fs, ast_kid(ast, node, 2), REG_NONE);
+    emit(&fs, bc_abc(OP_RETNIL, 0, 0, 0));
+    u32 sym = ast_sym(ast, node);
+    return finish_func(&fs, c->names[sym], sym, n_params);
+}
+
+BcProgram* bc_compile(Arena* arena, Module* mod) {
+    Compiler c = {};
+    c.arena = arena;
+    c.ast = mod->ast;
+    c.names = Array<String8>{mod->symbols.names.data, mod->symbols.names.len};
+
+    FuncState fs = {};
+    fs.c = &c;
+    fs.is_main = true;
+    u32 result = alloc_reg(&fs);
+    if(c.ast == nullptr) {
+        compile_error(&fs, AST_NONE, S8_LIT("the module has parse errors"));
+        emit(&fs, bc_abc(OP_LOADNIL, result, 0, 0));
+    } else {
+        compile_block(&fs, c.ast->root, (i32) result);
+    }
+    emit(&fs, bc_abc(OP_RET, result, 0, 0));
+
+    BcProgram* prog = arena_push<BcProgram>(arena);
+    prog->main = finish_func(&fs, mod->name, 0, 0);
+    prog->protos = copy_array(arena, Array<BcFunc*>(c.protos));
+    prog->names = copy_array(arena, c.names);
+    prog->call_sites = copy_array(arena, Array<u32>(c.call_sites));
+    prog->errors = copy_array(arena, Array<BcCompileError>(c.errors));
+    return prog;
+}
+
+GLOBAL const char* BC_OP_NAMES[] = {
+    "LOADK", "LOADI", "LOADNIL", "MOV", "GETG", "SETG", "DEFG", "ADD", "ADDI", "SUB", "MUL", "DIV",
+    "NEG",   "LT",    "LE",      "EQ",  "NE",   "JMP",  "JMPF", "JMPT", "CALL", "RET", "RETNIL", "DEFN",
+    "CHKDEF",
+};
+static_assert(COUNTOF_LIT(BC_OP_NAMES) == OP_COUNT);
+
+INTERNAL void bc_dump_func(FILE* f, const BcProgram* prog, const BcFunc* fn) {
+    writeln(f, "func {} (params: {}, registers: {})", fn->name, fn->n_params, fn->n_regs);
+    for(u64 i = 0; i < fn->code.len; ++i) {
+        BcInst inst = fn->code[i];
+        BcOp op = BC_OP(inst);
+        switch(op) {
+            case OP_LOADK: {
+                ArenaTmp tmp = begin_scratch();
+                String8 k = value_format(tmp.arena, fn->k[BC_BX(inst)]);
+                writeln(f, "  {} {} r{} {}", i, BC_OP_NAMES[op], BC_A(inst), k);
+                end_scratch(tmp);
+                break;
+            }
+            case OP_LOADI:
+                writeln(f, "  {} {} r{} {}", i, BC_OP_NAMES[op], BC_A(inst), BC_SBX(inst));
+                break;
+            case OP_JMP:
+                writeln(f, "  {} {} -> {}", i, BC_OP_NAMES[op], (i64) i + 1 + BC_SBX(inst));
+                break;
+            case OP_JMPF:
+            case OP_JMPT:
+                writeln(f, "  {} {} r{} -> {}", i, BC_OP_NAMES[op], BC_A(inst), (i64) i + 1 + BC_SBX(inst));
+                break;
+            case OP_MOV:
+            case OP_NEG:
+                writeln(f, "  {} {} r{} r{}", i, BC_OP_NAMES[op], BC_A(inst), BC_B(inst));
+                break;
+            case OP_LOADNIL:
+            case OP_RET:
+                writeln(f, "  {} {} r{}", i, BC_OP_NAMES[op], BC_A(inst));
+                break;
+            case OP_RETNIL:
+                writeln(f, "  {} {}", i, BC_OP_NAMES[op]);
+                break;
+            case OP_GETG:
+            case OP_SETG:
+            case OP_DEFG:
+            case OP_CHKDEF:
+                writeln(f, "  {} {} r{} {}", i, BC_OP_NAMES[op], BC_A(inst), prog->names[BC_BX(inst)]);
+                break;
+            case OP_ADDI:
+                writeln(f, "  {} {} r{} r{} {}", i, BC_OP_NAMES[op], BC_A(inst), BC_B(inst), (int8_t) BC_C(inst));
+                break;
+            case OP_CALL: {
+                i += 1;
+                String8 callee = prog->names[prog->call_sites[fn->code[i]]];
+                writeln(f, "  {} {} r{} {} {}", i - 1, BC_OP_NAMES[op], BC_A(inst), BC_B(inst), callee);
+                break;
+            }
+            case OP_DEFN:
+                writeln(f, "  {} {} {}", i, BC_OP_NAMES[op], prog->protos[BC_BX(inst)]->name);
+                break;
+            default:
+                writeln(f, "  {} {} r{} r{} r{}", i, BC_OP_NAMES[op], BC_A(inst), BC_B(inst), BC_C(inst));
+                break;
+        }
+    }
+}
+
+void bc_dump(FILE* f, const BcProgram* prog) {
+    bc_dump_func(f, prog, prog->main);
+    for(const BcFunc* fn : prog->protos) bc_dump_func(f, prog, fn);
+}
+
+/* SECTION: VM */
+Vm* vm_make(Arena* arena, u64 max_regs, u64 max_depth) {
+    Vm* vm = arena_push<Vm>(arena);
+    vm->arena = arena;
+    vm->stack = arena_push_array_fast<Value>(arena, max_regs);
+    vm->frames = arena_push_array_fast<VmFrame>(arena, max_depth);
+    return vm;
+}
+
+// computed goto (labels as values) with GCC and Clang: one indirect jump per instruction, each predicted separately
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO
+#endif
+
+// with COUNT, every executed instruction is counted in *n_executed
+template <bool COUNT>
+INTERNAL EvalResult vm_run_impl(Vm* vm, BcProgram* prog, u64* n_executed) {
+    EvalResult result = {.value = VALUE_NIL, .error = INTERP_OK, .reason = {}};
+    if(prog->errors.len > 0) {
+        result.error = INTERP_ERR_COMPILE;
+        result.reason = prog->errors[0].message;
+        return result;
+    }
+
+    // each run starts from scratch, the tables are reallocated for programs with more symbols or call sites
+    if(prog->names.len > vm->funcs.len) {
+        vm->funcs = arena_push_array_fast<BcFunc*>(vm->arena, prog->names.len);
+        vm->globals = arena_push_array_fast<Value>(vm->arena, prog->names.len);
+    }
+    for(u64 i = 0; i < prog->names.len; ++i) {
+        vm->funcs[i] = nullptr;
+        vm->globals[i] = VALUE_UNDEFINED;
+    }
+    if(prog->call_sites.len > vm->call_cache.len) {
+        vm->call_cache = arena_push_array_fast<BcFunc*>(vm->arena, prog->call_sites.len);
+    }
+    for(u64 i = 0; i < prog->call_sites.len; ++i) vm->call_cache[i] = nullptr;
+
+    BcFunc* fn = prog->main;
+    Value* R = vm->stack.data;
+    const Value* K = fn->k.data;
+    const BcInst* ip = fn->code.data;
+    const Value* stack_end = vm->stack.data + vm->stack.len;
+    u64 depth = 1;
+    if(fn->n_regs > vm->stack.len) {
+        result.error = INTERP_ERR_STACK_OVERFLOW;
+        result.reason = S8_LIT("stack overflow");
+        return result;
+    }
+    vm->frames[0] = VmFrame{.fn = fn, .ret_ip = nullptr, .base = R};
+    BcInst inst;
+
+#define A BC_A(inst)
+#define B BC_B(inst)
+#define C BC_C(inst)
+#define VM_ERROR(err, reason_)    \
+    do {                          \
+        result.error = (err);     \
+        result.reason = (reason_); \
+        return result;            \
+    } while(0)
+// R[a] = R[b] op R[c] with the fast path try_op, else value_arith
+#define VM_ARITH(vop, try_op, lhs_, rhs_)                           \
+    {                                                               \
+        Value lhs = (lhs_);                                         \
+        Value rhs = (rhs_);                                         \
+        if(UNLIKELY(!try_op(lhs, rhs, &R[A]))) {                    \
+            EvalResult r = value_arith(vm->arena, (vop), lhs, rhs); \
+            if(UNLIKELY(r)) VM_ERROR(r.error, r.reason);            \
+            R[A] = r.value;                                         \
+        }                                                           \
+    }
+
+#define VM_FETCH() ((COUNT ? (void) (*n_executed += 1) : (void) 0), inst = *ip++)
+
+#ifdef VM_COMPUTED_GOTO
+    static void* const LABELS[] = {
+        &&L_OP_LOADK, &&L_OP_LOADI, &&L_OP_LOADNIL, &&L_OP_MOV,  &&L_OP_GETG,  &&L_OP_SETG,   &&L_OP_DEFG, &&L_OP_ADD,
+        &&L_OP_ADDI,  &&L_OP_SUB,   &&L_OP_MUL,     &&L_OP_DIV,  &&L_OP_NEG,   &&L_OP_LT,     &&L_OP_LE,   &&L_OP_EQ,
+        &&L_OP_NE,    &&L_OP_JMP,   &&L_OP_JMPF,    &&L_OP_JMPT, &&L_OP_CALL,  &&L_OP_RET,    &&L_OP_RETNIL,
+        &&L_OP_DEFN,  &&L_OP_CHKDEF,
+    };
+    static_assert(COUNTOF_LIT(LABELS) == OP_COUNT);
+#define VM_CASE(op) L_##op:
+#define VM_NEXT()                      \
+    do {                               \
+        VM_FETCH();                    \
+        goto *LABELS[BC_OP(inst)];     \
+    } while(0)
+#define VM_LOOP() VM_NEXT();
+#else
+#define VM_CASE(op) case op:
+#define VM_NEXT() break
+#define VM_LOOP() for(;;) switch(BC_OP(VM_FETCH()))
+#endif
+
+    VM_LOOP() {
+        VM_CASE(OP_LOADK) {
+            R[A] = K[BC_BX(inst)];
+            VM_NEXT();
+        }
+        VM_CASE(OP_LOADI) {
+            R[A] = value_int(BC_SBX(inst));
+            VM_NEXT();
+        }
+        VM_CASE(OP_LOADNIL) {
+            R[A] = VALUE_NIL;
+            VM_NEXT();
+        }
+        VM_CASE(OP_MOV) {
+            R[A] = R[B];
+            VM_NEXT();
+        }
+        VM_CASE(OP_GETG) {
+            Value value = vm->globals[BC_BX(inst)];
+            if(UNLIKELY(value.bits == VALUE_UNDEFINED.bits)) {
+                VM_ERROR(INTERP_ERR_UNDEFINED, format(vm->arena, "undefined variable: {}", prog->names[BC_BX(inst)]));
+            }
+            R[A] = value;
+            VM_NEXT();
+        }
+        VM_CASE(OP_SETG) {
+            Value* global = &vm->globals[BC_BX(inst)];
+            if(UNLIKELY(global->bits == VALUE_UNDEFINED.bits)) {
+                VM_ERROR(INTERP_ERR_UNDEFINED, format(vm->arena, "undefined variable: {}", prog->names[BC_BX(inst)]));
+            }
+            *global = R[A];
+            VM_NEXT();
+        }
+        VM_CASE(OP_DEFG) {
+            vm->globals[BC_BX(inst)] = R[A];
+            VM_NEXT();
+        }
+        VM_CASE(OP_ADD) {
+            VM_ARITH(VALUE_ADD, value_try_add, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_ADDI) {
+            i64 imm = (int8_t) C;
+            if(imm >= 0) {
+                VM_ARITH(VALUE_ADD, value_try_add, R[B], value_int(imm));
+            } else {
+                VM_ARITH(VALUE_SUB, value_try_sub, R[B], value_int(-imm));
+            }
+            VM_NEXT();
+        }
+        VM_CASE(OP_SUB) {
+            VM_ARITH(VALUE_SUB, value_try_sub, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_MUL) {
+            VM_ARITH(VALUE_MUL, value_try_mul, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_DIV) {
+            VM_ARITH(VALUE_DIV, value_try_div, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_NEG) {
+            Value v = R[B];
+            if(LIKELY(value_is_int(v))) {
+                R[A] = value_number(-value_as_int(v));
+            } else {
+                EvalResult r = value_neg(vm->arena, v);
+                if(UNLIKELY(r)) VM_ERROR(r.error, r.reason);
+                R[A] = r.value;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(OP_LT) {
+            VM_ARITH(VALUE_LT, value_try_lt, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_LE) {
+            VM_ARITH(VALUE_LE, value_try_le, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_EQ) {
+            VM_ARITH(VALUE_EQ, value_try_eq, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_NE) {
+            VM_ARITH(VALUE_NE, value_try_ne, R[B], R[C]);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JMP) {
+            ip += BC_SBX(inst);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JMPF) {
+            if(!value_truthy(R[A])) ip += BC_SBX(inst);
+            VM_NEXT();
+        }
+        VM_CASE(OP_JMPT) {
+            if(value_truthy(R[A])) ip += BC_SBX(inst);
+            VM_NEXT();
+        }
+        VM_CASE(OP_CALL) {
+            u32 site = *ip++;
+            BcFunc* callee = vm->call_cache[site];
+            if(UNLIKELY(callee == nullptr)) {
+                String8 name = prog->names[prog->call_sites[site]];
+                callee = vm->funcs[prog->call_sites[site]];
+                if(callee == nullptr) VM_ERROR(INTERP_ERR_UNDEFINED, format(vm->arena, "undefined function: {}", name));
+                if(callee->n_params != B) {
+                    VM_ERROR(INTERP_ERR_ARGS,
+                             format(vm->arena, "{} expects {} arguments, got {}", name, callee->n_params, (u32) B));
+                }
+                vm->call_cache[site] = callee;
+            }
+            Value* base = R + A;
+            if(UNLIKELY(depth == vm->frames.len || base + callee->n_regs > stack_end)) {
+                VM_ERROR(INTERP_ERR_STACK_OVERFLOW, S8_LIT("stack overflow"));
+            }
+            vm->frames[depth++] = VmFrame{.fn = callee, .ret_ip = ip, .base = base};
+            fn = callee;
+            R = base;
+            K = fn->k.data;
+            ip = fn->code.data;
+            VM_NEXT();
+        }
+        VM_CASE(OP_RET) {
+            Value value = R[A];
+            depth -= 1;
+            // the callee's R[0] is the caller's R[a] of the call
+            R[0] = value;
+            if(depth == 0) {
+                result.value = value;
+                return result;
+            }
+            ip = vm->frames[depth].ret_ip;
+            const VmFrame& caller = vm->frames[depth - 1];
+            fn = caller.fn;
+            R = caller.base;
+            K = fn->k.data;
+            VM_NEXT();
+        }
+        VM_CASE(OP_RETNIL) {
+            depth -= 1;
+            R[0] = VALUE_NIL;
+            if(depth == 0) return result;
+            ip = vm->frames[depth].ret_ip;
+            const VmFrame& caller = vm->frames[depth - 1];
+            fn = caller.fn;
+            R = caller.base;
+            K = fn->k.data;
+            VM_NEXT();
+        }
+        VM_CASE(OP_DEFN) {
+            BcFunc* proto = prog->protos[BC_BX(inst)];
+            BcFunc* old = vm->funcs[proto->sym];
+            // redefinitions are rare: every call site resolves its callee again
+            if(old != nullptr && old != proto) {
+                for(u64 i = 0; i < prog->call_sites.len; ++i) vm->call_cache[i] = nullptr;
+            }
+            vm->funcs[proto->sym] = proto;
+            VM_NEXT();
+        }
+        VM_CASE(OP_CHKDEF) {
+            if(UNLIKELY(R[A].bits == VALUE_UNDEFINED.bits)) {
+                VM_ERROR(INTERP_ERR_UNDEFINED, format(vm->arena, "undefined variable: {}", prog->names[BC_BX(inst)]));
+            }
+            VM_NEXT();
+        }
+#ifndef VM_COMPUTED_GOTO
+        default:
+            INVALID_CODEPATH("invalid opcode");
+            return result;
+#endif
+    }
+
+#undef A
+#undef B
+#undef C
+#undef VM_ERROR
+#undef VM_ARITH
+#undef VM_CASE
+#undef VM_FETCH
+#undef VM_NEXT
+#undef VM_LOOP
+    return result;
+}
+
+EvalResult vm_run(Vm* vm, BcProgram* prog) {
+    return vm_run_impl<false>(vm, prog, nullptr);
+}
+
+EvalResult vm_run_counted(Vm* vm, BcProgram* prog, u64* n_executed) {
+    return vm_run_impl<true>(vm, prog, n_executed);
+}
@@ -28,6 +28,13 @@ STD_HEADERS: List[str] = [
     "unordered_map", "unordered_set", "utility", "valarray", "variant", "vector",
 ]
 
+# cxb's layered headers, see cxb/cxb.h. NOTE: a header's parse time includes the headers it includes that were not
+# parsed before in the same TU, e.g. core.h is only counted once per TU, in the first layer that includes it.
+CXB_HEADERS: List[str] = [
+    "cxb/cxb.h", "cxb/core.h", "cxb/fwd.h", "cxb/atomic.h", "cxb/arena.h", "cxb/array.h", "cxb/string8.h",
+    "cxb/format.h", "cxb/utf8.h", "cxb/hashmap.h",
+]
+
 # Relative path of the markdown file storing parse-time benchmarks for std headers.
 PARSE_TIMES_MD = Path(__file__).parent.parent / "tests/benchs" / "PARSE_TIMES.md"
 
@@ -371,7 +378,7 @@ def main():
     parser.add_argument(
         "--headers",
         nargs="+",
-        default=["cxb-cxx.h"],
+        default=CXB_HEADERS,
         help="Headers to analyze"
     )
     args = parser.parse_args()
@@ -429,7 +436,7 @@ def main():
     else:
         print("No metrics found. This might happen if:")
         print("- No trace files were generated")
-        print("- No cxb.h parsing events were found")
+        print("- No cxb header parsing events were found")
         print("- Trace files were malformed")
 
     return 0
@@ -0,0 +1,79 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Optimized benchmark builds and a profile-guided optimization pipeline, run from the repository root:
+#   1. build/bench-base: -O3, CXB_BENCH_ARCH_FLAGS and LTO, run each benchmark -> build/bench-results/<bench>.base.json
+#   2. build/bench-pgo:  instrumented (CXB_BENCH_PGO=generate), run each benchmark with short samples as training
+#   3. build/bench-pgo:  rebuilt with the profiles (CXB_BENCH_PGO=use), run -> build/bench-results/<bench>.pgo.json
+#   4. per benchmark, the comparison of pgo against base (cxb/bench.h) and per target the geometric mean speedup
+#
+# Arguments are passed to the measured runs, e.g. `scripts/bench_pgo.sh --filter AHashMap --samples 50`
+# Environment:
+#   BENCHS          benchmark targets, default: all but bench_io
+#   ARCH_FLAGS      CXB_BENCH_ARCH_FLAGS, default: -march=native
+#   TRAIN_ARGS      arguments of the training runs
+#   LLVM_PROFDATA   merges the Clang profiles, default: llvm-profdata
+
+default_benchs="bench_string bench_string_header bench_string_ops bench_format bench_hm bench_hm_suite bench_alloc"
+default_benchs+=" bench_algos bench_serialize bench_rng bench_interpreter"
+read -r -a benchs <<<"${BENCHS:-$default_benchs}"
+arch_flags=${ARCH_FLAGS:--march=native}
+read -r -a train_args <<<"${TRAIN_ARGS:---samples 5 --warmup-ms 10 --sample-ms 2 --max-ms 200}"
+llvm_profdata=${LLVM_PROFDATA:-llvm-profdata}
+
+base_dir="build/bench-base"
+pgo_dir="build/bench-pgo"
+profile_dir="$PWD/$pgo_dir/profiles"
+results_dir="build/bench-results"
+mkdir -p "$results_dir"
+
+configure() {
+    local dir=$1
+    shift
+    cmake -B "$dir" -DCMAKE_BUILD_TYPE=Release -DCXB_BUILD_BENCHS=ON -DCXB_BENCH_ARCH_FLAGS="$arch_flags" \
+        -DCXB_BENCH_LTO=ON -DCXB_BENCH_PGO_DIR="$profile_dir" "$@" >/dev/null
+    cmake --build "$dir" -j --target "${benchs[@]}"
+}
+
+echo -e "\n=== 1. optimized build ===\n"
+configure "$base_dir" -DCXB_BENCH_PGO=
+for b in "${benchs[@]}"; do
+    "$base_dir/$b" --json "$results_dir/$b.base.json" "$@"
+done
+
+echo -e "\n=== 2. instrumented build, training ===\n"
+rm -rf "$profile_dir"
+configure "$pgo_dir" -DCXB_BENCH_PGO=generate
+for b in "${benchs[@]}"; do
+    # bench_hm_suite: the setup of the DRAM sized maps would dominate the training
+    CXB_BENCH_HM_MAX_N=65536 "$pgo_dir/$b" "${train_args[@]}" >/dev/null
+done
+# Clang writes raw profiles, -fprofile-use reads the merged default.profdata
+if compgen -G "$profile_dir/*.profraw" >/dev/null; then
+    "$llvm_profdata" merge -o "$profile_dir/default.profdata" "$profile_dir"/*.profraw
+fi
+
+echo -e "\n=== 3. PGO build ===\n"
+configure "$pgo_dir" -DCXB_BENCH_PGO=use
+for b in "${benchs[@]}"; do
+    "$pgo_dir/$b" --json "$results_dir/$b.pgo.json" "$@"
+done
+
+echo -e "\n=== 4. PGO vs optimized ===\n"
+summary=""
+for b in "${benchs[@]}"; do
+    echo "== $b"
+    # exit code 1: a benchmark got slower, reported below
+    report=$("$pgo_dir/$b" --compare "$results_dir/$b.base.json" "$results_dir/$b.pgo.json" || true)
+    echo "$report"
+    summary+=$(echo "$report" | awk -v name="$b" '
+        match($0, /ratio=[0-9.]+/) { log_sum += log(substr($0, RSTART + 6, RLENGTH - 6)); n += 1 }
+        / faster$/ { faster += 1 }
+        / SLOWER$/ { slower += 1 }
+        END { if(n > 0) printf "%-22s %5d %10.3fx %7d %7d\n", name, n, exp(-log_sum / n), faster, slower }')
+    summary+=$'\n'
+done
+
+echo -e "\nspeedup of PGO, geometric mean of base/pgo per target\n"
+printf "%-22s %5s %11s %7s %7s\n" target n speedup faster slower
+printf "%s" "$summary"
@@ -33,7 +33,7 @@ for compiler in "${compilers[@]}"; do
 
     build_dir="build/${compiler}-${build_type}"
     rm -rf "$build_dir"
-    cmake -B "$build_dir" -DCMAKE_BUILD_TYPE="${build_type}" -DCXB_BUILD_C_API_TESTS=ON -DCXB_BUILD_TESTS=ON -DCXB_BUILD_FUZZERS=ON -DCXB_BUILD_TOOLS=ON
+    cmake -B "$build_dir" -DCMAKE_BUILD_TYPE="${build_type}" -DCXB_BUILD_C_API_TESTS=ON -DCXB_BUILD_TESTS=ON -DCXB_BUILD_BENCHS=ON -DCXB_BUILD_FUZZERS=ON -DCXB_BUILD_TOOLS=ON
     cmake --build "$build_dir" --config "${build_type}" -j
 
     pushd "$build_dir" >/dev/null
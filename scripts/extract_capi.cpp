@@ -1,20 +1,21 @@
-#include "examples/memfile.h"
-
 #include <cxb/cxb.h>
+#include <cxb/io.h>
 
 int main(int argc, char* argv[]) {
     (void) argc;
     (void) argv;
 
-    String8 in = "../cxb/cxb-cxx.h"_s8;
+    // the layers of cxb.h with C-compatible parts, in include order
+    String8 ins[] = {
+        "../cxb/core.h"_s8,
+        "../cxb/atomic.h"_s8,
+        "../cxb/arena.h"_s8,
+        "../cxb/string8.h"_s8,
+        "../cxb/utf8.h"_s8,
+    };
     String8 out = "../cxb/cxb-c.h"_s8;
 
     Arena* arena = get_perm();
-    auto in_f = open_memfile(arena, in);
-    if(in_f) {
-        writeln(stderr, "Error opening file {}, reason: {} (code={})", in, in_f.reason, (int) in_f.error);
-        return 1;
-    }
     FILE* out_f = fopen(out.c_str(), "w");
 
     enum Scope {
@@ -27,42 +28,52 @@ int main(int argc, char* argv[]) {
         STATE_IN_COMPAT_BLOCK,
     } state = STATE_NONE;
 
-    String8 in_data_str = in_f.value.data.as_string8();
-    String8SplitIterator line_iter = in_data_str.split("\n"_s8);
-
-    String8 line;
     writeln(out_f, "#ifndef CXB_C_H");
     writeln(out_f, "#define CXB_C_H\n");
-    while(line_iter.next(line)) {
-        if(line.starts_with("CXB_C_IMPORT"_s8)) {
-            writeln(out_f, "{}", line.trim_all_left("CXB_C_IMPORT"_s8).trim(" "_s8));
-        } else if(line.starts_with("CXB_C_TYPE"_s8)) {
-            scope = SCOPE_TYPE;
-            writeln(out_f, "\n{}", line.trim_all_left("CXB_C_TYPE"_s8).trim(" "_s8));
-        } else if(line.starts_with("};"_s8)) {
-            if(scope == SCOPE_TYPE) {
-                scope = SCOPE_GLOBAL;
-                writeln(out_f, "{}", line.trim(" "_s8));
-            }
-        } else if(line.trim_left(" "_s8).starts_with("CXB_C_COMPAT_END"_s8)) {
-            if(state != STATE_IN_COMPAT_BLOCK) {
-                writeln(stderr, "CXB_C_COMPAT_END must be before CXB_C_COMPAT_BEGIN");
-                return 3;
-            }
-            state = STATE_NONE;
-        } else if(line.trim_left(" "_s8).starts_with("CXB_C_COMPAT_BEGIN"_s8)) {
-            if(state == STATE_IN_COMPAT_BLOCK) {
-                writeln(stderr, "nested CXB_C_COMPAT_BEGIN / CXB_C_COMPAT_END block not supported");
-                return 3;
+    for(String8 in : ins) {
+        auto in_f = memfile_open(arena, in);
+        if(in_f) {
+            writeln(stderr, "Error opening file {}, reason: {} (code={})", in, in_f.reason, (int) in_f.error);
+            return 1;
+        }
+
+        String8 in_data_str = in_f.value.data.as_string8();
+        String8SplitIterator line_iter = in_data_str.split("\n"_s8);
+
+        String8 line;
+        while(line_iter.next(line)) {
+            if(line.starts_with("CXB_C_IMPORT"_s8)) {
+                writeln(out_f, "{}", line.trim_all_left("CXB_C_IMPORT"_s8).trim(" "_s8));
+            } else if(line.starts_with("CXB_C_TYPE"_s8)) {
+                scope = SCOPE_TYPE;
+                writeln(out_f, "\n{}", line.trim_all_left("CXB_C_TYPE"_s8).trim(" "_s8));
+            } else if(line.starts_with("};"_s8)) {
+                if(scope == SCOPE_TYPE) {
+                    scope = SCOPE_GLOBAL;
+                    writeln(out_f, "{}", line.trim(" "_s8));
+                }
+            } else if(line.trim_left(" "_s8).starts_with("CXB_C_COMPAT_END"_s8)) {
+                if(state != STATE_IN_COMPAT_BLOCK) {
+                    writeln(stderr, "CXB_C_COMPAT_END must be before CXB_C_COMPAT_BEGIN");
+                    return 3;
+                }
+                state = STATE_NONE;
+            } else if(line.trim_left(" "_s8).starts_with("CXB_C_COMPAT_BEGIN"_s8)) {
+                if(state == STATE_IN_COMPAT_BLOCK) {
+                    writeln(stderr, "nested CXB_C_COMPAT_BEGIN / CXB_C_COMPAT_END block not supported");
+                    return 3;
+                }
+                state = STATE_IN_COMPAT_BLOCK;
+            } else if(state == STATE_IN_COMPAT_BLOCK) {
+                writeln(out_f, "{}", line);
             }
-            state = STATE_IN_COMPAT_BLOCK;
-        } else if(state == STATE_IN_COMPAT_BLOCK) {
-            writeln(out_f, "{}", line);
+        }
+        if(state == STATE_IN_COMPAT_BLOCK) {
+            writeln(stderr, "{}: CXB_C_COMPAT_BEGIN without CXB_C_COMPAT_END", in);
+            return 3;
         }
     }
     writeln(out_f, "\n#endif /* CXB_C_H */");
 
     return 0;
 }
-
-#include "examples/memfile.cpp"
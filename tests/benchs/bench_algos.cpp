@@ -1,60 +1,86 @@
 #include <algorithm>
-#include <catch2/benchmark/catch_benchmark.hpp>
-#include <catch2/catch_test_macros.hpp>
+#include <cxb/bench.h>
 #include <cxb/cxb.h>
-#include <random>
-#include <string>
+#include <cxb/perf.h>
+#include <cxb/rng.h>
 #include <vector>
 
 struct TestInit {
     TestInit() {
-        cxb_init(CxbRuntimeParams{.perm_params = {},
-                                  .scratch_params = ArenaParams{.reserve_bytes = GB(1), .max_n_blocks = 0}});
+        cxb_init(CxbRuntimeParams{
+            .perm_params = {},
+            .scratch_params =
+                ArenaParams{.reserve_bytes = GB(1), .max_n_blocks = 0, .name = nullptr, .decommit_threshold = 0}});
     }
 } init;
 
-TEST_CASE("merge_sort vs std::sort", "[benchmark][algos]") {
+BENCH_CASE("merge_sort vs std::sort") {
     constexpr int N = 10000;
     std::vector<int> data(N);
     for(int i = 0; i < N; ++i) {
         data[i] = N - i;
     }
 
-    BENCHMARK("merge_sort") {
+    bench_run(b, "merge_sort", [&] {
         std::vector<int> xs = data;
         merge_sort(xs.data(), xs.size());
         return xs[0];
-    };
+    });
 
-    BENCHMARK("std::sort") {
+    bench_run(b, "std::sort", [&] {
         std::vector<int> xs = data;
         std::sort(xs.begin(), xs.end());
         return xs[0];
-    };
+    });
 }
 
-TEST_CASE("merge_sort randomized data sweep", "[benchmark][algos]") {
+BENCH_CASE("merge_sort randomized data sweep") {
     for(u64 n = 100; n <= 10000000; n *= 10) {
         std::vector<int> data(n);
-        std::mt19937 rng(1337);
-        std::uniform_int_distribution<int> dist(0, static_cast<int>(n));
+        Xoshiro256 rng = xoshiro256_make(1337);
         for(auto& x : data) {
-            x = dist(rng);
+            x = (int) rng_bounded_u32(rng, (u32) n + 1);
         }
 
-        BENCHMARK_ADVANCED(("merge_sort random N=" + std::to_string(n)).c_str())(Catch::Benchmark::Chronometer meter) {
-            meter.measure([&] {
-                std::vector<int> xs = data;
-                merge_sort(xs.data(), xs.size());
-                return xs[0];
-            });
-        };
-        BENCHMARK_ADVANCED(("std::sort random N=" + std::to_string(n)).c_str())(Catch::Benchmark::Chronometer meter) {
-            meter.measure([&] {
-                std::vector<int> xs = data;
-                std::sort(xs.begin(), xs.end());
-                return xs[0];
-            });
-        };
+        // the names outlive the runs, arena is cleared by them
+        Arena* names = get_perm();
+        bench_run(b, format(names, "merge_sort random N={}", n), [&] {
+            std::vector<int> xs = data;
+            merge_sort(xs.data(), xs.size());
+            return xs[0];
+        });
+        bench_run(b, format(names, "std::sort random N={}", n), [&] {
+            std::vector<int> xs = data;
+            std::sort(xs.begin(), xs.end());
+            return xs[0];
+        });
     }
 }
+
+BENCH_CASE("merge_sort vs std::sort counters") {
+    constexpr u64 N = 1000000;
+    constexpr u64 ITERS = 10;
+    std::vector<int> data(N);
+    Xoshiro256 rng = xoshiro256_make(1337);
+    for(auto& x : data) {
+        x = (int) rng_bounded_u32(rng, (u32) N + 1);
+    }
+
+    // NOTE: both include copying the input
+    std::vector<int> xs;
+    auto run_merge_sort = [&] {
+        xs = data;
+        merge_sort(xs.data(), xs.size());
+    };
+    auto run_std_sort = [&] {
+        xs = data;
+        std::sort(xs.begin(), xs.end());
+    };
+
+    PerfCounters pc = perf_counters_open();
+    perf_print(stdout, S8_LIT("merge_sort random N=1000000"), perf_measure(pc, ITERS, run_merge_sort));
+    perf_print(stdout, S8_LIT("std::sort random N=1000000"), perf_measure(pc, ITERS, run_std_sort));
+    perf_counters_close(pc);
+}
+
+BENCH_MAIN()
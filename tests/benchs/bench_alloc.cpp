@@ -0,0 +1,213 @@
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <memory_resource>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+constexpr size_t N = 100000;
+
+BENCH_CASE("arena_push_bytes vs malloc vs std::pmr") {
+    Arena* arena = arena_make_nbytes(MB(64));
+    std::vector<void*> ptrs(N);
+    std::vector<std::byte> buffer(N * 256);
+
+    for(size_t size : {16, 64, 256}) {
+        // the names outlive the runs, arena is cleared by them
+        Arena* names = get_perm();
+        String8 suffix = format(names, " {}B x N", size);
+
+        bench_run(b, format(names, "arena_push_bytes{}", suffix), [&] {
+            u64 sum = 0;
+            for(size_t i = 0; i < N; ++i) sum += (u64) arena_push_bytes(arena, size, 8);
+            arena_clear(arena);
+            return sum;
+        });
+
+        bench_run(b, format(names, "malloc/free{}", suffix), [&] {
+            for(size_t i = 0; i < N; ++i) ptrs[i] = malloc(size);
+            for(size_t i = 0; i < N; ++i) free(ptrs[i]);
+            return ptrs[0];
+        });
+
+        bench_run(b, format(names, "heap_alloc{}", suffix), [&] {
+            for(size_t i = 0; i < N; ++i) ptrs[i] = heap_alloc.alloc<u8>(size);
+            for(size_t i = 0; i < N; ++i) heap_alloc.free((u8*) ptrs[i], size);
+            return ptrs[0];
+        });
+
+        // NOTE: the initial buffer fits all allocations, i.e. the resource never goes upstream
+        bench_run(b, format(names, "std::pmr::monotonic_buffer_resource{}", suffix), [&] {
+            std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size()};
+            u64 sum = 0;
+            for(size_t i = 0; i < N; ++i) sum += (u64) resource.allocate(size, 8);
+            return sum;
+        });
+
+        bench_run(b, format(names, "std::pmr::unsynchronized_pool_resource{}", suffix), [&] {
+            std::pmr::unsynchronized_pool_resource resource;
+            for(size_t i = 0; i < N; ++i) ptrs[i] = resource.allocate(size, 8);
+            for(size_t i = 0; i < N; ++i) resource.deallocate(ptrs[i], size, 8);
+            return ptrs[0];
+        });
+    }
+    arena_destroy(arena);
+}
+
+BENCH_CASE("array_push_back vs MArray vs std::vector") {
+    Arena* arena = arena_make_nbytes(MB(64));
+    std::vector<std::byte> buffer(N * sizeof(u64) * 4);
+
+    bench_run(b, "array_push_back<u64> N", [&] {
+        Array<u64> xs = {};
+        for(u64 i = 0; i < N; ++i) array_push_back(xs, arena, i);
+        u64 last = xs[N - 1];
+        arena_clear(arena);
+        return last;
+    });
+
+    bench_run(b, "AArray<u64>::push_back N (heap_alloc)", [&] {
+        AArray<u64> xs;
+        for(u64 i = 0; i < N; ++i) xs.push_back(i);
+        return xs[N - 1];
+    });
+
+    bench_run(b, "AArray<u64>::push_back N (arena allocator)", [&] {
+        u64 last = 0;
+        {
+            AArray<u64> xs{push_arena_alloc(arena)};
+            for(u64 i = 0; i < N; ++i) xs.push_back(i);
+            last = xs[N - 1];
+        }
+        arena_clear(arena);
+        return last;
+    });
+
+    bench_run(b, "std::vector<u64>::push_back N", [&] {
+        std::vector<u64> xs;
+        for(u64 i = 0; i < N; ++i) xs.push_back(i);
+        return xs[N - 1];
+    });
+
+    bench_run(b, "std::vector<u64>::push_back N (reserved)", [&] {
+        std::vector<u64> xs;
+        xs.reserve(N);
+        for(u64 i = 0; i < N; ++i) xs.push_back(i);
+        return xs[N - 1];
+    });
+
+    bench_run(b, "std::pmr::vector<u64>::push_back N (monotonic_buffer_resource)", [&] {
+        std::pmr::monotonic_buffer_resource resource{buffer.data(), buffer.size()};
+        std::pmr::vector<u64> xs{&resource};
+        for(u64 i = 0; i < N; ++i) xs.push_back(i);
+        return xs[N - 1];
+    });
+    arena_destroy(arena);
+}
+
+BENCH_CASE("scratch begin/end") {
+    Arena* arena = arena_make_nbytes(MB(1));
+
+    bench_run(b, "begin_scratch/end_scratch N", [&] {
+        u64 sum = 0;
+        for(size_t i = 0; i < N; ++i) {
+            AArenaTmp tmp = begin_scratch();
+            sum += (u64) arena_push_bytes(tmp.arena, 64, 8);
+        }
+        return sum;
+    });
+
+    bench_run(b, "begin_scratch/end_scratch nested N", [&] {
+        u64 sum = 0;
+        for(size_t i = 0; i < N; ++i) {
+            AArenaTmp outer = begin_scratch();
+            sum += (u64) arena_push_bytes(outer.arena, 64, 8);
+            AArenaTmp inner = begin_scratch();
+            sum += (u64) arena_push_bytes(inner.arena, 64, 8);
+        }
+        return sum;
+    });
+
+    // baseline without the thread local lookup of the scratch arenas
+    bench_run(b, "arena pos save/arena_pop_to N", [&] {
+        u64 sum = 0;
+        for(size_t i = 0; i < N; ++i) {
+            u64 pos = arena->pos;
+            sum += (u64) arena_push_bytes(arena, 64, 8);
+            arena_pop_to(arena, pos);
+        }
+        return sum;
+    });
+    arena_destroy(arena);
+}
+
+// runs fn(thread index) on n_threads threads
+template <class Fn>
+void run_threads(u32 n_threads, Fn&& fn) {
+    std::vector<std::thread> threads;
+    for(u32 t = 0; t < n_threads; ++t) threads.emplace_back([&fn, t] { fn(t); });
+    for(auto& t : threads) t.join();
+}
+
+// each thread allocates and frees N blocks of 64 bytes, in batches of BATCH
+BENCH_CASE("multi-threaded allocation scaling") {
+    constexpr size_t BATCH = 64;
+    u32 max_threads = max(std::thread::hardware_concurrency(), 1u);
+
+    // NOTE: the pointers are stored outside of the threads, such that malloc/free pairs are not optimized out
+    std::vector<void*> slots(64 * BATCH);
+    void** ptrs_base = slots.data();
+    Arena* arenas[64] = {};
+    for(u32 t = 0; t < 64; ++t) arenas[t] = arena_make_nbytes(BATCH * 64 + KB(4));
+    std::pmr::synchronized_pool_resource shared_pool;
+
+    for(u32 n_threads = 1; n_threads <= min(max_threads, 64u); n_threads *= 2) {
+        Arena* names = get_perm();
+        String8 suffix = format(names, " 64B x N, {} threads", n_threads);
+
+        bench_run(b, format(names, "malloc/free{}", suffix), [&] {
+            run_threads(n_threads, [ptrs_base](u32 t) {
+                void** ptrs = ptrs_base + t * BATCH;
+                for(size_t i = 0; i < N; i += BATCH) {
+                    for(size_t j = 0; j < BATCH; ++j) ptrs[j] = malloc(64);
+                    for(size_t j = 0; j < BATCH; ++j) free(ptrs[j]);
+                }
+            });
+        });
+
+        // heap_alloc_data counters are shared by all threads
+        bench_run(b, format(names, "heap_alloc{}", suffix), [&] {
+            run_threads(n_threads, [ptrs_base](u32 t) {
+                void** ptrs = ptrs_base + t * BATCH;
+                for(size_t i = 0; i < N; i += BATCH) {
+                    for(size_t j = 0; j < BATCH; ++j) ptrs[j] = heap_alloc.alloc<u8>(64);
+                    for(size_t j = 0; j < BATCH; ++j) heap_alloc.free((u8*) ptrs[j], 64);
+                }
+            });
+        });
+
+        bench_run(b, format(names, "arena_push_bytes (arena per thread){}", suffix), [&] {
+            run_threads(n_threads, [&arenas](u32 t) {
+                Arena* arena = arenas[t];
+                for(size_t i = 0; i < N; i += BATCH) {
+                    u64 pos = arena->pos;
+                    for(size_t j = 0; j < BATCH; ++j) arena_push_bytes(arena, 64, 8);
+                    arena_pop_to(arena, pos);
+                }
+            });
+        });
+
+        bench_run(b, format(names, "std::pmr::synchronized_pool_resource (shared){}", suffix), [&] {
+            run_threads(n_threads, [ptrs_base, &shared_pool](u32 t) {
+                void** ptrs = ptrs_base + t * BATCH;
+                for(size_t i = 0; i < N; i += BATCH) {
+                    for(size_t j = 0; j < BATCH; ++j) ptrs[j] = shared_pool.allocate(64, 8);
+                    for(size_t j = 0; j < BATCH; ++j) shared_pool.deallocate(ptrs[j], 64, 8);
+                }
+            });
+        });
+    }
+    for(u32 t = 0; t < 64; ++t) arena_destroy(arenas[t]);
+}
+
+BENCH_MAIN()
@@ -0,0 +1,208 @@
+#include <charconv>
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <cxb/rng.h>
+#include <stdio.h>
+#include <vector>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+#if __has_include(<fmt/format.h>)
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+#define CXB_BENCH_HAS_FMT
+#endif
+
+constexpr size_t N = 10000;
+
+struct FormatInputs {
+    std::vector<i64> ints;
+    std::vector<f64> floats;
+    std::vector<String8> words;
+};
+
+// ints of all magnitudes, floats as latencies in ms, words as log levels, thread and path names
+INTERNAL FormatInputs make_inputs() {
+    FormatInputs in;
+    Xoshiro256 rng = xoshiro256_make(42);
+    const char* words[] = {"INFO", "WARN", "ERROR", "DEBUG", "worker-1", "worker-12", "/api/v1/items", "/health"};
+    for(size_t i = 0; i < N; ++i) {
+        i64 x = (i64) rng_bounded_u64(rng, 1000000000000000000ull);
+        for(u32 d = 1 + rng_bounded_u32(rng, 18); d < 18; ++d) x /= 10;
+        in.ints.push_back(i % 4 == 0 ? -x : x);
+        in.floats.push_back(rng_lognormal(rng, 1.0, 1.5));
+        const char* word = words[rng_bounded_u32(rng, 8)];
+        in.words.push_back(S8_CSTR(word));
+    }
+    return in;
+}
+
+BENCH_CASE("format ints, floats and strings") {
+    Arena* arena = arena_make_nbytes(MB(64));
+    FormatInputs in = make_inputs();
+    char buf[256];
+
+    // ints
+    bench_run(b, "format {} i64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += format(arena, "{}", in.ints[i]).len;
+        arena_clear(arena);
+        return n;
+    });
+    bench_run(b, "snprintf %lld i64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += snprintf(buf, sizeof(buf), "%lld", (long long) in.ints[i]);
+        return n;
+    });
+    bench_run(b, "std::to_chars i64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += std::to_chars(buf, buf + sizeof(buf), in.ints[i]).ptr - buf;
+        return n;
+    });
+
+    // floats
+    bench_run(b, "format {.3} f64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += format(arena, "{.3}", in.floats[i]).len;
+        arena_clear(arena);
+        return n;
+    });
+    bench_run(b, "snprintf %.3f f64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += snprintf(buf, sizeof(buf), "%.3f", in.floats[i]);
+        return n;
+    });
+    bench_run(b, "std::to_chars fixed 3 f64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) {
+            n += std::to_chars(buf, buf + sizeof(buf), in.floats[i], std::chars_format::fixed, 3).ptr - buf;
+        }
+        return n;
+    });
+
+    // strings
+    bench_run(b, "format {} {} String8 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += format(arena, "{} {}", in.words[i], in.words[N - 1 - i]).len;
+        arena_clear(arena);
+        return n;
+    });
+    bench_run(b, "snprintf %.*s %.*s x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) {
+            const String8& x = in.words[i];
+            const String8& y = in.words[N - 1 - i];
+            n += snprintf(buf, sizeof(buf), "%.*s %.*s", (int) x.len, x.data, (int) y.len, y.data);
+        }
+        return n;
+    });
+
+#ifdef __cpp_lib_format
+    bench_run(b, "std::format {} i64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += std::format_to(buf, "{}", in.ints[i]) - buf;
+        return n;
+    });
+    bench_run(b, "std::format {:.3f} f64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += std::format_to(buf, "{:.3f}", in.floats[i]) - buf;
+        return n;
+    });
+#endif
+#ifdef CXB_BENCH_HAS_FMT
+    bench_run(b, "fmt::format {} i64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += fmt::format_to(buf, "{}", in.ints[i]) - buf;
+        return n;
+    });
+    bench_run(b, "fmt::format {:.3f} f64 x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) n += fmt::format_to(buf, "{:.3f}", in.floats[i]) - buf;
+        return n;
+    });
+#endif
+    arena_destroy(arena);
+}
+
+BENCH_CASE("format log lines") {
+    Arena* arena = arena_make_nbytes(MB(64));
+    FormatInputs in = make_inputs();
+    char buf[256];
+    FILE* devnull = fopen("/dev/null", "wb");
+    ASSERT(devnull);
+
+    bench_run(b, "format log line x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) {
+            n += format(arena,
+                        "{} [{}] id={} path={} latency_ms={.3}\n",
+                        in.words[i],
+                        in.words[(i + 1) % N],
+                        in.ints[i],
+                        in.words[(i + 2) % N],
+                        in.floats[i])
+                     .len;
+        }
+        arena_clear(arena);
+        return n;
+    });
+    bench_run(b, "snprintf log line x N", [&] {
+        size_t n = 0;
+        for(size_t i = 0; i < N; ++i) {
+            const String8& level = in.words[i];
+            const String8& thread = in.words[(i + 1) % N];
+            const String8& path = in.words[(i + 2) % N];
+            n += snprintf(buf,
+                          sizeof(buf),
+                          "%.*s [%.*s] id=%lld path=%.*s latency_ms=%.3f\n",
+                          (int) level.len,
+                          level.data,
+                          (int) thread.len,
+                          thread.data,
+                          (long long) in.ints[i],
+                          (int) path.len,
+                          path.data,
+                          in.floats[i]);
+        }
+        return n;
+    });
+
+    // to a file: formatting, the scratch arena and stdio buffering
+    bench_run(b, "print log line to /dev/null x N", [&] {
+        for(size_t i = 0; i < N; ++i) {
+            AArenaTmp tmp = begin_scratch();
+            print(devnull,
+                  tmp.arena,
+                  "{} [{}] id={} path={} latency_ms={.3}\n",
+                  in.words[i],
+                  in.words[(i + 1) % N],
+                  in.ints[i],
+                  in.words[(i + 2) % N],
+                  in.floats[i]);
+        }
+        return N;
+    });
+    bench_run(b, "fprintf log line to /dev/null x N", [&] {
+        for(size_t i = 0; i < N; ++i) {
+            const String8& level = in.words[i];
+            const String8& thread = in.words[(i + 1) % N];
+            const String8& path = in.words[(i + 2) % N];
+            fprintf(devnull,
+                    "%.*s [%.*s] id=%lld path=%.*s latency_ms=%.3f\n",
+                    (int) level.len,
+                    level.data,
+                    (int) thread.len,
+                    thread.data,
+                    (long long) in.ints[i],
+                    (int) path.len,
+                    path.data,
+                    in.floats[i]);
+        }
+        return N;
+    });
+    fclose(devnull);
+    arena_destroy(arena);
+}
+
+BENCH_MAIN()
@@ -1,39 +1,42 @@
-#include <catch2/benchmark/catch_benchmark.hpp>
-#include <catch2/catch_test_macros.hpp>
+#include <stddef.h>
 #include <unordered_map>
 #include <vector>
 
 size_t hash(const int& x);
+#include <cxb/bench.h>
 #include <cxb/cxb.h>
+#include <cxb/histogram.h>
+#include <cxb/perf.h>
+#include <cxb/profile.h>
 
 size_t hash(const int& x) {
     return static_cast<size_t>(x);
 }
 
-TEST_CASE("AHashMap vs std::unordered_map", "[benchmark][AHashMap]") {
+BENCH_CASE("AHashMap vs std::unordered_map") {
     constexpr int N = 2000;
 
     std::vector<int> keys;
     keys.reserve(N);
     for(int i = 0; i < N; ++i) keys.push_back(i);
 
-    BENCHMARK("AHashMap<int,int> insert N") {
+    bench_run(b, "AHashMap<int,int> insert N", [&] {
         AHashMap<int, int> hm;
         hm.reserve(static_cast<size_t>(N * 2));
         for(int i = 0; i < N; ++i) {
             hm.put({keys[i], i});
         }
         return hm.len;
-    };
+    });
 
-    BENCHMARK("std::unordered_map<int,int> insert N") {
+    bench_run(b, "std::unordered_map<int,int> insert N", [&] {
         std::unordered_map<int, int> m;
         m.reserve(N * 2);
         for(int i = 0; i < N; ++i) {
             m.emplace(keys[i], i);
         }
         return m.size();
-    };
+    });
 
     AHashMap<int, int> hm_pre;
     hm_pre.reserve(static_cast<size_t>(N * 2));
@@ -43,24 +46,24 @@ TEST_CASE("AHashMap vs std::unordered_map", "[benchmark][AHashMap]") {
     m_pre.reserve(N * 2);
     for(int i = 0; i < N; ++i) m_pre.emplace(keys[i], i);
 
-    BENCHMARK("AHashMap<int,int> lookup N") {
+    bench_run(b, "AHashMap<int,int> lookup N", [&] {
         volatile int sum = 0; // prevent optimization
         for(int i = 0; i < N; ++i) {
             if(hm_pre.contains(keys[i])) sum += hm_pre[keys[i]];
         }
         return sum;
-    };
+    });
 
-    BENCHMARK("std::unordered_map<int,int> lookup N") {
+    bench_run(b, "std::unordered_map<int,int> lookup N", [&] {
         volatile int sum = 0; // prevent optimization
         for(int i = 0; i < N; ++i) {
             auto it = m_pre.find(keys[i]);
             if(it != m_pre.end()) sum += it->second;
         }
         return sum;
-    };
+    });
 
-    BENCHMARK("AHashMap<int,int> erase N") {
+    bench_run(b, "AHashMap<int,int> erase N", [&] {
         AHashMap<int, int> hm;
         hm.reserve(static_cast<size_t>(N * 2));
         for(int i = 0; i < N; ++i) hm.put({keys[i], i});
@@ -68,9 +71,9 @@ TEST_CASE("AHashMap vs std::unordered_map", "[benchmark][AHashMap]") {
             hm.erase(keys[i]);
         }
         return hm.len;
-    };
+    });
 
-    BENCHMARK("std::unordered_map<int,int> erase N") {
+    bench_run(b, "std::unordered_map<int,int> erase N", [&] {
         std::unordered_map<int, int> m;
         m.reserve(N * 2);
         for(int i = 0; i < N; ++i) m.emplace(keys[i], i);
@@ -78,5 +81,75 @@ TEST_CASE("AHashMap vs std::unordered_map", "[benchmark][AHashMap]") {
             m.erase(keys[i]);
         }
         return m.size();
+    });
+}
+
+BENCH_CASE("AHashMap vs std::unordered_map counters") {
+    constexpr int N = 2000;
+    constexpr u64 ITERS = 1000;
+
+    AHashMap<int, int> hm;
+    hm.reserve(static_cast<size_t>(N * 2));
+    std::unordered_map<int, int> m;
+    m.reserve(N * 2);
+    for(int i = 0; i < N; ++i) {
+        hm.put({i, i});
+        m.emplace(i, i);
+    }
+
+    volatile int sum = 0; // prevent optimization
+    auto lookup_hm = [&] {
+        for(int i = 0; i < N; ++i) {
+            if(hm.contains(i)) sum = sum + hm[i];
+        }
+    };
+    auto lookup_std = [&] {
+        for(int i = 0; i < N; ++i) {
+            auto it = m.find(i);
+            if(it != m.end()) sum = sum + it->second;
+        }
     };
+
+    PerfCounters pc = perf_counters_open();
+    perf_print(stdout, S8_LIT("AHashMap<int,int> lookup N"), perf_measure(pc, ITERS, lookup_hm));
+    perf_print(stdout, S8_LIT("std::unordered_map<int,int> lookup N"), perf_measure(pc, ITERS, lookup_std));
+    perf_counters_close(pc);
 }
+
+BENCH_CASE("AHashMap vs std::unordered_map lookup latency") {
+    constexpr int N = 2000;
+    constexpr int ITERS = 10000;
+
+    AHashMap<int, int> hm;
+    hm.reserve(static_cast<size_t>(N * 2));
+    std::unordered_map<int, int> m;
+    m.reserve(N * 2);
+    for(int i = 0; i < N; ++i) {
+        hm.put({i, i});
+        m.emplace(i, i);
+    }
+
+    // one sample per pass over all keys, such that the timer overhead is negligible
+    f64 ticks_per_ns = profile_ticks_per_ns();
+    Histogram* lat_hm = arena_push<Histogram>(get_perm());
+    Histogram* lat_std = arena_push<Histogram>(get_perm());
+    volatile int sum = 0; // prevent optimization
+    for(int it = 0; it < ITERS; ++it) {
+        u64 t0 = profile_now();
+        for(int i = 0; i < N; ++i) {
+            if(hm.contains(i)) sum = sum + hm[i];
+        }
+        u64 t1 = profile_now();
+        for(int i = 0; i < N; ++i) {
+            auto x = m.find(i);
+            if(x != m.end()) sum = sum + x->second;
+        }
+        u64 t2 = profile_now();
+        histogram_record(lat_hm, (u64) ((f64) (t1 - t0) / ticks_per_ns));
+        histogram_record(lat_std, (u64) ((f64) (t2 - t1) / ticks_per_ns));
+    }
+    histogram_print(stdout, S8_LIT("AHashMap<int,int> lookup N (ns)"), lat_hm);
+    histogram_print(stdout, S8_LIT("std::unordered_map<int,int> lookup N (ns)"), lat_std);
+}
+
+BENCH_MAIN()
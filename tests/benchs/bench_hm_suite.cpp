@@ -0,0 +1,288 @@
+/*
+Hash map suite: AHashMap vs std::unordered_map (and optionally an external map) over
+
+* sizes from L1 resident to DRAM bound: powers of 4 from 2^8 up to the env var CXB_BENCH_HM_MAX_N entries, 2^22 by
+  default
+* key types: int, u64, String8 and a 16 byte struct
+* operations: insert (growing from empty), lookups with 100%, 50% and 0% hits in random order, iteration and
+  insert/erase churn (erase an old key, insert a new one, at a constant size)
+* memory: bytes allocated by the map per entry after the inserts, excluding String8 key payloads
+
+Each (map, key, n, op) is a benchmark of cxb/bench.h, e.g. "hm_suite String8: AHashMap n=16384 lookup 50% hits",
+its time per call is the time per operation:
+* insert: one insert, amortized over growing a map from empty to n entries and destroying it
+* lookup: one lookup, the keys are queried in a random order fixed up front
+* iterate: one pass over the whole map
+* churn: one erase and one insert
+The bytes per entry are printed after the insert benchmark. `--json` writes the results, `--filter` selects them, e.g.
+`./bench_hm_suite --filter 'n=1024 ' --json hm.json`.
+
+An external map with the std::unordered_map interface and template parameters (key, value, hash, equal, allocator),
+e.g. absl::flat_hash_map or ankerl::unordered_dense::map, is compared when compiled with
+`-DCXB_BENCH_EXTERNAL_MAP=absl::flat_hash_map -DCXB_BENCH_EXTERNAL_MAP_HEADER='<absl/container/flat_hash_map.h>'`.
+All maps use the same hash functions, via DefaultHasher.
+*/
+#include <stdint.h>
+#include <stdlib.h>
+#include <unordered_map>
+#include <vector>
+
+size_t hash(const int& x);
+size_t hash(const uint64_t& x);
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <cxb/rng.h>
+
+#ifdef CXB_BENCH_EXTERNAL_MAP
+#include CXB_BENCH_EXTERNAL_MAP_HEADER
+#endif
+
+size_t hash(const int& x) {
+    return hash_mix64((u32) x);
+}
+
+size_t hash(const uint64_t& x) {
+    return hash_mix64(x);
+}
+
+size_t hash(const String8& s) {
+    // FNV-1a
+    u64 h = 0xcbf29ce484222325ull;
+    for(size_t i = 0; i < s.len; ++i) {
+        h ^= (u8) s.data[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+struct PointKey {
+    i32 x, y, z;
+    u32 tag;
+
+    bool operator==(const PointKey& o) const {
+        return x == o.x && y == o.y && z == o.z && tag == o.tag;
+    }
+};
+
+size_t hash(const PointKey& k) {
+    return hash_mix64(((u64) (u32) k.x << 32 | (u32) k.y) ^ hash_mix64((u64) (u32) k.z << 32 | k.tag));
+}
+
+/* SECTION: keys
+make_key(a, i, out) maps distinct indices to distinct keys, in an order unrelated to their hash
+*/
+INTERNAL void make_key(Arena* a, u64 i, int& out) {
+    (void) a;
+    // odd multiplier: a bijection on u32
+    out = (int) (u32) (i * 0x9e3779b1u);
+}
+
+INTERNAL void make_key(Arena* a, u64 i, u64& out) {
+    (void) a;
+    out = i * 0x9e3779b97f4a7c15ull;
+}
+
+INTERNAL void make_key(Arena* a, u64 i, String8& out) {
+    // 8 to 40 characters
+    out = format(a, "key/{}/{}", i, hash_mix64(i) >> (hash_mix64(i) & 63));
+}
+
+INTERNAL void make_key(Arena* a, u64 i, PointKey& out) {
+    (void) a;
+    u64 h = hash_mix64(i);
+    out = PointKey{.x = (i32) (u32) h, .y = (i32) (h >> 32), .z = (i32) i, .tag = (u32) (i >> 31)};
+}
+
+/* SECTION: maps
+Adapters with a common interface: insert, find, erase, sum (iteration), len and bytes
+*/
+template <class K>
+struct CxbMap {
+    AHashMap<K, u64> m;
+
+    void insert(const K& k, u64 v) {
+        m.put({k, v});
+    }
+    const u64* find(const K& k) const {
+        auto* e = m.occupied_entry_for(k);
+        return e ? &e->kv.value : nullptr;
+    }
+    void erase(const K& k) {
+        m.erase(k);
+    }
+    u64 sum() {
+        u64 s = 0;
+        for(auto& e : m) s += e.kv.value;
+        return s;
+    }
+    size_t len() const {
+        return m.len;
+    }
+    size_t bytes() const {
+        return m.table.len * sizeof(typename AHashMap<K, u64>::Entry);
+    }
+};
+
+// counts the live bytes of a std compatible container
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+    size_t* n_bytes;
+
+    CountingAllocator(size_t* n_bytes) : n_bytes{n_bytes} {}
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>& o) : n_bytes{o.n_bytes} {}
+
+    T* allocate(size_t n) {
+        *n_bytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        *n_bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+    template <class U>
+    bool operator==(const CountingAllocator<U>& o) const {
+        return n_bytes == o.n_bytes;
+    }
+};
+
+template <template <class...> class Map, class K>
+struct StdLikeMap {
+    using Alloc = CountingAllocator<std::pair<const K, u64>>;
+    size_t n_bytes = 0;
+    Map<K, u64, DefaultHasher, std::equal_to<K>, Alloc> m{0, DefaultHasher{}, std::equal_to<K>{}, Alloc{&n_bytes}};
+
+    void insert(const K& k, u64 v) {
+        m.emplace(k, v);
+    }
+    const u64* find(const K& k) const {
+        auto it = m.find(k);
+        return it != m.end() ? &it->second : nullptr;
+    }
+    void erase(const K& k) {
+        m.erase(k);
+    }
+    u64 sum() {
+        u64 s = 0;
+        for(auto& kv : m) s += kv.second;
+        return s;
+    }
+    size_t len() const {
+        return m.size();
+    }
+    size_t bytes() const {
+        return n_bytes;
+    }
+};
+
+template <class K>
+using StdMap = StdLikeMap<std::unordered_map, K>;
+#ifdef CXB_BENCH_EXTERNAL_MAP
+template <class K>
+using ExternalMap = StdLikeMap<CXB_BENCH_EXTERNAL_MAP, K>;
+#endif
+
+/* SECTION: benchmarks */
+INTERNAL size_t bench_max_n() {
+    const char* s = getenv("CXB_BENCH_HM_MAX_N");
+    return s ? (size_t) strtoull(s, nullptr, 10) : (size_t) 1 << 22;
+}
+
+template <class Map, class K>
+void bench_map(Bencher* b, const char* map_name, const std::vector<K>& keys, size_t n) {
+    AArenaTmp tmp = begin_scratch();
+    String8 prefix = format(tmp.arena, "{} n={}", map_name, n);
+    auto name = [&](const char* op) { return format(tmp.arena, "{} {}", prefix, op); };
+    // the setup of a large map takes seconds, skip it if no benchmark of the map runs
+    bool any = false;
+    for(const char* op : {"insert", "lookup", "iterate", "churn"}) any = any || bench_enabled(b, name(op));
+    if(!any) return;
+    Xoshiro256 rng = xoshiro256_make(n);
+
+    // insert, growing from an empty map
+    {
+        Map* m = new Map{};
+        size_t i = 0;
+        bench_run(b, name("insert"), [&] {
+            if(i == n) {
+                delete m;
+                m = new Map{};
+                i = 0;
+            }
+            m->insert(keys[i], i);
+            i += 1;
+        });
+        delete m;
+    }
+
+    Map* m = new Map{};
+    for(size_t i = 0; i < n; ++i) m->insert(keys[i], i);
+    print(stdout, tmp.arena, "{}: {}: {.1} bytes per entry\n", b->case_name, prefix, (f64) m->bytes() / (f64) m->len());
+
+    // lookups in random order, misses are keys [n, 2n)
+    for(f64 hit_ratio : {1.0, 0.5, 0.0}) {
+        std::vector<const K*> queries(n);
+        for(size_t i = 0; i < n; ++i) {
+            size_t idx = rng_bounded_u64(rng, n);
+            queries[i] = &keys[rng_f64(rng) < hit_ratio ? idx : n + idx];
+        }
+
+        size_t i = 0;
+        bench_run(b, format(tmp.arena, "{} lookup {}% hits", prefix, (int) (hit_ratio * 100)), [&] {
+            const u64* v = m->find(*queries[i]);
+            i = i + 1 == n ? 0 : i + 1;
+            return v ? *v : 1;
+        });
+    }
+
+    bench_run(b, name("iterate"), [&] { return m->sum(); });
+
+    // churn: erase the oldest key and insert a new one, the keys of the map rotate through [0, 2n)
+    size_t next = n;
+    bench_run(b, name("churn"), [&] {
+        m->erase(keys[(next - n) % (2 * n)]);
+        m->insert(keys[next % (2 * n)], next);
+        next += 1;
+    });
+    ASSERT(m->len() == n, "churn changed the size of the map");
+    delete m;
+}
+
+template <class K>
+void bench_key(Bencher* b) {
+    size_t max_n = bench_max_n();
+    for(size_t n = 1 << 8; n <= max_n; n *= 4) {
+        // 2n keys: [0, n) are inserted, [n, 2n) are misses and the keys inserted by the churn
+        Arena* arena = arena_make_nbytes(MB(1) + 2 * n * 64);
+        std::vector<K> keys(2 * n);
+        for(size_t i = 0; i < 2 * n; ++i) make_key(arena, i, keys[i]);
+
+        bench_map<CxbMap<K>>(b, "AHashMap", keys, n);
+        bench_map<StdMap<K>>(b, "std::unordered_map", keys, n);
+#ifdef CXB_BENCH_EXTERNAL_MAP
+#define CXB_STR_(x) #x
+#define CXB_STR(x) CXB_STR_(x)
+        bench_map<ExternalMap<K>>(b, CXB_STR(CXB_BENCH_EXTERNAL_MAP), keys, n);
+#endif
+        arena_destroy(arena);
+    }
+}
+
+BENCH_CASE("hm_suite int") {
+    bench_key<int>(b);
+}
+
+BENCH_CASE("hm_suite u64") {
+    bench_key<u64>(b);
+}
+
+BENCH_CASE("hm_suite String8") {
+    bench_key<String8>(b);
+}
+
+BENCH_CASE("hm_suite PointKey") {
+    bench_key<PointKey>(b);
+}
+
+BENCH_MAIN()
@@ -0,0 +1,460 @@
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+
+#include "examples/interpreter.h"
+
+// call-heavy: ~22k calls
+GLOBAL const char* FIB_SRC = R"(func fib(n: int): int {
+    if n <= 1 {
+        return n
+    }
+    return fib(n - 1) + fib(n - 2)
+}
+fib(20)
+)";
+
+// loop-heavy: variables, comparisons and jumps
+GLOBAL const char* LOOP_SRC = R"(func count(n: int) {
+    i := 0
+    s := 0
+    while i < n {
+        if i == 7 {
+            s += 1
+        } else {
+            s += 2
+        }
+        i += 1
+    }
+    return s
+}
+count(20000)
+)";
+
+// arithmetic-heavy: an LCG modulo 65537 in a loop
+GLOBAL const char* ARITH_SRC = R"(func lcg(n: int) {
+    x := 1
+    s := 0
+    i := 0
+    while i < n {
+        x = x * 75 + 74
+        x = x - x / 65537 * 65537
+        s = s + x / 3 - i * 2
+        i += 1
+    }
+    return s
+}
+lcg(20000)
+)";
+
+// doubles, through value_arith
+GLOBAL const char* FLOAT_SRC = R"(func series(n: int) {
+    s := 0.0
+    i := 1
+    while i <= n {
+        s += 1.0 / (i * i)
+        i += 1
+    }
+    return s
+}
+series(20000)
+)";
+
+// call-heavy: 3 calls per iteration through small functions
+GLOBAL const char* CALLS_SRC = R"(func add3(a: int, b: int, c: int): int {
+    return a + b + c
+}
+func inc(x: int): int {
+    return add3(x, 1, 0)
+}
+func twice(x: int): int {
+    return inc(inc(x))
+}
+func calls(n: int) {
+    i := 0
+    s := 0
+    while i < n {
+        s = s + twice(i)
+        i += 1
+    }
+    return s
+}
+calls(20000)
+)";
+
+// globals: a loop at the module level
+GLOBAL const char* GLOBALS_SRC = R"(total := 0
+step := 3
+i := 0
+while i < 20000 {
+    total = total + i * step
+    i += 1
+}
+total
+)";
+
+struct Program {
+    Module* mod;
+    BcProgram* bc;
+};
+
+INTERNAL Program program_make(Arena* arena, const char* src) {
+    Program p = {};
+    p.mod = module_make(S8_LIT("bench"), nullptr, nullptr);
+    ParseFileResult parsed = module_parse_string(p.mod, S8_CSTR(src));
+    ASSERT(!parsed && p.mod->parse_errors.len == 0, "parse failed");
+    p.bc = bc_compile(arena, p.mod);
+    ASSERT(p.bc->errors.len == 0, "compile failed");
+    return p;
+}
+
+// ops are the VM instructions a run executes, the unit of work of both evaluators: ops/s = ops per run / ns per run
+INTERNAL void print_ops_per_sec(Bencher* b, String8 name, u64 n_ops) {
+    if(!bench_enabled(b, name)) return;
+    const BenchResult& r = b->results[b->results.len - 1];
+    print("{}: {.1}M ops/s ({} ops per run)\n", r.name, (f64) n_ops / r.median_ns * 1e3, n_ops);
+}
+
+INTERNAL void bench_program(Bencher* b, const char* name, const char* src) {
+    Arena* arena = arena_make_nbytes(MB(64));
+    Program p = program_make(arena, src);
+    Interpreter* interp = interpreter_make(arena);
+    Vm* vm = vm_make(arena);
+
+    // the evaluators must agree before they are timed
+    EvalResult expected = eval(interp, p.mod);
+    EvalResult got = vm_run(vm, p.bc);
+    ASSERT(!expected && !got && value_equal(expected.value, got.value), "tree walker and VM disagree");
+    u64 n_ops = 0;
+    vm_run_counted(vm, p.bc, &n_ops);
+
+    String8 tree_walker_name = format(arena, "{} tree walker", name);
+    bench_run(b, tree_walker_name, [&] { return eval(interp, p.mod).value.bits; });
+    print_ops_per_sec(b, tree_walker_name, n_ops);
+    String8 vm_name = format(arena, "{} bytecode VM", name);
+    bench_run(b, vm_name, [&] { return vm_run(vm, p.bc).value.bits; });
+    print_ops_per_sec(b, vm_name, n_ops);
+
+    module_destroy(p.mod);
+    arena_destroy(arena);
+}
+
+BENCH_CASE("interpreter") {
+    bench_program(b, "fib(20)", FIB_SRC);
+    bench_program(b, "loop 20k", LOOP_SRC);
+    bench_program(b, "arith 20k", ARITH_SRC);
+    bench_program(b, "float 20k", FLOAT_SRC);
+    bench_program(b, "calls 20k", CALLS_SRC);
+    bench_program(b, "globals 20k", GLOBALS_SRC);
+}
+
+BENCH_CASE("compile") {
+    Arena* arena = arena_make_nbytes(MB(64));
+    Module* mod = module_make(S8_LIT("bench"), nullptr, nullptr);
+    module_parse_string(mod, S8_CSTR(ARITH_SRC));
+    u64 pos = arena->pos;
+    bench_run(b, "bc_compile arith", [&] {
+        u64 len = bc_compile(arena, mod)->main->code.len;
+        arena_pop_to(arena, pos);
+        return len;
+    });
+    module_destroy(mod);
+    arena_destroy(arena);
+}
+
+/* SECTION: AST layouts */
+// n_funcs functions of 3 blocks each
+INTERNAL String8 make_large_src(Arena* arena, u64 n_funcs) {
+    String8 src = arena_push_string8(arena);
+    char buf[512];
+    for(u64 i = 0; i < n_funcs; ++i) {
+        // format has no escape for braces
+        int n = snprintf(buf,
+                         sizeof(buf),
+                         "func f%llu(a: int, b: int) {\n"
+                         "    x := a * %llu + b\n"
+                         "    while x > 100 {\n"
+                         "        if x - x / 2 * 2 == 0 {\n"
+                         "            x = x / 2\n"
+                         "        } else {\n"
+                         "            x = x * 3 + 1\n"
+                         "        }\n"
+                         "    }\n"
+                         "    return x\n"
+                         "}\n",
+                         (unsigned long long) i,
+                         (unsigned long long) (i % 97));
+        src.extend(arena, String8{.data = buf, .len = (size_t) n, .not_null_term = true});
+    }
+    return src;
+}
+
+// n_funcs functions of n_ifs blocks each
+INTERNAL String8 make_blocks_src(Arena* arena, u64 n_funcs, u64 n_ifs) {
+    String8 src = arena_push_string8(arena);
+    char buf[128];
+    for(u64 i = 0; i < n_funcs; ++i) {
+        int n = snprintf(buf, sizeof(buf), "func f%llu(x: int) {\n", (unsigned long long) i);
+        src.extend(arena, String8{.data = buf, .len = (size_t) n, .not_null_term = true});
+        for(u64 j = 0; j < n_ifs; ++j) {
+            n = snprintf(buf, sizeof(buf), "    if x > %llu {\n        x = x - 1\n    }\n", (unsigned long long) j);
+            src.extend(arena, String8{.data = buf, .len = (size_t) n, .not_null_term = true});
+        }
+        src.extend(arena, S8_LIT("    return x\n}\n"));
+    }
+    return src;
+}
+
+INTERNAL i64 tree_sum_ints(const AstNode* node) {
+    i64 s = node->kind == NODE_INT_LIT ? node->data.numeral_literal.value : 0;
+    for(size_t i = 0; i < node->kids.len; ++i) {
+        if(node->kids[i] != nullptr) s += tree_sum_ints(node->kids[i]);
+    }
+    return s;
+}
+
+INTERNAL i64 ast_sum_ints(const Ast* ast, AstId id) {
+    i64 s = ast_kind(ast, id) == NODE_INT_LIT ? ast_data(ast, id).numeral_literal.value : 0;
+    for(u32 i = 0; i < ast_n_kids(ast, id); ++i) {
+        AstId kid = ast_kid(ast, id, i);
+        if(kid != AST_NONE) s += ast_sum_ints(ast, kid);
+    }
+    return s;
+}
+
+BENCH_CASE("ast") {
+    Arena* arena = arena_make_nbytes(MB(256));
+    String8 src = make_large_src(arena, 2000);
+    Module* mod = module_make(S8_LIT("bench"), nullptr, nullptr);
+    mod->keep_tree = true;
+    ParseFileResult parsed = module_parse_string(mod, src);
+    ASSERT(!parsed && mod->parse_errors.len == 0, "parse failed");
+    const Ast* ast = mod->ast;
+    ASSERT(tree_sum_ints(mod->root) == ast_sum_ints(ast, ast->root), "tree and flat AST disagree");
+
+    u64 n_nodes = ast->kind.len;
+    u64 n_edges = ast->edges.len;
+    u64 tree_kb = (n_nodes * sizeof(AstNode) + n_edges * sizeof(AstNode*)) / KB(1);
+    u64 hot_kb = (n_nodes * (2 * sizeof(u8) + 3 * sizeof(u32)) + n_edges * sizeof(AstId)) / KB(1);
+    u64 flat_kb = hot_kb + n_nodes * (sizeof(u32) + sizeof(AstNodeData)) / KB(1);
+
+    String8 flatten_name = format(arena, "ast_flatten {} nodes", n_nodes);
+    u64 pos = arena->pos;
+    bench_run(b, flatten_name, [&] {
+        AstId root = ast_flatten(arena, mod->root)->root;
+        arena_pop_to(arena, pos);
+        return root;
+    });
+    bench_run(b, format(arena, "sum int literals: AstNode tree ({} KB)", tree_kb), [&] {
+        return tree_sum_ints(mod->root);
+    });
+    bench_run(b, format(arena, "sum int literals: flat AST ({} KB, {} KB hot)", flat_kb, hot_kb), [&] {
+        return ast_sum_ints(ast, ast->root);
+    });
+    // ids are in pre-order, a pass that does not need the shape is a scan
+    bench_run(b, "sum int literals: flat AST scan", [&] {
+        i64 s = 0;
+        for(AstId id = 0; id < n_nodes; ++id) {
+            if(ast_kind(ast, id) == NODE_INT_LIT) s += ast_data(ast, id).numeral_literal.value;
+        }
+        return s;
+    });
+
+    // what a parsed module keeps committed, the tree is released once flattened unless keep_tree
+    u64 committed[2] = {};
+    for(int keep = 0; keep < 2; ++keep) {
+        u64 before = arena_registry_committed();
+        Module* m = module_make(S8_LIT("bench"), nullptr, nullptr);
+        m->keep_tree = keep;
+        module_parse_string(m, src);
+        committed[keep] = (arena_registry_committed() - before) / KB(1);
+        module_destroy(m);
+    }
+    String8 parse_name = format(
+        arena, "module_parse_string: {} KB committed, {} KB with keep_tree", committed[0], committed[1]);
+    bench_run(b, parse_name, [&] {
+        Module* m = module_make(S8_LIT("bench"), nullptr, nullptr);
+        module_parse_string(m, src);
+        u64 n = m->ast->kind.len;
+        module_destroy(m);
+        return n;
+    });
+
+    module_destroy(mod);
+    arena_destroy(arena);
+}
+
+// 101k blocks, parsed into a fresh module each time
+BENCH_CASE("parse") {
+    Arena* arena = arena_make_nbytes(MB(256));
+    String8 src = make_blocks_src(arena, 1000, 100);
+
+    // the arenas (one mmap each) and committed bytes a parse leaves behind until module_destroy
+    Module* mod = module_make(S8_LIT("bench"), nullptr, nullptr);
+    u64 n_arenas = arena_registry_snapshot(arena).len;
+    u64 committed = arena_registry_committed();
+    ParseFileResult parsed = module_parse_string(mod, src);
+    ASSERT(!parsed && mod->parse_errors.len == 0, "parse failed");
+    committed = arena_registry_committed() - committed;
+    n_arenas = arena_registry_snapshot(arena).len - n_arenas;
+    module_destroy(mod);
+    String8 name = format(arena,
+                          "module_parse_string {} KB: {} new arenas, {} KB committed",
+                          src.len / KB(1),
+                          n_arenas,
+                          committed / KB(1));
+
+    bench_run(b, name, [&] {
+        Module* mod = module_make(S8_LIT("bench"), nullptr, nullptr);
+        module_parse_string(mod, src);
+        u64 n_nodes = mod->ast->kind.len;
+        module_destroy(mod);
+        return n_nodes;
+    });
+    arena_destroy(arena);
+}
+
+/* SECTION: value representations */
+// the alternative to NaN-boxing: a tag next to a union, 16 bytes
+enum TaggedKind : u8 {
+    TAGGED_NIL,
+    TAGGED_BOOL,
+    TAGGED_INT,
+    TAGGED_DOUBLE,
+    TAGGED_STR,
+};
+
+struct TaggedValue {
+    TaggedKind kind;
+    union {
+        bool b;
+        i64 i;
+        f64 d;
+        const String8* s;
+    };
+};
+
+INTERNAL f64 tagged_to_f64(TaggedValue v) {
+    return v.kind == TAGGED_INT ? (f64) v.i : v.d;
+}
+
+// out of line, like value_arith
+__attribute__((noinline)) INTERNAL TaggedValue tagged_add_slow(TaggedValue a, TaggedValue b) {
+    bool a_number = a.kind == TAGGED_INT || a.kind == TAGGED_DOUBLE;
+    bool b_number = b.kind == TAGGED_INT || b.kind == TAGGED_DOUBLE;
+    TaggedValue r = {};
+    if(a_number && b_number) {
+        r.kind = TAGGED_DOUBLE;
+        r.d = tagged_to_f64(a) + tagged_to_f64(b);
+    }
+    return r;
+}
+
+CXB_INLINE TaggedValue tagged_add(TaggedValue a, TaggedValue b) {
+    TaggedValue r;
+    if(LIKELY(a.kind == TAGGED_INT && b.kind == TAGGED_INT) && !__builtin_add_overflow(a.i, b.i, &r.i)) {
+        r.kind = TAGGED_INT;
+        return r;
+    }
+    if(a.kind == TAGGED_DOUBLE && b.kind == TAGGED_DOUBLE) {
+        r.kind = TAGGED_DOUBLE;
+        r.d = a.d + b.d;
+        return r;
+    }
+    return tagged_add_slow(a, b);
+}
+
+CXB_INLINE bool tagged_truthy(TaggedValue v) {
+    switch(v.kind) {
+        case TAGGED_NIL:
+            return false;
+        case TAGGED_BOOL:
+            return v.b;
+        case TAGGED_INT:
+            return v.i != 0;
+        case TAGGED_DOUBLE:
+            return v.d != 0.0;
+        default:
+            return true;
+    }
+}
+
+__attribute__((noinline)) INTERNAL TaggedValue tagged_lt_slow(TaggedValue a, TaggedValue b) {
+    TaggedValue r = {.kind = TAGGED_BOOL, .b = tagged_to_f64(a) < tagged_to_f64(b)};
+    return r;
+}
+
+CXB_INLINE TaggedValue tagged_lt(TaggedValue a, TaggedValue b) {
+    if(LIKELY(a.kind == TAGGED_INT && b.kind == TAGGED_INT)) return TaggedValue{.kind = TAGGED_BOOL, .b = a.i < b.i};
+    if(a.kind == TAGGED_DOUBLE && b.kind == TAGGED_DOUBLE) return TaggedValue{.kind = TAGGED_BOOL, .b = a.d < b.d};
+    return tagged_lt_slow(a, b);
+}
+
+CXB_INLINE Value nanbox_add(Arena* arena, Value a, Value b) {
+    Value r;
+    if(LIKELY(value_try_add(a, b, &r))) return r;
+    return value_arith(arena, VALUE_ADD, a, b).value;
+}
+
+CXB_INLINE Value nanbox_lt(Arena* arena, Value a, Value b) {
+    Value r;
+    if(LIKELY(value_try_lt(a, b, &r))) return r;
+    return value_arith(arena, VALUE_LT, a, b).value;
+}
+
+// values per measurement
+constexpr size_t N_VALUES = 4096;
+
+BENCH_CASE("values") {
+    Arena* arena = arena_make_nbytes(MB(1));
+    Array<Value> ints = arena_push_array_fast<Value>(arena, N_VALUES);
+    Array<Value> mixed = arena_push_array_fast<Value>(arena, N_VALUES);
+    Array<TaggedValue> tagged_ints = arena_push_array_fast<TaggedValue>(arena, N_VALUES);
+    Array<TaggedValue> tagged_mixed = arena_push_array_fast<TaggedValue>(arena, N_VALUES);
+    for(size_t i = 0; i < N_VALUES; ++i) {
+        i64 x = (i64) (i * 7919 % 1000) - 500;
+        ints[i] = value_int(x);
+        tagged_ints[i] = TaggedValue{.kind = TAGGED_INT, .i = x};
+        // every 4th value is a double
+        if(i % 4 == 0) {
+            mixed[i] = value_double((f64) x + 0.5);
+            tagged_mixed[i] = TaggedValue{.kind = TAGGED_DOUBLE, .d = (f64) x + 0.5};
+        } else {
+            mixed[i] = ints[i];
+            tagged_mixed[i] = tagged_ints[i];
+        }
+    }
+
+    auto nanbox_sum = [&](Array<Value> xs) {
+        Value acc = value_int(0);
+        for(Value x : xs) acc = nanbox_add(arena, acc, x);
+        return acc.bits;
+    };
+    auto tagged_sum = [&](Array<TaggedValue> xs) {
+        TaggedValue acc = {.kind = TAGGED_INT, .i = 0};
+        for(TaggedValue x : xs) acc = tagged_add(acc, x);
+        return acc.i;
+    };
+    auto nanbox_count = [&](Array<Value> xs) {
+        u64 n = 0;
+        for(Value x : xs) n += value_truthy(nanbox_lt(arena, x, value_int(0)));
+        return n;
+    };
+    auto tagged_count = [&](Array<TaggedValue> xs) {
+        u64 n = 0;
+        TaggedValue zero = {.kind = TAGGED_INT, .i = 0};
+        for(TaggedValue x : xs) n += tagged_truthy(tagged_lt(x, zero));
+        return n;
+    };
+
+    bench_run(b, "sum ints: NaN-boxed", [&] { return nanbox_sum(ints); });
+    bench_run(b, "sum ints: tagged union", [&] { return tagged_sum(tagged_ints); });
+    bench_run(b, "sum 1/4 doubles: NaN-boxed", [&] { return nanbox_sum(mixed); });
+    bench_run(b, "sum 1/4 doubles: tagged union", [&] { return tagged_sum(tagged_mixed); });
+    bench_run(b, "count x < 0 ints: NaN-boxed", [&] { return nanbox_count(ints); });
+    bench_run(b, "count x < 0 ints: tagged union", [&] { return tagged_count(tagged_ints); });
+    bench_run(b, "count x < 0 1/4 doubles: NaN-boxed", [&] { return nanbox_count(mixed); });
+    bench_run(b, "count x < 0 1/4 doubles: tagged union", [&] { return tagged_count(tagged_mixed); });
+    arena_destroy(arena);
+}
+
+BENCH_MAIN()
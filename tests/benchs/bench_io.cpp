@@ -0,0 +1,166 @@
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <cxb/io.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+INTERNAL u64 sum_bytes(const char* data, size_t n) {
+    u64 sum = 0;
+    for(size_t i = 0; i < n; ++i) sum += (u8) data[i];
+    return sum;
+}
+
+INTERNAL u64 read_aio(AsyncIo* aio, int fd, Array<char> bufs, size_t file_size, size_t chunk) {
+    AArenaTmp tmp = begin_scratch();
+    u32 depth = (u32) (bufs.len / chunk);
+    Array<AioOp> ops = arena_push_array<AioOp>(tmp.arena, depth);
+    Array<AioCompletion> completions = arena_push_array<AioCompletion>(tmp.arena, depth);
+
+    u64 sum = 0;
+    size_t next = 0;
+    size_t n_chunks = file_size / chunk;
+    size_t completed = 0;
+    u32 n_free = depth;
+    u32* free_slots = arena_push<u32>(tmp.arena, depth);
+    for(u32 i = 0; i < depth; ++i) free_slots[i] = i;
+
+    while(completed < n_chunks) {
+        u32 n_ops = 0;
+        while(n_free > 0 && next < n_chunks) {
+            u32 slot = free_slots[--n_free];
+            ops[n_ops++] = aio_op_read(fd, next * chunk, Array<char>{bufs.data + slot * chunk, chunk}, slot);
+            next++;
+        }
+        if(n_ops > 0) {
+            auto res = aio_submit(aio, Array<AioOp>{ops.data, n_ops});
+            ASSERT(!res && res.value == n_ops);
+        }
+        auto polled = aio_poll(aio, completions, 1);
+        ASSERT(!polled, "aio_poll failed");
+        u32 got = polled.value;
+        for(u32 i = 0; i < got; ++i) {
+            u32 slot = (u32) completions[i].user_data;
+            sum += sum_bytes(bufs.data + slot * chunk, (size_t) completions[i].result);
+            free_slots[n_free++] = slot;
+        }
+        completed += got;
+    }
+    return sum;
+}
+
+BENCH_CASE("mmap vs pread vs AsyncIo") {
+    constexpr size_t FILE_SIZE = MB(64);
+    constexpr size_t CHUNK = KB(64);
+    constexpr u32 DEPTH = 32;
+
+    Arena* arena = arena_make_nbytes(MB(8));
+    String8 path = S8_LIT("bench_io.bin");
+    unlink(path.data);
+
+    auto created = memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = FILE_SIZE});
+    ASSERT(!created);
+    MemFile f = created.value;
+    for(size_t i = 0; i < FILE_SIZE; ++i) f.data[i] = (char) (i * 31);
+    ASSERT(!memfile_sync(f));
+    u64 expected = sum_bytes(f.data.data, FILE_SIZE);
+    memfile_close(f);
+
+    auto opened = memfile_open(arena, path);
+    ASSERT(!opened);
+    MemFile r = opened.value;
+    int fd = r.fd;
+
+    Array<char> bufs = aio_push_buffer(arena, DEPTH * CHUNK);
+
+    auto uring = aio_make(arena, AioParams{.queue_depth = DEPTH});
+    auto threads = aio_make(arena, AioParams{.queue_depth = DEPTH, .force_fallback = true});
+    ASSERT(!uring);
+    ASSERT(!threads);
+    Array<Array<char>> registered = arena_push_array<Array<char>>(arena, 1);
+    registered[0] = bufs;
+    ASSERT(!aio_register_buffers(uring.value, registered));
+
+    ASSERT(read_aio(uring.value, fd, bufs, FILE_SIZE, CHUNK) == expected);
+    ASSERT(read_aio(threads.value, fd, bufs, FILE_SIZE, CHUNK) == expected);
+
+    bench_run(b, "mmap sum", [&] {
+        return sum_bytes(r.data.data, r.data.len);
+    });
+
+    bench_run(b, "pread loop", [&] {
+        u64 sum = 0;
+        for(size_t off = 0; off < FILE_SIZE; off += CHUNK) {
+            ssize_t n = pread(fd, bufs.data, CHUNK, (off_t) off);
+            sum += sum_bytes(bufs.data, (size_t) n);
+        }
+        return sum;
+    });
+
+    const char* uring_name =
+        aio_backend(uring.value) == AIO_BACKEND_IO_URING ? "AsyncIo io_uring" : "AsyncIo io_uring (unavailable)";
+    bench_run(b, uring_name, [&] {
+        return read_aio(uring.value, fd, bufs, FILE_SIZE, CHUNK);
+    });
+
+    bench_run(b, "AsyncIo threads", [&] {
+        return read_aio(threads.value, fd, bufs, FILE_SIZE, CHUNK);
+    });
+
+    aio_destroy(uring.value);
+    aio_destroy(threads.value);
+    memfile_close(r);
+    unlink(path.data);
+    arena_destroy(arena);
+}
+
+BENCH_CASE("file copy methods vs read/write loop") {
+    constexpr size_t FILE_SIZE = MB(256);
+    constexpr size_t CHUNK = KB(64);
+
+    Arena* arena = arena_make_nbytes(MB(8));
+    String8 src = S8_LIT("bench_copy_src.bin");
+    String8 dst = S8_LIT("bench_copy_dst.bin");
+    unlink(src.data);
+
+    auto created = memfile_open(arena, src, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = FILE_SIZE});
+    ASSERT(!created);
+    for(size_t i = 0; i < FILE_SIZE; i += 64) created.value.data[i] = (char) i;
+    memfile_close(created.value);
+
+    Array<char> buf = aio_push_buffer(arena, CHUNK);
+    bench_run(b, "read/write loop", [&] {
+        int in = open(src.data, O_RDONLY);
+        int out = open(dst.data, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        size_t total = 0;
+        for(;;) {
+            ssize_t n = read(in, buf.data, buf.len);
+            if(n <= 0) break;
+            total += (size_t) write(out, buf.data, (size_t) n);
+        }
+        close(in);
+        close(out);
+        return total;
+    });
+
+    const char* names[] = {"file_copy auto",
+                           "file_copy FICLONE",
+                           "file_copy copy_file_range",
+                           "file_copy sendfile",
+                           "file_copy splice",
+                           "file_copy buffered"};
+    for(int m = FILE_COPY_AUTO; m < FILE_COPY_CNT; ++m) {
+        FileCopyParams params = {.method = (FileCopyMethod) m};
+        if(file_copy(dst, src, params)) {
+            continue; // unsupported here
+        }
+        bench_run(b, names[m], [&] {
+            return file_copy(dst, src, params).value.n_bytes;
+        });
+    }
+
+    unlink(src.data);
+    unlink(dst.data);
+    arena_destroy(arena);
+}
+
+BENCH_MAIN()
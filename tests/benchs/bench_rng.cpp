@@ -0,0 +1,97 @@
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <cxb/rng.h>
+#include <random>
+
+// values per measurement
+constexpr size_t N = 4096;
+
+template <typename F>
+INTERNAL u64 sum_n(F&& next) {
+    u64 sum = 0;
+    for(size_t i = 0; i < N; ++i) sum += next();
+    return sum;
+}
+
+BENCH_CASE("raw u64") {
+    std::mt19937 mt(1);
+    std::mt19937_64 mt64(1);
+    std::minstd_rand minstd(1);
+    Xoshiro256 xoshiro = xoshiro256_make(1);
+    WyRand wy = wyrand_make(1);
+    Pcg32 pcg = pcg32_make(1);
+    Xoshiro256x4 x4 = xoshiro256x4_make(1);
+    u64 buf[N];
+
+    bench_run(b, "std::mt19937 (u32)", [&] { return sum_n([&] { return mt(); }); });
+    bench_run(b, "std::mt19937_64", [&] { return sum_n([&] { return mt64(); }); });
+    bench_run(b, "std::minstd_rand (u31)", [&] { return sum_n([&] { return minstd(); }); });
+    bench_run(b, "xoshiro256++", [&] { return sum_n([&] { return rng_u64(xoshiro); }); });
+    bench_run(b, "wyrand", [&] { return sum_n([&] { return rng_u64(wy); }); });
+    bench_run(b, "pcg32 (u32)", [&] { return sum_n([&] { return rng_u32(pcg); }); });
+    bench_run(b, "pcg32 (2 x u32)", [&] { return sum_n([&] { return rng_u64(pcg); }); });
+    bench_run(b, "rng_fill_u64 xoshiro256++ x4", [&] {
+        rng_fill_u64(x4, Array<u64>{buf, N});
+        return buf[N - 1];
+    });
+}
+
+BENCH_CASE("bounded u32 in [0, 1000)") {
+    std::mt19937 mt(1);
+    std::uniform_int_distribution<u32> dist(0, 999);
+    Xoshiro256 xoshiro = xoshiro256_make(1);
+    WyRand wy = wyrand_make(1);
+    Xoshiro256x4 x4 = xoshiro256x4_make(1);
+    u32 buf[N];
+
+    bench_run(b, "std::uniform_int_distribution mt19937", [&] { return sum_n([&] { return dist(mt); }); });
+    bench_run(b, "std::uniform_int_distribution xoshiro256++", [&] { return sum_n([&] { return dist(xoshiro); }); });
+    bench_run(b, "rng_bounded_u32 xoshiro256++", [&] { return sum_n([&] { return rng_bounded_u32(xoshiro, 1000); }); });
+    bench_run(b, "rng_bounded_u32 wyrand", [&] { return sum_n([&] { return rng_bounded_u32(wy, 1000); }); });
+    bench_run(b, "x % 1000 xoshiro256++ (biased)", [&] { return sum_n([&] { return rng_u64(xoshiro) % 1000; }); });
+    bench_run(b, "rng_fill_bounded_u32 xoshiro256++ x4", [&] {
+        rng_fill_bounded_u32(x4, Array<u32>{buf, N}, 1000);
+        return buf[N - 1];
+    });
+}
+
+BENCH_CASE("uniform floats in [0, 1)") {
+    std::mt19937 mt(1);
+    std::mt19937_64 mt64(1);
+    std::uniform_real_distribution<f32> dist_f32(0, 1);
+    std::uniform_real_distribution<f64> dist_f64(0, 1);
+    Xoshiro256 xoshiro = xoshiro256_make(1);
+    Xoshiro256x4 x4 = xoshiro256x4_make(1);
+    f32 buf[N];
+
+    auto sum_f = [](auto&& next) {
+        f64 sum = 0;
+        for(size_t i = 0; i < N; ++i) sum += next();
+        return sum;
+    };
+    bench_run(b, "std::uniform_real_distribution<f32> mt19937", [&] { return sum_f([&] { return dist_f32(mt); }); });
+    bench_run(b, "std::uniform_real_distribution<f64> mt19937_64", [&] {
+        return sum_f([&] { return dist_f64(mt64); });
+    });
+    bench_run(b, "std::generate_canonical<f64> xoshiro256++", [&] {
+        return sum_f([&] { return std::generate_canonical<f64, 53>(xoshiro); });
+    });
+    bench_run(b, "rng_f32 xoshiro256++", [&] { return sum_f([&] { return rng_f32(xoshiro); }); });
+    bench_run(b, "rng_f64 xoshiro256++", [&] { return sum_f([&] { return rng_f64(xoshiro); }); });
+    bench_run(b, "rng_fill_f32 xoshiro256++ x4", [&] {
+        rng_fill_f32(x4, Array<f32>{buf, N});
+        return buf[N - 1];
+    });
+}
+
+BENCH_CASE("streams") {
+    bench_run(b, "xoshiro256_stream(seed, 8)", [&] { return xoshiro256_stream(1, 8).s[0]; });
+    bench_run(b, "xoshiro256x4_make(seed, 8)", [&] { return xoshiro256x4_make(1, 8).s[0][0]; });
+    bench_run(b, "pcg32_advance 2^40", [&] {
+        Pcg32 g = pcg32_make(1);
+        pcg32_advance(g, 1ull << 40);
+        return g.state;
+    });
+}
+
+BENCH_MAIN()
@@ -0,0 +1,122 @@
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <cxb/serialize.h>
+
+struct Record {
+    u64 id;
+    String8 name;
+    Array<f32> values;
+};
+
+void serialize_value(Arena* a, String8& dst, const Record& x) {
+    serialize_value(a, dst, x.id);
+    serialize_value(a, dst, x.name);
+    serialize_value(a, dst, x.values);
+}
+
+void deserialize_value(Arena* a, SerialReader& r, Record& x) {
+    deserialize_value(a, r, x.id);
+    deserialize_value(a, r, x.name);
+    deserialize_value(a, r, x.values);
+}
+
+// hand-written: u32 lengths, a single pre-sized output buffer
+INTERNAL String8 write_records_by_hand(Arena* a, Array<Record> records) {
+    size_t n = sizeof(u32);
+    for(const Record& r : records) {
+        n += sizeof(u64) + sizeof(u32) + r.name.len + sizeof(u32) + r.values.len * sizeof(f32);
+    }
+    char* out = (char*) arena_push_bytes(a, n, 1);
+    char* p = out;
+    u32 len = (u32) records.len;
+    memcpy(p, &len, sizeof(len));
+    p += sizeof(len);
+    for(const Record& r : records) {
+        memcpy(p, &r.id, sizeof(r.id));
+        p += sizeof(r.id);
+        len = (u32) r.name.len;
+        memcpy(p, &len, sizeof(len));
+        p += sizeof(len);
+        memcpy(p, r.name.data, r.name.len);
+        p += r.name.len;
+        len = (u32) r.values.len;
+        memcpy(p, &len, sizeof(len));
+        p += sizeof(len);
+        memcpy(p, r.values.data, r.values.len * sizeof(f32));
+        p += r.values.len * sizeof(f32);
+    }
+    return String8{.data = out, .len = n, .not_null_term = true};
+}
+
+INTERNAL Array<Record> read_records_by_hand(Arena* a, String8 src) {
+    const char* p = src.data;
+    u32 n = 0;
+    memcpy(&n, p, sizeof(n));
+    p += sizeof(n);
+    Array<Record> records = arena_push_array<Record>(a, n);
+    for(Record& r : records) {
+        memcpy(&r.id, p, sizeof(r.id));
+        p += sizeof(r.id);
+        u32 len = 0;
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        r.name = String8{.data = (char*) p, .len = len, .not_null_term = true};
+        p += len;
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        r.values = arena_push_array<f32>(a, len);
+        memcpy(r.values.data, p, len * sizeof(f32));
+        p += len * sizeof(f32);
+    }
+    return records;
+}
+
+BENCH_CASE("serialize vs hand-written") {
+    constexpr size_t N = 10000;
+    Arena* arena = arena_make_nbytes(MB(256));
+
+    Array<Record> records = arena_push_array<Record>(arena, N);
+    for(size_t i = 0; i < N; ++i) {
+        records[i].id = i;
+        records[i].name = format(arena, "record_{}", i);
+        records[i].values = arena_push_array<f32>(arena, 1 + i % 32);
+        for(size_t j = 0; j < records[i].values.len; ++j) records[i].values[j] = (f32) (i * j);
+    }
+
+    String8 generic = serialize(arena, records);
+    String8 by_hand = write_records_by_hand(arena, records);
+    auto rt = deserialize<Array<Record>>(arena, generic);
+    ASSERT(!rt);
+    ASSERT(rt.value.len == N);
+    ASSERT(rt.value[N - 1].name == records[N - 1].name);
+    ASSERT(read_records_by_hand(arena, by_hand)[N - 1].values.len == records[N - 1].values.len);
+
+    u64 pos = arena->pos;
+    bench_run(b, "serialize Array<Record>", [&] {
+        String8 out = serialize(arena, records);
+        arena_pop_to(arena, pos);
+        return out.len;
+    });
+
+    bench_run(b, "hand-written write", [&] {
+        String8 out = write_records_by_hand(arena, records);
+        arena_pop_to(arena, pos);
+        return out.len;
+    });
+
+    bench_run(b, "deserialize Array<Record>", [&] {
+        auto out = deserialize<Array<Record>>(arena, generic);
+        arena_pop_to(arena, pos);
+        return out.value.len;
+    });
+
+    bench_run(b, "hand-written read", [&] {
+        Array<Record> out = read_records_by_hand(arena, by_hand);
+        arena_pop_to(arena, pos);
+        return out.len;
+    });
+
+    arena_destroy(arena);
+}
+
+BENCH_MAIN()
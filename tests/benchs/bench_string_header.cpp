@@ -1,9 +1,8 @@
 #include <algorithm>
-#include <catch2/benchmark/catch_benchmark.hpp>
-#include <catch2/catch_test_macros.hpp>
+#include <cxb/bench.h>
 #include <cxb/cxb.h>
+#include <cxb/rng.h>
 #include <numeric>
-#include <random>
 #include <string>
 #include <vector>
 
@@ -11,13 +10,12 @@ namespace {
 constexpr size_t SMALL_SIZE = 1024;
 constexpr size_t LARGE_SIZE = 1 << 24; // 16 MiB
 
-char random_char(std::mt19937& rng) {
-    static std::uniform_int_distribution<int> dist('a', 'z');
-    return static_cast<char>(dist(rng));
+char random_char(Xoshiro256& rng) {
+    return static_cast<char>('a' + rng_bounded_u32(rng, 26));
 }
 
 // Helper to generate an AString8 of given length filled with random chars
-AString8 make_astring(size_t len, std::mt19937& rng) {
+AString8 make_astring(size_t len, Xoshiro256& rng) {
     AString8 s;
     s.reserve(len);
     for(size_t i = 0; i < len; ++i) s.push_back(random_char(rng));
@@ -25,7 +23,7 @@ AString8 make_astring(size_t len, std::mt19937& rng) {
 }
 
 // Helper to generate std::string of given length filled with random chars
-std::string make_stdstring(size_t len, std::mt19937& rng) {
+std::string make_stdstring(size_t len, Xoshiro256& rng) {
     std::string s;
     s.reserve(len);
     for(size_t i = 0; i < len; ++i) s.push_back(random_char(rng));
@@ -33,46 +31,46 @@ std::string make_stdstring(size_t len, std::mt19937& rng) {
 }
 } // namespace
 
-TEST_CASE("push_back benchmark", "[benchmark][String]") {
-    BENCHMARK("AString8 push_back small") {
+BENCH_CASE("push_back benchmark") {
+    bench_run(b, "AString8 push_back small", [&] {
         AString8 s;
         s.reserve(SMALL_SIZE);
         for(size_t i = 0; i < SMALL_SIZE; ++i) {
             s.push_back('x');
         }
         return s.size();
-    };
+    });
 
-    BENCHMARK("std::string push_back small") {
+    bench_run(b, "std::string push_back small", [&] {
         std::string s;
         s.reserve(SMALL_SIZE);
         for(size_t i = 0; i < SMALL_SIZE; ++i) {
             s.push_back('x');
         }
         return s.size();
-    };
+    });
 
-    BENCHMARK("AString8 push_back large") {
+    bench_run(b, "AString8 push_back large", [&] {
         AString8 s;
         s.reserve(LARGE_SIZE);
         for(size_t i = 0; i < LARGE_SIZE; ++i) {
             s.push_back('x');
         }
         return s.size();
-    };
+    });
 
-    BENCHMARK("std::string push_back large") {
+    bench_run(b, "std::string push_back large", [&] {
         std::string s;
         s.reserve(LARGE_SIZE);
         for(size_t i = 0; i < LARGE_SIZE; ++i) {
             s.push_back('x');
         }
         return s.size();
-    };
+    });
 }
 
-TEST_CASE("random access benchmark", "[benchmark][String]") {
-    std::mt19937 rng(12345);
+BENCH_CASE("random access benchmark") {
+    Xoshiro256 rng = xoshiro256_make(12345);
 
     // Prepare test strings
     AString8 a_small = make_astring(SMALL_SIZE, rng);
@@ -86,32 +84,32 @@ TEST_CASE("random access benchmark", "[benchmark][String]") {
     // Precompute random indices
     constexpr size_t N_INDICES = 2048;
     std::vector<size_t> idx_small(N_INDICES), idx_large(N_INDICES);
-    std::uniform_int_distribution<size_t> dist_small(0, SMALL_SIZE - 1);
-    std::uniform_int_distribution<size_t> dist_large(0, LARGE_SIZE - 1);
-    for(size_t& v : idx_small) v = dist_small(rng);
-    for(size_t& v : idx_large) v = dist_large(rng);
+    for(size_t& v : idx_small) v = rng_bounded_u32(rng, SMALL_SIZE);
+    for(size_t& v : idx_large) v = rng_bounded_u32(rng, LARGE_SIZE);
 
-    BENCHMARK("AString8 random access small") {
+    bench_run(b, "AString8 random access small", [&] {
         volatile size_t sum = 0;
         for(size_t i : idx_small) sum += a_small[i];
         return sum;
-    };
+    });
 
-    BENCHMARK("std::string random access small") {
+    bench_run(b, "std::string random access small", [&] {
         volatile size_t sum = 0;
         for(size_t i : idx_small) sum += std_small[i];
         return sum;
-    };
+    });
 
-    BENCHMARK("AString8 random access large") {
+    bench_run(b, "AString8 random access large", [&] {
         volatile size_t sum = 0;
         for(size_t i : idx_large) sum += a_large[i];
         return sum;
-    };
+    });
 
-    BENCHMARK("std::string random access large") {
+    bench_run(b, "std::string random access large", [&] {
         volatile size_t sum = 0;
         for(size_t i : idx_large) sum += std_large[i];
         return sum;
-    };
+    });
 }
+
+BENCH_MAIN()
@@ -0,0 +1,257 @@
+#include <charconv>
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <cxb/rng.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* SECTION: corpora
+~1MB of log lines, CSV and source code, generated with a fixed seed
+*/
+constexpr size_t CORPUS_BYTES = MB(1);
+
+INTERNAL const char* pick(Xoshiro256& rng, std::initializer_list<const char*> xs) {
+    return xs.begin()[rng_bounded_u32(rng, (u32) xs.size())];
+}
+
+INTERNAL std::string make_log_corpus() {
+    Xoshiro256 rng = xoshiro256_make(1);
+    std::string s;
+    char line[256];
+    for(u64 i = 0; s.size() < CORPUS_BYTES; ++i) {
+        snprintf(line,
+                 sizeof(line),
+                 "2026-10-18T12:%02d:%02d.%03dZ %s [%s] request id=%llu path=%s status=%s latency_ms=%.3f\n",
+                 (int) (i / 60000 % 60),
+                 (int) (i / 1000 % 60),
+                 (int) (i % 1000),
+                 pick(rng, {"INFO", "INFO", "INFO", "WARN", "ERROR", "DEBUG"}),
+                 pick(rng, {"main", "worker-1", "worker-2", "worker-12", "io"}),
+                 (unsigned long long) rng_bounded_u32(rng, 1000000),
+                 pick(rng, {"/api/v1/items", "/api/v1/items/42", "/health", "/api/v2/users/me", "/static/app.js"}),
+                 pick(rng, {"200", "200", "200", "201", "404", "500"}),
+                 rng_lognormal(rng, 1.0, 1.5));
+        s += line;
+    }
+    return s;
+}
+
+INTERNAL std::string make_csv_corpus() {
+    Xoshiro256 rng = xoshiro256_make(2);
+    std::string s = "id,name,price,qty,timestamp\n";
+    char line[256];
+    for(u64 i = 0; s.size() < CORPUS_BYTES; ++i) {
+        snprintf(line,
+                 sizeof(line),
+                 "%llu,%s,%.2f,%d,%llu\n",
+                 (unsigned long long) i,
+                 pick(rng, {"widget", "gadget", "sprocket", "doohickey", "thingamajig", "gizmo"}),
+                 rng_uniform(rng, 0.5, 2000.0),
+                 (int) rng_bounded_u32(rng, 1000),
+                 (unsigned long long) (1760000000 + rng_bounded_u32(rng, 10000000)));
+        s += line;
+    }
+    return s;
+}
+
+INTERNAL std::string make_source_corpus() {
+    Xoshiro256 rng = xoshiro256_make(3);
+    std::string s;
+    int depth = 0;
+    while(s.size() < CORPUS_BYTES) {
+        const char* line = pick(rng,
+                                {"",
+                                 "// NOTE: the arena must outlive the result",
+                                 "size_t n = xs.len;",
+                                 "for(size_t i = 0; i < n; ++i) {",
+                                 "if(UNLIKELY(x == nullptr)) return {};",
+                                 "String8 name = format(a, \"{}_{}\", prefix, i);",
+                                 "return result;",
+                                 "}",
+                                 "u64 h = hash(key) & (table.len - 1);",
+                                 "array_push_back(out, arena, value);\t"});
+        if(line[0] == '}') depth = max(depth - 1, 0);
+        s.append((size_t) depth * 4, ' ');
+        s += line;
+        s += '\n';
+        if(line[0] && line[strlen(line) - 1] == '{') depth = min(depth + 1, 6);
+    }
+    return s;
+}
+
+struct Corpus {
+    const char* name;
+    std::string text;
+    const char* needle;
+};
+
+INTERNAL std::vector<Corpus> make_corpora() {
+    std::vector<Corpus> corpora;
+    corpora.push_back({"log", make_log_corpus(), "status=500"});
+    corpora.push_back({"csv", make_csv_corpus(), ",gizmo,"});
+    corpora.push_back({"source", make_source_corpus(), "return"});
+    return corpora;
+}
+
+/* SECTION: benchmarks */
+BENCH_CASE("find") {
+    for(const Corpus& c : make_corpora()) {
+        String8 text = S8_STR(c.text);
+        String8 needle = S8_CSTR(c.needle);
+        std::string_view text_sv = c.text;
+        // the names outlive the runs, arena is cleared by them
+        Arena* names = get_perm();
+        String8 suffix = format(names, " '{}' in {}", c.needle, c.name);
+
+        bench_run(b, format(names, "string8_find{}", suffix), [&] {
+            size_t count = 0;
+            String8 rest = text;
+            for(size_t i; (i = string8_find(rest, needle)) != SIZE_MAX; ++count) {
+                rest = S8_DATA(rest.data + i + 1, rest.len - i - 1);
+            }
+            return count;
+        });
+        bench_run(b, format(names, "std::string_view::find{}", suffix), [&] {
+            size_t count = 0;
+            for(size_t i = text_sv.find(c.needle); i != std::string_view::npos; i = text_sv.find(c.needle, i + 1)) {
+                count += 1;
+            }
+            return count;
+        });
+        bench_run(b, format(names, "memmem{}", suffix), [&] {
+            size_t count = 0;
+            const char* end = text.data + text.len;
+            for(const char* p = text.data; (p = (const char*) memmem(p, end - p, needle.data, needle.len)); ++p) {
+                count += 1;
+            }
+            return count;
+        });
+    }
+}
+
+BENCH_CASE("split") {
+    for(const Corpus& c : make_corpora()) {
+        String8 text = S8_STR(c.text);
+        std::string_view text_sv = c.text;
+        // fields of a log line are separated by spaces
+        char sep = c.name[0] == 'c' ? ',' : ' ';
+        String8 sep8 = S8_DATA(&sep, 1);
+        Arena* names = get_perm();
+        String8 suffix = format(names, " lines and fields in {}", c.name);
+
+        bench_run(b, format(names, "String8::split{}", suffix), [&] {
+            size_t n_fields = 0;
+            for(String8 line : text.split(S8_LIT("\n"))) {
+                for(String8 field : line.split(sep8)) n_fields += field.len > 0;
+            }
+            return n_fields;
+        });
+        bench_run(b, format(names, "std::string_view::find{}", suffix), [&] {
+            size_t n_fields = 0;
+            size_t line_start = 0;
+            while(line_start <= text_sv.size()) {
+                size_t line_end = text_sv.find('\n', line_start);
+                if(line_end == std::string_view::npos) line_end = text_sv.size();
+                std::string_view line = text_sv.substr(line_start, line_end - line_start);
+                size_t field_start = 0;
+                while(field_start <= line.size()) {
+                    size_t field_end = line.find(sep, field_start);
+                    if(field_end == std::string_view::npos) field_end = line.size();
+                    n_fields += field_end > field_start;
+                    field_start = field_end + 1;
+                }
+                line_start = line_end + 1;
+            }
+            return n_fields;
+        });
+    }
+}
+
+BENCH_CASE("trim") {
+    std::string source = make_source_corpus();
+    Arena* arena = arena_make_nbytes(MB(16));
+    Array<String8> lines = S8_STR(source).split(S8_LIT("\n")).collect(arena);
+    std::vector<std::string_view> lines_sv;
+    for(String8 line : lines) lines_sv.push_back(std::string_view{line.data, line.len});
+
+    bench_run(b, "string8_trim source lines", [&] {
+        size_t n = 0;
+        for(String8 line : lines) n += string8_trim(line, S8_LIT(" \t")).len;
+        return n;
+    });
+    bench_run(b, "std::string_view find_first_not_of/find_last_not_of source lines", [&] {
+        size_t n = 0;
+        for(std::string_view line : lines_sv) {
+            size_t start = line.find_first_not_of(" \t");
+            if(start == std::string_view::npos) continue;
+            n += line.find_last_not_of(" \t") + 1 - start;
+        }
+        return n;
+    });
+    arena_destroy(arena);
+}
+
+BENCH_CASE("parse") {
+    // the qty (int) and price (float) columns of the CSV
+    std::string csv = make_csv_corpus();
+    Arena* arena = arena_make_nbytes(MB(64));
+    AArray<String8> ints;
+    AArray<String8> floats;
+    bool header = true;
+    for(String8 line : S8_STR(csv).split(S8_LIT("\n"))) {
+        if(header || line.len == 0) {
+            header = false;
+            continue;
+        }
+        Array<String8> fields = line.split(S8_LIT(",")).collect(arena);
+        floats.push_back(fields[2]);
+        ints.push_back(fields[3]);
+    }
+
+    bench_run(b, "string8_parse<i64> CSV column", [&] {
+        i64 sum = 0;
+        for(String8 x : ints) sum += string8_parse<i64>(x).value;
+        return sum;
+    });
+    bench_run(b, "std::from_chars i64 CSV column", [&] {
+        i64 sum = 0;
+        for(String8 x : ints) {
+            i64 v = 0;
+            std::from_chars(x.data, x.data + x.len, v);
+            sum += v;
+        }
+        return sum;
+    });
+    bench_run(b, "strtoll CSV column", [&] {
+        i64 sum = 0;
+        for(String8 x : ints) sum += strtoll(x.data, nullptr, 10);
+        return sum;
+    });
+
+    bench_run(b, "string8_parse<f64> CSV column", [&] {
+        f64 sum = 0;
+        for(String8 x : floats) sum += string8_parse<f64>(x).value;
+        return sum;
+    });
+    bench_run(b, "std::from_chars f64 CSV column", [&] {
+        f64 sum = 0;
+        for(String8 x : floats) {
+            f64 v = 0;
+            std::from_chars(x.data, x.data + x.len, v);
+            sum += v;
+        }
+        return sum;
+    });
+    // NOTE: the fields are not null terminated, strtod stops at the next ','
+    bench_run(b, "strtod CSV column", [&] {
+        f64 sum = 0;
+        for(String8 x : floats) sum += strtod(x.data, nullptr);
+        return sum;
+    });
+    arena_destroy(arena);
+}
+
+BENCH_MAIN()
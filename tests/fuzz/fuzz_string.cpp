@@ -1,4 +1,4 @@
-#include "cxb/cxb-cxx.h"
+#include "cxb/cxb.h"
 
 #include <stddef.h>
 #include <stdint.h>
@@ -0,0 +1,138 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <cxb/alloc_track.h>
+#include <cxb/cxb.h>
+
+#include <thread>
+
+INTERNAL AllocSiteStats totals(AllocSiteKind kind) {
+    AArenaTmp tmp = begin_scratch();
+    Array<AllocSiteStats> stats = alloc_track_snapshot(tmp.arena);
+    AllocSiteStats result = {};
+    for(const AllocSiteStats& s : stats) {
+        if(s.kind != kind) continue;
+        result.n_allocs += s.n_allocs;
+        result.n_frees += s.n_frees;
+        result.n_bytes += s.n_bytes;
+        result.live_bytes += s.live_bytes;
+        for(u32 i = 0; i < ALLOC_TRACK_LIFETIME_BUCKETS; ++i) result.lifetimes[i] += s.lifetimes[i];
+    }
+    return result;
+}
+
+__attribute__((noinline)) INTERNAL u32* alloc_ints(Allocator* a, size_t n) {
+    return a->alloc<u32>(n);
+}
+
+TEST_CASE("tracking allocator", "[alloc_track]") {
+    Allocator tracked = alloc_track_allocator(&heap_alloc);
+    AllocSiteStats before = totals(ALLOC_SITE_ALLOCATOR);
+
+    u32* xs[10];
+    for(int i = 0; i < 10; ++i) {
+        xs[i] = alloc_ints(&tracked, 100);
+        REQUIRE(((u64) xs[i] & 15) == 0);
+        for(int j = 0; j < 100; ++j) xs[i][j] = j;
+    }
+    AllocSiteStats mid = totals(ALLOC_SITE_ALLOCATOR);
+    REQUIRE(mid.n_allocs - before.n_allocs == 10);
+    REQUIRE(mid.live_bytes - before.live_bytes == 10 * 100 * sizeof(u32));
+
+    for(int i = 0; i < 10; ++i) tracked.free(xs[i], 100);
+    AllocSiteStats after = totals(ALLOC_SITE_ALLOCATOR);
+    REQUIRE(after.n_frees - before.n_frees == 10);
+    REQUIRE(after.live_bytes == before.live_bytes);
+
+    u64 n_lifetimes = 0;
+    for(u32 i = 0; i < ALLOC_TRACK_LIFETIME_BUCKETS; ++i) n_lifetimes += after.lifetimes[i] - before.lifetimes[i];
+    REQUIRE(n_lifetimes == 10);
+}
+
+TEST_CASE("tracking allocator with containers", "[alloc_track]") {
+    Allocator tracked = alloc_track_allocator(&heap_alloc);
+    AllocSiteStats before = totals(ALLOC_SITE_ALLOCATOR);
+    {
+        AArray<u64> xs{&tracked};
+        for(u64 i = 0; i < 1000; ++i) xs.push_back(i);
+        for(u64 i = 0; i < 1000; ++i) REQUIRE(xs[i] == i);
+
+        AllocSiteStats mid = totals(ALLOC_SITE_ALLOCATOR);
+        REQUIRE(mid.live_bytes - before.live_bytes == xs.capacity * sizeof(u64));
+        REQUIRE(mid.n_bytes - before.n_bytes >= 1000 * sizeof(u64));
+    }
+    AllocSiteStats after = totals(ALLOC_SITE_ALLOCATOR);
+    REQUIRE(after.live_bytes == before.live_bytes);
+}
+
+__attribute__((noinline)) void grow_a(AArray<u64>& xs) {
+    for(u64 i = 0; i < 100; ++i) xs.push_back(i);
+}
+
+__attribute__((noinline)) void grow_b(AArray<u64>& xs) {
+    for(u64 i = 0; i < 300; ++i) xs.push_back(i);
+}
+
+// the allocator site closest after the start of `fn`
+INTERNAL const AllocSiteStats* site_after(Array<AllocSiteStats> stats, void (*fn)(AArray<u64>&)) {
+    const AllocSiteStats* result = nullptr;
+    for(const AllocSiteStats& s : stats) {
+        if(s.kind != ALLOC_SITE_ALLOCATOR || (char*) s.addr < (char*) fn) continue;
+        if(!result || (char*) s.addr < (char*) result->addr) result = &s;
+    }
+    return result;
+}
+
+TEST_CASE("container growth is attributed to the caller", "[alloc_track]") {
+    Allocator tracked = alloc_track_allocator(&heap_alloc);
+    AArray<u64> xs{&tracked};
+    AArray<u64> ys{&tracked};
+    grow_a(xs);
+    grow_b(ys);
+
+    AArenaTmp tmp = begin_scratch();
+    Array<AllocSiteStats> stats = alloc_track_snapshot(tmp.arena);
+    const AllocSiteStats* a = site_after(stats, grow_a);
+    const AllocSiteStats* b = site_after(stats, grow_b);
+    REQUIRE(a != nullptr);
+    REQUIRE(b != nullptr);
+    REQUIRE(a->addr != b->addr);
+    REQUIRE(a->live_bytes == xs.capacity * sizeof(u64));
+    REQUIRE(b->live_bytes == ys.capacity * sizeof(u64));
+}
+
+TEST_CASE("frees on another thread", "[alloc_track]") {
+    Allocator tracked = alloc_track_allocator(&heap_alloc);
+    AllocSiteStats before = totals(ALLOC_SITE_ALLOCATOR);
+
+    u32* xs = alloc_ints(&tracked, 64);
+    std::thread t([&] { tracked.free(xs, 64); });
+    t.join();
+
+    AllocSiteStats after = totals(ALLOC_SITE_ALLOCATOR);
+    REQUIRE(after.n_allocs - before.n_allocs == 1);
+    REQUIRE(after.n_frees - before.n_frees == 1);
+    REQUIRE(after.live_bytes == before.live_bytes);
+}
+
+TEST_CASE("arena pushes", "[alloc_track]") {
+    AllocSiteStats before = totals(ALLOC_SITE_ARENA);
+    int site = 0;
+    for(int i = 0; i < 5; ++i) alloc_track_arena_push(&site, 128);
+    AllocSiteStats after = totals(ALLOC_SITE_ARENA);
+    REQUIRE(after.n_allocs - before.n_allocs >= 5);
+    REQUIRE(after.n_bytes - before.n_bytes >= 5 * 128);
+
+    AArenaTmp tmp = begin_scratch();
+    Array<AllocSiteStats> stats = alloc_track_snapshot(tmp.arena);
+    bool found = false;
+    for(const AllocSiteStats& s : stats) {
+        if(s.addr == &site) {
+            found = true;
+            REQUIRE(s.kind == ALLOC_SITE_ARENA);
+            REQUIRE(s.n_allocs == 5);
+            REQUIRE(s.n_bytes == 5 * 128);
+        }
+    }
+    REQUIRE(found);
+    REQUIRE(alloc_track_site_name(tmp.arena, &site).len > 0);
+}
@@ -242,3 +242,86 @@ TEST_CASE("MString with arena interface", "[Arena][Allocator]") {
 
     arena_alloc->free_all();
 }
+
+TEST_CASE("arena telemetry", "[Arena]") {
+    Arena* arena = arena_make(
+        ArenaParams{.reserve_bytes = MB(16), .max_n_blocks = 1, .name = "telemetry", .decommit_threshold = 0});
+    ArenaStats s = arena_stats(arena);
+    REQUIRE(strcmp(s.name, "telemetry") == 0);
+    REQUIRE(s.n_pushes == 0);
+    REQUIRE(s.reserved == MB(16));
+
+    size_t mark = arena->pos;
+    arena_push_bytes(arena, MB(4), 1);
+    arena_push_bytes(arena, MB(1), 1);
+    arena_pop_to(arena, mark);
+    s = arena_stats(arena);
+    REQUIRE(s.n_pushes == 2);
+    REQUIRE(s.pos == mark);
+    REQUIRE(s.high_water == mark + MB(5));
+    REQUIRE(s.committed >= MB(5));
+
+    // popping keeps pages resident until decommitted, the high-water mark is kept
+    arena_decommit(arena, 0);
+    s = arena_stats(arena);
+    REQUIRE(s.committed < KB(64));
+    REQUIRE(s.high_water == mark + MB(5));
+
+    // pages read back as zero after a decommit
+    char* data = (char*) arena_push_bytes(arena, MB(1), 1);
+    REQUIRE(data[KB(512)] == 0);
+    arena_destroy(arena);
+}
+
+TEST_CASE("arena decommit threshold", "[Arena]") {
+    Arena* arena = arena_make(ArenaParams{
+        .reserve_bytes = MB(16), .max_n_blocks = 1, .name = "decommit", .decommit_threshold = MB(1)});
+    size_t mark = arena->pos;
+    memset(arena_push_bytes(arena, KB(512), 1), 1, KB(512));
+    arena_pop_to(arena, mark);
+    REQUIRE(arena_stats(arena).committed >= KB(512));
+
+    memset(arena_push_bytes(arena, MB(4), 1), 1, MB(4));
+    arena_clear(arena);
+    REQUIRE(arena_stats(arena).committed < KB(64));
+    arena_destroy(arena);
+}
+
+TEST_CASE("arena registry", "[Arena]") {
+    Arena* a = arena_make(
+        ArenaParams{.reserve_bytes = MB(8), .max_n_blocks = 1, .name = "registry a", .decommit_threshold = 0});
+    Arena* b = arena_make(
+        ArenaParams{.reserve_bytes = MB(8), .max_n_blocks = 1, .name = "registry b", .decommit_threshold = 0});
+    arena_push_bytes(b, MB(2), 1);
+
+    AArenaTmp tmp = begin_scratch();
+    Array<ArenaStats> stats = arena_registry_snapshot(tmp.arena);
+    const ArenaStats* sa = nullptr;
+    const ArenaStats* sb = nullptr;
+    bool has_scratch = false;
+    for(const ArenaStats& s : stats) {
+        if(s.arena == a) sa = &s;
+        if(s.arena == b) sb = &s;
+        has_scratch |= strcmp(s.name, "scratch") == 0;
+    }
+    REQUIRE(sa);
+    REQUIRE(sb);
+    REQUIRE(has_scratch);
+    REQUIRE(sb < sa); // sorted by committed bytes
+    for(u64 i = 1; i < stats.len; ++i) REQUIRE(stats[i - 1].committed >= stats[i].committed);
+
+    String8 line = format(tmp.arena, "{}", *sb);
+    REQUIRE(line.starts_with(S8_LIT("registry b: pos=")));
+
+    // memory ceiling for this process, e.g. to catch arenas that grow unexpectedly
+    REQUIRE(arena_registry_committed() >= MB(2));
+    REQUIRE(arena_registry_committed() < MB(64));
+
+    arena_destroy(a);
+    arena_destroy(b);
+    stats = arena_registry_snapshot(tmp.arena);
+    for(const ArenaStats& s : stats) {
+        REQUIRE(s.arena != a);
+        REQUIRE(s.arena != b);
+    }
+}
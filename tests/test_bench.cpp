@@ -0,0 +1,136 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <cxb/bench.h>
+#include <cxb/cxb.h>
+#include <cxb/rng.h>
+
+INTERNAL Array<f64> normal_samples(Arena* a, u64 seed, size_t n, f64 mean, f64 sd) {
+    Xoshiro256 rng = xoshiro256_make(seed);
+    Array<f64> xs = arena_push_array<f64>(a, n);
+    for(size_t i = 0; i < n; ++i) xs[i] = rng_normal(rng, mean, sd);
+    return xs;
+}
+
+INTERNAL BenchResult result_of(Arena* a, String8 name, Array<f64> samples) {
+    BenchResult r = {.name = name,
+                     .samples_ns = {},
+                     .n_iters = 1,
+                     .n_outliers = 0,
+                     .median_ns = 0,
+                     .mean_ns = 0,
+                     .stddev_ns = 0,
+                     .min_ns = 0,
+                     .max_ns = 0,
+                     .p50_ns = 0,
+                     .p99_ns = 0,
+                     .p999_ns = 0,
+                     .perf = {}};
+    bench_summarize(r, arena_push_array(a, samples));
+    return r;
+}
+
+TEST_CASE("summary and outliers", "[bench]") {
+    Arena* arena = arena_make_nbytes(MB(1));
+    f64 xs[] = {10, 11, 9, 10, 10, 12, 8, 10, 100, 0.5};
+    BenchResult r = result_of(arena, S8_LIT("x"), Array<f64>{xs, 10});
+    REQUIRE(r.n_outliers == 2);
+    REQUIRE(r.samples_ns.len == 8);
+    REQUIRE(r.min_ns == 8);
+    REQUIRE(r.max_ns == 12);
+    REQUIRE(r.median_ns == 10);
+    REQUIRE(r.mean_ns == 10);
+    for(size_t i = 1; i < r.samples_ns.len; ++i) REQUIRE(r.samples_ns[i - 1] <= r.samples_ns[i]);
+    arena_destroy(arena);
+}
+
+TEST_CASE("mann whitney", "[bench]") {
+    Arena* arena = arena_make_nbytes(MB(1));
+    Array<f64> x = normal_samples(arena, 1, 30, 100, 5);
+    Array<f64> same = normal_samples(arena, 2, 30, 100, 5);
+    Array<f64> shifted = normal_samples(arena, 3, 30, 110, 5);
+
+    REQUIRE(mann_whitney_p(x, x) > 0.9);
+    REQUIRE(mann_whitney_p(x, same) > 0.05);
+    REQUIRE(mann_whitney_p(x, shifted) < 1e-6);
+    REQUIRE(mann_whitney_p(x, shifted) == mann_whitney_p(shifted, x));
+
+    // all ties
+    f64 ones[] = {1, 1, 1, 1};
+    REQUIRE(mann_whitney_p(Array<f64>{ones, 4}, Array<f64>{ones, 4}) == 1);
+    REQUIRE(mann_whitney_p(x, Array<f64>{}) == 1);
+    arena_destroy(arena);
+}
+
+TEST_CASE("compare verdicts", "[bench]") {
+    Arena* arena = arena_make_nbytes(MB(1));
+    BenchResult base = result_of(arena, S8_LIT("x"), normal_samples(arena, 1, 30, 100, 2));
+    BenchResult same = result_of(arena, S8_LIT("x"), normal_samples(arena, 2, 30, 100, 2));
+    BenchResult slower = result_of(arena, S8_LIT("x"), normal_samples(arena, 3, 30, 120, 2));
+    BenchResult faster = result_of(arena, S8_LIT("x"), normal_samples(arena, 4, 30, 80, 2));
+    // significant, but below the threshold
+    BenchResult tiny = result_of(arena, S8_LIT("x"), normal_samples(arena, 5, 30, 101, 0.2));
+
+    REQUIRE(bench_compare(base, same, 0.05, 0.02).verdict == BENCH_UNCHANGED);
+
+    BenchComparison c = bench_compare(base, slower, 0.05, 0.02);
+    REQUIRE(c.verdict == BENCH_SLOWER);
+    REQUIRE(c.ratio > 1.15);
+    REQUIRE(c.ratio < 1.25);
+    REQUIRE(c.ratio_lo <= c.ratio);
+    REQUIRE(c.ratio <= c.ratio_hi);
+
+    REQUIRE(bench_compare(base, faster, 0.05, 0.02).verdict == BENCH_FASTER);
+    REQUIRE(bench_compare(base, tiny, 0.05, 0.02).verdict == BENCH_UNCHANGED);
+    arena_destroy(arena);
+}
+
+TEST_CASE("run and json round trip", "[bench]") {
+    Bencher b = {};
+    b.params.n_samples = 10;
+    b.params.warmup_ms = 1;
+    b.params.sample_ms = 0.1;
+    b.arena = arena_make_nbytes(MB(16));
+    b.case_name = "case";
+
+    u64 n_calls = 0;
+    bench_run(&b, "sum", [&] {
+        n_calls += 1;
+        u64 sum = 0;
+        for(u64 i = 0; i < 100; ++i) sum += i * i;
+        return sum;
+    });
+    b.params.filter = S8_LIT("other");
+    bench_run(&b, "filtered out", [&] { n_calls = 0; });
+
+    REQUIRE(b.results.len == 1);
+    REQUIRE(n_calls > 0);
+    const BenchResult& r = b.results[0];
+    REQUIRE(r.name == S8_LIT("case: sum"));
+    REQUIRE(r.n_iters >= 1);
+    REQUIRE(r.samples_ns.len + r.n_outliers == 10);
+    REQUIRE(r.min_ns > 0);
+    REQUIRE(r.min_ns <= r.median_ns);
+    REQUIRE(r.median_ns <= r.max_ns);
+    REQUIRE(r.p50_ns > 0);
+    REQUIRE(r.p50_ns <= r.p99_ns);
+    REQUIRE(r.p99_ns <= r.p999_ns);
+
+    BenchResult quoted = r;
+    quoted.name = S8_LIT("\"quoted\" \\ {}\t\n");
+    BenchResult results[] = {r, quoted};
+    String8 json = bench_results_json(b.arena, Array<BenchResult>{results, 2}, 3);
+    REQUIRE(string8_contains(json, S8_LIT("\"p999_ns\":")));
+    REQUIRE(string8_contains(json, S8_LIT("\\u0009\\u000a")));
+    Array<BenchResult> parsed = bench_results_parse(b.arena, json);
+    REQUIRE(parsed.len == 2);
+    REQUIRE(parsed[0].name == r.name);
+    REQUIRE(parsed[1].name == quoted.name);
+    REQUIRE(parsed[0].samples_ns.len == r.samples_ns.len);
+    for(size_t i = 0; i < r.samples_ns.len; ++i) {
+        // 3 decimals in the file
+        REQUIRE(parsed[0].samples_ns[i] > r.samples_ns[i] - 1e-3);
+        REQUIRE(parsed[0].samples_ns[i] < r.samples_ns[i] + 1e-3);
+    }
+    REQUIRE(bench_compare(r, parsed[0], 0.05, 0.02).verdict == BENCH_UNCHANGED);
+    arena_destroy(b.arena);
+}
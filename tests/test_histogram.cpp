@@ -0,0 +1,128 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <cxb/cxb.h>
+#include <cxb/histogram.h>
+#include <cxb/rng.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+TEST_CASE("buckets", "[Histogram]") {
+    for(u64 v = 0; v < 2 * HISTOGRAM_SUB_BUCKETS; ++v) {
+        REQUIRE(histogram_bucket(v) == v);
+        REQUIRE(histogram_bucket_low((u32) v) == v);
+        REQUIRE(histogram_bucket_high((u32) v) == v);
+    }
+
+    u64 values[] = {256, 257, 1000, 12345, 1ull << 40, (1ull << 40) + 12345678, UINT64_MAX};
+    for(u64 v : values) {
+        u32 b = histogram_bucket(v);
+        REQUIRE(b < HISTOGRAM_N_BUCKETS);
+        REQUIRE(histogram_bucket_low(b) <= v);
+        REQUIRE(histogram_bucket_high(b) >= v);
+        // relative error of the bucket width
+        REQUIRE((f64) (histogram_bucket_high(b) - histogram_bucket_low(b)) / (f64) v <= 1.0 / HISTOGRAM_SUB_BUCKETS);
+    }
+    REQUIRE(histogram_bucket(UINT64_MAX) == HISTOGRAM_N_BUCKETS - 1);
+
+    // buckets are contiguous
+    for(u32 b = 1; b < HISTOGRAM_N_BUCKETS; ++b) {
+        REQUIRE(histogram_bucket_low(b) == histogram_bucket_high(b - 1) + 1);
+    }
+}
+
+TEST_CASE("percentiles against sorting", "[Histogram]") {
+    Histogram* h = arena_push<Histogram>(get_perm());
+    std::vector<u64> xs;
+    Xoshiro256 rng = xoshiro256_make(42);
+    for(int i = 0; i < 100000; ++i) {
+        u64 x = (u64) rng_lognormal(rng, 8.0, 1.5);
+        xs.push_back(x);
+        histogram_record(h, x);
+    }
+    std::sort(xs.begin(), xs.end());
+
+    REQUIRE(h->total.load() == xs.size());
+    REQUIRE(h->min.load() == xs.front());
+    REQUIRE(h->max.load() == xs.back());
+    for(f64 q : {0.5, 0.9, 0.99, 0.999}) {
+        u64 expected = xs[(size_t) std::ceil(q * (f64) xs.size() - 1e-6) - 1];
+        u64 got = histogram_percentile(h, q);
+        REQUIRE(got >= expected);
+        REQUIRE((f64) (got - expected) <= (f64) expected / HISTOGRAM_SUB_BUCKETS + 1);
+    }
+    REQUIRE(histogram_percentile(h, 1.0) == xs.back());
+    REQUIRE(histogram_percentile(h, 0.0) == xs.front());
+
+    AArenaTmp tmp = begin_scratch();
+    String8 line = histogram_format(tmp.arena, h);
+    REQUIRE(line.starts_with(S8_LIT("n=100000 ")));
+    REQUIRE(line.find(S8_LIT(" p999=")) != SIZE_MAX);
+}
+
+TEST_CASE("percentiles of few values", "[Histogram]") {
+    Histogram* h = arena_push<Histogram>(get_perm());
+    for(u64 x : {1, 2, 3}) histogram_record(h, x);
+    REQUIRE(histogram_percentile(h, 0.0) == 1);
+    REQUIRE(histogram_percentile(h, 0.33) == 1);
+    REQUIRE(histogram_percentile(h, 0.34) == 2);
+    REQUIRE(histogram_percentile(h, 0.5) == 2);
+    REQUIRE(histogram_percentile(h, 2.0 / 3) == 2);
+    REQUIRE(histogram_percentile(h, 0.67) == 3);
+    REQUIRE(histogram_percentile(h, 1.0) == 3);
+}
+
+TEST_CASE("merge and sharded recording", "[Histogram]") {
+    ShardedHistogram* sh = arena_push<ShardedHistogram>(get_perm());
+    std::thread threads[8];
+    for(u64 t = 0; t < 8; ++t) {
+        threads[t] = std::thread([sh, t] {
+            for(u64 i = 0; i < 10000; ++i) sharded_histogram_record(sh, t * 10000 + i);
+        });
+    }
+    for(auto& t : threads) t.join();
+
+    Histogram* h = arena_push<Histogram>(get_perm());
+    sharded_histogram_merge(h, sh);
+    REQUIRE(h->total.load() == 80000);
+    REQUIRE(h->min.load() == 0);
+    REQUIRE(h->max.load() == 79999);
+    REQUIRE(histogram_mean(h) == 79999.0 / 2);
+    u64 p50 = histogram_percentile(h, 0.5);
+    REQUIRE(p50 >= 39999);
+    REQUIRE(p50 <= 39999 + 39999 / HISTOGRAM_SUB_BUCKETS);
+
+    Histogram* h2 = arena_push<Histogram>(get_perm());
+    histogram_merge(h2, h);
+    histogram_merge(h2, h);
+    REQUIRE(h2->total.load() == 160000);
+    REQUIRE(histogram_percentile(h2, 0.5) == p50);
+    sharded_histogram_destroy(sh);
+}
+
+TEST_CASE("serialization", "[Histogram]") {
+    Histogram* h = arena_push<Histogram>(get_perm());
+    for(u64 i = 0; i < 1000; ++i) histogram_record(h, i * i);
+
+    AArenaTmp tmp = begin_scratch();
+    String8 bytes = serialize(tmp.arena, *h);
+    // sparse: far smaller than the buckets
+    REQUIRE(bytes.len < 4096);
+
+    Histogram* out = arena_push<Histogram>(get_perm());
+    SerialReader r = {.src = bytes, .pos = 0, .failed = false, .alloc = nullptr};
+    deserialize_value(tmp.arena, r, *out);
+    REQUIRE(!r.failed);
+    REQUIRE(r.pos == bytes.len);
+    REQUIRE(out->total.load() == 1000);
+    REQUIRE(out->min.load() == 0);
+    REQUIRE(out->max.load() == 999 * 999);
+    for(u32 i = 0; i < HISTOGRAM_N_BUCKETS; ++i) REQUIRE(out->counts[i].load() == h->counts[i].load());
+
+    SerialReader truncated = {.src = bytes.slice(0, (i64) bytes.len / 2), .pos = 0, .failed = false, .alloc = nullptr};
+    deserialize_value(tmp.arena, truncated, *out);
+    REQUIRE(truncated.failed);
+    REQUIRE(out->total.load() == 0);
+}
@@ -82,3 +82,59 @@ TEST_CASE("AHashMap automatic cleanup", "[AHashMap]") {
     }
     REQUIRE(heap_alloc_data.n_active_bytes == allocated_before);
 }
+
+TEST_CASE("release keeps the tombstones", "[AHashMap]") {
+    AHashMap<int, int> hm;
+    for(int i = 0; i < 10; ++i) REQUIRE(hm.put({i, i}));
+    for(int i = 0; i < 5; ++i) REQUIRE(hm.erase(i));
+    size_t n_tombstones = hm.n_tombstones;
+    REQUIRE(n_tombstones > 0);
+
+    MHashMap<int, int> released = hm.release();
+    REQUIRE(hm.n_tombstones == 0);
+    REQUIRE(released.n_tombstones == n_tombstones);
+    // reuses the tombstones
+    for(int i = 0; i < 5; ++i) REQUIRE(released.put({i, i}));
+    REQUIRE(released.n_tombstones + released.len <= 10);
+    released.destroy();
+}
+
+TEST_CASE("insert/erase churn", "[MHashMap]") {
+    AHashMap<int, int> hm;
+    for(int i = 0; i < 1000; ++i) REQUIRE(hm.put({i, i}));
+    size_t capacity = hm.table.len;
+
+    // tombstones are reused or cleared by a rehash: the table never fills up and grows at most once
+    for(int k = 1000; k < 20000; ++k) {
+        REQUIRE(hm.erase(k - 1000));
+        REQUIRE(hm.put({k, k}));
+    }
+    REQUIRE(hm.len == 1000);
+    REQUIRE(hm.table.len <= 2 * capacity);
+    REQUIRE(!hm.needs_rehash());
+    for(int k = 0; k < 19000; ++k) REQUIRE(!hm.contains(k));
+    for(int k = 19000; k < 20000; ++k) REQUIRE(hm[k] == k);
+
+    int n = 0;
+    i64 sum = 0;
+    for(auto& entry : hm) {
+        n += 1;
+        sum += entry.kv.value;
+    }
+    REQUIRE(n == 1000);
+    REQUIRE(sum == (i64) 1000 * (19000 + 19999) / 2);
+}
+
+TEST_CASE("builtin hasher", "[AHashMap]") {
+    AHashMap<String8, i32, DefaultHasherBuiltin> names;
+    REQUIRE(names.put({S8_LIT("a"), 1}));
+    REQUIRE(names.put({S8_LIT("ab"), 2}));
+    REQUIRE(names.put({S8_LIT(""), 3}));
+    REQUIRE(names[S8_LIT("ab")] == 2);
+    REQUIRE(names[S8_LIT("")] == 3);
+    REQUIRE(!names.contains(S8_LIT("b")));
+
+    AHashMap<u64, u64, DefaultHasherBuiltin> ids;
+    for(u64 i = 0; i < 1000; ++i) REQUIRE(ids.put({i << 32, i}));
+    for(u64 i = 0; i < 1000; ++i) REQUIRE(ids[i << 32] == i);
+}
@@ -0,0 +1,200 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <cxb/cxb.h>
+
+#include "examples/interpreter.h"
+
+struct Outcomes {
+    Arena* arena;
+    String8 tree_walker; // the value formatted, or "error: <reason>"
+    String8 vm;
+};
+
+INTERNAL String8 outcome(Arena* arena, EvalResult result) {
+    if(result) return format(arena, "error: {}", result.reason);
+    // copied, strings may point into the module
+    return format(arena, "{}", value_format(arena, result.value));
+}
+
+INTERNAL Outcomes run(const char* src) {
+    Outcomes out = {};
+    out.arena = arena_make_nbytes(MB(64));
+    Module* mod = module_make(S8_LIT("test"), nullptr, nullptr);
+    ParseFileResult parsed = module_parse_string(mod, S8_CSTR(src));
+    REQUIRE(!parsed);
+    out.tree_walker = outcome(out.arena, eval(interpreter_make(out.arena), mod));
+    out.vm = outcome(out.arena, vm_run(vm_make(out.arena), bc_compile(out.arena, mod)));
+    module_destroy(mod);
+    return out;
+}
+
+// both evaluators give expected
+INTERNAL void check(const char* src, const char* expected) {
+    Outcomes out = run(src);
+    CHECK(out.tree_walker == S8_CSTR(expected));
+    CHECK(out.vm == S8_CSTR(expected));
+    arena_destroy(out.arena);
+}
+
+TEST_CASE("arithmetic", "[interpreter]") {
+    check("1 + 2 * 3 - 4 / 2", "5");
+    check("7 / 2", "3");
+    check("-7 / 2.0", "-3.5");
+    check("x := 2\nx *= 5\nx -= 1\nx", "9");
+    check("\"ab\" + \"cd\"", "abcd");
+    check("1 == 1.0", "true");
+    check("\"a\" - 1", "error: unsupported operands for -: str and int");
+}
+
+TEST_CASE("int overflow promotes to double", "[interpreter]") {
+    // ints are 48-bit
+    check("140737488355327", "140737488355327");
+    check("140737488355327 + 1", "140737488355328.0");
+    check("-140737488355328 - 1", "-140737488355329.0");
+    check("x := 70368744177664\nx * 4", "281474976710656.0");
+    check("func f(x: int) {\n    return x + 1\n}\nf(140737488355327)", "140737488355328.0");
+}
+
+TEST_CASE("division by zero", "[interpreter]") {
+    check("1 / 0", "error: division by zero");
+    check("func f(x: int) {\n    return 10 / x\n}\nf(0)", "error: division by zero");
+    check("x := 3\nx /= 0", "error: division by zero");
+}
+
+TEST_CASE("and/or short-circuit", "[interpreter]") {
+#define BOOM "func boom() {\n    return 1 / 0\n}\n"
+    check(BOOM "false and boom()", "false");
+    check(BOOM "0 and boom()", "0");
+    check(BOOM "1 or boom()", "1");
+    check(BOOM "true and boom()", "error: division by zero");
+    check(BOOM "nil or boom()", "error: division by zero");
+#undef BOOM
+    // an operand is the result
+    check("nil or 7", "7");
+    check("3 and \"x\"", "x");
+}
+
+TEST_CASE("break and continue", "[interpreter]") {
+    check(R"(func f(n: int) {
+    i := 0
+    s := 0
+    while true {
+        i += 1
+        if i > n {
+            break
+        }
+        if i == 2 {
+            continue
+        }
+        s += i
+    }
+    return s
+}
+f(5))",
+          "13");
+    check(R"(i := 0
+n := 0
+while i < 3 {
+    i += 1
+    j := 0
+    while true {
+        j += 1
+        if j > i {
+            break
+        }
+        n += 1
+    }
+}
+n)",
+          "6");
+    check("break\n", "error: break or continue outside of a loop");
+}
+
+TEST_CASE("errors", "[interpreter]") {
+    check("func f(x: int) {\n    return x\n}\nf(1, 2)", "error: f expects 1 arguments, got 2");
+    check("func f(x: int) {\n    return x\n}\nf()", "error: f expects 1 arguments, got 0");
+    check("g(1)", "error: undefined function: g");
+    check("x + 1", "error: undefined variable: x");
+    check("x = 1", "error: undefined variable: x");
+    check("func f() {\n    return y\n}\nf()", "error: undefined variable: y");
+}
+
+TEST_CASE("stack overflow", "[interpreter]") {
+    check("func r(n: int) {\n    return r(n + 1)\n}\nr(0)", "error: stack overflow");
+    // not an overflow
+    check("func d(n: int) {\n    if n == 0 {\n        return 0\n    }\n    return d(n - 1) + 1\n}\nd(500)", "500");
+}
+
+TEST_CASE("scoping", "[interpreter]") {
+    // a local declared in a branch that did not run
+    check(R"(func f(x: int) {
+    if x > 0 {
+        v := x
+    }
+    return v
+}
+f(0))",
+          "error: undefined variable: v");
+    check(R"(func f(x: int) {
+    if x > 0 {
+        v := x
+    }
+    return v
+}
+f(3))",
+          "3");
+    // a name declared in a function is local in all of it, the global is not read before the declaration
+    check(R"(y := 100
+func g() {
+    i := 0
+    r := 0
+    while i < 2 {
+        r = y
+        y := 5
+        i += 1
+    }
+    return r
+}
+g())",
+          "error: undefined variable: y");
+    check("func n() {\n    v = 3\n    v := 1\n    return v\n}\nn()", "error: undefined variable: v");
+    check(R"(func k(c: int) {
+    if c > 0 {
+        v := 1
+    } else {
+        return v
+    }
+    return v
+}
+k(0))",
+          "error: undefined variable: v");
+    // locals keep their value across iterations
+    check(R"(func m() {
+    i := 0
+    t := 0
+    while i < 3 {
+        if i > 0 {
+            t += w
+        }
+        w := i
+        i += 1
+    }
+    return t
+}
+m())",
+          "1");
+    // assignments without a local write the global
+    check("x := 1\nfunc f() {\n    x = 5\n}\nf()\nx", "5");
+    check("x := 1\nfunc f() {\n    x := 5\n    return x\n}\nf() + x", "6");
+    // each call has its own locals
+    check(R"(func f(n: int) {
+    if n > 0 {
+        v := n
+        f(n - 1)
+        return v
+    }
+    return 0
+}
+f(3))",
+          "3");
+}
@@ -0,0 +1,751 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <cxb/cxb.h>
+#include <cxb/io.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST_CASE("create, grow and reopen", "[MemFile]") {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_memfile.bin");
+    unlink(path.data);
+
+    auto created =
+        memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = 16, .reserve_bytes = MB(1)});
+    REQUIRE(!created);
+    MemFile& f = created.value;
+    REQUIRE(f.data.len == 16);
+    REQUIRE(f.reserved == MB(1));
+    memcpy(f.data.data, "0123456789abcdef", 16);
+
+    char* before = f.data.data;
+    auto grown = memfile_resize(f, KB(64));
+    REQUIRE(!grown);
+    REQUIRE(grown.value == KB(64));
+    REQUIRE(f.data.data == before); // within the reservation
+    f.data[KB(64) - 1] = 'z';
+
+    auto past_reserve = memfile_resize(f, MB(2));
+    REQUIRE(!past_reserve);
+    REQUIRE(f.data.len == MB(2));
+    REQUIRE(f.reserved >= MB(2));
+    REQUIRE(f.data[KB(64) - 1] == 'z');
+
+    REQUIRE(!memfile_sync(f));
+    REQUIRE(!memfile_resize(f, KB(64)));
+    memfile_close(f);
+    REQUIRE(f.fd == -1);
+
+    auto opened = memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_READ,
+                                                          .advice = MEMFILE_ADVICE_SEQUENTIAL,
+                                                          .populate = true});
+    REQUIRE(!opened);
+    MemFile& r = opened.value;
+    REQUIRE(r.filepath == path);
+    REQUIRE(r.data.len == KB(64));
+    REQUIRE(memcmp(r.data.data, "0123456789abcdef", 16) == 0);
+    REQUIRE(r.data[KB(64) - 1] == 'z');
+
+    auto resized = memfile_resize(r, KB(4));
+    REQUIRE(resized);
+    REQUIRE(resized.error == FileErr::ReadOnly);
+
+    memfile_close(r);
+    unlink(path.data);
+}
+
+TEST_CASE("a failed grow keeps the file size", "[MemFile]") {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_memfile_grow.bin");
+    unlink(path.data);
+    auto created =
+        memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = 16, .reserve_bytes = MB(1)});
+    REQUIRE(!created);
+    MemFile& f = created.value;
+
+    // the mapping cannot grow once the address space is capped, in a child such that the cap does not stay
+    pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if(pid == 0) {
+        FILE* statm = fopen("/proc/self/statm", "r");
+        unsigned long n_pages = 0;
+        if(!statm || fscanf(statm, "%lu", &n_pages) != 1) _exit(2);
+        rlimit limit;
+        if(getrlimit(RLIMIT_AS, &limit) != 0) _exit(2);
+        limit.rlim_cur = n_pages * os_page_size() + MB(64);
+        if(setrlimit(RLIMIT_AS, &limit) != 0) _exit(2);
+        auto grown = memfile_resize(f, GB(4));
+        struct stat st;
+        if(fstat(f.fd, &st) != 0) _exit(2);
+        _exit(grown.error == FileErr::CouldNotMap && st.st_size == 16 && f.data.len == 16 ? 0 : 1);
+    }
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+
+    memfile_close(f);
+    unlink(path.data);
+}
+
+TEST_CASE("hints, prefetch and evict", "[MemFile]") {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_memfile_hints.bin");
+    unlink(path.data);
+
+    auto created = memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = MB(1)});
+    REQUIRE(!created);
+    MemFile& f = created.value;
+    memset(f.data.data, 'x', f.data.len);
+
+    auto prefetched = memfile_prefetch(f, 1, KB(8));
+    REQUIRE(!prefetched);
+    REQUIRE(prefetched.value == KB(12)); // rounded out to pages
+
+    REQUIRE(!memfile_advise(f, MEMFILE_ADVICE_RANDOM));
+    REQUIRE(!memfile_advise(f, MEMFILE_ADVICE_NORMAL, KB(4), KB(4)));
+
+    auto evicted = memfile_evict(f, 0, f.data.len);
+    REQUIRE(!evicted);
+    REQUIRE(evicted.value == MB(1));
+    REQUIRE(f.data[0] == 'x'); // shared mapping, data is kept in the page cache
+    REQUIRE(f.data[MB(1) - 1] == 'x');
+
+    auto out_of_range = memfile_prefetch(f, MB(2), 1);
+    REQUIRE(out_of_range);
+    REQUIRE(out_of_range.error == FileErr::OutOfRange);
+
+    memfile_close(f);
+    unlink(path.data);
+}
+
+TEST_CASE("open errors", "[MemFile]") {
+    Arena* arena = get_perm();
+
+    auto missing = memfile_open(arena, S8_LIT("this/file/does/not/exist"));
+    REQUIRE(missing);
+    REQUIRE(missing.error == FileErr::CouldNotOpen);
+    REQUIRE(missing.value.fd == -1);
+
+    auto dir = memfile_open(arena, S8_LIT("."));
+    REQUIRE(dir);
+    REQUIRE(dir.error == FileErr::IsNotFile);
+
+    auto empty = memfile_open(arena, S8_LIT("test_io_empty.bin"), MemFileParams{.mode = MEMFILE_MODE_CREATE});
+    REQUIRE(!empty);
+    REQUIRE(empty.value.data.len == 0);
+    REQUIRE(!memfile_prefetch(empty.value, 0, 10));
+    memfile_close(empty.value);
+    unlink("test_io_empty.bin");
+}
+
+INTERNAL void _aio_roundtrip(bool force_fallback) {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_aio.bin");
+    unlink(path.data);
+
+    auto made = aio_make(arena, AioParams{.queue_depth = 8, .n_threads = 2, .force_fallback = force_fallback});
+    REQUIRE(!made);
+    AsyncIo* aio = made.value;
+    if(force_fallback) {
+        REQUIRE(aio_backend(aio) == AIO_BACKEND_THREADS);
+    }
+    REQUIRE(aio_queue_depth(aio) >= 8);
+
+    auto created = memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = KB(64)});
+    REQUIRE(!created);
+    MemFile& f = created.value;
+
+    const size_t n_chunks = 16;
+    const size_t chunk = KB(4);
+    Array<char> src = aio_push_buffer(arena, n_chunks * chunk);
+    for(size_t i = 0; i < src.len; ++i) {
+        src[i] = (char) (i * 31 + 7);
+    }
+
+    // writes, more ops than the queue can hold at once
+    AioOp ops[n_chunks];
+    for(size_t i = 0; i < n_chunks; ++i) {
+        ops[i] = aio_op_write(f.fd, i * chunk, Array<char>{src.data + i * chunk, chunk}, i);
+    }
+    AioCompletion completions[n_chunks];
+    size_t submitted = 0;
+    size_t completed = 0;
+    u64 seen = 0;
+    while(completed < n_chunks) {
+        if(submitted < n_chunks) {
+            auto res = aio_submit(aio, Array<AioOp>{ops + submitted, n_chunks - submitted});
+            if(!res) submitted += res.value;
+            else REQUIRE(res.error == FileErr::QueueFull);
+        }
+        auto polled = aio_poll(aio, Array<AioCompletion>{completions, n_chunks}, 1);
+        REQUIRE(!polled);
+        u32 got = polled.value;
+        for(u32 i = 0; i < got; ++i) {
+            REQUIRE(completions[i].result == (i64) chunk);
+            seen |= 1ull << completions[i].user_data;
+        }
+        completed += got;
+    }
+    REQUIRE(seen == (1ull << n_chunks) - 1);
+    REQUIRE(aio_pending(aio) == 0);
+    REQUIRE(memcmp(f.data.data, src.data, src.len) == 0);
+
+    // reads via registered files and buffers
+    Array<char> dst = aio_push_buffer(arena, n_chunks * chunk);
+    int fds[] = {f.fd};
+    auto reg_files = aio_register_files(aio, Array<int>{fds, 1});
+    REQUIRE(!reg_files);
+    REQUIRE(reg_files.value == 1);
+    Array<char> bufs[] = {dst};
+    REQUIRE(!aio_register_buffers(aio, Array<Array<char>>{bufs, 1}));
+
+    for(size_t i = 0; i < 4; ++i) {
+        ops[i] = aio_op_read(0, i * chunk, Array<char>{dst.data + i * chunk, chunk}, i);
+        ops[i].fixed_file = true;
+        ops[i].buf_index = 0;
+    }
+    auto res = aio_submit(aio, Array<AioOp>{ops, 4});
+    REQUIRE(!res);
+    REQUIRE(res.value == 4);
+    completed = 0;
+    while(completed < 4) {
+        completed += aio_poll(aio, Array<AioCompletion>{completions, n_chunks}, 4 - (u32) completed).value;
+    }
+    REQUIRE(memcmp(dst.data, src.data, 4 * chunk) == 0);
+
+    // errors are reported per op
+    ops[0] = aio_op_read(-1, 0, Array<char>{dst.data, chunk}, 42);
+    REQUIRE(!aio_submit(aio, Array<AioOp>{ops, 1}));
+    REQUIRE(aio_poll(aio, Array<AioCompletion>{completions, 1}, 1).value == 1);
+    REQUIRE(completions[0].user_data == 42);
+    REQUIRE(completions[0].result == -EBADF);
+
+    aio_destroy(aio);
+    memfile_close(f);
+    unlink(path.data);
+}
+
+TEST_CASE("read and write", "[AsyncIo]") {
+    SECTION("default backend") {
+        _aio_roundtrip(false);
+    }
+    SECTION("thread pool fallback") {
+        _aio_roundtrip(true);
+    }
+}
+
+TEST_CASE("notify fd", "[AsyncIo]") {
+    Arena* arena = get_perm();
+    auto made = aio_make(arena, AioParams{.queue_depth = 4, .notify_fd = true});
+    REQUIRE(!made);
+    AsyncIo* aio = made.value;
+    int nfd = aio_notify_fd(aio);
+    REQUIRE(nfd >= 0);
+
+    char buf[16];
+    AioOp op = aio_op_read(STDIN_FILENO, 0, Array<char>{buf, 0}, 1);
+    REQUIRE(!aio_submit(aio, Array<AioOp>{&op, 1}));
+    AioCompletion c;
+    REQUIRE(aio_poll(aio, Array<AioCompletion>{&c, 1}, 1).value == 1);
+
+    u64 count = 0;
+    REQUIRE(read(nfd, &count, sizeof(count)) == sizeof(count));
+    REQUIRE(count >= 1);
+
+    aio_destroy(aio);
+}
+
+TEST_CASE("failed submit", "[AsyncIo]") {
+    Arena* arena = get_perm();
+    // the ring is the lowest free fd when it is made
+    int ring_fd = dup(STDIN_FILENO);
+    REQUIRE(ring_fd >= 0);
+    close(ring_fd);
+    auto made = aio_make(arena, AioParams{.queue_depth = 4});
+    REQUIRE(!made);
+    AsyncIo* aio = made.value;
+    if(aio_backend(aio) != AIO_BACKEND_IO_URING) {
+        // the thread pool has no submission that can fail
+        aio_destroy(aio);
+        return;
+    }
+
+    // io_uring_enter fails on anything but a ring
+    int saved = dup(ring_fd);
+    int not_a_ring = open("/dev/null", O_RDONLY);
+    REQUIRE(dup2(not_a_ring, ring_fd) == ring_fd);
+
+    char buf[16];
+    AioOp op = aio_op_read(STDIN_FILENO, 0, Array<char>{buf, 0}, 7);
+    auto failed = aio_submit(aio, Array<AioOp>{&op, 1});
+    REQUIRE(failed);
+    REQUIRE(failed.error == FileErr::CouldNotSubmit);
+    REQUIRE(aio_pending(aio) == 0);
+
+    REQUIRE(dup2(saved, ring_fd) == ring_fd);
+    close(saved);
+    close(not_a_ring);
+
+    // the retry is the only submission
+    REQUIRE(!aio_submit(aio, Array<AioOp>{&op, 1}));
+    AioCompletion completions[2];
+    REQUIRE(aio_poll(aio, Array<AioCompletion>{completions, 2}, 1).value == 1);
+    REQUIRE(completions[0].user_data == 7);
+    REQUIRE(aio_poll(aio, Array<AioCompletion>{completions, 2}, 0).value == 0);
+    REQUIRE(aio_pending(aio) == 0);
+
+    aio_destroy(aio);
+}
+
+TEST_CASE("failed poll", "[AsyncIo]") {
+    Arena* arena = get_perm();
+    int ring_fd = dup(STDIN_FILENO);
+    REQUIRE(ring_fd >= 0);
+    close(ring_fd);
+    auto made = aio_make(arena, AioParams{.queue_depth = 4});
+    REQUIRE(!made);
+    AsyncIo* aio = made.value;
+    if(aio_backend(aio) != AIO_BACKEND_IO_URING) {
+        aio_destroy(aio);
+        return;
+    }
+
+    // a read of an empty pipe stays in flight
+    int pipe_fds[2];
+    REQUIRE(pipe(pipe_fds) == 0);
+    char buf[16];
+    AioOp op = aio_op_read(pipe_fds[0], 0, Array<char>{buf, sizeof(buf)}, 3);
+    REQUIRE(!aio_submit(aio, Array<AioOp>{&op, 1}));
+
+    int saved = dup(ring_fd);
+    int not_a_ring = open("/dev/null", O_RDONLY);
+    REQUIRE(dup2(not_a_ring, ring_fd) == ring_fd);
+    AioCompletion c;
+    auto failed = aio_poll(aio, Array<AioCompletion>{&c, 1}, 1);
+    REQUIRE(failed);
+    REQUIRE(failed.error == FileErr::CouldNotPoll);
+    REQUIRE(failed.value == 0);
+    REQUIRE(aio_pending(aio) == 1);
+
+    REQUIRE(dup2(saved, ring_fd) == ring_fd);
+    close(saved);
+    close(not_a_ring);
+    REQUIRE(write(pipe_fds[1], "x", 1) == 1);
+    auto polled = aio_poll(aio, Array<AioCompletion>{&c, 1}, 1);
+    REQUIRE(!polled);
+    REQUIRE(polled.value == 1);
+    REQUIRE(c.user_data == 3);
+    REQUIRE(c.result == 1);
+
+    aio_destroy(aio);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+INTERNAL void _filereader_lines(bool force_fallback) {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_reader.txt");
+    unlink(path.data);
+
+    // lines of varying length, such that they straddle chunk boundaries
+    auto created = memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = KB(16)});
+    REQUIRE(!created);
+    MemFile& f = created.value;
+    size_t n_lines = 0;
+    size_t pos = 0;
+    while(pos < f.data.len) {
+        size_t line_len = min((size_t) (n_lines * 7) % 50, f.data.len - pos - 1);
+        memset(f.data.data + pos, 'a' + (char) (n_lines % 26), line_len);
+        pos += line_len;
+        f.data[pos++] = '\n';
+        n_lines += 1;
+    }
+
+    FileReaderParams params = {.chunk_size = 100, .max_carry = 64};
+    params.aio.force_fallback = force_fallback;
+    auto opened = filereader_open(arena, path, params);
+    REQUIRE(!opened);
+    FileReader& r = opened.value;
+
+    size_t n_read_lines = 0;
+    size_t n_read_bytes = 0;
+    size_t consumed = 0;
+    for(;;) {
+        auto next = filereader_next(r, consumed);
+        REQUIRE(!next);
+        if(!next.value) break;
+
+        String8 lines = filereader_lines(r);
+        REQUIRE(memcmp(lines.data, f.data.data + r.offset, lines.len) == 0);
+        for(size_t i = 0; i < lines.len; ++i) {
+            n_read_lines += lines.data[i] == '\n';
+        }
+        n_read_bytes += lines.len;
+        consumed = lines.len;
+    }
+    REQUIRE(r.eof);
+    REQUIRE(r.window.len == 0);
+    REQUIRE(n_read_bytes == f.data.len);
+    REQUIRE(n_read_lines == n_lines);
+
+    filereader_close(r);
+    memfile_close(f);
+    unlink(path.data);
+}
+
+TEST_CASE("lines straddling chunks", "[FileReader]") {
+    SECTION("default backend") {
+        _filereader_lines(false);
+    }
+    SECTION("thread pool fallback") {
+        _filereader_lines(true);
+    }
+}
+
+TEST_CASE("carry limit and errors", "[FileReader]") {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_reader_long.txt");
+    unlink(path.data);
+
+    auto created = memfile_open(arena, path, MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = 1000});
+    REQUIRE(!created);
+    memset(created.value.data.data, 'x', 1000);
+    memfile_close(created.value);
+
+    auto opened = filereader_open(arena, path, FileReaderParams{.chunk_size = 100, .max_carry = 150});
+    REQUIRE(!opened);
+    FileReader& r = opened.value;
+    REQUIRE(!filereader_next(r, 0));
+    REQUIRE(filereader_lines(r).len == 0); // no newline in the window
+    REQUIRE(!filereader_next(r, 0));
+    REQUIRE(r.window.len == 200);
+
+    auto overflow = filereader_next(r, 0);
+    REQUIRE(overflow);
+    REQUIRE(overflow.error == FileErr::OutOfRange);
+    filereader_close(r);
+    REQUIRE(r.fd == -1);
+
+    auto missing = filereader_open(arena, S8_LIT("this/file/does/not/exist"));
+    REQUIRE(missing);
+    REQUIRE(missing.error == FileErr::CouldNotOpen);
+
+    auto empty = memfile_open(arena, S8_LIT("test_io_reader_empty.txt"), MemFileParams{.mode = MEMFILE_MODE_CREATE});
+    REQUIRE(!empty);
+    memfile_close(empty.value);
+    auto empty_reader = filereader_open(arena, S8_LIT("test_io_reader_empty.txt"), FileReaderParams{.chunk_size = 64});
+    REQUIRE(!empty_reader);
+    REQUIRE(empty_reader.value.eof);
+    auto next = filereader_next(empty_reader.value, 0);
+    REQUIRE(!next);
+    REQUIRE(!next.value);
+    filereader_close(empty_reader.value);
+
+    unlink("test_io_reader_empty.txt");
+    unlink(path.data);
+}
+
+struct Sample {
+    u64 t;
+    f32 x;
+    f32 y;
+};
+
+TEST_CASE("push, grow and reopen", "[FileArray]") {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_filearray.bin");
+    unlink(path.data);
+
+    auto opened = filearray_open<Sample>(arena, path, FileArrayParams{.reserve_bytes = MB(64)});
+    REQUIRE(!opened);
+    FileArray<Sample>& xs = opened.value;
+    REQUIRE(xs.len == 0);
+    REQUIRE(xs.header()->elem_size == sizeof(Sample));
+
+    Sample* before = xs.data;
+    const size_t N = 100000;
+    bool pushed = true;
+    for(size_t i = 0; i < N; ++i) {
+        pushed &= !filearray_push(xs, Sample{.t = i, .x = (f32) i, .y = -(f32) i});
+    }
+    REQUIRE(pushed);
+    REQUIRE(xs.len == N);
+    REQUIRE(xs.capacity >= N);
+    REQUIRE(xs.data == before); // within the reservation
+    REQUIRE(xs.header()->len == N);
+    REQUIRE(!filearray_sync(xs));
+
+    Sample more[] = {{.t = N, .x = 1, .y = 2}, {.t = N + 1, .x = 3, .y = 4}};
+    REQUIRE(!filearray_extend(xs, Array<Sample>{more, 2}));
+    REQUIRE(xs.back().t == N + 1);
+
+    Array<Sample> view = xs;
+    REQUIRE(view.len == N + 2);
+    REQUIRE(view[N / 2].t == N / 2);
+
+    REQUIRE(!filearray_close(xs));
+    REQUIRE(xs.file.fd == -1);
+
+    struct stat st;
+    REQUIRE(stat(path.data, &st) == 0);
+    REQUIRE((size_t) st.st_size == sizeof(FileArrayHeader) + (N + 2) * sizeof(Sample));
+
+    auto reopened = filearray_open<Sample>(arena, path);
+    REQUIRE(!reopened);
+    FileArray<Sample>& ys = reopened.value;
+    REQUIRE(ys.len == N + 2);
+    u64 sum = 0;
+    for(const Sample& s : ys) {
+        sum += s.t;
+    }
+    REQUIRE(sum == (N + 2) * (N + 1) / 2);
+    REQUIRE(!filearray_resize(ys, 10));
+    REQUIRE(!filearray_resize(ys, 20));
+    REQUIRE(ys[15].t == 0);
+    REQUIRE(!filearray_close(ys));
+
+    auto wrong_type = filearray_open<u8>(arena, path);
+    REQUIRE(wrong_type);
+    REQUIRE(wrong_type.error == FileErr::BadHeader);
+    REQUIRE(wrong_type.value.file.fd == -1);
+
+    unlink(path.data);
+}
+
+TEST_CASE("invalid files are left unchanged", "[FileArray]") {
+    Arena* arena = get_perm();
+    String8 path = S8_LIT("test_io_filearray_bad.bin");
+    struct stat st;
+
+    SECTION("shorter than a header") {
+        int fd = open(path.data, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        REQUIRE(write(fd, "abc", 3) == 3);
+        close(fd);
+        auto opened = filearray_open<u64>(arena, path);
+        REQUIRE(opened);
+        REQUIRE(opened.error == FileErr::BadHeader);
+        REQUIRE(stat(path.data, &st) == 0);
+        REQUIRE(st.st_size == 3);
+    }
+
+    SECTION("starts with zeros") {
+        char zeros[128] = {};
+        int fd = open(path.data, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        REQUIRE(write(fd, zeros, sizeof(zeros)) == (ssize_t) sizeof(zeros));
+        close(fd);
+        auto opened = filearray_open<u64>(arena, path);
+        REQUIRE(opened);
+        REQUIRE(opened.error == FileErr::BadHeader);
+
+        char back[128];
+        fd = open(path.data, O_RDONLY);
+        REQUIRE(read(fd, back, sizeof(back)) == (ssize_t) sizeof(back));
+        close(fd);
+        REQUIRE(memcmp(back, zeros, sizeof(zeros)) == 0);
+    }
+
+    SECTION("length overflows") {
+        unlink(path.data);
+        auto created = filearray_open<u64>(arena, path);
+        REQUIRE(!created);
+        REQUIRE(!filearray_push(created.value, (u64) 1));
+        // len * 8 wraps to 8
+        created.value.header()->len = (1ull << 61) + 1;
+        memfile_close(created.value.file);
+
+        auto opened = filearray_open<u64>(arena, path);
+        REQUIRE(opened);
+        REQUIRE(opened.error == FileErr::BadHeader);
+    }
+
+    unlink(path.data);
+}
+
+INTERNAL void _write_file(const char* path, size_t n) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    REQUIRE(ftruncate(fd, (off_t) n) == 0);
+    close(fd);
+}
+
+INTERNAL bool _skip_named_skip(const DirEntry& e, void* user_data) {
+    (void) user_data;
+    return !e.path.ends_with(S8_LIT("/skip"));
+}
+
+TEST_CASE("walk a tree", "[dirwalk]") {
+    Arena* arena = get_perm();
+    REQUIRE(system("rm -rf test_io_tree") == 0);
+
+    // 8 dirs of 3 subdirs of 10 files of 100 bytes, plus a directory to filter out
+    size_t n_dirs = 0;
+    size_t n_files = 0;
+    char path[256];
+    mkdir("test_io_tree", 0755);
+    for(int i = 0; i < 8; ++i) {
+        snprintf(path, sizeof(path), "test_io_tree/d%d", i);
+        REQUIRE(mkdir(path, 0755) == 0);
+        n_dirs += 1;
+        for(int j = 0; j < 3; ++j) {
+            snprintf(path, sizeof(path), "test_io_tree/d%d/s%d", i, j);
+            REQUIRE(mkdir(path, 0755) == 0);
+            n_dirs += 1;
+            for(int k = 0; k < 10; ++k) {
+                snprintf(path, sizeof(path), "test_io_tree/d%d/s%d/f%d.txt", i, j, k);
+                _write_file(path, 100);
+                n_files += 1;
+            }
+        }
+    }
+    REQUIRE(mkdir("test_io_tree/skip", 0755) == 0);
+    _write_file("test_io_tree/skip/hidden.txt", 1);
+
+    SECTION("all entries, with stat") {
+        auto walked = dirwalk(arena, S8_LIT("test_io_tree/"), DirWalkParams{.n_threads = 4, .stat = true});
+        REQUIRE(!walked);
+        DirWalkResult& res = walked.value;
+        REQUIRE(res.n_errors == 0);
+        REQUIRE(res.arenas.len == 4);
+
+        size_t got_dirs = 0;
+        size_t got_files = 0;
+        u64 total_size = 0;
+        for(const DirEntry& e : res.entries) {
+            REQUIRE(e.path.starts_with(S8_LIT("test_io_tree/")));
+            REQUIRE(e.path.data[e.path.len] == '\0');
+            got_dirs += e.kind == DIRENT_DIR;
+            got_files += e.kind == DIRENT_FILE;
+            if(e.kind == DIRENT_FILE) {
+                total_size += e.size;
+                REQUIRE(e.depth == (e.path.starts_with(S8_LIT("test_io_tree/skip")) ? 1u : 2u));
+            }
+        }
+        REQUIRE(got_dirs == n_dirs + 1);
+        REQUIRE(got_files == n_files + 1);
+        REQUIRE(total_size == n_files * 100 + 1);
+        dirwalk_destroy(res);
+    }
+
+    SECTION("filter and max depth") {
+        auto walked = dirwalk(arena,
+                              S8_LIT("test_io_tree"),
+                              DirWalkParams{.n_threads = 2, .max_depth = 0, .filter = _skip_named_skip});
+        REQUIRE(!walked);
+        DirWalkResult& res = walked.value;
+        REQUIRE(res.entries.len == 8); // d0..d7, not descended into
+        for(const DirEntry& e : res.entries) {
+            REQUIRE(e.kind == DIRENT_DIR);
+            REQUIRE(e.depth == 0);
+        }
+        dirwalk_destroy(res);
+    }
+
+    SECTION("empty directory") {
+        REQUIRE(mkdir("test_io_tree/empty", 0755) == 0);
+        auto empty = dirwalk(arena, S8_LIT("test_io_tree/empty"));
+        REQUIRE(!empty);
+        REQUIRE(empty.value.entries.len == 0);
+        dirwalk_destroy(empty.value);
+    }
+
+    SECTION("errors") {
+        auto missing = dirwalk(arena, S8_LIT("test_io_tree/does_not_exist"));
+        REQUIRE(missing);
+        REQUIRE(missing.error == FileErr::CouldNotOpen);
+
+        auto file = dirwalk(arena, S8_LIT("test_io_tree/skip/hidden.txt"));
+        REQUIRE(file);
+        REQUIRE(file.error == FileErr::CouldNotReadDir);
+    }
+
+    REQUIRE(system("rm -rf test_io_tree") == 0);
+}
+
+INTERNAL bool _files_equal(const char* a, const char* b, size_t offset_in_b = 0) {
+    Arena* arena = get_perm();
+    auto fa = memfile_open(arena, S8_CSTR(a));
+    auto fb = memfile_open(arena, S8_CSTR(b));
+    bool equal = !fa && !fb && fa.value.data.len + offset_in_b <= fb.value.data.len &&
+                 memcmp(fa.value.data.data, fb.value.data.data + offset_in_b, fa.value.data.len) == 0;
+    if(!fa) memfile_close(fa.value);
+    if(!fb) memfile_close(fb.value);
+    return equal;
+}
+
+TEST_CASE("copy and concat", "[FileCopy]") {
+    Arena* arena = get_perm();
+    const size_t SIZE = MB(1) + 123; // not block aligned
+    auto created =
+        memfile_open(arena, S8_LIT("test_io_copy_src.bin"), MemFileParams{.mode = MEMFILE_MODE_CREATE, .size = SIZE});
+    REQUIRE(!created);
+    for(size_t i = 0; i < SIZE; ++i) created.value.data[i] = (char) (i * 13 + i / 4096);
+    memfile_close(created.value);
+
+    for(int m = FILE_COPY_AUTO; m < FILE_COPY_CNT; ++m) {
+        CAPTURE(m);
+        unlink("test_io_copy_dst.bin");
+        auto copied = file_copy(S8_LIT("test_io_copy_dst.bin"),
+                                S8_LIT("test_io_copy_src.bin"),
+                                FileCopyParams{.method = (FileCopyMethod) m, .buffer_bytes = KB(64)});
+        if(m == FILE_COPY_CLONE && copied) {
+            // reflinks are only supported by some filesystems
+            REQUIRE(copied.error == FileErr::CouldNotCopy);
+            continue;
+        }
+        REQUIRE(!copied);
+        REQUIRE(copied.value.n_bytes == SIZE);
+        if(m != FILE_COPY_AUTO) REQUIRE(copied.value.method == m);
+        REQUIRE(_files_equal("test_io_copy_src.bin", "test_io_copy_dst.bin"));
+    }
+
+    String8 srcs[] = {S8_LIT("test_io_copy_src.bin"), S8_LIT("test_io_copy_dst.bin"), S8_LIT("test_io_copy_src.bin")};
+    auto concat = file_concat(S8_LIT("test_io_copy_cat.bin"), Array<String8>{srcs, 3});
+    REQUIRE(!concat);
+    REQUIRE(concat.value.n_bytes == 3 * SIZE);
+    REQUIRE(_files_equal("test_io_copy_src.bin", "test_io_copy_cat.bin", 0));
+    REQUIRE(_files_equal("test_io_copy_src.bin", "test_io_copy_cat.bin", SIZE));
+    REQUIRE(_files_equal("test_io_copy_src.bin", "test_io_copy_cat.bin", 2 * SIZE));
+
+    auto missing = file_copy(S8_LIT("test_io_copy_dst.bin"), S8_LIT("this/file/does/not/exist"));
+    REQUIRE(missing);
+    REQUIRE(missing.error == FileErr::CouldNotOpen);
+
+    // the destination is left untouched, the copy is not reported as done
+    String8 self[] = {S8_LIT("test_io_copy_src.bin"), S8_LIT("test_io_copy_cat.bin")};
+    auto into_src = file_concat(S8_LIT("test_io_copy_cat.bin"), Array<String8>{self, 2});
+    REQUIRE(into_src);
+    REQUIRE(into_src.error == FileErr::CouldNotCopy);
+    REQUIRE(_files_equal("test_io_copy_src.bin", "test_io_copy_cat.bin", SIZE));
+
+    // the bytes of dst written before the failure are reported
+    String8 partial[] = {S8_LIT("test_io_copy_src.bin"), S8_LIT("this/file/does/not/exist")};
+    auto partial_concat = file_concat(S8_LIT("test_io_copy_cat.bin"), Array<String8>{partial, 2});
+    REQUIRE(partial_concat);
+    REQUIRE(partial_concat.error == FileErr::CouldNotOpen);
+    REQUIRE(partial_concat.value.n_bytes == SIZE);
+    REQUIRE(_files_equal("test_io_copy_src.bin", "test_io_copy_cat.bin", 0));
+
+    for(int m = FILE_COPY_AUTO; m < FILE_COPY_CNT; ++m) {
+        CAPTURE(m);
+        int src_fd = open("test_io_copy_src.bin", O_RDONLY);
+        int dst_fd = open("test_io_copy_dst.bin", O_RDONLY);
+        REQUIRE(src_fd >= 0);
+        REQUIRE(dst_fd >= 0);
+        auto read_only = file_copy_fd(dst_fd, 0, src_fd, 0, SIZE, FileCopyParams{.method = (FileCopyMethod) m});
+        REQUIRE(read_only);
+        REQUIRE(read_only.error == FileErr::CouldNotCopy);
+        REQUIRE(read_only.value.n_bytes == 0);
+        REQUIRE(read_only.value.err != 0);
+        close(src_fd);
+        close(dst_fd);
+    }
+
+    unlink("test_io_copy_src.bin");
+    unlink("test_io_copy_dst.bin");
+    unlink("test_io_copy_cat.bin");
+}
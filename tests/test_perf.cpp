@@ -0,0 +1,36 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <cxb/cxb.h>
+#include <cxb/perf.h>
+
+TEST_CASE("perf counters", "[perf]") {
+    PerfCounters pc = perf_counters_open();
+    volatile u64 sink = 0;
+    PerfSample sample = perf_measure(pc, 100, [&] {
+        for(u64 i = 0; i < 1000; ++i) sink = sink + i;
+    });
+    REQUIRE(sample.n_iters == 100);
+
+    for(int i = 0; i < PERF_COUNTER_CNT; ++i) {
+        // counters that failed to open are reported as unavailable instead of as zero
+        if(pc.fds[i] < 0) {
+            REQUIRE(!sample.valid[i]);
+            REQUIRE(pc.open_errno[i] != 0);
+        }
+    }
+    if(sample.valid[PERF_INSTRUCTIONS]) {
+        // at least one add and store per loop iteration
+        REQUIRE(sample.values[PERF_INSTRUCTIONS] > 1000);
+    }
+
+    AArenaTmp tmp = begin_scratch();
+    String8 line = perf_sample_format(tmp.arena, sample);
+    REQUIRE(line.find(S8_LIT("cycles=")) != SIZE_MAX);
+    REQUIRE(line.find(S8_LIT("dtlb_misses=")) != SIZE_MAX);
+    if(!perf_counters_any(pc)) {
+        REQUIRE(line.find(S8_LIT("instructions=n/a")) != SIZE_MAX);
+    }
+
+    perf_counters_close(pc);
+    REQUIRE(!perf_counters_any(pc));
+}
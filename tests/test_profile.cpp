@@ -0,0 +1,117 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+
+#define CXB_PROFILE
+#include <cxb/cxb.h>
+#include <cxb/profile.h>
+
+#include <thread>
+
+INTERNAL volatile u64 sink = 0;
+
+INTERNAL void spin(u64 n) {
+    for(u64 i = 0; i < n; ++i) sink = sink + i;
+}
+
+INTERNAL void leaf() {
+    PROFILE_FUNCTION();
+    spin(1000);
+}
+
+INTERNAL void parent() {
+    PROFILE_ZONE("parent");
+    spin(1000);
+    for(int i = 0; i < 3; ++i) leaf();
+}
+
+INTERNAL const ProfileZoneStats* find_stats(const Array<ProfileZoneStats>& stats, const char* name) {
+    for(const ProfileZoneStats& s : stats) {
+        if(strcmp(s.name, name) == 0) return &s;
+    }
+    return nullptr;
+}
+
+TEST_CASE("nested zones", "[profile]") {
+    profile_reset();
+    for(int i = 0; i < 10; ++i) parent();
+
+    AArenaTmp tmp = begin_scratch();
+    Array<ProfileZoneStats> stats = profile_summary(tmp.arena);
+    REQUIRE(stats.len == 2);
+
+    const ProfileZoneStats* p = find_stats(stats, "parent");
+    const ProfileZoneStats* l = find_stats(stats, "leaf");
+    REQUIRE(p);
+    REQUIRE(l);
+    REQUIRE(p->count == 10);
+    REQUIRE(l->count == 30);
+    REQUIRE(p->self_ns <= p->inclusive_ns);
+    REQUIRE(p->self_ns < p->inclusive_ns);
+    REQUIRE(l->self_ns == l->inclusive_ns);
+    REQUIRE(p->inclusive_ns >= l->inclusive_ns);
+    REQUIRE(stats[0].self_ns >= stats[1].self_ns);
+}
+
+TEST_CASE("threads", "[profile]") {
+    profile_reset();
+    std::thread threads[4];
+    for(auto& t : threads) {
+        t = std::thread([] {
+            for(int i = 0; i < 100; ++i) leaf();
+        });
+    }
+    for(auto& t : threads) t.join();
+
+    AArenaTmp tmp = begin_scratch();
+    Array<ProfileZoneStats> stats = profile_summary(tmp.arena);
+    const ProfileZoneStats* l = find_stats(stats, "leaf");
+    REQUIRE(l);
+    REQUIRE(l->count == 400);
+}
+
+TEST_CASE("chrome trace", "[profile]") {
+    profile_reset();
+    {
+        PROFILE_ZONE("outer \"quoted\"");
+        leaf();
+    }
+    {
+        PROFILE_ZONE("tab\there\n");
+    }
+
+    AArenaTmp tmp = begin_scratch();
+    String8 json = profile_chrome_trace(tmp.arena);
+    REQUIRE(json.len > 0);
+    REQUIRE(json[0] == '{');
+    REQUIRE(json.find(S8_LIT("\"traceEvents\":[")) != SIZE_MAX);
+    REQUIRE(json.find(S8_LIT("\"name\":\"leaf\"")) != SIZE_MAX);
+    REQUIRE(json.find(S8_LIT("\"name\":\"outer \\\"quoted\\\"\"")) != SIZE_MAX);
+    REQUIRE(json.find(S8_LIT("\"name\":\"tab\\u0009here\\u000a\"")) != SIZE_MAX);
+    REQUIRE(json.find(S8_LIT("\"ph\":\"X\"")) != SIZE_MAX);
+    REQUIRE(json.find(S8_LIT("\"ts\":0.000")) != SIZE_MAX);
+    REQUIRE(json.find(S8_LIT("]}")) != SIZE_MAX);
+}
+
+TEST_CASE("ring buffer wraps", "[profile]") {
+    profile_reset();
+    profile_init(ProfileParams{.ring_capacity = 5});
+
+    u64 count = 0;
+    u64 capacity = 0;
+    std::thread t([&] {
+        for(int i = 0; i < 100; ++i) leaf();
+        count = _profile_thread->count;
+        capacity = _profile_thread->capacity;
+    });
+    t.join();
+    profile_init(ProfileParams{});
+
+    REQUIRE(count == 100);
+    REQUIRE(capacity == 8);
+
+    AArenaTmp tmp = begin_scratch();
+    Array<ProfileZoneStats> stats = profile_summary(tmp.arena);
+    const ProfileZoneStats* l = find_stats(stats, "leaf");
+    REQUIRE(l);
+    REQUIRE(l->count == 8);
+}
@@ -0,0 +1,186 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+#include <cxb/cxb.h>
+#include <cxb/rng.h>
+
+#include <algorithm>
+
+TEST_CASE("reference outputs", "[rng]") {
+    Xoshiro256 x = {{1, 2, 3, 4}};
+    REQUIRE(rng_u64(x) == 0x2800001);
+    REQUIRE(rng_u64(x) == 0x3800067);
+    REQUIRE(rng_u64(x) == 0xcc00003800067);
+    REQUIRE(x() == 0xcc201994400b2);
+
+    u64 seed = 0;
+    REQUIRE(splitmix64(seed) == 0xe220a8397b1dcdaf);
+    REQUIRE(splitmix64(seed) == 0x6e789e6aa1b965f4);
+
+    WyRand w = {0};
+    REQUIRE(rng_u64(w) == 0x111cb3a78f59a58e);
+    REQUIRE(rng_u64(w) == 0xceabd938ff4e856d);
+
+    // pcg32-demo
+    Pcg32 p = pcg32_make(42, 54);
+    REQUIRE(rng_u32(p) == 0xa15c02b7);
+    REQUIRE(rng_u32(p) == 0x7b47f409);
+    REQUIRE(p() == 0xba1d3330);
+}
+
+TEST_CASE("jump ahead", "[rng]") {
+    WyRand w = wyrand_make(7);
+    WyRand w_skip = w;
+    for(int i = 0; i < 1000; ++i) rng_u64(w);
+    wyrand_advance(w_skip, 1000);
+    REQUIRE(rng_u64(w) == rng_u64(w_skip));
+
+    Pcg32 p = pcg32_make(7, 3);
+    Pcg32 p_skip = p;
+    for(int i = 0; i < 12345; ++i) rng_u32(p);
+    pcg32_advance(p_skip, 12345);
+    REQUIRE(p_skip.state == p.state);
+    REQUIRE(rng_u32(p) == rng_u32(p_skip));
+
+    // streams differ from each other and from the seed's sequence
+    Xoshiro256 s0 = xoshiro256_stream(7, 0);
+    Xoshiro256 s1 = xoshiro256_stream(7, 1);
+    Xoshiro256 seeded = xoshiro256_make(7);
+    Xoshiro256 jumped = s0;
+    xoshiro256_jump(jumped);
+    REQUIRE(memcmp(&s0, &seeded, sizeof(s0)) == 0);
+    REQUIRE(rng_u64(s0) != rng_u64(s1));
+    REQUIRE(memcmp(&jumped, &s1, sizeof(s1)) != 0);
+    REQUIRE(memcmp(&jumped, &s0, sizeof(s0)) != 0);
+}
+
+TEST_CASE("bounded and floats", "[rng]") {
+    Xoshiro256 g = xoshiro256_make(1);
+    u32 counts[6] = {};
+    constexpr int N = 60000;
+    for(int i = 0; i < N; ++i) counts[rng_bounded_u32(g, 6)] += 1;
+    for(u32 c : counts) {
+        REQUIRE(c > N / 6 - 600);
+        REQUIRE(c < N / 6 + 600);
+    }
+
+    // n above 2^31: about half of the draws are rejected
+    u32 big = (1u << 31) + 1;
+    for(int i = 0; i < 1000; ++i) REQUIRE(rng_bounded_u32(g, big) < big);
+    for(int i = 0; i < 1000; ++i) REQUIRE(rng_bounded_u64(g, 3) < 3);
+    REQUIRE(rng_bounded_u32(g, 1) == 0);
+
+    bool seen_lo = false;
+    bool seen_hi = false;
+    for(int i = 0; i < 1000; ++i) {
+        i64 x = rng_range(g, -2, 2);
+        REQUIRE(x >= -2);
+        REQUIRE(x <= 2);
+        seen_lo |= x == -2;
+        seen_hi |= x == 2;
+    }
+    REQUIRE(seen_lo);
+    REQUIRE(seen_hi);
+    rng_range(g, INT64_MIN, INT64_MAX);
+
+    f64 sum = 0;
+    for(int i = 0; i < N; ++i) {
+        f64 x = rng_f64(g);
+        f32 y = rng_f32(g);
+        REQUIRE(x >= 0);
+        REQUIRE(x < 1);
+        REQUIRE(y >= 0);
+        REQUIRE(y < 1);
+        sum += x;
+    }
+    REQUIRE(sum / N > 0.49);
+    REQUIRE(sum / N < 0.51);
+
+    f64 u = rng_uniform(g, -3.0, -1.0);
+    REQUIRE(u >= -3.0);
+    REQUIRE(u < -1.0);
+
+    f64 n_sum = 0;
+    f64 n_sum_sq = 0;
+    for(int i = 0; i < N; ++i) {
+        f64 x = rng_normal(g, 2.0, 3.0);
+        n_sum += x;
+        n_sum_sq += x * x;
+    }
+    f64 n_mean = n_sum / N;
+    f64 n_sd = sqrt(n_sum_sq / N - n_mean * n_mean);
+    REQUIRE(n_mean > 1.95);
+    REQUIRE(n_mean < 2.05);
+    REQUIRE(n_sd > 2.95);
+    REQUIRE(n_sd < 3.05);
+    REQUIRE(rng_lognormal(g, 0.0, 1.0) > 0);
+
+    // UniformRandomBitGenerator
+    int xs[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    Pcg32 p = pcg32_make(3);
+    std::shuffle(xs, xs + 8, p);
+    std::sort(xs, xs + 8);
+    for(int i = 0; i < 8; ++i) REQUIRE(xs[i] == i + 1);
+}
+
+TEST_CASE("batch fill matches the lanes", "[rng]") {
+    Arena* arena = arena_make_nbytes(MB(1));
+    Xoshiro256 lanes[4];
+    lanes[0] = xoshiro256_stream(5, 2);
+    for(int j = 1; j < 4; ++j) {
+        lanes[j] = lanes[j - 1];
+        xoshiro256_jump(lanes[j]);
+    }
+
+    Xoshiro256x4 g = xoshiro256x4_make(5, 2);
+    Array<u64> xs = arena_push_array<u64>(arena, 4 * 100 + 3);
+    rng_fill_u64(g, xs);
+    for(size_t k = 0; k < xs.len; ++k) REQUIRE(xs[k] == rng_u64(lanes[k % 4]));
+    // the rest of the partial block was discarded
+    rng_u64(lanes[3]);
+
+    // the same bits as u32 and f32
+    Xoshiro256x4 g2 = g;
+    Array<u32> us = arena_push_array<u32>(arena, 8 * 50 + 5);
+    Array<f32> fs = arena_push_array<f32>(arena, us.len);
+    rng_fill_u32(g, us);
+    rng_fill_f32(g2, fs);
+    // two u32 per u64, low half first
+    u64 x = 0;
+    for(size_t k = 0; k < us.len; ++k) {
+        if(k % 2 == 0) x = rng_u64(lanes[(k / 2) % 4]);
+        u32 u = k % 2 == 0 ? (u32) x : (u32) (x >> 32);
+        REQUIRE(us[k] == u);
+        REQUIRE(fs[k] == (f32) (u >> 8) * 0x1p-24f);
+        REQUIRE(fs[k] < 1);
+    }
+    arena_destroy(arena);
+}
+
+TEST_CASE("batch bounded fill", "[rng]") {
+    Arena* arena = arena_make_nbytes(MB(1));
+    Xoshiro256x4 g = xoshiro256x4_make(9);
+    Array<u32> xs = arena_push_array<u32>(arena, 3000);
+
+    rng_fill_bounded_u32(g, xs, 10);
+    u32 counts[10] = {};
+    for(u32 x : xs) {
+        REQUIRE(x < 10);
+        counts[x] += 1;
+    }
+    for(u32 c : counts) {
+        REQUIRE(c > 200);
+        REQUIRE(c < 400);
+    }
+
+    // frequent rejections
+    u32 big = (1u << 31) + 1;
+    rng_fill_bounded_u32(g, xs, big);
+    u32 n_high = 0;
+    for(u32 x : xs) {
+        REQUIRE(x < big);
+        n_high += x >= (1u << 30);
+    }
+    REQUIRE(n_high > 1300);
+    REQUIRE(n_high < 1700);
+    arena_destroy(arena);
+}
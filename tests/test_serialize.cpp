@@ -0,0 +1,175 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch_test_macros.hpp>
+
+size_t hash(const int& x);
+#include <cxb/cxb.h>
+#include <cxb/serialize.h>
+
+size_t hash(const int& x) {
+    return (size_t) x;
+}
+
+size_t hash(const String8& x) {
+    size_t h = 14695981039346656037ull;
+    for(size_t i = 0; i < x.len; ++i) h = (h ^ (u8) x.data[i]) * 1099511628211ull;
+    return h;
+}
+
+struct Vec3 {
+    f32 x, y, z;
+};
+template <>
+struct SerializePod<Vec3> : std::true_type {};
+
+struct Mesh {
+    String8 name;
+    Array<Vec3> vertices;
+    Array<u32> indices;
+};
+
+void serialize_value(Arena* a, String8& dst, const Mesh& x) {
+    serialize_value(a, dst, x.name);
+    serialize_value(a, dst, x.vertices);
+    serialize_value(a, dst, x.indices);
+}
+
+void deserialize_value(Arena* a, SerialReader& r, Mesh& x) {
+    deserialize_value(a, r, x.name);
+    deserialize_value(a, r, x.vertices);
+    deserialize_value(a, r, x.indices);
+}
+
+TEST_CASE("varints", "[serialize]") {
+    Arena* a = get_perm();
+    u64 values[] = {0, 1, 127, 128, 300, 16383, 16384, (u64) UINT32_MAX, UINT64_MAX};
+    size_t sizes[] = {1, 1, 1, 2, 2, 2, 3, 5, 10};
+    for(size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        String8 dst = {.data = nullptr, .len = 0, .not_null_term = true};
+        serial_write_varint(a, dst, values[i]);
+        REQUIRE(dst.len == sizes[i]);
+
+        SerialReader r = {.src = dst, .pos = 0, .failed = false, .alloc = nullptr};
+        REQUIRE(serial_read_varint(r) == values[i]);
+        REQUIRE(!r.failed);
+        REQUIRE(r.pos == dst.len);
+    }
+}
+
+TEST_CASE("scalars, strings and arrays", "[serialize]") {
+    Arena* a = get_perm();
+
+    auto x = deserialize<i64>(a, serialize(a, (i64) -42));
+    REQUIRE(!x);
+    REQUIRE(x.value == -42);
+
+    String8 bytes = serialize(a, S8_LIT("hello"));
+    REQUIRE(bytes.len == 6);
+    auto s = deserialize<String8>(a, bytes);
+    REQUIRE(!s);
+    REQUIRE(s.value == S8_LIT("hello"));
+    REQUIRE(s.value.data == bytes.data + 1); // zero-copy
+
+    MArray<String8> words{push_arena_alloc(a)};
+    words.push_back(S8_LIT("a"));
+    words.push_back(S8_LIT("bc"));
+    words.push_back(S8_LIT(""));
+    auto words_rt = deserialize<MArray<String8>>(a, serialize(a, words));
+    REQUIRE(!words_rt);
+    REQUIRE(words_rt.value.len == 3);
+    REQUIRE(words_rt.value[1] == S8_LIT("bc"));
+    REQUIRE(words_rt.value[2].len == 0);
+    words_rt.value.push_back(S8_LIT("d")); // arena backed, can grow
+    REQUIRE(words_rt.value.len == 4);
+
+    // bools are validated, any other byte is not a valid bool
+    auto flag = deserialize<bool>(a, serialize(a, true));
+    REQUIRE(!flag);
+    REQUIRE(flag.value);
+    auto flags = deserialize<Array<bool>>(a, String8{.data = (char*) "\x02\x00\x01", .len = 3, .not_null_term = true});
+    REQUIRE(!flags);
+    REQUIRE((flags.value.len == 2 && !flags.value[0] && flags.value[1]));
+    auto bad_flag = deserialize<bool>(a, String8{.data = (char*) "\x02", .len = 1, .not_null_term = true});
+    REQUIRE(bad_flag);
+    REQUIRE(bad_flag.error == SerializeErr::Truncated);
+    REQUIRE(!bad_flag.value);
+
+    AString8 ms("owned");
+    auto ms_rt = deserialize<MString8>(a, serialize<MString8>(a, ms));
+    REQUIRE(!ms_rt);
+    REQUIRE(ms_rt.value == S8_LIT("owned"));
+    REQUIRE(ms_rt.value.allocator == nullptr);
+}
+
+TEST_CASE("user types and pod arrays", "[serialize]") {
+    Arena* a = get_perm();
+    Vec3 vertices[] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+    u32 indices[] = {0, 1, 2};
+    Mesh mesh = {.name = S8_LIT("triangle"), .vertices = {vertices, 3}, .indices = {indices, 3}};
+
+    String8 bytes = serialize(a, mesh);
+    REQUIRE(bytes.len == (1 + 8) + (1 + 3 * sizeof(Vec3)) + (1 + 3 * sizeof(u32)));
+
+    auto rt = deserialize<Mesh>(a, bytes);
+    REQUIRE(!rt);
+    REQUIRE(rt.value.name == S8_LIT("triangle"));
+    REQUIRE(rt.value.vertices.len == 3);
+    REQUIRE(rt.value.vertices[1].x == 1);
+    REQUIRE(rt.value.indices[2] == 2);
+
+    // every strict prefix is truncated, extra bytes are rejected
+    for(size_t n = 0; n < bytes.len; ++n) {
+        auto truncated = deserialize<Mesh>(a, String8{.data = bytes.data, .len = n, .not_null_term = true});
+        REQUIRE(truncated);
+        REQUIRE(truncated.error == SerializeErr::Truncated);
+    }
+    String8 extra = serialize(a, mesh);
+    serial_write_bytes(a, extra, "x", 1);
+    auto trailing = deserialize<Mesh>(a, extra);
+    REQUIRE(trailing);
+    REQUIRE(trailing.error == SerializeErr::TrailingBytes);
+
+    // a corrupt length can not request more than the input holds
+    String8 corrupt = {.data = nullptr, .len = 0, .not_null_term = true};
+    serial_write_varint(a, corrupt, UINT64_MAX / 2);
+    auto huge = deserialize<Array<u64>>(a, corrupt);
+    REQUIRE(huge);
+    REQUIRE(huge.value.len == 0);
+
+    // as does a failed element read
+    String8 words[] = {S8_LIT("a"), S8_LIT("bc")};
+    String8 words_bytes = serialize(a, Array<String8>{words, 2});
+    auto words_truncated = deserialize<Array<String8>>(
+        a, String8{.data = words_bytes.data, .len = words_bytes.len - 1, .not_null_term = true});
+    REQUIRE(words_truncated);
+    REQUIRE(words_truncated.value.len == 0);
+}
+
+TEST_CASE("hash maps", "[serialize]") {
+    Arena* a = get_perm();
+    MHashMap<String8, int> hm{push_arena_alloc(a)};
+    hm.put({S8_LIT("one"), 1});
+    hm.put({S8_LIT("two"), 2});
+    hm.put({S8_LIT("three"), 3});
+
+    auto rt = deserialize<MHashMap<String8, int>>(a, serialize(a, hm));
+    REQUIRE(!rt);
+    REQUIRE(rt.value.len == 3);
+    REQUIRE(rt.value[S8_LIT("two")] == 2);
+    REQUIRE(rt.value[S8_LIT("three")] == 3);
+    REQUIRE(!rt.value.contains(S8_LIT("four")));
+
+    // a failed read leaves the map empty, not holding the entries read so far or a zeroed one
+    String8 bytes = serialize(a, hm);
+    auto truncated = deserialize<MHashMap<String8, int>>(
+        a, String8{.data = bytes.data, .len = bytes.len - 1, .not_null_term = true});
+    REQUIRE(truncated);
+    REQUIRE(truncated.value.len == 0);
+
+    MHashMap<int, Array<u32>> nested{push_arena_alloc(a)};
+    u32 xs[] = {1, 2, 3};
+    nested.put({7, Array<u32>{xs, 3}});
+    auto nested_rt = deserialize<MHashMap<int, Array<u32>>>(a, serialize(a, nested));
+    REQUIRE(!nested_rt);
+    REQUIRE(nested_rt.value[7].len == 3);
+    REQUIRE(nested_rt.value[7][2] == 3);
+}
@@ -85,6 +85,17 @@ TEST_CASE("String8 append C string", "[String8]") {
     REQUIRE(strcmp(s.c_str(), "Hello, World!") == 0);
 }
 
+TEST_CASE("String8 append past the capacity", "[String8]") {
+    // the null terminator needs a byte past len
+    AString8 s("Hello");
+    s.extend(", World! Hello, World! Hello, World!!");
+    s.extend("?");
+
+    REQUIRE(s.len == 43);
+    REQUIRE(s.capacity > s.len);
+    REQUIRE(strcmp(s.c_str(), "Hello, World! Hello, World! Hello, World!!?") == 0);
+}
+
 TEST_CASE("String8 append other String8", "[String8]") {
     AString8 s1("Hello");
     String8 s2 = S8_LIT(", World!");